@@ -1033,6 +1033,8 @@ int char_mmo_chars_fromsql(struct char_session_data* sd, uint8* buf)
 {
 	SqlStmt* stmt;
 	struct mmo_charstatus p;
+	struct char_handoff *h;
+	DBIterator *iter;
 	int j = 0, i;
 	char last_map[MAP_NAME_LENGTH_EXT];
 	time_t unban_time = 0;
@@ -1041,6 +1043,14 @@ int char_mmo_chars_fromsql(struct char_session_data* sd, uint8* buf)
 	nullpo_ret(sd);
 	nullpo_ret(buf);
 
+	// Statuses handed off between map-servers are newer than their SQL rows
+	iter = db_iterator(chr->handoff_db);
+	for (h = dbi_first(iter); dbi_exists(iter); h = dbi_next(iter)) {
+		if (h->account_id == sd->account_id)
+			chr->handoff_save_status(h);
+	}
+	dbi_destroy(iter);
+
 	stmt = SQL->StmtMalloc(inter->sql_handle);
 	if( stmt == NULL ) {
 		SqlStmt_ShowDebug(stmt);
@@ -1129,6 +1139,7 @@ int char_mmo_char_fromsql(int char_id, struct mmo_charstatus* p, bool load_every
 	int i,j;
 	char t_msg[128] = "";
 	struct mmo_charstatus* cp;
+	struct char_handoff *h;
 	StringBuf buf;
 	SqlStmt* stmt;
 	char last_map[MAP_NAME_LENGTH_EXT];
@@ -1152,6 +1163,10 @@ int char_mmo_char_fromsql(int char_id, struct mmo_charstatus* p, bool load_every
 
 	if (save_log) ShowInfo("Char load request (%d)\n", char_id);
 
+	// A status handed off between map-servers is newer than the SQL rows
+	if ((h = (struct char_handoff *)idb_get(chr->handoff_db, char_id)) != NULL)
+		chr->handoff_save_status(h);
+
 	stmt = SQL->StmtMalloc(inter->sql_handle);
 	if( stmt == NULL )
 	{
@@ -3095,6 +3110,34 @@ void char_parse_frommap_map_names(int fd, int id)
 void char_send_scdata(int fd, int aid, int cid)
 {
 	#ifdef ENABLE_SC_SAVING
+	struct char_handoff *h = (struct char_handoff *)idb_get(chr->handoff_db, cid);
+
+	if (h != NULL && h->has_scdata && h->account_id == aid) {
+		// Shipped by the previous map-server, nothing was written to SQL.
+		int count = min(h->sc_count, 50);
+
+		WFIFOHEAD(fd,14+count*sizeof(struct status_change_data));
+		WFIFOW(fd,0) = 0x2b1d;
+		WFIFOW(fd,2) = 14 + count*sizeof(struct status_change_data);
+		WFIFOL(fd,4) = aid;
+		WFIFOL(fd,8) = cid;
+		WFIFOW(fd,12) = count;
+		if (count > 0)
+			memcpy(WFIFOP(fd,14), h->sc_data, count*sizeof(struct status_change_data));
+		WFIFOSET(fd,WFIFOW(fd,2));
+		if (h->sc_count > count)
+			ShowWarning("Too many status changes for %d:%d, some of them were not loaded.\n", aid, cid);
+
+		// Clear the rows stored while online (0x2740) now that the data is loaded.
+		if( SQL_ERROR == SQL->Query(inter->sql_handle, "DELETE FROM `%s` WHERE `account_id` = '%d' AND `char_id`='%d'", scdata_db, aid, cid) )
+			Sql_ShowDebug(inter->sql_handle);
+
+		h->has_scdata = 0;
+		if (!h->has_status)
+			chr->handoff_remove(h);
+		return;
+	}
+
 	if( SQL_ERROR == SQL->Query(inter->sql_handle, "SELECT `type`, `tick`, `val1`, `val2`, `val3`, `val4` "
 		"FROM `%s` WHERE `account_id` = '%d' AND `char_id`='%d'",
 		scdata_db, aid, cid) )
@@ -3208,20 +3251,30 @@ void char_parse_frommap_save_character(int fd, int id)
 		return;
 	}
 	//Check account only if this ain't final save. Final-save goes through because of the char-map reconnect
-	if (RFIFOB(fd,12)
+	if (RFIFOB(fd,12) == 1
 	 || ( (character = (struct online_char_data*)idb_get(chr->online_char_db, aid)) != NULL
 	    && character->char_id == cid)
 	) {
-		struct mmo_charstatus char_dat;
-		memcpy(&char_dat, RFIFOP(fd,13), sizeof(struct mmo_charstatus));
-		chr->mmo_char_tosql(cid, &char_dat);
+		if (RFIFOB(fd,12) == 2) {
+			// Changing map-server: keep it in memory for the destination, written out once it took over.
+			struct char_handoff *h = chr->handoff_ensure(aid, cid);
+			memcpy(&h->status, RFIFOP(fd,13), sizeof(struct mmo_charstatus));
+			h->has_status = 1;
+		} else {
+			struct mmo_charstatus char_dat;
+			struct char_handoff *h = (struct char_handoff *)idb_get(chr->handoff_db, cid);
+			if (h != NULL && h->has_status)
+				h->has_status = 0; // Superseded by this save.
+			memcpy(&char_dat, RFIFOP(fd,13), sizeof(struct mmo_charstatus));
+			chr->mmo_char_tosql(cid, &char_dat);
+		}
 	} else {
 		//This may be valid on char-server reconnection, when re-sending characters that already logged off.
 		ShowError("parse_from_map (save-char): Received data for non-existing/offline character (%d:%d).\n", aid, cid);
 		chr->set_char_online(id, cid, aid);
 	}
 
-	if (RFIFOB(fd,12)) {
+	if (RFIFOB(fd,12) == 1) {
 		//Flag, set character offline after saving. [Skotlex]
 		chr->set_char_offline(cid, aid);
 		chr->save_character_ack(fd, aid, cid);
@@ -3290,13 +3343,17 @@ void char_change_map_server_ack(int fd, uint8 *data, bool ok)
 void char_parse_frommap_change_map_server(int fd)
 {
 	int map_id, map_fd = -1;
-	struct mmo_charstatus* char_data;
+	struct mmo_charstatus* char_data = NULL;
+	struct char_handoff *h;
 
 	map_id = chr->search_mapserver(RFIFOW(fd,18), ntohl(RFIFOL(fd,24)), ntohs(RFIFOW(fd,28))); //Locate mapserver by ip and port.
 	if (map_id >= 0)
 		map_fd = chr->server[map_id].fd;
-	//Char should just had been saved before this packet, so this should be safe. [Skotlex]
-	char_data = (struct mmo_charstatus*)uidb_get(chr->char_db_,RFIFOL(fd,14));
+	//Char should just had been saved (or handed off) before this packet, so this should be safe. [Skotlex]
+	if ((h = (struct char_handoff *)idb_get(chr->handoff_db, RFIFOL(fd,14))) != NULL && h->has_status)
+		char_data = &h->status;
+	else
+		char_data = (struct mmo_charstatus*)uidb_get(chr->char_db_,RFIFOL(fd,14));
 	if (char_data == NULL) {
 		//Really shouldn't happen.
 		struct mmo_charstatus char_dat;
@@ -3676,41 +3733,185 @@ void char_parse_frommap_build_fame_list(int fd)
 	RFIFOSKIP(fd,2);
 }
 
-void char_parse_frommap_save_status_change_data(int fd)
+/**
+ * Replaces the saved status changes of a character.
+ *
+ * @param aid   Account id.
+ * @param cid   Character id.
+ * @param data  Packed status_change_data entries (not necessarily aligned).
+ * @param count Number of entries.
+ */
+void char_scdata_tosql(int aid, int cid, const uint8 *data, int count)
 {
 	#ifdef ENABLE_SC_SAVING
-	int aid = RFIFOL(fd, 4);
-	int cid = RFIFOL(fd, 8);
-	int count = RFIFOW(fd, 12);
-
 	/* clear; ensure no left overs e.g. permanent */
 	if( SQL_ERROR == SQL->Query(inter->sql_handle, "DELETE FROM `%s` WHERE `account_id` = '%d' AND `char_id`='%d'", scdata_db, aid, cid) )
 		Sql_ShowDebug(inter->sql_handle);
 
 	if( count > 0 )
 	{
-		struct status_change_data data;
+		struct status_change_data scdata;
 		StringBuf buf;
 		int i;
 
+		nullpo_retv(data);
 		StrBuf->Init(&buf);
 		StrBuf->Printf(&buf, "INSERT INTO `%s` (`account_id`, `char_id`, `type`, `tick`, `val1`, `val2`, `val3`, `val4`) VALUES ", scdata_db);
 		for( i = 0; i < count; ++i )
 		{
-			memcpy (&data, RFIFOP(fd, 14+i*sizeof(struct status_change_data)), sizeof(struct status_change_data));
+			memcpy(&scdata, data + i*sizeof(struct status_change_data), sizeof(struct status_change_data));
 			if( i > 0 )
 				StrBuf->AppendStr(&buf, ", ");
 			StrBuf->Printf(&buf, "('%d','%d','%hu','%d','%d','%d','%d','%d')", aid, cid,
-				data.type, data.tick, data.val1, data.val2, data.val3, data.val4);
+				scdata.type, scdata.tick, scdata.val1, scdata.val2, scdata.val3, scdata.val4);
 		}
 		if( SQL_ERROR == SQL->QueryStr(inter->sql_handle, StrBuf->Value(&buf)) )
 			Sql_ShowDebug(inter->sql_handle);
 		StrBuf->Destroy(&buf);
 	}
 	#endif
+}
+
+void char_parse_frommap_save_status_change_data(int fd)
+{
+	#ifdef ENABLE_SC_SAVING
+	int aid = RFIFOL(fd, 4);
+	int cid = RFIFOL(fd, 8);
+	int count = RFIFOW(fd, 12);
+	struct char_handoff *h = (struct char_handoff *)idb_get(chr->handoff_db, cid);
+
+	if (h != NULL && h->has_scdata) {
+		h->has_scdata = 0; // Superseded by this save.
+		if (!h->has_status)
+			chr->handoff_remove(h);
+	}
+	chr->scdata_tosql(aid, cid, RFIFOP(fd, 14), count);
+	#endif
+	RFIFOSKIP(fd, RFIFOW(fd, 2));
+}
+
+/**
+ * Status changes of a character about to change map-server (0x2b2b).
+ * Same layout as 0x2b1c, but kept in memory for the destination map-server.
+ */
+void char_parse_frommap_handoff_status_change_data(int fd)
+{
+	#ifdef ENABLE_SC_SAVING
+	int aid = RFIFOL(fd, 4);
+	int cid = RFIFOL(fd, 8);
+	int count = RFIFOW(fd, 12);
+	struct char_handoff *h = chr->handoff_ensure(aid, cid);
+
+	// The rows stored while online (0x2740) stay until this is loaded or written out.
+	if (count > h->sc_count)
+		RECREATE(h->sc_data, struct status_change_data, count);
+	if (count > 0)
+		memcpy(h->sc_data, RFIFOP(fd, 14), count*sizeof(struct status_change_data));
+	h->sc_count = count;
+	h->has_scdata = 1;
+	#endif
 	RFIFOSKIP(fd, RFIFOW(fd, 2));
 }
 
+/**
+ * Looks up (or creates) the handoff entry of a character.
+ *
+ * New entries are written out after CHAR_HANDOFF_TIMEOUT if the destination
+ * map-server never takes over.
+ *
+ * @param account_id Account id.
+ * @param char_id    Character id.
+ * @return the handoff entry.
+ */
+struct char_handoff *char_handoff_ensure(int account_id, int char_id)
+{
+	struct char_handoff *h = (struct char_handoff *)idb_get(chr->handoff_db, char_id);
+
+	if (h == NULL) {
+		CREATE(h, struct char_handoff, 1);
+		h->char_id = char_id;
+		h->flush_timer = INVALID_TIMER;
+		idb_put(chr->handoff_db, char_id, h);
+	}
+	h->account_id = account_id;
+	h->expiration = timer->gettick() + CHAR_HANDOFF_TIMEOUT;
+	if (h->flush_timer == INVALID_TIMER)
+		h->flush_timer = timer->add(h->expiration, chr->handoff_timer, char_id, 0);
+	else
+		timer->settick(h->flush_timer, h->expiration);
+	return h;
+}
+
+/// Writes out the handed off character status, if still pending.
+void char_handoff_save_status(struct char_handoff *h)
+{
+	nullpo_retv(h);
+	if (!h->has_status)
+		return;
+	h->has_status = 0;
+	chr->mmo_char_tosql(h->char_id, &h->status);
+}
+
+/// Writes out the handed off status changes, if still pending.
+void char_handoff_save_scdata(struct char_handoff *h)
+{
+	nullpo_retv(h);
+	if (!h->has_scdata)
+		return;
+	h->has_scdata = 0;
+	chr->scdata_tosql(h->account_id, h->char_id, (const uint8 *)h->sc_data, h->sc_count);
+}
+
+/// Drops a handoff entry, pending data is discarded.
+void char_handoff_remove(struct char_handoff *h)
+{
+	nullpo_retv(h);
+	if (h->flush_timer != INVALID_TIMER)
+		timer->delete(h->flush_timer, chr->handoff_timer);
+	idb_remove(chr->handoff_db, h->char_id);
+	aFree(h->sc_data);
+	aFree(h);
+}
+
+/**
+ * Writes out a handoff entry.
+ *
+ * Fires right after the destination map-server authenticated the character
+ * (status only, the status changes are still to be requested) and on expiration.
+ */
+int char_handoff_timer(int tid, int64 tick, int id, intptr_t data)
+{
+	struct char_handoff *h = (struct char_handoff *)idb_get(chr->handoff_db, id);
+
+	if (h == NULL || h->flush_timer != tid)
+		return 0;
+	h->flush_timer = INVALID_TIMER;
+
+	chr->handoff_save_status(h);
+	if (h->has_scdata && DIFF_TICK(h->expiration, tick) > 0) {
+		h->flush_timer = timer->add(h->expiration, chr->handoff_timer, id, 0);
+		return 0;
+	}
+	chr->handoff_save_scdata(h);
+	chr->handoff_remove(h);
+	return 0;
+}
+
+/// Writes out and frees a handoff entry on shutdown (DBApply).
+int char_handoff_final(DBKey key, DBData *data, va_list ap)
+{
+	struct char_handoff *h = DB->data2ptr(data);
+
+	nullpo_ret(h);
+	chr->handoff_save_status(h);
+	chr->handoff_save_scdata(h);
+	if (h->flush_timer != INVALID_TIMER)
+		timer->delete(h->flush_timer, chr->handoff_timer);
+	aFree(h->sc_data);
+	aFree(h);
+	return 0;
+}
+
 void char_send_pong(int fd)
 {
 	WFIFOHEAD(fd,2);
@@ -3768,6 +3969,7 @@ void char_parse_frommap_auth_request(int fd, int id)
 	struct mmo_charstatus char_dat;
 	struct char_auth_node* node;
 	struct mmo_charstatus* cd;
+	struct char_handoff *h;
 
 	int account_id  = RFIFOL(fd,2);
 	int char_id     = RFIFOL(fd,6);
@@ -3778,7 +3980,10 @@ void char_parse_frommap_auth_request(int fd, int id)
 	RFIFOSKIP(fd,20);
 
 	node = (struct char_auth_node*)idb_get(auth_db, account_id);
-	cd = (struct mmo_charstatus*)uidb_get(chr->char_db_,char_id);
+	if ((h = (struct char_handoff *)idb_get(chr->handoff_db, char_id)) != NULL && h->has_status)
+		cd = &h->status; // Shipped by the previous map-server.
+	else
+		cd = (struct mmo_charstatus*)uidb_get(chr->char_db_,char_id);
 
 	if( cd == NULL ) { //Really shouldn't happen.
 		chr->mmo_char_fromsql(char_id, &char_dat, true);
@@ -3809,6 +4014,9 @@ void char_parse_frommap_auth_request(int fd, int id)
 		// only use the auth once and mark user online
 		idb_remove(auth_db, account_id);
 		chr->set_char_online(id, char_id, account_id);
+		// The destination took over, write the handed off status once the reply is out.
+		if (h != NULL && h->has_status && h->flush_timer != INVALID_TIMER)
+			timer->settick(h->flush_timer, timer->gettick());
 	}
 	else
 	{// auth failed
@@ -3894,6 +4102,40 @@ void char_parse_frommap_scdata_delete(int fd)
 	RFIFOSKIP(fd, 12);
 }
 
+/**
+ * Map-server offers a shared memory link (0x2b28).
+ * The answer is the last packet sent over TCP when the link is accepted.
+ */
+void char_parse_frommap_local_transport(int fd, int id)
+{
+	char name[SOCKET_SHM_NAME_LENGTH];
+	bool ok;
+
+	safestrncpy(name, (char*)RFIFOP(fd,2), sizeof(name));
+	RFIFOSKIP(fd, 2 + SOCKET_SHM_NAME_LENGTH);
+
+	ok = sockt->shm_attach(fd, name);
+
+	WFIFOHEAD(fd,3);
+	WFIFOW(fd,0) = 0x2b29;
+	WFIFOB(fd,2) = ok ? 0 : 1;
+	WFIFOSET(fd,3);
+
+	if( ok ) {
+		sockt->shm_start_send(fd);
+		ShowStatus("Map-Server %d is on this machine, switched its connection to a local link.\n", id);
+	}
+}
+
+/**
+ * Last packet the map-server sends over TCP (0x2b2a), the rest comes through the shared memory link.
+ */
+void char_parse_frommap_local_transport_switch(int fd, int id)
+{
+	RFIFOSKIP(fd, 2);
+	sockt->shm_start_recv(fd);
+}
+
 int char_parse_frommap(int fd)
 {
 	int i;
@@ -4103,6 +4345,22 @@ int char_parse_frommap(int fd)
 				}
 				break;
 
+			case 0x2b28: // local transport request
+				if( RFIFOREST(fd) < 2 + SOCKET_SHM_NAME_LENGTH )
+					return 0;
+				chr->parse_frommap_local_transport(fd, id);
+			break;
+
+			case 0x2b2a: // local transport switch
+				chr->parse_frommap_local_transport_switch(fd, id);
+			break;
+
+			case 0x2b2b: // status change data of a character changing map-server
+				if (RFIFOREST(fd) < 4 || RFIFOREST(fd) < RFIFOW(fd,2))
+					return 0;
+				chr->parse_frommap_handoff_status_change_data(fd);
+			break;
+
 			/* individual sc data delete */
 			case 0x2741:
 				if( RFIFOREST(fd) < 12 )
@@ -5758,6 +6016,9 @@ int do_final(void) {
 
 	HPM->event(HPET_FINAL);
 
+	// Write out characters that were still being handed off between map-servers.
+	chr->handoff_db->destroy(chr->handoff_db, chr->handoff_final);
+
 	chr->set_all_offline(-1);
 	chr->set_all_offline_sql();
 
@@ -5952,6 +6213,10 @@ int do_init(int argc, char **argv) {
 	// Timer to clear (chr->online_char_db)
 	timer->add_func_list(chr->waiting_disconnect, "chr->waiting_disconnect");
 
+	// Characters handed off between map-servers
+	chr->handoff_db = idb_alloc(DB_OPT_BASE);
+	timer->add_func_list(chr->handoff_timer, "chr->handoff_timer");
+
 	// Online Data timers (checking if char still connected)
 	timer->add_func_list(chr->online_data_cleanup, "chr->online_data_cleanup");
 	timer->add_interval(timer->gettick() + 1000, chr->online_data_cleanup, 0, 0, 600 * 1000);
@@ -6024,6 +6289,7 @@ void char_defaults(void)
 	chr->char_fd = -1;
 	chr->online_char_db = NULL;
 	chr->char_db_ = NULL;
+	chr->handoff_db = NULL;
 
 	memset(chr->userid, 0, sizeof(chr->userid));
 	memset(chr->passwd, 0, sizeof(chr->passwd));
@@ -6138,6 +6404,16 @@ void char_defaults(void)
 	chr->parse_frommap_request_stats_report = char_parse_frommap_request_stats_report;
 	chr->parse_frommap_scdata_update = char_parse_frommap_scdata_update;
 	chr->parse_frommap_scdata_delete = char_parse_frommap_scdata_delete;
+	chr->parse_frommap_local_transport = char_parse_frommap_local_transport;
+	chr->parse_frommap_local_transport_switch = char_parse_frommap_local_transport_switch;
+	chr->parse_frommap_handoff_status_change_data = char_parse_frommap_handoff_status_change_data;
+	chr->handoff_ensure = char_handoff_ensure;
+	chr->handoff_save_status = char_handoff_save_status;
+	chr->handoff_save_scdata = char_handoff_save_scdata;
+	chr->handoff_remove = char_handoff_remove;
+	chr->handoff_timer = char_handoff_timer;
+	chr->handoff_final = char_handoff_final;
+	chr->scdata_tosql = char_scdata_tosql;
 	chr->parse_frommap = char_parse_frommap;
 	chr->search_mapserver = char_search_mapserver;
 	chr->mapif_init = char_mapif_init;
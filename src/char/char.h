@@ -57,6 +57,29 @@ struct mmo_map_server {
 
 #define DEFAULT_AUTOSAVE_INTERVAL (300*1000)
 
+/// How long a character handed off between map-servers is kept in memory before it is written out anyway.
+#define CHAR_HANDOFF_TIMEOUT (30*1000)
+
+/**
+ * Character data in transit between two map-servers.
+ *
+ * The source map-server ships the character status and its status changes
+ * right before changing map-server; they are kept here and given to the
+ * destination map-server as-is, the SQL writes are done once the destination
+ * took over (or the handoff timed out).
+ **/
+struct char_handoff {
+	int account_id;
+	int char_id;
+	struct mmo_charstatus status; ///< Status shipped by the source map-server, valid when has_status is set
+	struct status_change_data *sc_data; ///< Status changes shipped by the source map-server
+	int sc_count;                 ///< Entries in sc_data
+	int64 expiration;             ///< Tick at which everything still pending is written out
+	int flush_timer;              ///< Timer writing out pending data
+	unsigned has_status : 1;
+	unsigned has_scdata : 1;
+};
+
 enum {
 	TABLE_INVENTORY,
 	TABLE_CART,
@@ -85,6 +108,7 @@ struct char_interface {
 	int char_fd;
 	DBMap* online_char_db; // int account_id -> struct online_char_data*
 	DBMap* char_db_;
+	DBMap* handoff_db; // int char_id -> struct char_handoff*
 	char userid[NAME_LENGTH];
 	char passwd[NAME_LENGTH];
 	char server_name[20];
@@ -202,6 +226,16 @@ struct char_interface {
 	void (*parse_frommap_request_stats_report) (int fd);
 	void (*parse_frommap_scdata_update) (int fd);
 	void (*parse_frommap_scdata_delete) (int fd);
+	void (*parse_frommap_local_transport) (int fd, int id);
+	void (*parse_frommap_local_transport_switch) (int fd, int id);
+	void (*parse_frommap_handoff_status_change_data) (int fd);
+	struct char_handoff *(*handoff_ensure) (int account_id, int char_id);
+	void (*handoff_save_status) (struct char_handoff *h);
+	void (*handoff_save_scdata) (struct char_handoff *h);
+	void (*handoff_remove) (struct char_handoff *h);
+	int (*handoff_timer) (int tid, int64 tick, int id, intptr_t data);
+	int (*handoff_final) (DBKey key, DBData *data, va_list ap);
+	void (*scdata_tosql) (int aid, int cid, const uint8 *data, int count);
 	int (*parse_frommap) (int fd);
 	int (*search_mapserver) (unsigned short map, uint32 ip, uint16 port);
 	int (*mapif_init) (int fd);
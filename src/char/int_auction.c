@@ -29,18 +29,135 @@ struct inter_auction_interface *inter_auction;
 
 static int inter_auction_count(int char_id, bool buy)
 {
-	int i = 0;
-	struct auction_data *auction;
-	DBIterator *iter = db_iterator(inter_auction->db);
+	struct auction_index *index = (struct auction_index *)idb_get(buy ? inter_auction->buyer_db : inter_auction->seller_db, char_id);
+
+	return index ? VECTOR_LENGTH(index->list) : 0;
+}
+
+/**
+ * Returns the item type search an auction is listed under, -1 if none.
+ */
+static int inter_auction_category(short type)
+{
+	switch( type )
+	{
+		case IT_ARMOR:
+		case IT_PETARMOR: return AUCTION_SEARCH_ARMOR;
+		case IT_WEAPON:   return AUCTION_SEARCH_WEAPON;
+		case IT_CARD:     return AUCTION_SEARCH_CARD;
+		case IT_ETC:      return AUCTION_SEARCH_ETC;
+	}
+	return -1;
+}
+
+/**
+ * Finds the position of an auction in an index (or where it would be inserted).
+ *
+ * @param by_price Whether the index is ordered by price first.
+ */
+int inter_auction_index_find(const struct auction_index *index, const struct auction_data *auction, bool by_price)
+{
+	int lo = 0, hi;
+
+	nullpo_ret(index);
+	nullpo_ret(auction);
+
+	hi = VECTOR_LENGTH(index->list);
+	while( lo < hi )
+	{
+		int mid = (lo + hi) / 2;
+		const struct auction_data *cur = VECTOR_INDEX(index->list, mid);
+
+		if( (by_price && cur->price < auction->price)
+		 || ((!by_price || cur->price == auction->price) && cur->auction_id < auction->auction_id) )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
 
-	for( auction = dbi_first(iter); dbi_exists(iter); auction = dbi_next(iter) )
+void inter_auction_index_add(struct auction_index *index, struct auction_data *auction, bool by_price)
+{
+	int i = inter_auction->index_find(index, auction, by_price);
+
+	VECTOR_ENSURE(index->list, 1, 8);
+	VECTOR_INSERT(index->list, i, auction);
+}
+
+void inter_auction_index_erase(struct auction_index *index, struct auction_data *auction, bool by_price)
+{
+	int i = inter_auction->index_find(index, auction, by_price);
+
+	if( i < VECTOR_LENGTH(index->list) && VECTOR_INDEX(index->list, i) == auction )
+		VECTOR_ERASE(index->list, i);
+}
+
+void inter_auction_index_db_add(DBMap *db, int key, struct auction_data *auction)
+{
+	struct auction_index *index;
+
+	if( (index = (struct auction_index *)idb_get(db, key)) == NULL )
 	{
-		if ((buy && auction->buyer_id == char_id) || (!buy && auction->seller_id == char_id))
-			i++;
+		CREATE(index, struct auction_index, 1);
+		VECTOR_INIT(index->list);
+		idb_put(db, key, index);
 	}
-	dbi_destroy(iter);
 
-	return i;
+	inter_auction->index_add(index, auction, false);
+}
+
+void inter_auction_index_db_erase(DBMap *db, int key, struct auction_data *auction)
+{
+	struct auction_index *index;
+
+	if( (index = (struct auction_index *)idb_get(db, key)) == NULL )
+		return;
+
+	inter_auction->index_erase(index, auction, false);
+	if( VECTOR_LENGTH(index->list) == 0 )
+	{
+		idb_remove(db, key);
+		VECTOR_CLEAR(index->list);
+		aFree(index);
+	}
+}
+
+/**
+ * Adds an auction to the secondary indexes, must be called once it is in inter_auction->db.
+ */
+void inter_auction_index_insert(struct auction_data *auction)
+{
+	int category;
+
+	nullpo_retv(auction);
+
+	if( (category = inter_auction_category(auction->type)) != -1 )
+		inter_auction->index_add(&inter_auction->category_index[category], auction, false);
+	inter_auction->index_add(&inter_auction->price_index, auction, true);
+	inter_auction->index_db_add(inter_auction->seller_db, auction->seller_id, auction);
+	if( auction->buyer_id > 0 )
+		inter_auction->index_db_add(inter_auction->buyer_db, auction->buyer_id, auction);
+	inter_auction->index_db_add(inter_auction->name_db, auction->item.nameid, auction);
+}
+
+/**
+ * Removes an auction from the secondary indexes, must be called before its buyer or price change.
+ */
+void inter_auction_index_remove(struct auction_data *auction)
+{
+	int category;
+
+	nullpo_retv(auction);
+
+	if( (category = inter_auction_category(auction->type)) != -1 )
+		inter_auction->index_erase(&inter_auction->category_index[category], auction, false);
+	inter_auction->index_erase(&inter_auction->price_index, auction, true);
+	inter_auction->index_db_erase(inter_auction->seller_db, auction->seller_id, auction);
+	if( auction->buyer_id > 0 )
+		inter_auction->index_db_erase(inter_auction->buyer_db, auction->buyer_id, auction);
+	inter_auction->index_db_erase(inter_auction->name_db, auction->item.nameid, auction);
 }
 
 void inter_auction_save(struct auction_data *auction)
@@ -120,6 +237,7 @@ unsigned int inter_auction_create(struct auction_data *auction)
 		CREATE(auction_, struct auction_data, 1);
 		memcpy(auction_, auction, sizeof(struct auction_data));
 		idb_put(inter_auction->db, auction_->auction_id, auction_);
+		inter_auction->index_insert(auction_);
 	}
 
 	SQL->StmtFree(stmt);
@@ -173,6 +291,7 @@ void inter_auction_delete(struct auction_data *auction)
 	if( auction->auction_end_timer != INVALID_TIMER )
 		timer->delete(auction->auction_end_timer, inter_auction->end_timer);
 
+	inter_auction->index_remove(auction);
 	idb_remove(inter_auction->db, auction_id);
 }
 
@@ -236,6 +355,7 @@ void inter_auctions_fromsql(void)
 
 		auction->auction_end_timer = timer->add(endtick, inter_auction->end_timer, auction->auction_id, 0);
 		idb_put(inter_auction->db, auction->auction_id, auction);
+		inter_auction->index_insert(auction);
 	}
 
 	SQL->FreeResult(inter->sql_handle);
@@ -257,47 +377,92 @@ void mapif_auction_sendlist(int fd, int char_id, short count, short pages, unsig
 	WFIFOSET(fd,len);
 }
 
+/**
+ * Copies the auctions of a list of matches that fall into the requested page.
+ *
+ * @param list  Matching auctions.
+ * @param count Length of list.
+ * @param pos   Position of list[0] among all matches of the search.
+ * @param page  Requested page, starting at 1.
+ * @param buf   Page buffer (AUCTION_PAGE_SIZE auctions).
+ * @return Number of auctions copied.
+ */
+int inter_auction_page(struct auction_data **list, int count, int pos, short page, unsigned char *buf)
+{
+	int first = (page - 1) * AUCTION_PAGE_SIZE, i, n = 0;
+
+	nullpo_ret(buf);
+
+	for( i = max(first - pos, 0); i < count && pos + i < first + AUCTION_PAGE_SIZE; i++, n++ )
+		memcpy(WBUFP(buf, (pos + i - first) * sizeof(struct auction_data)), list[i], sizeof(struct auction_data));
+
+	return n;
+}
+
 void mapif_parse_auction_requestlist(int fd)
 {
 	char searchtext[NAME_LENGTH];
-	int char_id = RFIFOL(fd,4), len = sizeof(struct auction_data);
+	int char_id = RFIFOL(fd,4);
 	int price = RFIFOL(fd,10);
 	short type = RFIFOW(fd,8), page = max(1,RFIFOW(fd,14));
-	unsigned char buf[5 * sizeof(struct auction_data)];
-	DBIterator *iter = db_iterator(inter_auction->db);
-	struct auction_data *auction;
-	short i = 0, j = 0, pages = 1;
+	unsigned char buf[AUCTION_PAGE_SIZE * sizeof(struct auction_data)];
+	struct auction_index *index = NULL;
+	int total = 0, j = 0;
 
 	memcpy(searchtext, RFIFOP(fd,16), NAME_LENGTH);
 
-	for( auction = dbi_first(iter); dbi_exists(iter); auction = dbi_next(iter) )
+	switch( type )
 	{
-		if( (type == 0 && auction->type != IT_ARMOR && auction->type != IT_PETARMOR) ||
-			(type == 1 && auction->type != IT_WEAPON) ||
-			(type == 2 && auction->type != IT_CARD) ||
-			(type == 3 && auction->type != IT_ETC) ||
-			(type == 4 && !strstr(auction->item_name, searchtext)) ||
-			(type == 5 && auction->price > price) ||
-			(type == 6 && auction->seller_id != char_id) ||
-			(type == 7 && auction->buyer_id != char_id) )
-			continue;
-
-		i++;
-		if( i > 5 )
-		{ // Counting Pages of Total Results (5 Results per Page)
-			pages++;
-			i = 1; // First Result of This Page
+		case AUCTION_SEARCH_ARMOR:
+		case AUCTION_SEARCH_WEAPON:
+		case AUCTION_SEARCH_CARD:
+		case AUCTION_SEARCH_ETC:
+			index = &inter_auction->category_index[type];
+			break;
+		case AUCTION_SEARCH_NAME:
+		{ // Only the distinct item names are matched, all auctions of an item share its name
+			DBIterator *iter = db_iterator(inter_auction->name_db);
+			struct auction_index *item;
+
+			for( item = dbi_first(iter); dbi_exists(iter); item = dbi_next(iter) )
+			{
+				if( !strstr(VECTOR_INDEX(item->list, 0)->item_name, searchtext) )
+					continue;
+
+				j += inter_auction->page(VECTOR_DATA(item->list), VECTOR_LENGTH(item->list), total, page, buf);
+				total += VECTOR_LENGTH(item->list);
+			}
+			dbi_destroy(iter);
+			break;
 		}
+		case AUCTION_SEARCH_PRICE:
+		{ // Auctions up to the given price are the head of the price index
+			struct auction_data key;
+
+			key.price = price;
+			key.auction_id = UINT_MAX;
+			total = inter_auction->index_find(&inter_auction->price_index, &key, true);
+			j = inter_auction->page(VECTOR_DATA(inter_auction->price_index.list), total, 0, page, buf);
+			break;
+		}
+		case AUCTION_SEARCH_SELL:
+			index = (struct auction_index *)idb_get(inter_auction->seller_db, char_id);
+			break;
+		case AUCTION_SEARCH_BUY:
+			index = (struct auction_index *)idb_get(inter_auction->buyer_db, char_id);
+			break;
+		default: // Unknown searches match every auction
+			index = &inter_auction->price_index;
+			break;
+	}
 
-		if( page != pages )
-			continue; // This is not the requested Page
-
-		memcpy(WBUFP(buf, j * len), auction, len);
-		j++; // Found Results
+	if( index != NULL )
+	{
+		total = VECTOR_LENGTH(index->list);
+		j = inter_auction->page(VECTOR_DATA(index->list), total, 0, page, buf);
 	}
-	dbi_destroy(iter);
 
-	mapif->auction_sendlist(fd, char_id, j, pages, buf);
+	mapif->auction_sendlist(fd, char_id, j, max(1, (total + AUCTION_PAGE_SIZE - 1) / AUCTION_PAGE_SIZE), buf);
 }
 
 void mapif_auction_register(int fd, struct auction_data *auction)
@@ -445,9 +610,11 @@ void mapif_parse_auction_bid(int fd)
 			inter_mail->sendmail(0, "Auction Manager", auction->buyer_id, auction->buyer_name, "Auction", "You have placed a higher bid.", auction->price, NULL);
 	}
 
+	inter_auction->index_remove(auction);
 	auction->buyer_id = char_id;
 	safestrncpy(auction->buyer_name, (char*)RFIFOP(fd,16), NAME_LENGTH);
 	auction->price = bid;
+	inter_auction->index_insert(auction);
 
 	if( bid >= auction->buynow )
 	{ // Automatic won the auction
@@ -484,9 +651,25 @@ int inter_auction_parse_frommap(int fd)
 	return 1;
 }
 
+/**
+ * @see DBApply
+ */
+static int inter_auction_index_final(DBKey key, DBData *data, va_list ap)
+{
+	struct auction_index *index = DB->data2ptr(data);
+
+	VECTOR_CLEAR(index->list);
+	aFree(index);
+
+	return 0;
+}
+
 int inter_auction_sql_init(void)
 {
 	inter_auction->db = idb_alloc(DB_OPT_RELEASE_DATA);
+	inter_auction->seller_db = idb_alloc(DB_OPT_BASE);
+	inter_auction->buyer_db = idb_alloc(DB_OPT_BASE);
+	inter_auction->name_db = idb_alloc(DB_OPT_BASE);
 	inter_auction->fromsql();
 
 	return 0;
@@ -494,6 +677,14 @@ int inter_auction_sql_init(void)
 
 void inter_auction_sql_final(void)
 {
+	int i;
+
+	inter_auction->seller_db->destroy(inter_auction->seller_db, inter_auction_index_final);
+	inter_auction->buyer_db->destroy(inter_auction->buyer_db, inter_auction_index_final);
+	inter_auction->name_db->destroy(inter_auction->name_db, inter_auction_index_final);
+	for( i = 0; i < AUCTION_SEARCH_CATEGORY_MAX; i++ )
+		VECTOR_CLEAR(inter_auction->category_index[i].list);
+	VECTOR_CLEAR(inter_auction->price_index.list);
 	inter_auction->db->destroy(inter_auction->db,NULL);
 
 	return;
@@ -501,9 +692,17 @@ void inter_auction_sql_final(void)
 
 void inter_auction_defaults(void)
 {
+	int i;
+
 	inter_auction = &inter_auction_s;
 
 	inter_auction->db = NULL; // int auction_id -> struct auction_data*
+	for( i = 0; i < AUCTION_SEARCH_CATEGORY_MAX; i++ )
+		VECTOR_INIT(inter_auction->category_index[i].list);
+	VECTOR_INIT(inter_auction->price_index.list);
+	inter_auction->seller_db = NULL;
+	inter_auction->buyer_db = NULL;
+	inter_auction->name_db = NULL;
 
 	inter_auction->count = inter_auction_count;
 	inter_auction->save = inter_auction_save;
@@ -514,4 +713,12 @@ void inter_auction_defaults(void)
 	inter_auction->parse_frommap = inter_auction_parse_frommap;
 	inter_auction->sql_init = inter_auction_sql_init;
 	inter_auction->sql_final = inter_auction_sql_final;
+	inter_auction->index_insert = inter_auction_index_insert;
+	inter_auction->index_remove = inter_auction_index_remove;
+	inter_auction->index_find = inter_auction_index_find;
+	inter_auction->index_add = inter_auction_index_add;
+	inter_auction->index_erase = inter_auction_index_erase;
+	inter_auction->index_db_add = inter_auction_index_db_add;
+	inter_auction->index_db_erase = inter_auction_index_db_erase;
+	inter_auction->page = inter_auction_page;
 }
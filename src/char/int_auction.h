@@ -8,11 +8,40 @@
 #include "common/db.h"
 #include "common/mmo.h"
 
+#define AUCTION_PAGE_SIZE 5 ///< Results per auction list page
+
+/**
+ * Auction list search types (0x3050)
+ **/
+enum auction_search_type {
+	AUCTION_SEARCH_ARMOR  = 0,
+	AUCTION_SEARCH_WEAPON = 1,
+	AUCTION_SEARCH_CARD   = 2,
+	AUCTION_SEARCH_ETC    = 3,
+	AUCTION_SEARCH_NAME   = 4,
+	AUCTION_SEARCH_PRICE  = 5,
+	AUCTION_SEARCH_SELL   = 6,
+	AUCTION_SEARCH_BUY    = 7,
+	AUCTION_SEARCH_CATEGORY_MAX = AUCTION_SEARCH_NAME, ///< Searches below this one are by item type
+};
+
+/**
+ * Secondary index over inter_auction->db
+ **/
+struct auction_index {
+	VECTOR_DECL(struct auction_data *) list; ///< Ordered by auction id (by price, then auction id, for inter_auction->price_index)
+};
+
 /**
  * inter_auction_interface interface
  **/
 struct inter_auction_interface {
 	DBMap* db; // int auction_id -> struct auction_data*
+	struct auction_index category_index[AUCTION_SEARCH_CATEGORY_MAX]; // by enum auction_search_type
+	struct auction_index price_index; // all auctions
+	DBMap* seller_db; // int seller_id -> struct auction_index*
+	DBMap* buyer_db; // int buyer_id -> struct auction_index*
+	DBMap* name_db; // int nameid -> struct auction_index*, auctions of one item share its name
 	int (*count) (int char_id, bool buy);
 	void (*save) (struct auction_data *auction);
 	unsigned int (*create) (struct auction_data *auction);
@@ -22,6 +51,14 @@ struct inter_auction_interface {
 	int (*parse_frommap) (int fd);
 	int (*sql_init) (void);
 	void (*sql_final) (void);
+	void (*index_insert) (struct auction_data *auction);
+	void (*index_remove) (struct auction_data *auction);
+	int (*index_find) (const struct auction_index *index, const struct auction_data *auction, bool by_price);
+	void (*index_add) (struct auction_index *index, struct auction_data *auction, bool by_price);
+	void (*index_erase) (struct auction_index *index, struct auction_data *auction, bool by_price);
+	void (*index_db_add) (DBMap *db, int key, struct auction_data *auction);
+	void (*index_db_erase) (DBMap *db, int key, struct auction_data *auction);
+	int (*page) (struct auction_data **list, int count, int pos, short page, unsigned char *buf);
 };
 
 #ifdef HERCULES_CORE
@@ -16,6 +16,7 @@
 HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 	#ifdef CHAR_CHAR_H
 		{ "char_auth_node", sizeof(struct char_auth_node), SERVER_TYPE_CHAR },
+		{ "char_handoff", sizeof(struct char_handoff), SERVER_TYPE_CHAR },
 		{ "char_interface", sizeof(struct char_interface), SERVER_TYPE_CHAR },
 		{ "char_session_data", sizeof(struct char_session_data), SERVER_TYPE_CHAR },
 		{ "mmo_map_server", sizeof(struct mmo_map_server), SERVER_TYPE_CHAR },
@@ -35,6 +36,7 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		#define CHAR_INTER_H
 	#endif // CHAR_INTER_H
 	#ifdef CHAR_INT_AUCTION_H
+		{ "auction_index", sizeof(struct auction_index), SERVER_TYPE_CHAR },
 		{ "inter_auction_interface", sizeof(struct inter_auction_interface), SERVER_TYPE_CHAR },
 	#else
 		#define CHAR_INT_AUCTION_H
@@ -203,6 +205,9 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		{ "s_subnet", sizeof(struct s_subnet), SERVER_TYPE_ALL },
 		{ "socket_data", sizeof(struct socket_data), SERVER_TYPE_ALL },
 		{ "socket_interface", sizeof(struct socket_interface), SERVER_TYPE_ALL },
+		{ "socket_shm", sizeof(struct socket_shm), SERVER_TYPE_ALL },
+		{ "socket_shm_ring", sizeof(struct socket_shm_ring), SERVER_TYPE_ALL },
+		{ "socket_shm_segment", sizeof(struct socket_shm_segment), SERVER_TYPE_ALL },
 	#else
 		#define COMMON_SOCKET_H
 	#endif // COMMON_SOCKET_H
@@ -233,6 +238,7 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 	#ifdef COMMON_TIMER_H
 		{ "TimerData", sizeof(struct TimerData), SERVER_TYPE_ALL },
 		{ "timer_interface", sizeof(struct timer_interface), SERVER_TYPE_ALL },
+		{ "timer_profile_stat", sizeof(struct timer_profile_stat), SERVER_TYPE_ALL },
 	#else
 		#define COMMON_TIMER_H
 	#endif // COMMON_TIMER_H
@@ -264,6 +270,7 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		{ "AliasInfo", sizeof(struct AliasInfo), SERVER_TYPE_MAP },
 		{ "AtCommandInfo", sizeof(struct AtCommandInfo), SERVER_TYPE_MAP },
 		{ "atcmd_binding_data", sizeof(struct atcmd_binding_data), SERVER_TYPE_MAP },
+		{ "atcmd_dispatch_entry", sizeof(struct atcmd_dispatch_entry), SERVER_TYPE_MAP },
 		{ "atcommand_interface", sizeof(struct atcommand_interface), SERVER_TYPE_MAP },
 	#else
 		#define MAP_ATCOMMAND_H
@@ -280,6 +287,7 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		{ "Battle_Config", sizeof(struct Battle_Config), SERVER_TYPE_MAP },
 		{ "Damage", sizeof(struct Damage), SERVER_TYPE_MAP },
 		{ "battle_interface", sizeof(struct battle_interface), SERVER_TYPE_MAP },
+		{ "battle_skill_terms", sizeof(struct battle_skill_terms), SERVER_TYPE_MAP },
 		{ "delay_damage", sizeof(struct delay_damage), SERVER_TYPE_MAP },
 	#else
 		#define MAP_BATTLE_H
@@ -314,6 +322,13 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 	#ifdef MAP_CLIF_H
 		{ "cdelayed_damage", sizeof(struct cdelayed_damage), SERVER_TYPE_MAP },
 		{ "clif_interface", sizeof(struct clif_interface), SERVER_TYPE_MAP },
+		{ "clif_packet_bucket", sizeof(struct clif_packet_bucket), SERVER_TYPE_MAP },
+		{ "clif_session_throttle", sizeof(struct clif_session_throttle), SERVER_TYPE_MAP },
+		{ "clif_throttle_entry", sizeof(struct clif_throttle_entry), SERVER_TYPE_MAP },
+		{ "clif_throttle_stats", sizeof(struct clif_throttle_stats), SERVER_TYPE_MAP },
+		{ "clif_unit_packet", sizeof(struct clif_unit_packet), SERVER_TYPE_MAP },
+		{ "clif_view_enter", sizeof(struct clif_view_enter), SERVER_TYPE_MAP },
+		{ "clif_view_stats", sizeof(struct clif_view_stats), SERVER_TYPE_MAP },
 		{ "hCSData", sizeof(struct hCSData), SERVER_TYPE_MAP },
 		{ "merge_item", sizeof(struct merge_item), SERVER_TYPE_MAP },
 		{ "s_packet_db", sizeof(struct s_packet_db), SERVER_TYPE_MAP },
@@ -421,6 +436,7 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		{ "mapit_interface", sizeof(struct mapit_interface), SERVER_TYPE_MAP },
 		{ "questinfo", sizeof(struct questinfo), SERVER_TYPE_MAP },
 		{ "spawn_data", sizeof(struct spawn_data), SERVER_TYPE_MAP },
+		{ "xy_broadcast_stats", sizeof(struct xy_broadcast_stats), SERVER_TYPE_MAP },
 	#else
 		#define MAP_MAP_H
 	#endif // MAP_MAP_H
@@ -450,8 +466,10 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		{ "npc_item_list", sizeof(struct npc_item_list), SERVER_TYPE_MAP },
 		{ "npc_label_list", sizeof(struct npc_label_list), SERVER_TYPE_MAP },
 		{ "npc_path_data", sizeof(struct npc_path_data), SERVER_TYPE_MAP },
+		{ "npc_preload_queue", sizeof(struct npc_preload_queue), SERVER_TYPE_MAP },
 		{ "npc_shop_data", sizeof(struct npc_shop_data), SERVER_TYPE_MAP },
 		{ "npc_src_list", sizeof(struct npc_src_list), SERVER_TYPE_MAP },
+		{ "npc_src_preload", sizeof(struct npc_src_preload), SERVER_TYPE_MAP },
 		{ "npc_timerevent_list", sizeof(struct npc_timerevent_list), SERVER_TYPE_MAP },
 	#else
 		#define MAP_NPC_H
@@ -548,6 +566,7 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 	#ifdef MAP_PC_H
 		{ "autotrade_vending", sizeof(struct autotrade_vending), SERVER_TYPE_MAP },
 		{ "item_cd", sizeof(struct item_cd), SERVER_TYPE_MAP },
+		{ "item_index", sizeof(struct item_index), SERVER_TYPE_MAP },
 		{ "map_session_data", sizeof(struct map_session_data), SERVER_TYPE_MAP },
 		{ "pc_combos", sizeof(struct pc_combos), SERVER_TYPE_MAP },
 		{ "pc_interface", sizeof(struct pc_interface), SERVER_TYPE_MAP },
@@ -589,6 +608,9 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		{ "hQueueIterator", sizeof(struct hQueueIterator), SERVER_TYPE_MAP },
 		{ "reg_db", sizeof(struct reg_db), SERVER_TYPE_MAP },
 		{ "script_array", sizeof(struct script_array), SERVER_TYPE_MAP },
+		{ "script_bytecode_cache", sizeof(struct script_bytecode_cache), SERVER_TYPE_MAP },
+		{ "script_bytecode_entry", sizeof(struct script_bytecode_entry), SERVER_TYPE_MAP },
+		{ "script_bytecode_header", sizeof(struct script_bytecode_header), SERVER_TYPE_MAP },
 		{ "script_code", sizeof(struct script_code), SERVER_TYPE_MAP },
 		{ "script_data", sizeof(struct script_data), SERVER_TYPE_MAP },
 		{ "script_function", sizeof(struct script_function), SERVER_TYPE_MAP },
@@ -605,6 +627,8 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		#define MAP_SCRIPT_H
 	#endif // MAP_SCRIPT_H
 	#ifdef MAP_SEARCHSTORE_H
+		{ "s_search_store_index_entry", sizeof(struct s_search_store_index_entry), SERVER_TYPE_MAP },
+		{ "s_search_store_index_list", sizeof(struct s_search_store_index_list), SERVER_TYPE_MAP },
 		{ "s_search_store_info", sizeof(struct s_search_store_info), SERVER_TYPE_MAP },
 		{ "s_search_store_info_item", sizeof(struct s_search_store_info_item), SERVER_TYPE_MAP },
 		{ "searchstore_interface", sizeof(struct searchstore_interface), SERVER_TYPE_MAP },
@@ -640,6 +664,8 @@ HPExport const struct s_HPMDataCheck HPMDataCheck[] = {
 		{ "s_refine_info", sizeof(struct s_refine_info), SERVER_TYPE_MAP },
 		{ "s_status_dbs", sizeof(struct s_status_dbs), SERVER_TYPE_MAP },
 		{ "sc_display_entry", sizeof(struct sc_display_entry), SERVER_TYPE_MAP },
+		{ "sc_mod_rates", sizeof(struct sc_mod_rates), SERVER_TYPE_MAP },
+		{ "sc_modifier", sizeof(struct sc_modifier), SERVER_TYPE_MAP },
 		{ "status_change", sizeof(struct status_change), SERVER_TYPE_MAP },
 		{ "status_change_entry", sizeof(struct status_change_entry), SERVER_TYPE_MAP },
 		{ "status_data", sizeof(struct status_data), SERVER_TYPE_MAP },
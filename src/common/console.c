@@ -121,6 +121,22 @@ CPCMD_C(mem_report,server) {
 #endif
 }
 
+/**
+ * Displays the main loop frame profile
+ * Usage: server frame_report [number of timer functions to list]
+ **/
+CPCMD_C(frame_report,server) {
+	timer->profile_report(line ? atoi(line) : 0);
+}
+
+/**
+ * Clears the main loop frame profile
+ **/
+CPCMD_C(frame_reset,server) {
+	timer->profile_reset();
+	ShowInfo("Frame profile cleared.\n");
+}
+
 /**
  * Displays command list
  **/
@@ -207,6 +223,8 @@ void console_load_defaults(void)
 		CP_DEF_S(ers_report,server),
 		CP_DEF_S(mem_report,server),
 		CP_DEF_S(malloc_usage,server),
+		CP_DEF_S(frame_report,server),
+		CP_DEF_S(frame_reset,server),
 		CP_DEF_S(exit,server),
 		/**
 		 * Sql related commands
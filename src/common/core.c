@@ -251,6 +251,20 @@ static CMDLINEARG(version)
 	ShowInfo("Open "CL_WHITE"readme.txt"CL_RESET" for more information.\n");
 	return false;
 }
+#ifndef MINICORE
+/**
+ * --rnd-seed handler
+ *
+ * Seeds the random number generator with a fixed value instead of the
+ * time and process id, so that runs can be reproduced (testing).
+ * @see cmdline->exec
+ */
+static CMDLINEARG(rndseed)
+{
+	rnd_seed((uint32)strtoul(params, NULL, 10));
+	return true;
+}
+#endif // !MINICORE
 /**
  * Checks if there is a value available for the current argument
  *
@@ -293,6 +307,8 @@ int cmdline_exec(int argc, char **argv, unsigned int options)
 		struct CmdlineArgData *data = NULL;
 		const char *arg = argv[i];
 		if (arg[0] != '-') { // All arguments must begin with '-'
+			if (options&(CMDLINE_OPT_SILENT|CMDLINE_OPT_PREINIT))
+				continue; // May be the value of an option that plugins haven't registered yet
 			ShowError("Invalid option '%s'.\n", argv[i]);
 			exit(EXIT_FAILURE);
 		}
@@ -343,6 +359,7 @@ void cmdline_init(void)
 	CMDLINEARG_DEF(version, 'v', "Displays the server's version.", CMDLINE_OPT_NORMAL);
 #ifndef MINICORE
 	CMDLINEARG_DEF2(load-plugin, loadplugin, "Loads an additional plugin (can be repeated).", CMDLINE_OPT_PARAM|CMDLINE_OPT_PREINIT);
+	CMDLINEARG_DEF2(rnd-seed, rndseed, "Seeds the random number generator with a fixed value (testing).", CMDLINE_OPT_PARAM);
 #endif // !MINICORE
 	cmdline_args_init_local();
 }
@@ -416,6 +433,7 @@ int main (int argc, char **argv) {
 
 	Sql_Init();
 	rathread_init();
+	showmsg->async_init();
 	DB->init();
 	signals_init();
 
@@ -441,8 +459,11 @@ int main (int argc, char **argv) {
 
 	// Main runtime cycle
 	while (core->runflag != CORE_ST_STOP) {
+		int64 frame_start = timer->microtick(), timers_end;
 		int next = timer->perform(timer->gettick_nocache());
+		timers_end = timer->microtick();
 		sockt->perform(next);
+		timer->profile_frame(frame_start, timers_end, timer->microtick());
 	}
 
 	console->final();
@@ -452,6 +473,7 @@ int main (int argc, char **argv) {
 	timer->final();
 	sockt->final();
 	DB->final();
+	showmsg->async_final();
 	rathread_final();
 	ers_final();
 #endif
@@ -7,14 +7,20 @@
 #include "showmsg.h"
 
 #include "common/cbasetypes.h"
+#include "common/atomic.h"
 #include "common/core.h" //[Ind] - For SERVER_TYPE
+#include "common/malloc.h"
+#include "common/mutex.h"
 #include "common/strlib.h" // StringBuf
+#include "common/thread.h"
 
 #include <libconfig/libconfig.h>
 
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h> // atexit
+#include <string.h>
+#include <time.h>
 
 #ifdef WIN32
 #	include "common/winapi.h"
@@ -38,6 +44,9 @@ struct showmsg_interface *showmsg;
 
 #define SBUF_SIZE 2054 // never put less that what's required for the debug message
 
+#define SHOWMSG_OUT_CONSOLE 0x1 ///< Print to the console (and DEBUGLOGPATH)
+#define SHOWMSG_OUT_MSGLOG  0x2 ///< Append to the console_log message log
+
 #define NEWBUF(buf) \
 	struct { \
 		char s_[SBUF_SIZE]; \
@@ -48,7 +57,10 @@ struct showmsg_interface *showmsg;
 //define NEWBUF
 
 #define BUFVPRINTF(buf,fmt,args) do { \
-	(buf).l_ = vsnprintf((buf).s_, SBUF_SIZE, (fmt), args); \
+	va_list argscopy_; \
+	va_copy(argscopy_, args); /* args is used again below */ \
+	(buf).l_ = vsnprintf((buf).s_, SBUF_SIZE, (fmt), argscopy_); \
+	va_end(argscopy_); \
 	if( (buf).l_ >= 0 && (buf).l_ < SBUF_SIZE ) \
 	{/* static buffer */ \
 		(buf).v_ = (buf).s_; \
@@ -586,41 +598,391 @@ int FPRINTF(FILE *file, const char *fmt, ...) {
 
 #endif// not _WIN32
 
-int vShowMessage_(enum msg_type flag, const char *string, va_list ap)
+/**
+ * Writes a formatted message to its destinations.
+ *
+ * This is the only place that touches the console and the log files; it is
+ * called directly by vShowMessage_ when the asynchronous writer is not
+ * running and by the writer thread otherwise.
+ *
+ * @param flag    Message type.
+ * @param outputs Bitmask of SHOWMSG_OUT_* destinations.
+ * @param stamp   Timestamp for the message log (only used with SHOWMSG_OUT_MSGLOG).
+ * @param prefix  Console prefix (type tag and optional timestamp).
+ * @param body    Formatted message text.
+ */
+static void showmsg_write(enum msg_type flag, int outputs, const char *stamp, const char *prefix, const char *body)
 {
-	va_list apcopy;
-	char prefix[100];
 #if defined(DEBUGLOGMAP) || defined(DEBUGLOGCHAR) || defined(DEBUGLOGLOGIN)
 	FILE *fp;
 #endif
 
-	if (!string || *string == '\0') {
-		ShowError("Empty string passed to vShowMessage_().\n");
-		return 1;
-	}
-	if(
-		( flag == MSG_WARNING && showmsg->console_log&1 ) ||
-		( ( flag == MSG_ERROR || flag == MSG_SQL ) && showmsg->console_log&2 ) ||
-		( flag == MSG_DEBUG && showmsg->console_log&4 ) ) {//[Ind]
+	if (outputs&SHOWMSG_OUT_MSGLOG) {
 		FILE *log = NULL;
 		if( (log = fopen(SERVER_TYPE == SERVER_TYPE_MAP ? "./log/map-msg_log.log" : "./log/unknown.log","a+")) ) {
-			char timestring[255];
-			time_t curtime;
-			time(&curtime);
-			strftime(timestring, 254, "%m/%d/%Y %H:%M:%S", localtime(&curtime));
-			fprintf(log,"(%s) [ %s ] : ",
-				timestring,
+			fprintf(log,"(%s) [ %s ] : %s",
+				stamp,
 				flag == MSG_WARNING ? "Warning" :
 				flag == MSG_ERROR ? "Error" :
 				flag == MSG_SQL ? "SQL Error" :
 				flag == MSG_DEBUG ? "Debug" :
-				"Unknown");
-			va_copy(apcopy, ap);
-			vfprintf(log,string,apcopy);
-			va_end(apcopy);
+				"Unknown",
+				body);
 			fclose(log);
 		}
 	}
+	if (!(outputs&SHOWMSG_OUT_CONSOLE))
+		return;
+
+	if (flag == MSG_ERROR || flag == MSG_FATALERROR || flag == MSG_SQL) {
+		//Send Errors to StdErr [Skotlex]
+		FPRINTF(STDERR, "%s ", prefix);
+		FPRINTF(STDERR, "%s", body);
+		FFLUSH(STDERR);
+	} else {
+		if (flag != MSG_NONE)
+			FPRINTF(STDOUT, "%s ", prefix);
+		FPRINTF(STDOUT, "%s", body);
+		FFLUSH(STDOUT);
+	}
+
+#if defined(DEBUGLOGMAP) || defined(DEBUGLOGCHAR) || defined(DEBUGLOGLOGIN)
+	if(strlen(DEBUGLOGPATH) > 0) {
+		fp=fopen(DEBUGLOGPATH,"a");
+		if (fp == NULL) {
+			FPRINTF(STDERR, CL_RED"[ERROR]"CL_RESET": Could not open '"CL_WHITE"%s"CL_RESET"', access denied.\n", DEBUGLOGPATH);
+			FFLUSH(STDERR);
+		} else {
+			fprintf(fp,"%s %s", prefix, body);
+			fclose(fp);
+		}
+	} else {
+		FPRINTF(STDERR, CL_RED"[ERROR]"CL_RESET": DEBUGLOGPATH not defined!\n");
+		FFLUSH(STDERR);
+	}
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Asynchronous output.
+///
+/// Messages are formatted by the calling thread and copied into a fixed ring
+/// of preallocated slots; a single writer thread drains the ring and performs
+/// the actual console/file I/O, so a slow terminal or disk never stalls the
+/// main loop.  The ring is a bounded multi-producer queue (each slot carries
+/// a sequence number, producers claim positions with a CAS on the tail) so
+/// any thread may log without taking a lock.
+///
+/// Loss policy when the ring is full: errors, SQL errors and warnings wait
+/// for a free slot, everything else gives the writer SHOWMSG_ASYNC_RETRIES
+/// chances to catch up and is then dropped and counted; the writer reports
+/// the number of dropped messages once it catches up.
+/// Fatal errors, messages that do not fit in a slot, messages logged by the
+/// writer itself and anything logged while the writer is not running are
+/// written synchronously (after draining the ring, to keep the ordering).
+/// The ring is also drained at exit, so an error logged right before exit()
+/// is still written, in order.
+///
+/// The writer also collapses runs of identical messages: repeats of the last
+/// message within SHOWMSG_REPEAT_WINDOW seconds are counted instead of
+/// printed, and a single "last message repeated" line is emitted when the
+/// run ends.
+
+struct showmsg_slot {
+	volatile int32 seq; ///< Ring position this slot is ready for (see showmsg_async_push)
+	int32 flag;         ///< enum msg_type
+	int32 outputs;      ///< SHOWMSG_OUT_* bitmask
+	int32 body;         ///< Offset of the message body in text (the prefix comes first)
+	char stamp[24];     ///< Message log timestamp
+	char text[SHOWMSG_ASYNC_LINE];
+};
+
+static struct {
+	struct showmsg_slot *ring;
+	volatile int32 tail;      ///< Next position to be claimed by a producer
+	volatile int32 head;      ///< Next position to be consumed (written by the writer thread only)
+	volatile int32 running;   ///< Writer thread keeps going while non-zero
+	volatile int32 sleeping;  ///< Writer thread is (about to be) waiting on cond
+	volatile int32 dropped;   ///< Messages dropped because the ring was full
+	rAthread *thread;
+	ramutex *mutex;
+	racond *cond;
+
+	// duplicate suppression (writer thread only)
+	enum msg_type last_flag;
+	char last_body[SHOWMSG_ASYNC_LINE];
+	char last_prefix[100];
+	time_t last_time;
+	int repeats;
+} showmsg_async = { 0 };
+
+/// Emits the pending "last message repeated" line, if any (writer thread only).
+static void showmsg_async_flush_repeats(void)
+{
+	char body[64];
+
+	if (showmsg_async.repeats == 0)
+		return;
+	snprintf(body, sizeof(body), "Last message repeated %d time%s.\n", showmsg_async.repeats, showmsg_async.repeats == 1 ? "" : "s");
+	showmsg_write(showmsg_async.last_flag, SHOWMSG_OUT_CONSOLE, "", showmsg_async.last_prefix, body);
+	showmsg_async.repeats = 0;
+}
+
+/// Writes out one dequeued slot (writer thread only).
+static void showmsg_async_write(struct showmsg_slot *slot)
+{
+	const char *body = slot->text + slot->body;
+	time_t now = time(NULL);
+
+	if (slot->outputs&SHOWMSG_OUT_CONSOLE && slot->flag == MSG_NONE) {
+		// raw output (line fragments, blank lines) is never collapsed, but ends a run
+		showmsg_async_flush_repeats();
+		showmsg_async.last_body[0] = '\0';
+	} else if (slot->outputs&SHOWMSG_OUT_CONSOLE) {
+		if (slot->flag == showmsg_async.last_flag && now - showmsg_async.last_time < SHOWMSG_REPEAT_WINDOW
+		 && strcmp(body, showmsg_async.last_body) == 0) {
+			showmsg_async.repeats++;
+			if (slot->outputs&SHOWMSG_OUT_MSGLOG)
+				showmsg_write(slot->flag, SHOWMSG_OUT_MSGLOG, slot->stamp, "", body);
+			return;
+		}
+		showmsg_async_flush_repeats();
+		showmsg_async.last_flag = slot->flag;
+		showmsg_async.last_time = now;
+		safestrncpy(showmsg_async.last_body, body, sizeof(showmsg_async.last_body));
+		safestrncpy(showmsg_async.last_prefix, slot->text, min(slot->body, (int)sizeof(showmsg_async.last_prefix)));
+	}
+	slot->text[slot->body > 0 ? slot->body - 1 : 0] = '\0'; // terminate the prefix
+	showmsg_write(slot->flag, slot->outputs, slot->stamp, slot->text, body);
+}
+
+/**
+ * Writes out everything currently in the ring (writer thread only).
+ *
+ * @return the number of messages written.
+ */
+static int showmsg_async_drain(void)
+{
+	int count = 0;
+	int32 dropped;
+
+	for (;;) {
+		int32 pos = showmsg_async.head;
+		struct showmsg_slot *slot = &showmsg_async.ring[pos&(SHOWMSG_ASYNC_SLOTS-1)];
+
+		if (slot->seq != pos + 1)
+			break; // empty (or the producer hasn't finished filling it yet)
+		showmsg_async_write(slot);
+		InterlockedExchange(&slot->seq, pos + SHOWMSG_ASYNC_SLOTS); // hand the slot back to the producers
+		showmsg_async.head = pos + 1;
+		count++;
+	}
+
+	if ((dropped = InterlockedExchange(&showmsg_async.dropped, 0)) != 0) {
+		char body[96];
+		showmsg_async_flush_repeats();
+		showmsg_async.last_body[0] = '\0';
+		snprintf(body, sizeof(body), "showmsg: %d message%s dropped, console output could not keep up.\n", dropped, dropped == 1 ? "" : "s");
+		showmsg_write(MSG_WARNING, SHOWMSG_OUT_CONSOLE, "", CL_YELLOW"[Warning]"CL_RESET":", body);
+	}
+	return count;
+}
+
+/// Writer thread main loop.
+static void *showmsg_async_main(void *param)
+{
+	while (showmsg_async.running) {
+		if (showmsg_async_drain() > 0)
+			continue;
+		if (showmsg_async.repeats > 0 && time(NULL) - showmsg_async.last_time >= SHOWMSG_REPEAT_WINDOW) {
+			showmsg_async_flush_repeats();
+			showmsg_async.last_body[0] = '\0';
+		}
+		// Producers only signal when this flag is set; the timeout covers the
+		// (harmless) race between the last drain and setting it.
+		InterlockedExchange(&showmsg_async.sleeping, 1);
+		ramutex_lock(showmsg_async.mutex);
+		racond_wait(showmsg_async.cond, showmsg_async.mutex, SHOWMSG_ASYNC_IDLE);
+		ramutex_unlock(showmsg_async.mutex);
+		InterlockedExchange(&showmsg_async.sleeping, 0);
+	}
+	showmsg_async_drain();
+	showmsg_async_flush_repeats();
+	return NULL;
+}
+
+/// Wakes up the writer thread if it's waiting.
+static void showmsg_async_wakeup(void)
+{
+	if (InterlockedCompareExchange(&showmsg_async.sleeping, 0, 1) == 1)
+		racond_signal(showmsg_async.cond);
+}
+
+/// Whether messages logged by the calling thread go through the writer thread.
+static bool showmsg_async_active(void)
+{
+	return showmsg_async.running && rathread_self() != showmsg_async.thread;
+}
+
+/// Waits until the writer thread has written everything queued so far.
+static void showmsg_async_wait(void)
+{
+	int32 tail = showmsg_async.tail;
+
+	showmsg_async_wakeup();
+	while (showmsg_async.running && (int32)(showmsg_async.head - tail) < 0) {
+		showmsg_async_wakeup();
+		rathread_yield();
+	}
+}
+
+/**
+ * Queues a message for the writer thread.
+ *
+ * @param flag    Message type.
+ * @param outputs Bitmask of SHOWMSG_OUT_* destinations.
+ * @param stamp   Message log timestamp.
+ * @param prefix  Console prefix.
+ * @param body    Formatted message text.
+ * @param len     Length of body.
+ * @retval true  the message was queued, or dropped according to the loss policy.
+ * @retval false the message must be written synchronously.
+ */
+static bool showmsg_async_push(enum msg_type flag, int outputs, const char *stamp, const char *prefix, const char *body, int len)
+{
+	struct showmsg_slot *slot;
+	int plen = (int)strlen(prefix);
+	int retries = 0;
+	int32 pos;
+
+	if (plen + 1 + len >= SHOWMSG_ASYNC_LINE)
+		return false;
+
+	pos = showmsg_async.tail;
+	for (;;) {
+		int32 diff;
+		slot = &showmsg_async.ring[pos&(SHOWMSG_ASYNC_SLOTS-1)];
+		diff = slot->seq - pos;
+		if (diff == 0) {
+			if (InterlockedCompareExchange(&showmsg_async.tail, pos + 1, pos) == pos)
+				break; // claimed
+		} else if (diff < 0) { // full
+			if (++retries > SHOWMSG_ASYNC_RETRIES
+			 && (flag == MSG_NONE || flag == MSG_STATUS || flag == MSG_INFORMATION || flag == MSG_NOTICE || flag == MSG_DEBUG)) {
+				InterlockedIncrement(&showmsg_async.dropped);
+				return true;
+			}
+			showmsg_async_wakeup();
+			rathread_yield();
+		}
+		pos = showmsg_async.tail;
+	}
+
+	slot->flag = flag;
+	slot->outputs = outputs;
+	slot->body = plen + 1;
+	safestrncpy(slot->stamp, stamp, sizeof(slot->stamp));
+	memcpy(slot->text, prefix, plen);
+	slot->text[plen] = ' ';
+	memcpy(slot->text + plen + 1, body, len + 1);
+	InterlockedExchange(&slot->seq, pos + 1); // publish
+
+	showmsg_async_wakeup();
+	return true;
+}
+
+/// atexit handler, writes out what's still queued when the program exits without do_final.
+static void showmsg_async_atexit(void)
+{
+	if (showmsg_async.running && rathread_self() != showmsg_async.thread)
+		showmsg->async_final();
+}
+
+/**
+ * Starts the asynchronous writer thread.
+ *
+ * Requires the threading subsystem; until this is called (and after
+ * showmsg->async_final) messages are written synchronously.
+ */
+void showmsg_async_init(void)
+{
+	static bool atexit_set = false;
+	int i;
+
+	if (showmsg_async.running)
+		return;
+
+	CREATE(showmsg_async.ring, struct showmsg_slot, SHOWMSG_ASYNC_SLOTS);
+	for (i = 0; i < SHOWMSG_ASYNC_SLOTS; i++)
+		showmsg_async.ring[i].seq = i;
+	showmsg_async.tail = showmsg_async.head = 0;
+	showmsg_async.dropped = showmsg_async.sleeping = 0;
+	showmsg_async.repeats = 0;
+	showmsg_async.last_body[0] = '\0';
+	showmsg_async.mutex = ramutex_create();
+	showmsg_async.cond = racond_create();
+
+	showmsg_async.running = 1;
+	if ((showmsg_async.thread = rathread_create(showmsg_async_main, NULL)) == NULL) {
+		showmsg_async.running = 0;
+		racond_destroy(showmsg_async.cond);
+		ramutex_destroy(showmsg_async.mutex);
+		aFree(showmsg_async.ring);
+		showmsg_async.ring = NULL;
+		ShowError("showmsg_async_init: failed to start the writer thread, console output stays synchronous.\n");
+		return;
+	}
+	if (!atexit_set) {
+		atexit(showmsg_async_atexit);
+		atexit_set = true;
+	}
+}
+
+/**
+ * Stops the asynchronous writer thread, after it has written everything
+ * that was queued.
+ */
+void showmsg_async_final(void)
+{
+	if (!showmsg_async.running)
+		return;
+
+	InterlockedExchange(&showmsg_async.running, 0);
+	ramutex_lock(showmsg_async.mutex);
+	racond_signal(showmsg_async.cond);
+	ramutex_unlock(showmsg_async.mutex);
+	rathread_wait(showmsg_async.thread, NULL);
+	showmsg_async.thread = NULL;
+
+	racond_destroy(showmsg_async.cond);
+	ramutex_destroy(showmsg_async.mutex);
+	aFree(showmsg_async.ring);
+	showmsg_async.ring = NULL;
+}
+
+int vShowMessage_(enum msg_type flag, const char *string, va_list ap)
+{
+	va_list apcopy;
+	char prefix[100];
+	char stamp[24];
+	int outputs = SHOWMSG_OUT_CONSOLE;
+	NEWBUF(body);
+
+	if (!string || *string == '\0') {
+		ShowError("Empty string passed to vShowMessage_().\n");
+		return 1;
+	}
+	if(
+		( flag == MSG_WARNING && showmsg->console_log&1 ) ||
+		( ( flag == MSG_ERROR || flag == MSG_SQL ) && showmsg->console_log&2 ) ||
+		( flag == MSG_DEBUG && showmsg->console_log&4 ) ) {//[Ind]
+		time_t curtime;
+		time(&curtime);
+		strftime(stamp, sizeof(stamp), "%m/%d/%Y %H:%M:%S", localtime(&curtime));
+		outputs |= SHOWMSG_OUT_MSGLOG;
+	} else {
+		stamp[0] = '\0';
+	}
 	if(
 	    (flag == MSG_INFORMATION && showmsg->silent&1) ||
 	    (flag == MSG_STATUS && showmsg->silent&2) ||
@@ -630,7 +992,9 @@ int vShowMessage_(enum msg_type flag, const char *string, va_list ap)
 	    (flag == MSG_SQL && showmsg->silent&16) ||
 	    (flag == MSG_DEBUG && showmsg->silent&32)
 	)
-		return 0; //Do not print it.
+		outputs &= ~SHOWMSG_OUT_CONSOLE; //Do not print it.
+	if (outputs == 0)
+		return 0;
 
 	if (showmsg->timestamp_format[0] && flag != MSG_NONE) {
 		//Display time format. [Skotlex]
@@ -670,40 +1034,28 @@ int vShowMessage_(enum msg_type flag, const char *string, va_list ap)
 			return 1;
 	}
 
-	if (flag == MSG_ERROR || flag == MSG_FATALERROR || flag == MSG_SQL) {
-		//Send Errors to StdErr [Skotlex]
-		FPRINTF(STDERR, "%s ", prefix);
-		va_copy(apcopy, ap);
-		VFPRINTF(STDERR, string, apcopy);
-		va_end(apcopy);
-		FFLUSH(STDERR);
+	va_copy(apcopy, ap);
+	body.l_ = vsnprintf(body.s_, SBUF_SIZE, string, apcopy);
+	va_end(apcopy);
+	if (body.l_ >= 0 && body.l_ < SBUF_SIZE) {
+		body.v_ = body.s_;
 	} else {
-		if (flag != MSG_NONE)
-			FPRINTF(STDOUT, "%s ", prefix);
+		body.d_ = StrBuf->Malloc();
 		va_copy(apcopy, ap);
-		VFPRINTF(STDOUT, string, apcopy);
+		body.l_ = StrBuf->Vprintf(body.d_, string, apcopy);
 		va_end(apcopy);
-		FFLUSH(STDOUT);
+		body.v_ = StrBuf->Value(body.d_);
 	}
 
-#if defined(DEBUGLOGMAP) || defined(DEBUGLOGCHAR) || defined(DEBUGLOGLOGIN)
-	if(strlen(DEBUGLOGPATH) > 0) {
-		fp=fopen(DEBUGLOGPATH,"a");
-		if (fp == NULL) {
-			FPRINTF(STDERR, CL_RED"[ERROR]"CL_RESET": Could not open '"CL_WHITE"%s"CL_RESET"', access denied.\n", DEBUGLOGPATH);
-			FFLUSH(STDERR);
-		} else {
-			fprintf(fp,"%s ", prefix);
-			va_copy(apcopy, ap);
-			vfprintf(fp,string,apcopy);
-			va_end(apcopy);
-			fclose(fp);
+	if (showmsg_async_active()) {
+		if (flag != MSG_FATALERROR && showmsg_async_push(flag, outputs, stamp, prefix, BUFVAL(body), BUFLEN(body))) {
+			FREEBUF(body);
+			return 0;
 		}
-	} else {
-		FPRINTF(STDERR, CL_RED"[ERROR]"CL_RESET": DEBUGLOGPATH not defined!\n");
-		FFLUSH(STDERR);
+		showmsg_async_wait(); // keep the ordering
 	}
-#endif
+	showmsg_write(flag, outputs, stamp, prefix, BUFVAL(body));
+	FREEBUF(body);
 
 	return 0;
 }
@@ -848,6 +1200,8 @@ void showmsg_defaults(void)
 
 	showmsg->init = showmsg_init;
 	showmsg->final = showmsg_final;
+	showmsg->async_init = showmsg_async_init;
+	showmsg->async_final = showmsg_async_final;
 
 	showmsg->clearScreen = showmsg_clearScreen;
 	showmsg->showMessageV = showmsg_vShowMessage;
@@ -69,6 +69,17 @@
 
 #define CL_SPACE   "           "   // space aquivalent of the print messages
 
+/// Number of preallocated slots in the asynchronous output ring (power of 2).
+#define SHOWMSG_ASYNC_SLOTS 2048
+/// Size of a ring slot; longer messages are written synchronously.
+#define SHOWMSG_ASYNC_LINE 1024
+/// How many times a low priority message yields on a full ring before being dropped.
+#define SHOWMSG_ASYNC_RETRIES 64
+/// How long the writer thread sleeps when idle, in milliseconds.
+#define SHOWMSG_ASYNC_IDLE 100
+/// Identical consecutive messages within this many seconds are collapsed.
+#define SHOWMSG_REPEAT_WINDOW 5
+
 enum msg_type {
 	MSG_NONE,
 	MSG_STATUS,
@@ -89,6 +100,8 @@ struct showmsg_interface {
 
 	void (*init) (void);
 	void (*final) (void);
+	void (*async_init) (void);
+	void (*async_final) (void);
 
 	void (*clearScreen) (void);
 	int (*showMessageV) (const char *string, va_list ap);
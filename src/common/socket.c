@@ -8,6 +8,7 @@
 #include "socket.h"
 
 #include "common/HPM.h"
+#include "common/atomic.h"
 #include "common/cbasetypes.h"
 #include "common/db.h"
 #include "common/malloc.h"
@@ -26,6 +27,7 @@
 #else
 #	include <arpa/inet.h>
 #	include <errno.h>
+#	include <fcntl.h>
 #	include <net/if.h>
 #	include <netdb.h>
 #if defined __linux__ || defined __linux
@@ -35,7 +37,9 @@
 #	include <netinet/tcp.h>
 #endif
 #	include <sys/ioctl.h>
+#	include <sys/mman.h>
 #	include <sys/socket.h>
+#	include <sys/stat.h>
 #	include <sys/time.h>
 #	include <unistd.h>
 
@@ -292,6 +296,14 @@ void set_defaultparse(ParseFunc defaultparse)
 	default_func_parse = defaultparse;
 }
 
+/// Run at the start of every do_sockets, before anything is sent (NULL: none)
+PreSendFunc func_presend = NULL;
+
+void set_presend(PreSendFunc presend)
+{
+	func_presend = presend;
+}
+
 /*======================================
  * CORE : Socket options
  *--------------------------------------*/
@@ -464,6 +476,339 @@ void flush_fifos(void)
 		sockt->flush(i);
 }
 
+/*======================================
+ * CORE : Local transport
+ *--------------------------------------
+ * Servers on the same machine can move a session's traffic to a pair of
+ * shared memory rings (one per direction). RFIFO/WFIFO and the packet
+ * handlers are unchanged, only func_recv/func_send of the session differ.
+ * The rings are drained every cycle of do_sockets. Only when do_sockets is
+ * about to block in select does the consumer of an empty ring ask for a
+ * wakeup through ring->waiting, the producer then writes a single doorbell
+ * byte to the TCP connection, which select is waiting on.
+ *--------------------------------------*/
+
+/// Copies what the peer wrote to the ring into the RFIFO.
+static void shm_fill_fifo(int fd)
+{
+	struct socket_data *s = sockt->session[fd];
+	struct socket_shm_ring *ring = s->shm->in;
+
+	uint32 tail = (uint32)ring->tail;
+	uint32 len = (uint32)min((uint32)InterlockedExchangeAdd(&ring->head, 0) - tail, RFIFOSPACE(fd));
+	uint32 offset, chunk;
+
+	InterlockedCompareExchange(&ring->waiting, 0, 1); // awake, doorbells are not needed until the next select
+	if( len == 0 )
+		return; // empty, or RFIFO full: the rest is picked up in the next cycle
+
+	offset = tail&(SOCKET_SHM_RING_SIZE-1);
+	chunk = min(len, SOCKET_SHM_RING_SIZE - offset);
+	memcpy(s->rdata + s->rdata_size, ring->data + offset, chunk);
+	memcpy(s->rdata + s->rdata_size + chunk, ring->data, len - chunk);
+	InterlockedExchangeAdd(&ring->tail, (int32)len);
+
+	s->rdata_size += len;
+	s->rdata_tick = sockt->last_tick;
+#ifdef SHOW_SERVER_STATS
+	socket_data_i += len;
+	socket_data_qi += len;
+#endif
+}
+
+/**
+ * Asks the peer for a doorbell before do_sockets blocks in select.
+ *
+ * @retval false if the ring already holds data, select must not block then.
+ */
+static bool shm_request_doorbell(int fd)
+{
+	struct socket_shm_ring *ring = sockt->session[fd]->shm->in;
+
+	if( InterlockedExchangeAdd(&ring->head, 0) != ring->tail )
+		return false;
+	// make sure nothing was written before the request was seen
+	InterlockedExchange(&ring->waiting, 1);
+	return InterlockedExchangeAdd(&ring->head, 0) == ring->tail;
+}
+
+/// func_recv of sessions on the local transport: the connection only carries doorbells.
+static int shm_recv_to_fifo(int fd)
+{
+	char doorbells[64];
+	ssize_t len;
+
+	if (!sockt->session_is_active(fd))
+		return -1;
+
+	len = sRecv(fd, doorbells, sizeof(doorbells), 0);
+
+	if( len == SOCKET_ERROR ) {
+		if( sErrno != S_EWOULDBLOCK )
+			sockt->eof(fd);
+		return 0;
+	}
+
+	if( len == 0 ) { // normal connection end
+		sockt->eof(fd);
+		return 0;
+	}
+
+	shm_fill_fifo(fd);
+	return 0;
+}
+
+/// func_send of sessions on the local transport.
+static int shm_send_from_fifo(int fd)
+{
+	struct socket_data *s;
+	struct socket_shm *shm;
+	struct socket_shm_ring *ring;
+	uint32 head, len, offset, chunk;
+
+	if (!sockt->session_is_valid(fd))
+		return -1;
+
+	s = sockt->session[fd];
+	shm = s->shm;
+	if( s->wdata_size == 0 )
+		return 0; // nothing to send
+
+	if( shm->tcp_pending > 0 ) { // the peer still reads these from the connection
+		ssize_t sent = sSend(fd, (const char *)s->wdata, (int)shm->tcp_pending, MSG_NOSIGNAL);
+
+		if( sent == SOCKET_ERROR ) {
+			if( sErrno != S_EWOULDBLOCK ) {
+#ifdef SHOW_SERVER_STATS
+				socket_data_qo -= s->wdata_size;
+#endif
+				s->wdata_size = 0;
+				sockt->eof(fd);
+			}
+			return 0;
+		}
+
+		memmove(s->wdata, s->wdata + sent, s->wdata_size - sent);
+		s->wdata_size -= sent;
+		shm->tcp_pending -= sent;
+#ifdef SHOW_SERVER_STATS
+		socket_data_o += sent;
+		socket_data_qo -= sent;
+#endif
+		if( shm->tcp_pending > 0 || s->wdata_size == 0 )
+			return 0;
+	}
+
+	ring = shm->out;
+	head = (uint32)ring->head;
+	len = (uint32)min(SOCKET_SHM_RING_SIZE - (head - (uint32)InterlockedExchangeAdd(&ring->tail, 0)), s->wdata_size);
+	if( len == 0 )
+		return 0; // ring is full, retried with the next send
+
+	offset = head&(SOCKET_SHM_RING_SIZE-1);
+	chunk = min(len, SOCKET_SHM_RING_SIZE - offset);
+	memcpy(ring->data + offset, s->wdata, chunk);
+	memcpy(ring->data, s->wdata + chunk, len - chunk);
+	InterlockedExchangeAdd(&ring->head, (int32)len);
+
+	if( len < s->wdata_size )
+		memmove(s->wdata, s->wdata + len, s->wdata_size - len);
+	s->wdata_size -= len;
+#ifdef SHOW_SERVER_STATS
+	socket_data_o += len;
+	socket_data_qo -= len;
+#endif
+
+	if( InterlockedCompareExchange(&ring->waiting, 0, 1) == 1 ) {
+		// a full socket buffer can be ignored, the peer has doorbells pending then
+		char doorbell = 0;
+		sSend(fd, &doorbell, 1, MSG_NOSIGNAL);
+	}
+
+	return 0;
+}
+
+#ifndef WIN32
+/// Maps an open segment file and binds it to the session.
+static bool shm_map(int fd, int file, const char *name, bool creator)
+{
+	struct socket_shm *shm;
+	void *segment = mmap(NULL, sizeof(struct socket_shm_segment), PROT_READ|PROT_WRITE, MAP_SHARED, file, 0);
+
+	close(file); // the mapping stays valid
+
+	if( segment == MAP_FAILED ) {
+		ShowError("shm_map: Unable to map the local link of connection #%d: %s\n", fd, strerror(errno));
+		return false;
+	}
+
+	CREATE(shm, struct socket_shm, 1);
+	shm->segment = segment;
+	shm->in = &shm->segment->ring[creator ? 1 : 0];
+	shm->out = &shm->segment->ring[creator ? 0 : 1];
+	safestrncpy(shm->name, name, sizeof(shm->name));
+	shm->creator = creator ? 1 : 0;
+	sockt->session[fd]->shm = shm;
+
+	return true;
+}
+#endif // WIN32
+
+/**
+ * Creates the shared memory segment of a local link for a session.
+ * The session keeps using TCP until socket_shm_start_send/socket_shm_start_recv.
+ *
+ * @param fd Session to create the link for.
+ * @retval true if the segment is ready, its name is in sockt->session[fd]->shm->name.
+ */
+bool socket_shm_create(int fd)
+{
+#ifdef WIN32
+	return false;
+#else
+	char name[SOCKET_SHM_NAME_LENGTH], path[sizeof(SOCKET_SHM_PATH) + SOCKET_SHM_NAME_LENGTH];
+	int file;
+
+	if (!sockt->session_is_active(fd) || sockt->session[fd]->shm != NULL)
+		return false;
+
+	snprintf(name, sizeof(name), "hercules-%d-%d", (int)getpid(), fd);
+	snprintf(path, sizeof(path), "%s%s", SOCKET_SHM_PATH, name);
+	unlink(path); // left behind by a crashed process with the same pid
+
+	if( (file = open(path, O_RDWR|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR)) == -1 ) {
+		ShowWarning("socket_shm_create: Unable to create '%s': %s\n", path, strerror(errno));
+		return false;
+	}
+
+	if( ftruncate(file, sizeof(struct socket_shm_segment)) != 0 ) {
+		ShowWarning("socket_shm_create: Unable to size '%s': %s\n", path, strerror(errno));
+		close(file);
+		unlink(path);
+		return false;
+	}
+
+	if( !shm_map(fd, file, name, true) ) {
+		unlink(path);
+		return false;
+	}
+
+	// the rings start out zeroed
+	sockt->session[fd]->shm->segment->ring_size = SOCKET_SHM_RING_SIZE;
+	sockt->session[fd]->shm->segment->magic = SOCKET_SHM_MAGIC;
+
+	return true;
+#endif // WIN32
+}
+
+/**
+ * Attaches a session to the local link segment created by its peer.
+ *
+ * @param fd   Session to attach.
+ * @param name Segment name sent by the peer.
+ * @retval false if the segment can't be opened (e.g. the peer is on another machine).
+ */
+bool socket_shm_attach(int fd, const char *name)
+{
+#ifdef WIN32
+	return false;
+#else
+	char path[sizeof(SOCKET_SHM_PATH) + SOCKET_SHM_NAME_LENGTH];
+	struct stat st;
+	int file;
+
+	nullpo_retr(false, name);
+
+	if (!sockt->session_is_active(fd) || sockt->session[fd]->shm != NULL)
+		return false;
+
+	if( strncmp(name, "hercules-", 9) != 0 || strchr(name, '/') != NULL || strlen(name) >= SOCKET_SHM_NAME_LENGTH ) {
+		ShowWarning("socket_shm_attach: Connection #%d sent an invalid segment name, ignoring.\n", fd);
+		return false;
+	}
+	snprintf(path, sizeof(path), "%s%s", SOCKET_SHM_PATH, name);
+
+	if( (file = open(path, O_RDWR)) == -1 )
+		return false; // not on this machine
+
+	if( fstat(file, &st) != 0 || st.st_size != (off_t)sizeof(struct socket_shm_segment) ) {
+		ShowWarning("socket_shm_attach: '%s' has an unexpected size, ignoring.\n", path);
+		close(file);
+		return false;
+	}
+
+	if( !shm_map(fd, file, name, false) )
+		return false;
+
+	if( sockt->session[fd]->shm->segment->magic != SOCKET_SHM_MAGIC || sockt->session[fd]->shm->segment->ring_size != SOCKET_SHM_RING_SIZE ) {
+		ShowWarning("socket_shm_attach: '%s' was made by an incompatible server, ignoring.\n", path);
+		sockt->shm_close(fd);
+		return false;
+	}
+
+	return true;
+#endif // WIN32
+}
+
+/// Removes the segment file once both sides mapped it (or gave up).
+void socket_shm_unlink(int fd)
+{
+#ifndef WIN32
+	struct socket_shm *shm;
+	char path[sizeof(SOCKET_SHM_PATH) + SOCKET_SHM_NAME_LENGTH];
+
+	if( !sockt->session_is_valid(fd) || (shm = sockt->session[fd]->shm) == NULL || !shm->creator )
+		return;
+
+	snprintf(path, sizeof(path), "%s%s", SOCKET_SHM_PATH, shm->name);
+	unlink(path);
+	shm->creator = 0;
+#endif // WIN32
+}
+
+/// Sends everything queued after this call through the local link.
+void socket_shm_start_send(int fd)
+{
+	struct socket_shm *shm;
+
+	if( !sockt->session_is_valid(fd) || (shm = sockt->session[fd]->shm) == NULL || shm->sending )
+		return;
+
+	shm->tcp_pending = sockt->session[fd]->wdata_size;
+	shm->sending = 1;
+	sockt->session[fd]->func_send = shm_send_from_fifo;
+}
+
+/// Reads from the local link from now on, the peer must not send anything else over TCP.
+void socket_shm_start_recv(int fd)
+{
+	struct socket_shm *shm;
+
+	if( !sockt->session_is_valid(fd) || (shm = sockt->session[fd]->shm) == NULL || shm->receiving )
+		return;
+
+	shm->receiving = 1;
+	sockt->session[fd]->func_recv = shm_recv_to_fifo;
+}
+
+/// Detaches a session from its local link.
+void socket_shm_close(int fd)
+{
+	struct socket_shm *shm;
+
+	if( !sockt->session_is_valid(fd) || (shm = sockt->session[fd]->shm) == NULL )
+		return;
+
+	sockt->shm_unlink(fd);
+#ifndef WIN32
+	munmap(shm->segment, sizeof(struct socket_shm_segment));
+#endif // WIN32
+	aFree(shm);
+	sockt->session[fd]->shm = NULL;
+	sockt->session[fd]->func_recv = recv_to_fifo;
+	sockt->session[fd]->func_send = send_from_fifo;
+}
+
 /*======================================
  * CORE : Connection functions
  *--------------------------------------*/
@@ -622,6 +967,7 @@ static int create_session(int fd, RecvFunc func_recv, SendFunc func_send, ParseF
 	sockt->session[fd]->func_parse = func_parse;
 	sockt->session[fd]->rdata_tick = sockt->last_tick;
 	sockt->session[fd]->session_data = NULL;
+	sockt->session[fd]->shm = NULL;
 	sockt->session[fd]->hdata = NULL;
 	sockt->session[fd]->hdatac = 0;
 	return 0;
@@ -634,6 +980,8 @@ static void delete_session(int fd)
 		socket_data_qi -= sockt->session[fd]->rdata_size - sockt->session[fd]->rdata_pos;
 		socket_data_qo -= sockt->session[fd]->wdata_size;
 #endif
+		if (sockt->session[fd]->shm)
+			sockt->shm_close(fd);
 		aFree(sockt->session[fd]->rdata);
 		aFree(sockt->session[fd]->wdata);
 		if( sockt->session[fd]->session_data )
@@ -790,8 +1138,13 @@ int do_sockets(int next)
 	fd_set rfd;
 	struct timeval timeout;
 	int ret,i;
+	int64 wait_start;
 
 	// PRESEND Timers are executed before do_sendrecv and can send packets and/or set sessions to eof.
+	// Packets the server holds back until now are written out first.
+	if( func_presend != NULL )
+		func_presend();
+
 	// Send remaining data and process client-side disconnects here.
 #ifdef SEND_SHORTLIST
 	send_shortlist_do_sends();
@@ -806,12 +1159,21 @@ int do_sockets(int next)
 	}
 #endif
 
+	// local links are drained every cycle, their peers only ring when this is going to block
+	for( i = 1; next > 0 && i < sockt->fd_max; i++ ) {
+		if( sockt->session[i] && sockt->session[i]->shm && sockt->session[i]->shm->receiving
+		 && !sockt->session[i]->flag.eof && !shm_request_doorbell(i) )
+			next = 0;
+	}
+
 	// can timeout until the next tick
 	timeout.tv_sec  = next/1000;
 	timeout.tv_usec = next%1000*1000;
 
 	memcpy(&rfd, &readfds, sizeof(rfd));
+	wait_start = timer->microtick();
 	ret = sSelect(sockt->fd_max, &rfd, NULL, NULL, &timeout);
+	timer->profile_phase(TIMER_PHASE_WAIT, timer->microtick() - wait_start);
 
 	if( ret == SOCKET_ERROR )
 	{
@@ -884,6 +1246,9 @@ int do_sockets(int next)
 		// Let Clang's static analyzer know this never happens (it thinks it might because of a NULL check in session_is_valid)
 		if (!sockt->session[i]) continue;
 #endif // __clang_analyzer__
+		if (sockt->session[i]->shm && sockt->session[i]->shm->receiving && !sockt->session[i]->flag.eof)
+			shm_fill_fifo(i); // doorbells are only sent once the ring was drained, pick up what didn't fit last time
+
 		sockt->session[i]->func_parse(i);
 
 		if(!sockt->session[i])
@@ -1802,6 +2167,7 @@ void socket_defaults(void) {
 	sockt->flush_fifos = flush_fifos;
 	sockt->set_nonblocking = set_nonblocking;
 	sockt->set_defaultparse = set_defaultparse;
+	sockt->set_presend = set_presend;
 	sockt->host2ip = host2ip;
 	sockt->ip2str = ip2str;
 	sockt->str2ip = str2ip;
@@ -1814,4 +2180,11 @@ void socket_defaults(void) {
 	sockt->trusted_ip_check = socket_trusted_ip_check;
 	sockt->net_config_read_sub = socket_net_config_read_sub;
 	sockt->net_config_read = socket_net_config_read;
+	/* local transport */
+	sockt->shm_create = socket_shm_create;
+	sockt->shm_attach = socket_shm_attach;
+	sockt->shm_unlink = socket_shm_unlink;
+	sockt->shm_start_send = socket_shm_start_send;
+	sockt->shm_start_recv = socket_shm_start_recv;
+	sockt->shm_close = socket_shm_close;
 }
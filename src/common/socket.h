@@ -83,6 +83,45 @@ struct HPluginData;
 typedef int (*RecvFunc)(int fd);
 typedef int (*SendFunc)(int fd);
 typedef int (*ParseFunc)(int fd);
+typedef void (*PreSendFunc)(void);
+
+#define SOCKET_SHM_PATH "/dev/shm/"         ///< Where local link segments are created
+#define SOCKET_SHM_NAME_LENGTH 32            ///< Segment file name, including the terminator
+#define SOCKET_SHM_RING_SIZE (1024*1024)     ///< Bytes per direction of a local link, power of two
+#define SOCKET_SHM_MAGIC 0x48524c4b          ///< 'HRLK'
+
+/**
+ * One direction of a local (shared memory) link.
+ **/
+struct socket_shm_ring {
+	volatile int32 head;    ///< Bytes written so far, only the producer moves it
+	volatile int32 tail;    ///< Bytes read so far, only the consumer moves it
+	volatile int32 waiting; ///< The consumer is about to block and waits for a doorbell byte on the TCP connection
+	uint8 data[SOCKET_SHM_RING_SIZE];
+};
+
+/**
+ * Shared memory segment of a local link.
+ **/
+struct socket_shm_segment {
+	uint32 magic;
+	uint32 ring_size;
+	struct socket_shm_ring ring[2]; ///< [0] creator to peer, [1] peer to creator
+};
+
+/**
+ * Local transport state of a session.
+ * The TCP connection stays open, it carries the handshake, doorbells and the disconnect.
+ **/
+struct socket_shm {
+	struct socket_shm_segment *segment;
+	struct socket_shm_ring *in, *out;
+	char name[SOCKET_SHM_NAME_LENGTH];
+	size_t tcp_pending;       ///< Bytes at the head of the WFIFO queued before the switch, still sent over TCP
+	unsigned int creator : 1; ///< The segment file still has to be unlinked by this side
+	unsigned int sending : 1;
+	unsigned int receiving : 1;
+};
 
 struct socket_data {
 	struct {
@@ -105,6 +144,8 @@ struct socket_data {
 
 	void* session_data; // stores application-specific data related to the session
 
+	struct socket_shm *shm; // local transport, NULL while on plain TCP
+
 	struct HPluginData **hdata;
 	unsigned int hdatac;
 };
@@ -175,6 +216,7 @@ struct socket_interface {
 	void (*flush_fifos) (void);
 	void (*set_nonblocking) (int fd, unsigned long yes);
 	void (*set_defaultparse) (ParseFunc defaultparse);
+	void (*set_presend) (PreSendFunc presend);
 	/* hostname/ip conversion functions */
 	uint32 (*host2ip) (const char* hostname);
 	const char * (*ip2str) (uint32 ip, char *ip_str);
@@ -191,6 +233,13 @@ struct socket_interface {
 	bool (*trusted_ip_check) (uint32 ip);
 	int (*net_config_read_sub) (config_setting_t *t, struct s_subnet **list, int *count, const char *filename, const char *groupname);
 	void (*net_config_read) (const char *filename);
+	/* local transport */
+	bool (*shm_create) (int fd);
+	bool (*shm_attach) (int fd, const char *name);
+	void (*shm_unlink) (int fd);
+	void (*shm_start_send) (int fd);
+	void (*shm_start_recv) (int fd);
+	void (*shm_close) (int fd);
 };
 
 #ifdef HERCULES_CORE
@@ -9,6 +9,7 @@
 #include "common/cbasetypes.h"
 #include "common/db.h"
 #include "common/malloc.h"
+#include "common/nullpo.h"
 #include "common/showmsg.h"
 #include "common/utils.h"
 
@@ -22,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 struct timer_interface timer_s;
 struct timer_interface *timer;
@@ -65,8 +67,38 @@ struct timer_func_list {
 	struct timer_func_list* next;
 	TimerFunc func;
 	char* name;
+	struct timer_profile_stat stat; ///< callback latencies (frame profiler)
 } *tfl_root = NULL;
 
+/*----------------------------
+ * Frame profiler
+ *----------------------------*/
+
+#define TIMER_PROFILE_MAP_SIZE 1024 // power of 2
+
+static const char *timer_profile_phase_name[TIMER_PHASE_MAX] = { "timers", "sockets", "wait" };
+
+static struct {
+	struct timer_profile_stat phase[TIMER_PHASE_MAX];
+	struct timer_profile_stat frame;   ///< work per frame (timers + sockets)
+	struct timer_profile_stat unknown; ///< callbacks without a name
+	/// callback -> stats cache, filled on first call
+	struct {
+		TimerFunc func;
+		struct timer_profile_stat *stat;
+		const char *name;
+	} map[TIMER_PROFILE_MAP_SIZE];
+	int64 wait;             ///< time spent waiting in the current frame
+	const char *frame_cb;   ///< slowest callback of the current frame
+	int64 frame_cb_time;
+	/// slowest frame since the last log line / reset
+	struct {
+		int64 work, timers, sockets, cb_time;
+		const char *cb;
+		time_t when;
+	} slowest;
+} timer_profile;
+
 /// Sets the name of a timer function.
 int timer_add_func_list(TimerFunc func, char* name) {
 	struct timer_func_list* tfl;
@@ -84,6 +116,7 @@ int timer_add_func_list(TimerFunc func, char* name) {
 		tfl->func = func;
 		tfl->name = aStrdup(name);
 		tfl_root = tfl;
+		memset(timer_profile.map, 0, sizeof(timer_profile.map)); // may have been cached as unknown
 	}
 	return 0;
 }
@@ -100,6 +133,172 @@ char* search_timer_func_list(TimerFunc func)
 	return "unknown timer function";
 }
 
+/// Adds a duration to a latency statistic.
+void timer_profile_add(struct timer_profile_stat *stat, int64 us) {
+	int b = 0;
+
+	nullpo_retv(stat);
+	if (us < 0)
+		us = 0;
+	stat->calls++;
+	stat->total += us;
+	if (us > stat->max)
+		stat->max = us;
+	while (us > 0 && b < TIMER_PROFILE_BUCKETS - 1) {
+		us >>= 1;
+		b++;
+	}
+	stat->hist[b]++;
+}
+
+/// Records the duration of a timer callback.
+static void timer_profile_callback(TimerFunc func, int64 us) {
+	unsigned int i, n;
+
+	i = (unsigned int)(((uintptr_t)func >> 4) & (TIMER_PROFILE_MAP_SIZE - 1));
+	for (n = 0; n < TIMER_PROFILE_MAP_SIZE; n++, i = (i + 1) & (TIMER_PROFILE_MAP_SIZE - 1)) {
+		if (timer_profile.map[i].func == func)
+			break;
+		if (timer_profile.map[i].func == NULL) {
+			struct timer_func_list *tfl;
+			for (tfl = tfl_root; tfl != NULL; tfl = tfl->next)
+				if (tfl->func == func)
+					break;
+			timer_profile.map[i].func = func;
+			timer_profile.map[i].stat = tfl ? &tfl->stat : &timer_profile.unknown;
+			timer_profile.map[i].name = tfl ? tfl->name : "unknown timer function";
+			break;
+		}
+	}
+
+	if (n == TIMER_PROFILE_MAP_SIZE) { // full, shouldn't happen
+		timer->profile_add(&timer_profile.unknown, us);
+		return;
+	}
+	timer->profile_add(timer_profile.map[i].stat, us);
+	if (us > timer_profile.frame_cb_time) {
+		timer_profile.frame_cb_time = us;
+		timer_profile.frame_cb = timer_profile.map[i].name;
+	}
+}
+
+/// Records the duration of a main loop phase (the wait for socket activity is reported by do_sockets).
+void timer_profile_phase(enum timer_profile_phase phase, int64 us) {
+	Assert_retv(phase >= TIMER_PHASE_TIMERS && phase < TIMER_PHASE_MAX);
+	timer->profile_add(&timer_profile.phase[phase], us);
+	if (phase == TIMER_PHASE_WAIT)
+		timer_profile.wait += us;
+}
+
+/**
+ * Closes a main loop iteration.
+ * @param start      microtick at the start of the frame
+ * @param timers_end microtick after timer->perform
+ * @param end        microtick after sockt->perform
+ */
+void timer_profile_frame(int64 start, int64 timers_end, int64 end) {
+	int64 timers = timers_end - start;
+	int64 sockets = max(end - timers_end - timer_profile.wait, 0);
+	int64 work = timers + sockets;
+
+	timer->profile_phase(TIMER_PHASE_TIMERS, timers);
+	timer->profile_phase(TIMER_PHASE_SOCKETS, sockets);
+	timer->profile_add(&timer_profile.frame, work);
+
+	if (work > timer_profile.slowest.work) {
+		timer_profile.slowest.work = work;
+		timer_profile.slowest.timers = timers;
+		timer_profile.slowest.sockets = sockets;
+		timer_profile.slowest.cb = timer_profile.frame_cb;
+		timer_profile.slowest.cb_time = timer_profile.frame_cb_time;
+		timer_profile.slowest.when = time(NULL);
+	}
+
+	timer_profile.wait = 0;
+	timer_profile.frame_cb = NULL;
+	timer_profile.frame_cb_time = 0;
+}
+
+/// Prints one latency statistic with its non-empty histogram buckets.
+static void timer_profile_show(const char *name, const struct timer_profile_stat *stat) {
+	char hist[TIMER_PROFILE_BUCKETS * 24];
+	int b, len = 0;
+
+	hist[0] = '\0';
+	for (b = 0; b < TIMER_PROFILE_BUCKETS; b++) {
+		if (stat->hist[b] == 0)
+			continue;
+		if (b == TIMER_PROFILE_BUCKETS - 1)
+			len += snprintf(hist + len, sizeof(hist) - len, " >=%d:%u", 1 << (b - 1), stat->hist[b]);
+		else
+			len += snprintf(hist + len, sizeof(hist) - len, " <%d:%u", 1 << b, stat->hist[b]);
+	}
+	ShowInfo("  %-32s calls: %10"PRIu64"  avg: %8"PRId64"us  max: %8"PRId64"us |%s\n", name, stat->calls,
+		stat->calls ? stat->total / (int64)stat->calls : 0, stat->max, hist);
+}
+
+/**
+ * Prints the frame profile: phases, frames, slowest frame and the timer functions that took the most time.
+ * @param count number of timer functions to list (0: default)
+ */
+void timer_profile_report(int count) {
+	struct timer_func_list *top[50];
+	struct timer_func_list *tfl;
+	int i, n = 0;
+
+	count = (count <= 0) ? 15 : min(count, ARRAYLENGTH(top));
+
+	ShowInfo("Frame profile (latency histogram in microseconds):\n");
+	for (i = 0; i < TIMER_PHASE_MAX; i++)
+		timer_profile_show(timer_profile_phase_name[i], &timer_profile.phase[i]);
+	timer_profile_show("frame (timers + sockets)", &timer_profile.frame);
+	if (timer_profile.slowest.when != 0) {
+		char when[32];
+		strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&timer_profile.slowest.when));
+		ShowInfo("Slowest frame: %"PRId64"us at %s (timers %"PRId64"us, sockets %"PRId64"us), slowest callback '%s' %"PRId64"us\n",
+			timer_profile.slowest.work, when, timer_profile.slowest.timers, timer_profile.slowest.sockets,
+			timer_profile.slowest.cb ? timer_profile.slowest.cb : "none", timer_profile.slowest.cb_time);
+	}
+
+	// timer functions with the most time spent, descending
+	for (tfl = tfl_root; tfl != NULL; tfl = tfl->next) {
+		if (tfl->stat.calls == 0 || (n == count && tfl->stat.total <= top[n-1]->stat.total))
+			continue;
+		for (i = (n < count) ? n++ : n-1; i > 0 && top[i-1]->stat.total < tfl->stat.total; i--)
+			top[i] = top[i-1];
+		top[i] = tfl;
+	}
+	ShowInfo("Timer functions by total time:\n");
+	for (i = 0; i < n; i++)
+		timer_profile_show(top[i]->name, &top[i]->stat);
+	if (timer_profile.unknown.calls != 0)
+		timer_profile_show("unknown timer function", &timer_profile.unknown);
+}
+
+/// Clears all frame profiler statistics.
+void timer_profile_reset(void) {
+	struct timer_func_list *tfl;
+
+	for (tfl = tfl_root; tfl != NULL; tfl = tfl->next)
+		memset(&tfl->stat, 0, sizeof(tfl->stat));
+	memset(timer_profile.phase, 0, sizeof(timer_profile.phase));
+	memset(&timer_profile.frame, 0, sizeof(timer_profile.frame));
+	memset(&timer_profile.unknown, 0, sizeof(timer_profile.unknown));
+	memset(&timer_profile.slowest, 0, sizeof(timer_profile.slowest));
+}
+
+/// Periodic frame profiler log line, restarts the slowest frame capture.
+int timer_profile_log(int tid, int64 tick, int id, intptr_t data) {
+	if (timer_profile.frame.calls == 0)
+		return 0;
+	ShowInfo("Frame profile: %"PRIu64" frames, avg %"PRId64"us, max %"PRId64"us; slowest frame in the last %d minutes: %"PRId64"us (timers %"PRId64"us, sockets %"PRId64"us, callback '%s' %"PRId64"us).\n",
+		timer_profile.frame.calls, timer_profile.frame.total / (int64)timer_profile.frame.calls, timer_profile.frame.max,
+		TIMER_PROFILE_LOG_INTERVAL / 60000, timer_profile.slowest.work, timer_profile.slowest.timers, timer_profile.slowest.sockets,
+		timer_profile.slowest.cb ? timer_profile.slowest.cb : "none", timer_profile.slowest.cb_time);
+	memset(&timer_profile.slowest, 0, sizeof(timer_profile.slowest));
+	return 0;
+}
+
 /*----------------------------
  * Get tick time
  *----------------------------*/
@@ -232,6 +431,31 @@ int64 timer_gettick(void) {
 #endif
 //////////////////////////////////////////////////////////////////////////
 
+/**
+ * High resolution monotonic clock, meant for measuring elapsed time
+ * (profiling); unrelated to the cached server tick.
+ * @return microseconds since an unspecified starting point
+ */
+int64 timer_microtick(void) {
+#if defined(WIN32)
+	static LARGE_INTEGER freq = { 0 };
+	LARGE_INTEGER count;
+
+	if( freq.QuadPart == 0 && !QueryPerformanceFrequency(&freq) )
+		return sys_tick() * 1000;
+	QueryPerformanceCounter(&count);
+	return (int64)(count.QuadPart / freq.QuadPart * 1000000 + count.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+#elif defined(HAVE_MONOTONIC_CLOCK)
+	struct timespec tval;
+	clock_gettime(CLOCK_MONOTONIC, &tval);
+	return (int64)tval.tv_sec * 1000000 + tval.tv_nsec / 1000;
+#else
+	struct timeval tval;
+	gettimeofday(&tval, NULL);
+	return (int64)tval.tv_sec * 1000000 + tval.tv_usec;
+#endif
+}
+
 /*======================================
  * CORE : Timer Heap
  *--------------------------------------*/
@@ -391,11 +615,14 @@ int do_timer(int64 tick) {
 		timer_data[tid].type |= TIMER_REMOVE_HEAP;
 
 		if( timer_data[tid].func ) {
+			TimerFunc func = timer_data[tid].func; // timer_data may be reallocated by the callback
+			int64 start = timer->microtick();
 			if( diff < -1000 )
 				// timer was delayed for more than 1 second, use current tick instead
-				timer_data[tid].func(tid, tick, timer_data[tid].id, timer_data[tid].data);
+				func(tid, tick, timer_data[tid].id, timer_data[tid].data);
 			else
-				timer_data[tid].func(tid, timer_data[tid].tick, timer_data[tid].id, timer_data[tid].data);
+				func(tid, timer_data[tid].tick, timer_data[tid].id, timer_data[tid].data);
+			timer_profile_callback(func, timer->microtick() - start);
 		}
 
 		// in the case the function didn't change anything...
@@ -438,6 +665,9 @@ void timer_init(void)
 #endif
 
 	time(&start_time);
+
+	timer->add_func_list(timer->profile_log, "timer->profile_log");
+	timer->add_interval(timer->gettick() + TIMER_PROFILE_LOG_INTERVAL, timer->profile_log, 0, 0, TIMER_PROFILE_LOG_INTERVAL);
 }
 
 void timer_final(void) {
@@ -465,6 +695,7 @@ void timer_defaults(void) {
 	/* funcs */
 	timer->gettick = timer_gettick;
 	timer->gettick_nocache = timer_gettick_nocache;
+	timer->microtick = timer_microtick;
 	timer->add = timer_add;
 	timer->add_interval = timer_add_interval;
 	timer->add_func_list = timer_add_func_list;
@@ -476,4 +707,10 @@ void timer_defaults(void) {
 	timer->perform = do_timer;
 	timer->init = timer_init;
 	timer->final = timer_final;
+	timer->profile_add = timer_profile_add;
+	timer->profile_phase = timer_profile_phase;
+	timer->profile_frame = timer_profile_frame;
+	timer->profile_report = timer_profile_report;
+	timer->profile_reset = timer_profile_reset;
+	timer->profile_log = timer_profile_log;
 }
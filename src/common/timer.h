@@ -19,10 +19,31 @@ enum {
 	TIMER_REMOVE_HEAP = 0x10,
 };
 
+/// Latency histogram buckets, bucket b counts durations in [2^(b-1), 2^b) microseconds (the last one is open-ended).
+#define TIMER_PROFILE_BUCKETS 16
+/// Interval of the frame profiler log line.
+#define TIMER_PROFILE_LOG_INTERVAL (10*60*1000)
+
+/// Main loop phases measured by the frame profiler.
+enum timer_profile_phase {
+	TIMER_PHASE_TIMERS,  ///< timer->perform
+	TIMER_PHASE_SOCKETS, ///< sockt->perform, without the wait for activity
+	TIMER_PHASE_WAIT,    ///< waiting for socket activity (idle time)
+	TIMER_PHASE_MAX
+};
+
 // Struct declaration
 
 typedef int (*TimerFunc)(int tid, int64 tick, int id, intptr_t data);
 
+/// Latency statistics of a main loop phase or timer function (microseconds).
+struct timer_profile_stat {
+	uint64 calls;
+	int64 total;
+	int64 max;
+	uint32 hist[TIMER_PROFILE_BUCKETS];
+};
+
 struct TimerData {
 	int64 tick;
 	TimerFunc func;
@@ -45,6 +66,7 @@ struct timer_interface {
 	/* funcs */
 	int64 (*gettick) (void);
 	int64 (*gettick_nocache) (void);
+	int64 (*microtick) (void);
 
 	int (*add) (int64 tick, TimerFunc func, int id, intptr_t data);
 	int (*add_interval) (int64 tick, TimerFunc func, int id, intptr_t data, int interval);
@@ -61,6 +83,13 @@ struct timer_interface {
 	int (*perform) (int64 tick);
 	void (*init) (void);
 	void (*final) (void);
+	/* frame profiler */
+	void (*profile_add) (struct timer_profile_stat *stat, int64 us);
+	void (*profile_phase) (enum timer_profile_phase phase, int64 us);
+	void (*profile_frame) (int64 start, int64 timers_end, int64 end);
+	void (*profile_report) (int count);
+	void (*profile_reset) (void);
+	int (*profile_log) (int tid, int64 tick, int id, intptr_t data);
 };
 
 #ifdef HERCULES_CORE
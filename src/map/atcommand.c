@@ -65,15 +65,17 @@ static char atcmd_player_name[NAME_LENGTH];
 
 // @commands (script-based)
 struct atcmd_binding_data* get_atcommandbind_byname(const char* name) {
-	int i = 0;
+	struct atcmd_dispatch_entry *entry;
 
 	nullpo_retr(NULL, name);
 	if( *name == atcommand->at_symbol || *name == atcommand->char_symbol )
 		name++; // for backwards compatibility
 
-	ARR_FIND( 0, atcommand->binding_count, i, strcmpi(atcommand->binding[i]->command, name) == 0 );
+	if( atcommand->binding_count == 0 )
+		return NULL;
 
-	return ( i < atcommand->binding_count ) ? atcommand->binding[i] : NULL;
+	entry = atcommand->dispatch_lookup(name);
+	return entry ? entry->binding : NULL;
 }
 
 const char* atcommand_msgsd(struct map_session_data *sd, int msg_number) {
@@ -9333,6 +9335,32 @@ ACMD(cddebug) {
 	return true;
 }
 
+/**
+ * Shows the packet rate limit counters of the server and of a player.
+ **/
+ACMD(packetstats) {
+	struct map_session_data *pl_sd = sd;
+	int i;
+
+	if (*message && (pl_sd = map->nick2sd((char *)message)) == NULL && (pl_sd = map->charid2sd(atoi(message))) == NULL) {
+		clif->message(fd, msg_fd(fd,3)); // Character not found.
+		return false;
+	}
+
+	clif->messages(fd, "Server: %"PRIu64" packets, %"PRIu64" delayed, %"PRIu64" dropped, %u kicked",
+	               clif->throttle_stats.packets, clif->throttle_stats.delayed, clif->throttle_stats.dropped, clif->throttle_stats.kicked);
+	clif->messages(fd, "%s: %u packets, %u delayed, %u dropped, %d/%d burst left",
+	               pl_sd->status.name, pl_sd->throttle.packets, pl_sd->throttle.delayed, pl_sd->throttle.dropped,
+	               (int)(pl_sd->throttle.session.tokens / 1000), battle_config.packet_burst);
+	for (i = 0; i < clif->throttle_count; i++) {
+		const struct clif_throttle_entry *entry = &clif->throttle_db[i];
+		clif->messages(fd, "- Packet 0x%04x: %d/s (burst %d, %s), %"PRIu64" dropped",
+		               entry->cmd, entry->rate, entry->burst, entry->action == CLIF_THROTTLE_KICK ? "kick" : "drop", entry->dropped);
+	}
+
+	return true;
+}
+
 /**
  *
  **/
@@ -9639,6 +9667,7 @@ void atcommand_basecommands(void) {
 		ACMD_DEF(skdebug),
 		ACMD_DEF(cddebug),
 		ACMD_DEF(lang),
+		ACMD_DEF(packetstats),
 	};
 	int i;
 
@@ -9673,6 +9702,7 @@ bool atcommand_add(char *name, AtCommandFunc func, bool replace) {
 	cmd->func = func;
 	cmd->help = NULL;
 	cmd->log = true;
+	atcommand->dispatch_dirty = true;
 
 	return true;
 }
@@ -9684,6 +9714,117 @@ AtCommandInfo* atcommand_exists(const char* name) {
 	return strdb_get(atcommand->db, name);
 }
 
+/**
+ * Case-insensitive FNV-1a hash of a command name.
+ * @param name command name (without symbol)
+ * @return hash
+ */
+unsigned int atcommand_dispatch_hash(const char *name) {
+	unsigned int hash = 2166136261U;
+	int i;
+
+	nullpo_ret(name);
+	for( i = 0; i < ATCOMMAND_LENGTH && name[i] != '\0'; i++ ) {
+		hash ^= (unsigned char)TOLOWER(name[i]);
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * Adds a name to the dispatch table, the table must have room for it.
+ * Fields already set for the same name are kept (commands go in before
+ * aliases, which take precedence, then script bindings).
+ * @param name    command name, alias or bound command (without symbol)
+ * @param info    command it resolves to, or NULL
+ * @param binding script binding, or NULL
+ */
+void atcommand_dispatch_insert(const char *name, AtCommandInfo *info, struct atcmd_binding_data *binding) {
+	unsigned int hash, mask = atcommand->dispatch_size - 1, i;
+	struct atcmd_dispatch_entry *entry;
+
+	nullpo_retv(name);
+	hash = atcommand->dispatch_hash(name);
+	for( i = hash&mask; ; i = (i+1)&mask ) {
+		entry = &atcommand->dispatch[i];
+		if( entry->name[0] == '\0' ) {
+			safestrncpy(entry->name, name, sizeof(entry->name));
+			entry->hash = hash;
+			break;
+		}
+		if( entry->hash == hash && strcmpi(entry->name, name) == 0 )
+			break;
+	}
+	if( info != NULL )
+		entry->info = info;
+	if( binding != NULL && entry->binding == NULL )
+		entry->binding = binding;
+}
+
+/**
+ * Rebuilds the dispatch table from atcommand->db, atcommand->alias_db and the script bindings.
+ */
+void atcommand_dispatch_build(void) {
+	unsigned int count = atcommand->binding_count, size = 64;
+	int i;
+
+	if( atcommand->db != NULL )
+		count += db_size(atcommand->db);
+	if( atcommand->alias_db != NULL )
+		count += db_size(atcommand->alias_db);
+	while( size < count*2 ) // keep the load factor at 50% at most
+		size <<= 1;
+
+	if( atcommand->dispatch_size != size ) {
+		aFree(atcommand->dispatch);
+		CREATE(atcommand->dispatch, struct atcmd_dispatch_entry, size);
+		atcommand->dispatch_size = size;
+	} else {
+		memset(atcommand->dispatch, 0, sizeof(struct atcmd_dispatch_entry)*size);
+	}
+
+	if( atcommand->db != NULL ) {
+		DBIterator *iter = db_iterator(atcommand->db);
+		AtCommandInfo *cmd;
+		for( cmd = dbi_first(iter); dbi_exists(iter); cmd = dbi_next(iter) )
+			atcommand->dispatch_insert(cmd->command, cmd, NULL);
+		dbi_destroy(iter);
+	}
+	if( atcommand->alias_db != NULL ) {
+		DBIterator *iter = db_iterator(atcommand->alias_db);
+		AliasInfo *alias;
+		for( alias = dbi_first(iter); dbi_exists(iter); alias = dbi_next(iter) )
+			atcommand->dispatch_insert(alias->alias, alias->command, NULL);
+		dbi_destroy(iter);
+	}
+	for( i = 0; i < atcommand->binding_count; i++ )
+		atcommand->dispatch_insert(atcommand->binding[i]->command, NULL, atcommand->binding[i]);
+
+	atcommand->dispatch_dirty = false;
+}
+
+/**
+ * Resolves a command name, alias or script-bound command.
+ * @param name typed name (without symbol)
+ * @return dispatch entry or NULL if nothing goes by that name
+ */
+struct atcmd_dispatch_entry* atcommand_dispatch_lookup(const char *name) {
+	unsigned int hash, mask, i;
+
+	nullpo_retr(NULL, name);
+	if( atcommand->dispatch_dirty || atcommand->dispatch == NULL )
+		atcommand->dispatch_build();
+
+	hash = atcommand->dispatch_hash(name);
+	mask = atcommand->dispatch_size - 1;
+	for( i = hash&mask; atcommand->dispatch[i].name[0] != '\0'; i = (i+1)&mask ) {
+		struct atcmd_dispatch_entry *entry = &atcommand->dispatch[i];
+		if( entry->hash == hash && strncmpi(entry->name, name, ATCOMMAND_LENGTH) == 0 )
+			return entry;
+	}
+	return NULL;
+}
+
 AtCommandInfo* get_atcommandinfo_byname(const char *name) {
 	AtCommandInfo *cmd;
 	if ((cmd = strdb_get(atcommand->db, name)))
@@ -9788,6 +9929,7 @@ bool atcommand_exec(const int fd, struct map_session_data *sd, const char *messa
 
 	TBL_PC * ssd = NULL; //sd for target
 	AtCommandInfo * info;
+	struct atcmd_dispatch_entry *entry;
 
 	nullpo_retr(false, sd);
 
@@ -9847,7 +9989,8 @@ bool atcommand_exec(const int fd, struct map_session_data *sd, const char *messa
 
 			if( !pc_get_group_level(sd) ) {
 				if( x >= 1 || y >= 1 ) { /* we have command */
-					info = atcommand->get_info_byname(atcommand->check_alias(command + 1));
+					entry = atcommand->dispatch_lookup(command + 1);
+					info = entry ? entry->info : NULL;
 					if( !info || info->char_groups[pcg->get_idx(sd->group)] == 0 ) /* if we can't use or doesn't exist: don't even display the command failed message */
 							return false;
 				} else
@@ -9877,12 +10020,15 @@ bool atcommand_exec(const int fd, struct map_session_data *sd, const char *messa
 	if( sscanf(atcmd_msg, "%99s %99[^\n]", command, params) < 2 )
 		params[0] = '\0';
 
+	// Resolve command, alias and script binding at once
+	entry = atcommand->dispatch_lookup(command + 1);
+
 	// @commands (script based)
 	if(player_invoked && atcommand->binding_count > 0) {
 		struct atcmd_binding_data * binding;
 
 		// Get atcommand binding
-		binding = atcommand->get_bind_byname(command);
+		binding = entry ? entry->binding : NULL;
 
 		// Check if the binding isn't NULL and there is a NPC event, level of usage met, et cetera
 		if( binding != NULL
@@ -9914,7 +10060,7 @@ bool atcommand_exec(const int fd, struct map_session_data *sd, const char *messa
 	}
 
 	//Grab the command information and check for the proper GM level required to use it or if the command exists
-	info = atcommand->get_info_byname(atcommand->check_alias(command + 1));
+	info = entry ? entry->info : NULL;
 	if (info == NULL) {
 		if( pc_get_group_level(sd) ) { // TODO: remove or replace with proper permission
 			sprintf(output, msg_fd(fd,153), command); // "%s is Unknown Command."
@@ -10238,6 +10384,12 @@ void atcommand_db_clear(void) {
 		db_destroy(atcommand->alias_db);
 		atcommand->alias_db = NULL;
 	}
+	if( atcommand->dispatch != NULL ) {
+		aFree(atcommand->dispatch);
+		atcommand->dispatch = NULL;
+		atcommand->dispatch_size = 0;
+	}
+	atcommand->dispatch_dirty = true;
 }
 
 void atcommand_doload(void) {
@@ -10249,6 +10401,7 @@ void atcommand_doload(void) {
 		atcommand->alias_db = stridb_alloc(DB_OPT_DUP_KEY|DB_OPT_RELEASE_DATA, ATCOMMAND_LENGTH);
 	atcommand->base_commands(); //fills initial atcommand_db with known commands
 	atcommand->config_read(map->ATCOMMAND_CONF_FILENAME);
+	atcommand->dispatch_dirty = true; // aliases
 }
 
 void atcommand_expand_message_table(void) {
@@ -10276,6 +10429,9 @@ void atcommand_defaults(void) {
 
 	atcommand->db = NULL;
 	atcommand->alias_db = NULL;
+	atcommand->dispatch = NULL;
+	atcommand->dispatch_size = 0;
+	atcommand->dispatch_dirty = true;
 
 	atcommand->init = do_init_atcommand;
 	atcommand->final = do_final_atcommand;
@@ -10292,6 +10448,10 @@ void atcommand_defaults(void) {
 	atcommand->get_info_byname = get_atcommandinfo_byname;
 	atcommand->check_alias = atcommand_checkalias;
 	atcommand->get_suggestions = atcommand_get_suggestions;
+	atcommand->dispatch_hash = atcommand_dispatch_hash;
+	atcommand->dispatch_insert = atcommand_dispatch_insert;
+	atcommand->dispatch_build = atcommand_dispatch_build;
+	atcommand->dispatch_lookup = atcommand_dispatch_lookup;
 	atcommand->config_read = atcommand_config_read;
 	atcommand->stopattack = atcommand_stopattack;
 	atcommand->pvpoff_sub = atcommand_pvpoff_sub;
@@ -68,6 +68,18 @@ struct atcmd_binding_data {
 	bool log;
 };
 
+/**
+ * Dispatch table slot, one per command name, alias and script binding.
+ * Resolves a typed command name with a single probe instead of the
+ * alias_db + db + binding lookups.
+ **/
+struct atcmd_dispatch_entry {
+	char name[ATCOMMAND_LENGTH];
+	unsigned int hash;
+	AtCommandInfo *info; ///< Command (aliases point to their command), NULL if only bound by a script
+	struct atcmd_binding_data *binding; ///< Script binding, if any
+};
+
 /**
  * Interface
  **/
@@ -80,6 +92,10 @@ struct atcommand_interface {
 	/* other vars */
 	DBMap* db; //name -> AtCommandInfo
 	DBMap* alias_db; //alias -> AtCommandInfo
+	/* dispatch table (open addressing, rebuilt on the next lookup when dirty) */
+	struct atcmd_dispatch_entry *dispatch;
+	unsigned int dispatch_size; // power of 2
+	bool dispatch_dirty;
 	/**
 	 * msg_table[lang_id][msg_id]
 	 * Server messages (0-499 reserved for GM commands, 500-999 reserved for others)
@@ -104,6 +120,10 @@ struct atcommand_interface {
 	AtCommandInfo* (*get_info_byname) (const char *name); // @help
 	const char* (*check_alias) (const char *aliasname); // @help
 	void (*get_suggestions) (struct map_session_data* sd, const char *name, bool is_atcmd_cmd); // @help
+	unsigned int (*dispatch_hash) (const char *name);
+	void (*dispatch_insert) (const char *name, AtCommandInfo *info, struct atcmd_binding_data *binding);
+	void (*dispatch_build) (void);
+	struct atcmd_dispatch_entry* (*dispatch_lookup) (const char *name);
 	void (*config_read) (const char* config_filename);
 	/* command-specific subs */
 	int (*stopattack) (struct block_list *bl,va_list ap);
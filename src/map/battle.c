@@ -3440,6 +3440,100 @@ int battle_adjust_skill_damage(int m, unsigned short skill_id) {
 	return 0;
 }
 
+/**
+ * Starts resolving a cast of skill_id by src: until the matching
+ * battle->skill_terms_pop, damage calculations of that cast share one lookup
+ * of the target independent terms (skill db and map modifiers).
+ * Nothing depending on the caster's status or equipment is shared, as it
+ * may change between two targets (reflected damage, autospells, breaks).
+ *
+ * @param terms    Storage for the terms, must outlive the matching pop (usually the caller's stack).
+ * @param src      Caster.
+ * @param skill_id Skill being cast.
+ * @param skill_lv Level of the skill.
+ */
+void battle_skill_terms_push(struct battle_skill_terms *terms, struct block_list *src, uint16 skill_id, uint16 skill_lv)
+{
+	nullpo_retv(terms);
+	nullpo_retv(src);
+
+	terms->src_id = src->id;
+	terms->m = src->m;
+	terms->skill_id = skill_id;
+	terms->skill_lv = skill_lv;
+	terms->loaded = false; // looked up on the first damage calculation, if any
+	terms->prev = battle->skill_terms;
+	battle->skill_terms = terms;
+}
+
+/**
+ * Ends the cast started by battle->skill_terms_push.
+ *
+ * @param terms The terms given to the matching push.
+ */
+void battle_skill_terms_pop(struct battle_skill_terms *terms)
+{
+	nullpo_retv(terms);
+	Assert_retv(battle->skill_terms == terms);
+
+	battle->skill_terms = terms->prev;
+}
+
+/**
+ * Looks up the target independent terms of a skill.
+ *
+ * @param terms Terms to fill, with src_id, m, skill_id and skill_lv set.
+ */
+void battle_skill_terms_load(struct battle_skill_terms *terms)
+{
+	nullpo_retv(terms);
+
+	terms->nk = skill->get_nk(terms->skill_id);
+	terms->inf = skill->get_inf(terms->skill_id);
+	terms->div_ = skill->get_num(terms->skill_id, terms->skill_lv);
+	terms->blewcount = skill->get_blewcount(terms->skill_id, terms->skill_lv);
+	terms->ele = skill->get_ele(terms->skill_id, terms->skill_lv);
+	terms->map_rate = battle->adjust_skill_damage(terms->m, terms->skill_id);
+	terms->loaded = true;
+}
+
+/**
+ * Gets the target independent terms for a damage calculation, from the cast
+ * being resolved when it matches or freshly looked up otherwise.
+ *
+ * @param src      Attacker.
+ * @param skill_id Skill used (must not be 0).
+ * @param skill_lv Level of the skill.
+ * @param buf      Storage used when no cast matches.
+ * @return The terms, never NULL.
+ */
+const struct battle_skill_terms *battle_skill_terms_get(struct block_list *src, uint16 skill_id, uint16 skill_lv, struct battle_skill_terms *buf)
+{
+	struct battle_skill_terms *terms;
+
+	nullpo_retr(buf, buf);
+	nullpo_retr(buf, src);
+
+	for (terms = battle->skill_terms; terms != NULL; terms = terms->prev) {
+		if (terms->src_id == src->id && terms->m == src->m && terms->skill_id == skill_id && terms->skill_lv == skill_lv)
+			break;
+	}
+
+	if (terms == NULL) {
+		terms = buf;
+		terms->src_id = src->id;
+		terms->m = src->m;
+		terms->skill_id = skill_id;
+		terms->skill_lv = skill_lv;
+		terms->loaded = false;
+		terms->prev = NULL;
+	}
+	if (!terms->loaded)
+		battle->skill_terms_load(terms);
+
+	return terms;
+}
+
 int battle_blewcount_bonus(struct map_session_data *sd, uint16 skill_id) {
 	int i;
 	nullpo_ret(sd);
@@ -3466,6 +3560,8 @@ struct Damage battle_calc_magic_attack(struct block_list *src,struct block_list
 	TBL_PC *sd;
 	struct status_change *sc;
 	struct Damage ad;
+	struct battle_skill_terms terms_buf;
+	const struct battle_skill_terms *terms;
 	struct status_data *sstatus = status->get_status_data(src);
 	struct status_data *tstatus = status->get_status_data(target);
 	struct {
@@ -3479,15 +3575,17 @@ struct Damage battle_calc_magic_attack(struct block_list *src,struct block_list
 	nullpo_retr(ad, src);
 	nullpo_retr(ad, target);
 
+	terms = battle->skill_terms_get(src, skill_id, skill_lv, &terms_buf);
+
 	//Initial Values
 	ad.damage = 1;
-	ad.div_=skill->get_num(skill_id,skill_lv);
-	ad.amotion = (skill->get_inf(skill_id)&INF_GROUND_SKILL) ? 0 : sstatus->amotion; //Amotion should be 0 for ground skills.
+	ad.div_=terms->div_;
+	ad.amotion = (terms->inf&INF_GROUND_SKILL) ? 0 : sstatus->amotion; //Amotion should be 0 for ground skills.
 	ad.dmotion=tstatus->dmotion;
-	ad.blewcount = skill->get_blewcount(skill_id,skill_lv);
+	ad.blewcount = terms->blewcount;
 	ad.flag=BF_MAGIC|BF_SKILL;
 	ad.dmg_lv=ATK_DEF;
-	nk = skill->get_nk(skill_id);
+	nk = terms->nk;
 	flag.imdef = (nk&NK_IGNORE_DEF)? 1 : 0;
 
 	sd = BL_CAST(BL_PC, src);
@@ -3495,7 +3593,7 @@ struct Damage battle_calc_magic_attack(struct block_list *src,struct block_list
 	sc = status->get_sc(src);
 
 	//Initialize variables that will be used afterwards
-	s_ele = skill->get_ele(skill_id, skill_lv);
+	s_ele = terms->ele;
 
 	if (s_ele == -1){ // pl=-1 : the skill takes the weapon's element
 		s_ele = sstatus->rhw.ele;
@@ -3700,7 +3798,7 @@ struct Damage battle_calc_magic_attack(struct block_list *src,struct block_list
 				default:
 					rskill = skill_id;
 			}
-			if( (i = battle->adjust_skill_damage(src->m,rskill)) )
+			if( (i = (rskill == skill_id) ? terms->map_rate : battle->adjust_skill_damage(src->m,rskill)) )
 				MATK_RATE(i);
 
 			//Ignore Defense?
@@ -3792,6 +3890,8 @@ struct Damage battle_calc_misc_attack(struct block_list *src,struct block_list *
 
 	struct map_session_data *sd, *tsd;
 	struct Damage md; //DO NOT CONFUSE with md of mob_data!
+	struct battle_skill_terms terms_buf;
+	const struct battle_skill_terms *terms;
 	struct status_data *sstatus = status->get_status_data(src);
 	struct status_data *tstatus = status->get_status_data(target);
 	struct status_change *tsc = status->get_sc(target);
@@ -3804,15 +3904,17 @@ struct Damage battle_calc_misc_attack(struct block_list *src,struct block_list *
 	nullpo_retr(md, src);
 	nullpo_retr(md, target);
 
+	terms = battle->skill_terms_get(src, skill_id, skill_lv, &terms_buf);
+
 	//Some initial values
-	md.amotion = (skill->get_inf(skill_id)&INF_GROUND_SKILL) ? 0 : sstatus->amotion;
+	md.amotion = (terms->inf&INF_GROUND_SKILL) ? 0 : sstatus->amotion;
 	md.dmotion=tstatus->dmotion;
-	md.div_=skill->get_num( skill_id,skill_lv );
-	md.blewcount=skill->get_blewcount(skill_id,skill_lv);
+	md.div_=terms->div_;
+	md.blewcount=terms->blewcount;
 	md.dmg_lv=ATK_DEF;
 	md.flag=BF_MISC|BF_SKILL;
 
-	nk = skill->get_nk(skill_id);
+	nk = terms->nk;
 
 	sd = BL_CAST(BL_PC, src);
 	tsd = BL_CAST(BL_PC, target);
@@ -3822,7 +3924,7 @@ struct Damage battle_calc_misc_attack(struct block_list *src,struct block_list *
 		md.blewcount += battle->blewcount_bonus(sd, skill_id);
 	}
 
-	s_ele = skill->get_ele(skill_id, skill_lv);
+	s_ele = terms->ele;
 	if (s_ele < 0 && s_ele != -3) //Attack that takes weapon's element for misc attacks? Make it neutral [Skotlex]
 		s_ele = ELE_NEUTRAL;
 	else if (s_ele == -3) //Use random element
@@ -4158,7 +4260,7 @@ struct Damage battle_calc_misc_attack(struct block_list *src,struct block_list *
 		if (sd && (i = pc->skillatk_bonus(sd, rskill)) != 0)
 			md.damage += md.damage*i/100;
 	}
-	if( (i = battle->adjust_skill_damage(src->m,skill_id)) )
+	if( (i = terms->map_rate) )
 		md.damage = md.damage * i / 100;
 
 	if(md.damage < 0)
@@ -4227,6 +4329,8 @@ struct Damage battle_calc_weapon_attack(struct block_list *src,struct block_list
 
 	struct map_session_data *sd, *tsd;
 	struct Damage wd;
+	struct battle_skill_terms terms_buf;
+	const struct battle_skill_terms *terms = NULL; // NULL for normal attacks
 	struct status_change *sc = status->get_sc(src);
 	struct status_change *tsc = status->get_sc(target);
 	struct status_data *sstatus = status->get_status_data(src);
@@ -4255,6 +4359,9 @@ struct Damage battle_calc_weapon_attack(struct block_list *src,struct block_list
 	nullpo_retr(wd, src);
 	nullpo_retr(wd, target);
 
+	if (skill_id)
+		terms = battle->skill_terms_get(src, skill_id, skill_lv, &terms_buf);
+
 	//Initial flag
 	flag.rh=1;
 	flag.weapon=1;
@@ -4268,16 +4375,16 @@ struct Damage battle_calc_weapon_attack(struct block_list *src,struct block_list
 
 	//Initial Values
 	wd.type = BDT_NORMAL;
-	wd.div_ = skill_id ? skill->get_num(skill_id,skill_lv) : 1;
-	wd.amotion=(skill_id && skill->get_inf(skill_id)&INF_GROUND_SKILL)?0:sstatus->amotion; //Amotion should be 0 for ground skills.
+	wd.div_ = terms ? terms->div_ : 1;
+	wd.amotion=(terms && terms->inf&INF_GROUND_SKILL)?0:sstatus->amotion; //Amotion should be 0 for ground skills.
 	if(skill_id == KN_AUTOCOUNTER)
 		wd.amotion >>= 1;
 	wd.dmotion=tstatus->dmotion;
-	wd.blewcount = skill_id ? skill->get_blewcount(skill_id,skill_lv) : 0;
+	wd.blewcount = terms ? terms->blewcount : 0;
 	wd.flag = BF_WEAPON; //Initial Flag
 	wd.flag |= (skill_id||wflag)?BF_SKILL:BF_NORMAL; // Baphomet card's splash damage is counted as a skill. [Inkfish]
 	wd.dmg_lv=ATK_DEF; //This assumption simplifies the assignation later
-	nk = skill->get_nk(skill_id);
+	nk = terms ? terms->nk : 0;
 	if( !skill_id && wflag ) //If flag, this is splash damage from Baphomet Card and it always hits.
 		nk |= NK_NO_CARDFIX_ATK|NK_IGNORE_FLEE;
 	flag.hit = (nk&NK_IGNORE_FLEE) ? 1 : 0;
@@ -4409,7 +4516,7 @@ struct Damage battle_calc_weapon_attack(struct block_list *src,struct block_list
 		return wd;
 	}
 
-	s_ele = s_ele_ = skill_id ? skill->get_ele(skill_id, skill_lv) : -1;
+	s_ele = s_ele_ = terms ? terms->ele : -1;
 	if (s_ele == -1) {
 		//Take weapon's element
 		s_ele = sstatus->rhw.ele;
@@ -5171,7 +5278,7 @@ struct Damage battle_calc_weapon_attack(struct block_list *src,struct block_list
 				default:
 					rskill = skill_id;
 			}
-			if( (i = battle->adjust_skill_damage(src->m,rskill)) )
+			if( (i = (rskill == skill_id) ? terms->map_rate : battle->adjust_skill_damage(src->m,rskill)) )
 				ATK_RATE(i);
 		}
 
@@ -5258,7 +5365,7 @@ struct Damage battle_calc_weapon_attack(struct block_list *src,struct block_list
 		}
 		//Div fix.
 		damage_div_fix(wd.damage, wd.div_);
-		if ( skill_id > 0 && (skill->get_ele(skill_id, skill_lv) == ELE_NEUTRAL || flag.distinct) ) { // re-evaluate forced neutral skills
+		if ( skill_id > 0 && (terms->ele == ELE_NEUTRAL || flag.distinct) ) { // re-evaluate forced neutral skills
 			wd.damage = battle->attr_fix(src, target, wd.damage, s_ele, tstatus->def_ele, tstatus->ele_lv);
 			if ( flag.lh )
 				wd.damage2 = battle->attr_fix(src, target, wd.damage2, s_ele_, tstatus->def_ele, tstatus->ele_lv);
@@ -7134,6 +7241,8 @@ static const struct battle_data {
 	{ "item_enabled_npc",                   &battle_config.item_enabled_npc,                1,      0,      1,              },
 	{ "gm_ignore_warpable_area",            &battle_config.gm_ignore_warpable_area,         0,      2,      100,            },
 	{ "packet_obfuscation",                 &battle_config.packet_obfuscation,              1,      0,      3,              },
+	{ "packet_rate",                        &battle_config.packet_rate,                     0,      0,      INT_MAX,        },
+	{ "packet_burst",                       &battle_config.packet_burst,                    10,     1,      1000,           },
 	{ "client_accept_chatdori",             &battle_config.client_accept_chatdori,          0,      0,      INT_MAX,        },
 	{ "snovice_call_type",                  &battle_config.snovice_call_type,               0,      0,      1,              },
 	{ "guild_notice_changemap",             &battle_config.guild_notice_changemap,          2,      0,      2,              },
@@ -7323,6 +7432,25 @@ static int Hercules_report_timer(int tid, int64 tick, int id, intptr_t data) {
 }
 #endif
 
+/**
+ * Looks up a setting in battle_data.
+ * The name index is built on first use, as the config is read before battle->init.
+ *
+ * @param w1 Setting name (case-insensitive).
+ * @return battle_data index, or -1 if there is no such setting.
+ */
+int battle_config_index(const char* w1)
+{
+	nullpo_retr(-1, w1);
+	if (battle->config_db == NULL) {
+		int i;
+		battle->config_db = stridb_alloc(DB_OPT_BASE, 0);
+		for (i = 0; i < ARRAYLENGTH(battle_data); i++)
+			strdb_iput(battle->config_db, battle_data[i].str, i + 1);
+	}
+	return strdb_iget(battle->config_db, w1) - 1;
+}
+
 int battle_set_value(const char* w1, const char* w2)
 {
 	int val = config_switch(w2);
@@ -7330,8 +7458,7 @@ int battle_set_value(const char* w1, const char* w2)
 
 	nullpo_retr(1, w1);
 	nullpo_retr(1, w2);
-	ARR_FIND(0, ARRAYLENGTH(battle_data), i, strcmpi(w1, battle_data[i].str) == 0);
-	if (i == ARRAYLENGTH(battle_data)) {
+	if ((i = battle->config_index(w1)) < 0) {
 		if( HPM->parseConf(w1,w2,HPCT_BATTLE) ) /* if plugin-owned, succeed */
 			return 1;
 		return 0; // not found
@@ -7351,8 +7478,7 @@ int battle_get_value(const char* w1)
 {
 	int i;
 	nullpo_retr(1, w1);
-	ARR_FIND(0, ARRAYLENGTH(battle_data), i, strcmpi(w1, battle_data[i].str) == 0);
-	if (i == ARRAYLENGTH(battle_data))
+	if ((i = battle->config_index(w1)) < 0)
 		return 0; // not found
 	else
 		return *battle_data[i].val;
@@ -7487,6 +7613,10 @@ void do_init_battle(bool minimal) {
 
 void do_final_battle(void) {
 	ers_destroy(battle->delay_damage_ers);
+	if (battle->config_db != NULL) {
+		db_destroy(battle->config_db);
+		battle->config_db = NULL;
+	}
 }
 
 /* initialize the interface */
@@ -7497,11 +7627,17 @@ void battle_defaults(void) {
 
 	memset(battle->attr_fix_table, 0, sizeof(battle->attr_fix_table));
 	battle->delay_damage_ers = NULL;
+	battle->config_db = NULL;
+	battle->skill_terms = NULL;
 
 	battle->init = do_init_battle;
 	battle->final = do_final_battle;
 
 	battle->calc_attack = battle_calc_attack;
+	battle->skill_terms_push = battle_skill_terms_push;
+	battle->skill_terms_pop = battle_skill_terms_pop;
+	battle->skill_terms_get = battle_skill_terms_get;
+	battle->skill_terms_load = battle_skill_terms_load;
 	battle->calc_damage = battle_calc_damage;
 	battle->calc_gvg_damage = battle_calc_gvg_damage;
 	battle->calc_bg_damage = battle_calc_bg_damage;
@@ -7547,6 +7683,7 @@ void battle_defaults(void) {
 	battle->config_set_defaults = battle_set_defaults;
 	battle->config_set_value = battle_set_value;
 	battle->config_get_value = battle_get_value;
+	battle->config_index = battle_config_index;
 	battle->config_adjust = battle_adjust_conf;
 	battle->get_enemy_area = battle_getenemyarea;
 	battle->damage_area = battle_damage_area;
@@ -486,6 +486,8 @@ struct Battle_Config {
 	int max_walk_path;
 	int item_enabled_npc;
 	int packet_obfuscation;
+	int packet_rate;
+	int packet_burst;
 	int idletime_criteria;
 	int gm_ignore_warpable_area;
 
@@ -540,6 +542,26 @@ struct delay_damage {
 	enum bl_type src_type;
 };
 
+/**
+ * Skill db and map terms of a skill's damage that don't depend on the target.
+ * Looked up once for all the targets hit by a cast instead of once per target,
+ * see battle->skill_terms_push.
+ **/
+struct battle_skill_terms {
+	int src_id;         ///< Caster
+	int16 m;            ///< Map the caster was on
+	uint16 skill_id;
+	uint16 skill_lv;
+	bool loaded;        ///< Whether the fields below are set
+	int nk;             ///< skill->get_nk
+	int inf;            ///< skill->get_inf
+	int div_;           ///< skill->get_num
+	int blewcount;      ///< skill->get_blewcount
+	int ele;            ///< skill->get_ele, -1/-2/-3 are resolved by each calculation
+	int map_rate;       ///< battle->adjust_skill_damage on m
+	struct battle_skill_terms *prev; ///< Enclosing cast (autospells), NULL if none
+};
+
 /**
  * Battle.c Interface
  **/
@@ -549,12 +571,19 @@ struct battle_interface {
 	/* */
 	int attr_fix_table[4][ELE_MAX][ELE_MAX];
 	struct eri *delay_damage_ers; //For battle delay damage structures.
+	DBMap *config_db; // setting name (case-insensitive) -> battle_data index + 1
+	struct battle_skill_terms *skill_terms; // innermost cast being resolved, see skill_terms_push
 	/* init */
 	void (*init) (bool minimal);
 	/* final */
 	void (*final) (void);
 	/* damage calculation */
 	struct Damage (*calc_attack) (int attack_type, struct block_list *bl, struct block_list *target, uint16 skill_id, uint16 skill_lv, int count);
+	/* target independent terms shared by the targets of a cast */
+	void (*skill_terms_push) (struct battle_skill_terms *terms, struct block_list *src, uint16 skill_id, uint16 skill_lv);
+	void (*skill_terms_pop) (struct battle_skill_terms *terms);
+	const struct battle_skill_terms *(*skill_terms_get) (struct block_list *src, uint16 skill_id, uint16 skill_lv, struct battle_skill_terms *buf);
+	void (*skill_terms_load) (struct battle_skill_terms *terms);
 	/* generic final damage calculation */
 	int64 (*calc_damage) (struct block_list *src, struct block_list *bl, struct Damage *d, int64 damage, uint16 skill_id, uint16 skill_lv);
 	/* gvg final damage calculation */
@@ -629,6 +658,7 @@ struct battle_interface {
 	void (*config_set_defaults) (void);
 	int (*config_set_value) (const char* w1, const char* w2);
 	int (*config_get_value) (const char* w1);
+	int (*config_index) (const char* w1);
 	void (*config_adjust) (void);
 	/* ----------------------------------------- */
 	/* picks a random enemy within the specified range */
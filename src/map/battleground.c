@@ -244,12 +244,12 @@ bool bg_send_message(struct map_session_data *sd, const char *mes, int len) {
 }
 
 /**
- * @see DBApply
+ * Sends the mini-map dots of the team members that moved since the last update.
+ * @return number of updates sent
  */
-int bg_send_xy_timer_sub(DBKey key, DBData *data, va_list ap) {
-	struct battleground_data *bgd = DB->data2ptr(data);
+int bg_send_xy_team(struct battleground_data *bgd) {
 	struct map_session_data *sd;
-	int i;
+	int i, sent = 0;
 	nullpo_ret(bgd);
 	for( i = 0; i < MAX_BG_MEMBERS; i++ ) {
 		if( (sd = bgd->members[i].sd) == NULL )
@@ -258,13 +258,47 @@ int bg_send_xy_timer_sub(DBKey key, DBData *data, va_list ap) {
 			bgd->members[i].x = sd->bl.x;
 			bgd->members[i].y = sd->bl.y;
 			clif->bg_xy(sd);
+			sent++;
 		}
 	}
-	return 0;
+	return sent;
+}
+
+/**
+ * Queues the team of sd for the next bg->send_xy_timer pass.
+ */
+void bg_send_xy_queue(struct map_session_data *sd) {
+	struct battleground_data *bgd;
+
+	nullpo_retv(sd);
+
+	if( !sd->bg_id || (bgd = bg->team_search(sd->bg_id)) == NULL || bgd->xy_queued )
+		return;
+
+	bgd->xy_queued = 1;
+	VECTOR_ENSURE(bg->xy_queue, 1, 8);
+	VECTOR_PUSH(bg->xy_queue, bgd->bg_id);
 }
 
 int bg_send_xy_timer(int tid, int64 tick, int id, intptr_t data) {
-	bg->team_db->foreach(bg->team_db, bg->send_xy_timer_sub, tick);
+	int64 start = timer->microtick();
+	unsigned int sent = 0;
+	int i;
+
+	bg->xy_stats.queued = (unsigned int)VECTOR_LENGTH(bg->xy_queue);
+	for( i = 0; i < VECTOR_LENGTH(bg->xy_queue); i++ ) {
+		struct battleground_data *bgd = bg->team_search(VECTOR_INDEX(bg->xy_queue, i));
+		if( bgd == NULL ) // deleted in the meantime
+			continue;
+		bgd->xy_queued = 0;
+		sent += bg->send_xy_team(bgd);
+	}
+	VECTOR_LENGTH(bg->xy_queue) = 0; // keep the allocation for the next pass
+
+	bg->xy_stats.sent = sent;
+	bg->xy_stats.duration = timer->microtick() - start;
+	if( bg->xy_stats.duration > bg->xy_stats.max_duration )
+		bg->xy_stats.max_duration = bg->xy_stats.duration;
 	return 0;
 }
 
@@ -870,6 +904,7 @@ void do_init_battleground(bool minimal) {
 		return;
 
 	bg->team_db = idb_alloc(DB_OPT_RELEASE_DATA);
+	VECTOR_INIT(bg->xy_queue);
 	timer->add_func_list(bg->send_xy_timer, "bg_send_xy_timer");
 	timer->add_interval(timer->gettick() + battle_config.bg_update_interval, bg->send_xy_timer, 0, 0, battle_config.bg_update_interval);
 	bg->config_read();
@@ -897,6 +932,7 @@ int bg_team_db_final(DBKey key, DBData *data, va_list ap) {
 void do_final_battleground(void)
 {
 	bg->team_db->destroy(bg->team_db,bg->team_db_final);
+	VECTOR_CLEAR(bg->xy_queue);
 
 	if (bg->arena) {
 		int i;
@@ -919,6 +955,8 @@ void battleground_defaults(void) {
 	/* */
 	bg->team_db = NULL;
 	bg->team_counter = 0;
+	VECTOR_INIT(bg->xy_queue);
+	memset(&bg->xy_stats, 0, sizeof(bg->xy_stats));
 	/* */
 	bg->init = do_init_battleground;
 	bg->final = do_final_battleground;
@@ -946,8 +984,9 @@ void battleground_defaults(void) {
 	bg->create = bg_create;
 	bg->team_get_id = bg_team_get_id;
 	bg->send_message = bg_send_message;
-	bg->send_xy_timer_sub = bg_send_xy_timer_sub;
+	bg->send_xy_team = bg_send_xy_team;
 	bg->send_xy_timer = bg_send_xy_timer;
+	bg->send_xy_queue = bg_send_xy_queue;
 	bg->afk_timer = bg_afk_timer;
 	bg->team_db_final = bg_team_db_final;
 	/* */
@@ -53,6 +53,7 @@ struct battleground_data {
 	// Logout Event
 	char logout_event[EVENT_NAME_LENGTH];
 	char die_event[EVENT_NAME_LENGTH];
+	unsigned xy_queued : 1; ///< Queued in bg->xy_queue for the next position broadcast
 	/* HPM Custom Struct */
 	struct HPluginData **hdata;
 	unsigned int hdatac;
@@ -90,6 +91,8 @@ struct battleground_interface {
 	/* */
 	DBMap *team_db; // int bg_id -> struct battleground_data*
 	unsigned int team_counter; // Next bg_id
+	VECTOR_DECL(int) xy_queue; ///< Ids of teams with members that moved since the last bg->send_xy_timer
+	struct xy_broadcast_stats xy_stats;
 	/* */
 	void (*init) (bool minimal);
 	void (*final) (void);
@@ -117,8 +120,9 @@ struct battleground_interface {
 	int (*create) (unsigned short map_index, short rx, short ry, const char *ev, const char *dev);
 	int (*team_get_id) (struct block_list *bl);
 	bool (*send_message) (struct map_session_data *sd, const char *mes, int len);
-	int (*send_xy_timer_sub) (DBKey key, DBData *data, va_list ap);
+	int (*send_xy_team) (struct battleground_data *bgd);
 	int (*send_xy_timer) (int tid, int64 tick, int id, intptr_t data);
+	void (*send_xy_queue) (struct map_session_data *sd);
 	int (*afk_timer) (int tid, int64 tick, int id, intptr_t data);
 	int (*team_db_final) (DBKey key, DBData *data, va_list ap);
 	/* */
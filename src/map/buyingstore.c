@@ -176,6 +176,7 @@ void buyingstore_create(struct map_session_data* sd, int zenylimit, unsigned cha
 	sd->buyingstore.zenylimit = zenylimit;
 	sd->buyingstore.slots = i;  // store actual amount of items
 	safestrncpy(sd->message, storename, sizeof(sd->message));
+	searchstore->index_add(sd, SEARCHTYPE_BUYING_STORE);
 	clif->buyingstore_myitemlist(sd);
 	clif->buyingstore_entry(sd);
 }
@@ -186,6 +187,7 @@ void buyingstore_close(struct map_session_data* sd)
 	if (sd->state.buyingstore)
 	{
 		// invalidate data
+		searchstore->index_remove(sd, SEARCHTYPE_BUYING_STORE);
 		sd->state.buyingstore = false;
 		memset(&sd->buyingstore, 0, sizeof(sd->buyingstore));
 
@@ -342,6 +344,9 @@ void buyingstore_trade(struct map_session_data* sd, int account_id, unsigned int
 		zeny+= amount*pl_sd->buyingstore.items[listidx].price;
 	}
 
+	// amounts are about to change, re-indexed below
+	searchstore->index_remove(pl_sd, SEARCHTYPE_BUYING_STORE);
+
 	// process item list
 	for( i = 0; i < count; i++ )
 	{// itemlist: <index>.W <name id>.W <amount>.W
@@ -369,6 +374,7 @@ void buyingstore_trade(struct map_session_data* sd, int account_id, unsigned int
 		clif->buyingstore_delete_item(sd, index, amount, pl_sd->buyingstore.items[listidx].price);
 		clif->buyingstore_update_item(pl_sd, nameid, amount);
 	}
+	searchstore->index_add(pl_sd, SEARCHTYPE_BUYING_STORE);
 
 	if( map->save_settings&128 ) {
 		chrif->save(sd, 0);
@@ -50,7 +50,7 @@ struct chrif_interface *chrif;
 //2afe: Outgoing, send_usercount_tochar -> 'sends player count of this map server to charserver'
 //2aff: Outgoing, chrif_send_users_tochar -> 'sends all actual connected character ids to charserver'
 //2b00: Incoming, map_setusers -> 'set the actual usercount? PACKET.2B COUNT.L.. ?' (not sure)
-//2b01: Outgoing, chrif_save -> 'charsave of char XY account XY (complete struct)'
+//2b01: Outgoing, chrif_save -> 'charsave of char XY account XY (complete struct), flag 2 when changing map-server'
 //2b02: Outgoing, chrif_charselectreq -> 'player returns from ingame to charserver to select another char.., this packets includes sessid etc' ? (not 100% sure)
 //2b03: Incoming, clif_charselectok -> '' (i think its the packet after enterworld?) (not sure)
 //2b04: Incoming, chrif_recvmap -> 'getting maps from charserver of other mapserver's'
@@ -89,6 +89,10 @@ struct chrif_interface *chrif;
 //2b25: Incoming, chrif_deadopt -> 'Removes baby from Father ID and Mother ID'
 //2b26: Outgoing, chrif_authreq -> 'client authentication request'
 //2b27: Incoming, chrif_authfail -> 'client authentication failed'
+//2b28: Outgoing, chrif_local_transport_req -> 'offer a shared memory link'
+//2b29: Incoming, chrif_local_transport_ack -> 'shared memory link accepted / refused, last packet over TCP when accepted'
+//2b2a: Outgoing, chrif_local_transport_ack -> 'last packet over TCP, everything after it goes through the shared memory link'
+//2b2b: Outgoing, chrif_handoff_scdata -> 'Send sc_data of player changing map-server, kept in memory by the char-server.'
 
 //This define should spare writing the check in every function. [Skotlex]
 #define chrif_check(a) do { if(!chrif->isconnected()) return a; } while(0)
@@ -263,8 +267,12 @@ bool chrif_save(struct map_session_data *sd, int flag) {
 
 	if (flag && sd->state.active) { //Store player data which is quitting
 		//FIXME: SC are lost if there's no connection at save-time because of the way its related data is cleared immediately after this function. [Skotlex]
-		if ( chrif->isconnected() )
-			chrif->save_scdata(sd);
+		if ( chrif->isconnected() ) {
+			if (flag == 2)
+				chrif->handoff_scdata(sd);
+			else
+				chrif->save_scdata(sd);
+		}
 		if ( !chrif->auth_logout(sd,flag == 1 ? ST_LOGOUT : ST_MAPCHANGE) )
 			ShowError("chrif_save: Failed to set up player %d:%d for proper quitting!\n", sd->status.account_id, sd->status.char_id);
 	}
@@ -287,7 +295,7 @@ bool chrif_save(struct map_session_data *sd, int flag) {
 	WFIFOW(chrif->fd,2) = sizeof(sd->status) + 13;
 	WFIFOL(chrif->fd,4) = sd->status.account_id;
 	WFIFOL(chrif->fd,8) = sd->status.char_id;
-	WFIFOB(chrif->fd,12) = (flag==1)?1:0; //Flag to tell char-server this character is quitting.
+	WFIFOB(chrif->fd,12) = (flag == 1 || flag == 2) ? flag : 0; //Flag to tell char-server this character is quitting (1) or changing map-server (2).
 	memcpy(WFIFOP(chrif->fd,13), &sd->status, sizeof(sd->status));
 	WFIFOSET(chrif->fd, WFIFOW(chrif->fd,2));
 
@@ -435,6 +443,9 @@ void chrif_connectack(int fd) {
 	chrif->state = 1;
 	chrif->connected = 1;
 
+	if( chrif->local_transport )
+		chrif->local_transport_req(fd);
+
 	chrif->sendmap(fd);
 
 	ShowStatus("Event '"CL_WHITE"OnInterIfInit"CL_RESET"' executed with '"CL_WHITE"%d"CL_RESET"' NPCs.\n", npc->event_doall("OnInterIfInit"));
@@ -1124,6 +1135,24 @@ int chrif_updatefamelist_ack(int fd) {
 }
 
 bool chrif_save_scdata(struct map_session_data *sd) { //parses the sc_data of the player and sends it to the char-server for saving. [Skotlex]
+	return chrif->send_scdata(sd, 0x2b1c);
+}
+
+/**
+ * Sends the sc_data of a player changing map-server, the char-server hands it
+ * to the destination map-server from memory.
+ */
+bool chrif_handoff_scdata(struct map_session_data *sd) {
+	return chrif->send_scdata(sd, 0x2b2b);
+}
+
+/**
+ * Packs the sc_data of a player.
+ *
+ * @param sd  Player.
+ * @param cmd 0x2b1c (save) or 0x2b2b (map-server change, sent even when empty).
+ */
+bool chrif_send_scdata(struct map_session_data *sd, uint16 cmd) {
 
 #ifdef ENABLE_SC_SAVING
 	int i, count=0;
@@ -1138,7 +1167,7 @@ bool chrif_save_scdata(struct map_session_data *sd) { //parses the sc_data of th
 	tick = timer->gettick();
 
 	WFIFOHEAD(chrif->fd, 14 + SC_MAX*sizeof(struct status_change_data));
-	WFIFOW(chrif->fd,0) = 0x2b1c;
+	WFIFOW(chrif->fd,0) = cmd;
 	WFIFOL(chrif->fd,4) = sd->status.account_id;
 	WFIFOL(chrif->fd,8) = sd->status.char_id;
 
@@ -1165,7 +1194,7 @@ bool chrif_save_scdata(struct map_session_data *sd) { //parses the sc_data of th
 		count++;
 	}
 
-	if (count == 0)
+	if (count == 0 && cmd == 0x2b1c)
 		return true; //Nothing to save. | Everything was as successful as if there was something to save.
 
 	WFIFOW(chrif->fd,12) = count;
@@ -1326,6 +1355,45 @@ void chrif_keepalive(int fd) {
 void chrif_keepalive_ack(int fd) {
 	sockt->session[fd]->flag.ping = 0;/* reset ping state, we received a packet */
 }
+
+/**
+ * Offers the char-server a shared memory link (char_local_transport).
+ * The link only works if the char-server can open the segment, i.e. runs on this machine.
+ */
+void chrif_local_transport_req(int fd) {
+	if( !sockt->shm_create(fd) ) {
+		ShowWarning("chrif_local_transport_req: Unable to set up a local link, staying on TCP.\n");
+		return;
+	}
+
+	WFIFOHEAD(fd,2+SOCKET_SHM_NAME_LENGTH);
+	WFIFOW(fd,0) = 0x2b28;
+	safestrncpy((char*)WFIFOP(fd,2), sockt->session[fd]->shm->name, SOCKET_SHM_NAME_LENGTH);
+	WFIFOSET(fd,2+SOCKET_SHM_NAME_LENGTH);
+}
+
+/**
+ * Answer to chrif_local_transport_req.
+ * When accepted, this is the last packet the char-server sent over TCP; the map-server
+ * sends 0x2b2a as its own last one and both sides switch to the shared memory link.
+ */
+void chrif_local_transport_ack(int fd) {
+	if( RFIFOB(fd,2) ) {
+		ShowInfo("Char-server is not on this machine, staying on TCP.\n");
+		sockt->shm_close(fd);
+		return;
+	}
+
+	sockt->shm_unlink(fd); // both sides have it mapped
+
+	WFIFOHEAD(fd,2);
+	WFIFOW(fd,0) = 0x2b2a;
+	WFIFOSET(fd,2);
+
+	sockt->shm_start_send(fd);
+	sockt->shm_start_recv(fd);
+	ShowStatus("Switched the char-server connection to a local link.\n");
+}
 void chrif_skillid2idx(int fd) {
 	int i, count = 0;
 
@@ -1432,6 +1500,7 @@ int chrif_parse(int fd) {
 			case 0x2b24: chrif->keepalive_ack(fd); break;
 			case 0x2b25: chrif->deadopt(RFIFOL(fd,2), RFIFOL(fd,6), RFIFOL(fd,10)); break;
 			case 0x2b27: chrif->authfail(fd); break;
+			case 0x2b29: chrif->local_transport_ack(fd); break;
 			default:
 				ShowError("chrif_parse : unknown packet (session #%d): 0x%x. Disconnecting.\n", fd, cmd);
 				sockt->eof(fd);
@@ -1666,6 +1735,7 @@ void chrif_defaults(void) {
 		11, 10, 10,  0, 11,  0,266, 10, // 2b10-2b17: U->2b10, U->2b11, U->2b12, F->2b13, U->2b14, F->2b15, U->2b16, U->2b17
 		 2, 10,  2, -1, -1, -1,  2,  7, // 2b18-2b1f: U->2b18, U->2b19, U->2b1a, U->2b1b, U->2b1c, U->2b1d, U->2b1e, U->2b1f
 		-1, 10,  8,  2,  2, 14, 19, 19, // 2b20-2b27: U->2b20, U->2b21, U->2b22, U->2b23, U->2b24, U->2b25, U->2b26, U->2b27
+		34,  3,  2,  0,  0,  0,  0,  0, // 2b28-2b2f: U->2b28, U->2b29, U->2b2a, F->2b2b, F->2b2c, F->2b2d, F->2b2e, F->2b2f
 	};
 
 	chrif = &chrif_s;
@@ -1683,6 +1753,7 @@ void chrif_defaults(void) {
 	memset(chrif->userid,0,sizeof(chrif->userid));
 	memset(chrif->passwd,0,sizeof(chrif->passwd));
 	chrif->state = 0;
+	chrif->local_transport = false;
 
 	/* */
 	chrif->auth_db = NULL;
@@ -1719,6 +1790,8 @@ void chrif_defaults(void) {
 	chrif->updatefamelist = chrif_updatefamelist;
 	chrif->buildfamelist = chrif_buildfamelist;
 	chrif->save_scdata = chrif_save_scdata;
+	chrif->handoff_scdata = chrif_handoff_scdata;
+	chrif->send_scdata = chrif_send_scdata;
 	chrif->ragsrvinfo = chrif_ragsrvinfo;
 	chrif->char_offline_nsd = chrif_char_offline_nsd;
 	chrif->char_reset_offline = chrif_char_reset_offline;
@@ -1764,6 +1837,8 @@ void chrif_defaults(void) {
 	chrif->keepalive_ack = chrif_keepalive_ack;
 	chrif->deadopt = chrif_deadopt;
 	chrif->authfail = chrif_authfail;
+	chrif->local_transport_req = chrif_local_transport_req;
+	chrif->local_transport_ack = chrif_local_transport_ack;
 	chrif->on_ready = chrif_on_ready;
 	chrif->on_disconnect = chrif_on_disconnect;
 	chrif->parse = chrif_parse;
@@ -66,6 +66,7 @@ struct chrif_interface {
 	uint16 port;
 	char userid[NAME_LENGTH], passwd[NAME_LENGTH];
 	int state;
+	bool local_transport; // ask for a shared memory link when the char-server is on this machine (char_local_transport)
 	/* */
 	void (*init) (bool minimal);
 	void (*final) (void);
@@ -97,6 +98,8 @@ struct chrif_interface {
 	int (*updatefamelist) (struct map_session_data *sd);
 	bool (*buildfamelist) (void);
 	bool (*save_scdata) (struct map_session_data *sd);
+	bool (*handoff_scdata) (struct map_session_data *sd);
+	bool (*send_scdata) (struct map_session_data *sd, uint16 cmd);
 	bool (*ragsrvinfo) (int base_rate,int job_rate, int drop_rate);
 	//int (*char_offline) (struct map_session_data *sd);
 	bool (*char_offline_nsd) (int account_id, int char_id);
@@ -143,6 +146,8 @@ struct chrif_interface {
 	void (*keepalive_ack) (int fd);
 	void (*deadopt) (int father_id, int mother_id, int child_id);
 	void (*authfail) (int fd);
+	void (*local_transport_req) (int fd);
+	void (*local_transport_ack) (int fd);
 	void (*on_ready) (void);
 	void (*on_disconnect) (void);
 	int (*parse) (int fd);
@@ -343,6 +343,9 @@ int clif_send_sub(struct block_list *bl, va_list ap) {
 	if( clif->ally_only && !sd->sc.data[SC_CLAIRVOYANCE] && !sd->special_state.intravision && battle->check_target( src_bl, &sd->bl, BCT_ENEMY ) > 0 )
 		return 0;
 
+	if( sd->view_pending > 0 && src_bl != bl ) // the client must know src_bl before it hears about it
+		clif->view_send_pending(sd, src_bl);
+
 	return clif->send_actual(fd, buf, len);
 }
 
@@ -911,6 +914,40 @@ static int clif_setlevel(struct block_list* bl) {
 	return lv;
 }
 /* for 'packetver < 20091103' 0x78 non-pc-looking unit handling */
+/**
+ * Finds the appearance packet cache entry of a unit.
+ *
+ * Only used during a viewport flush (clif->view_flush), when the same
+ * unit is sent to many clients in a row and can't change in between, so an
+ * entry is valid for the flush it was built in and needs no invalidation.
+ *
+ * @param bl   The unit.
+ * @param walk Whether the walking packet rather than the idle one is wanted.
+ * @param[out] hit Set to whether the entry already holds the packet.
+ * @return The entry to read from (on a hit) or fill (on a miss), NULL when not caching.
+ */
+static struct clif_unit_packet *clif_unit_packet_entry(struct block_list *bl, bool walk, bool *hit)
+{
+	struct clif_unit_packet *entry;
+
+	*hit = false;
+	if (!clif->view_flushing)
+		return NULL;
+
+	entry = &clif->unit_packet_cache[bl->id & (CLIF_UNIT_PACKET_CACHE - 1)];
+	if (entry->unit_id == bl->id && entry->pass == clif->view_pass && entry->walk == walk) {
+		clif->view_stats.packet_hits++;
+		*hit = true;
+		return entry;
+	}
+
+	clif->view_stats.packet_builds++;
+	entry->unit_id = bl->id;
+	entry->pass = clif->view_pass;
+	entry->walk = walk;
+	return entry;
+}
+
 void clif_set_unit_idle2(struct block_list* bl, struct map_session_data *tsd, enum send_target target) {
 #if PACKETVER < 20091103
 	struct map_session_data* sd;
@@ -965,79 +1002,102 @@ void clif_set_unit_idle2(struct block_list* bl, struct map_session_data *tsd, en
 /*==========================================
  * Prepares 'unit standing' packet
  *------------------------------------------*/
-void clif_set_unit_idle(struct block_list* bl, struct map_session_data *tsd, enum send_target target) {
+/**
+ * Builds the idle/spawn packet of a unit (see clif_set_unit_idle).
+ *
+ * @param bl The unit.
+ * @param[out] p The packet.
+ */
+void clif_set_unit_idle_packet(struct block_list* bl, struct packet_idle_unit *p) {
 	struct map_session_data* sd;
 	struct status_change* sc = status->get_sc(bl);
 	struct view_data* vd = status->get_viewdata(bl);
-	struct packet_idle_unit p;
 	int g_id = status->get_guild_id(bl);
 
 	nullpo_retv(bl);
-
-#if PACKETVER < 20091103
-	if( !pc->db_checkid(vd->class_) ) {
-		clif->set_unit_idle2(bl,tsd,target);
-		return;
-	}
-#endif
+	nullpo_retv(p);
 
 	sd = BL_CAST(BL_PC, bl);
 
-	p.PacketType = idle_unitType;
+	p->PacketType = idle_unitType;
 #if PACKETVER >= 20091103
-	p.PacketLength = sizeof(p);
-	p.objecttype = clif_bl_type(bl);
+	p->PacketLength = sizeof(*p);
+	p->objecttype = clif_bl_type(bl);
 #endif
-	p.GID = bl->id;
-	p.speed = status->get_speed(bl);
-	p.bodyState = (sc) ? sc->opt1 : 0;
-	p.healthState = (sc) ? sc->opt2 : 0;
-	p.effectState = (sc) ? sc->option : bl->type == BL_NPC ? ((TBL_NPC*)bl)->option : 0;
-	p.job = vd->class_;
-	p.head = vd->hair_style;
-	p.weapon = vd->weapon;
-	p.accessory = vd->head_bottom;
+	p->GID = bl->id;
+	p->speed = status->get_speed(bl);
+	p->bodyState = (sc) ? sc->opt1 : 0;
+	p->healthState = (sc) ? sc->opt2 : 0;
+	p->effectState = (sc) ? sc->option : bl->type == BL_NPC ? ((TBL_NPC*)bl)->option : 0;
+	p->job = vd->class_;
+	p->head = vd->hair_style;
+	p->weapon = vd->weapon;
+	p->accessory = vd->head_bottom;
 #if PACKETVER < 7
-	p.shield = vd->shield;
+	p->shield = vd->shield;
 #endif
-	p.accessory2 = vd->head_top;
-	p.accessory3 = vd->head_mid;
+	p->accessory2 = vd->head_top;
+	p->accessory3 = vd->head_mid;
 	if( bl->type == BL_NPC && vd->class_ == FLAG_CLASS ) { //The hell, why flags work like this?
-		p.accessory = status->get_emblem_id(bl);
-		p.accessory2 = GetWord(g_id, 1);
-		p.accessory3 = GetWord(g_id, 0);
+		p->accessory = status->get_emblem_id(bl);
+		p->accessory2 = GetWord(g_id, 1);
+		p->accessory3 = GetWord(g_id, 0);
 	}
-	p.headpalette = vd->hair_color;
-	p.bodypalette = vd->cloth_color;
-	p.headDir = (sd)? sd->head_dir : 0;
+	p->headpalette = vd->hair_color;
+	p->bodypalette = vd->cloth_color;
+	p->headDir = (sd)? sd->head_dir : 0;
 #if PACKETVER >= 20101124
-	p.robe = vd->robe;
+	p->robe = vd->robe;
 #endif
-	p.GUID = g_id;
-	p.GEmblemVer = status->get_emblem_id(bl);
-	p.honor = (sd) ? sd->status.manner : 0;
-	p.virtue = (sc) ? sc->opt3 : 0;
-	p.isPKModeON = (sd && sd->status.karma) ? 1 : 0;
-	p.sex = vd->sex;
-	WBUFPOS(&p.PosDir[0],0,bl->x,bl->y,unit->getdir(bl));
-	p.xSize = p.ySize = (sd) ? 5 : 0;
-	p.state = vd->dead_sit;
-	p.clevel = clif_setlevel(bl);
+	p->GUID = g_id;
+	p->GEmblemVer = status->get_emblem_id(bl);
+	p->honor = (sd) ? sd->status.manner : 0;
+	p->virtue = (sc) ? sc->opt3 : 0;
+	p->isPKModeON = (sd && sd->status.karma) ? 1 : 0;
+	p->sex = vd->sex;
+	WBUFPOS(&p->PosDir[0],0,bl->x,bl->y,unit->getdir(bl));
+	p->xSize = p->ySize = (sd) ? 5 : 0;
+	p->state = vd->dead_sit;
+	p->clevel = clif_setlevel(bl);
 #if PACKETVER >= 20080102
-	p.font = (sd) ? sd->status.font : 0;
+	p->font = (sd) ? sd->status.font : 0;
 #endif
 #if PACKETVER >= 20150000 //actual 20120221
 	if( bl->type == BL_MOB ) {
-		p.maxHP = status_get_max_hp(bl);
-		p.HP = status_get_hp(bl);
-		p.isBoss = ( ((TBL_MOB*)bl)->spawn && ((TBL_MOB*)bl)->spawn->state.boss ) ? 1 : 0;
+		p->maxHP = status_get_max_hp(bl);
+		p->HP = status_get_hp(bl);
+		p->isBoss = ( ((TBL_MOB*)bl)->spawn && ((TBL_MOB*)bl)->spawn->state.boss ) ? 1 : 0;
 	} else {
-		p.maxHP = -1;
-		p.HP = -1;
-		p.isBoss = 0;
+		p->maxHP = -1;
+		p->HP = -1;
+		p->isBoss = 0;
+	}
+#endif
+}
+
+void clif_set_unit_idle(struct block_list* bl, struct map_session_data *tsd, enum send_target target) {
+	struct packet_idle_unit p;
+	struct clif_unit_packet *cached;
+	bool hit;
+
+	nullpo_retv(bl);
+
+#if PACKETVER < 20091103
+	if( !pc->db_checkid(status->get_viewdata(bl)->class_) ) {
+		clif->set_unit_idle2(bl,tsd,target);
+		return;
 	}
 #endif
 
+	cached = clif_unit_packet_entry(bl, false, &hit);
+	if( hit ) {
+		p = cached->u.idle;
+	} else {
+		clif->set_unit_idle_packet(bl, &p);
+		if( cached )
+			cached->u.idle = p;
+	}
+
 	clif->send(&p,sizeof(p),tsd?&tsd->bl:bl,target);
 
 	if( disguised(bl) ) {
@@ -1187,69 +1247,94 @@ void clif_spawn_unit(struct block_list* bl, enum send_target target) {
 /*==========================================
  * Prepares 'unit walking' packet
  *------------------------------------------*/
-void clif_set_unit_walking(struct block_list* bl, struct map_session_data *tsd, struct unit_data* ud, enum send_target target) {
+/**
+ * Builds the walking packet of a unit (see clif_set_unit_walking).
+ *
+ * @param bl The unit.
+ * @param ud Its unit data.
+ * @param[out] p The packet.
+ */
+void clif_set_unit_walking_packet(struct block_list* bl, struct unit_data* ud, struct packet_unit_walking *p) {
 	struct map_session_data* sd;
 	struct status_change* sc = status->get_sc(bl);
 	struct view_data* vd = status->get_viewdata(bl);
-	struct packet_unit_walking p;
 	int g_id = status->get_guild_id(bl);
 
 	nullpo_retv(bl);
 	nullpo_retv(ud);
+	nullpo_retv(p);
 
 	sd = BL_CAST(BL_PC, bl);
 
-	p.PacketType = unit_walkingType;
+	p->PacketType = unit_walkingType;
 #if PACKETVER >= 20091103
-	p.PacketLength = sizeof(p);
+	p->PacketLength = sizeof(*p);
 #endif
 #if PACKETVER >= 20071106
-	p.objecttype = clif_bl_type(bl);
+	p->objecttype = clif_bl_type(bl);
 #endif
-	p.GID = bl->id;
-	p.speed = status->get_speed(bl);
-	p.bodyState = (sc) ? sc->opt1 : 0;
-	p.healthState = (sc) ? sc->opt2 : 0;
-	p.effectState = (sc) ? sc->option : bl->type == BL_NPC ? ((TBL_NPC*)bl)->option : 0;
-	p.job = vd->class_;
-	p.head = vd->hair_style;
-	p.weapon = vd->weapon;
-	p.accessory = vd->head_bottom;
-	p.moveStartTime = (unsigned int)timer->gettick();
+	p->GID = bl->id;
+	p->speed = status->get_speed(bl);
+	p->bodyState = (sc) ? sc->opt1 : 0;
+	p->healthState = (sc) ? sc->opt2 : 0;
+	p->effectState = (sc) ? sc->option : bl->type == BL_NPC ? ((TBL_NPC*)bl)->option : 0;
+	p->job = vd->class_;
+	p->head = vd->hair_style;
+	p->weapon = vd->weapon;
+	p->accessory = vd->head_bottom;
+	p->moveStartTime = (unsigned int)timer->gettick();
 #if PACKETVER < 7
-	p.shield = vd->shield;
+	p->shield = vd->shield;
 #endif
-	p.accessory2 = vd->head_top;
-	p.accessory3 = vd->head_mid;
-	p.headpalette = vd->hair_color;
-	p.bodypalette = vd->cloth_color;
-	p.headDir = (sd)? sd->head_dir : 0;
+	p->accessory2 = vd->head_top;
+	p->accessory3 = vd->head_mid;
+	p->headpalette = vd->hair_color;
+	p->bodypalette = vd->cloth_color;
+	p->headDir = (sd)? sd->head_dir : 0;
 #if PACKETVER >= 20101124
-	p.robe = vd->robe;
+	p->robe = vd->robe;
 #endif
-	p.GUID = g_id;
-	p.GEmblemVer = status->get_emblem_id(bl);
-	p.honor = (sd) ? sd->status.manner : 0;
-	p.virtue = (sc) ? sc->opt3 : 0;
-	p.isPKModeON = (sd && sd->status.karma) ? 1 : 0;
-	p.sex = vd->sex;
-	WBUFPOS2(&p.MoveData[0],0,bl->x,bl->y,ud->to_x,ud->to_y,8,8);
-	p.xSize = p.ySize = (sd) ? 5 : 0;
-	p.clevel = clif_setlevel(bl);
+	p->GUID = g_id;
+	p->GEmblemVer = status->get_emblem_id(bl);
+	p->honor = (sd) ? sd->status.manner : 0;
+	p->virtue = (sc) ? sc->opt3 : 0;
+	p->isPKModeON = (sd && sd->status.karma) ? 1 : 0;
+	p->sex = vd->sex;
+	WBUFPOS2(&p->MoveData[0],0,bl->x,bl->y,ud->to_x,ud->to_y,8,8);
+	p->xSize = p->ySize = (sd) ? 5 : 0;
+	p->clevel = clif_setlevel(bl);
 #if PACKETVER >= 20080102
-	p.font = (sd) ? sd->status.font : 0;
+	p->font = (sd) ? sd->status.font : 0;
 #endif
 #if PACKETVER >= 20150000 //actual 20120221
 	if( bl->type == BL_MOB ) {
-		p.maxHP = status_get_max_hp(bl);
-		p.HP = status_get_hp(bl);
-		p.isBoss = ( ((TBL_MOB*)bl)->spawn && ((TBL_MOB*)bl)->spawn->state.boss ) ? 1 : 0;
+		p->maxHP = status_get_max_hp(bl);
+		p->HP = status_get_hp(bl);
+		p->isBoss = ( ((TBL_MOB*)bl)->spawn && ((TBL_MOB*)bl)->spawn->state.boss ) ? 1 : 0;
 	} else {
-		p.maxHP = -1;
-		p.HP = -1;
-		p.isBoss = 0;
+		p->maxHP = -1;
+		p->HP = -1;
+		p->isBoss = 0;
 	}
 #endif
+}
+
+void clif_set_unit_walking(struct block_list* bl, struct map_session_data *tsd, struct unit_data* ud, enum send_target target) {
+	struct packet_unit_walking p;
+	struct clif_unit_packet *cached;
+	bool hit;
+
+	nullpo_retv(bl);
+	nullpo_retv(ud);
+
+	cached = clif_unit_packet_entry(bl, true, &hit);
+	if( hit ) {
+		p = cached->u.walk;
+	} else {
+		clif->set_unit_walking_packet(bl, ud, &p);
+		if( cached )
+			cached->u.walk = p;
+	}
 
 	clif->send(&p,sizeof(p),tsd?&tsd->bl:bl,target);
 
@@ -2848,6 +2933,8 @@ void clif_updatestatus(struct map_session_data *sd,int type)
 				clif->hpmeter(sd);
 			if( !battle_config.party_hp_mode && sd->status.party_id )
 				clif->party_hp(sd);
+			else if( sd->status.party_id )
+				party->send_xy_queue(sd); // sent on the next party->send_xy_timer
 			if( sd->bg_id )
 				clif->bg_hp(sd);
 			break;
@@ -4548,6 +4635,7 @@ int clif_outsight(struct block_list *bl,va_list ap)
 
 	if (tsd && tsd->fd) { //tsd has lost sight of the bl object.
 		nullpo_ret(bl);
+		clif->view_cancel(tsd, bl); // never sent, if it was still queued
 		switch(bl->type){
 			case BL_PC:
 				if (sd->vd.class_ != INVISIBLE_CLASS)
@@ -4581,6 +4669,7 @@ int clif_outsight(struct block_list *bl,va_list ap)
 	}
 	if (sd && sd->fd) { //sd is watching tbl go out of view.
 		nullpo_ret(tbl);
+		clif->view_cancel(sd, tbl);
 		if(tbl->type == BL_SKILL) //Trap knocked out of sight
 			clif->clearchar_skillunit((struct skill_unit *)tbl,sd->fd);
 		else if (((vd=status->get_viewdata(tbl)) && vd->class_ != INVISIBLE_CLASS) &&
@@ -4614,16 +4703,206 @@ int clif_insight(struct block_list *bl,va_list ap)
 				clif->getareachar_skillunit(&tsd->bl,(TBL_SKILL*)bl,SELF);
 				break;
 			default:
-				clif->getareachar_unit(tsd,bl);
+				clif->view_queue_add(tsd,bl);
 				break;
 		}
 	}
 	if (sd && sd->fd) { //Tell sd that tbl walked into his view
-		clif->getareachar_unit(sd,tbl);
+		clif->view_queue_add(sd,tbl);
+	}
+	return 0;
+}
+
+/// Key of a (observer, unit) pair in clif->view_pending
+static inline uint64 clif_view_key(int observer_id, int unit_id)
+{
+	return ((uint64)(uint32)observer_id << 32) | (uint32)unit_id;
+}
+
+/**
+ * Queues bl to be sent to sd as having come into its view.
+ *
+ * Units are sent by clif->view_flush right before packets go out, instead
+ * of on every step that brings them into view, so that a unit stepping back
+ * and forth over the edge of the view, or coming into view of the same
+ * client several times, only costs one spawn packet set, and units that
+ * already left again cost none.
+ *
+ * @param sd The observing player.
+ * @param bl The unit that came into view.
+ */
+void clif_view_queue_add(struct map_session_data *sd, struct block_list *bl)
+{
+	struct clif_view_enter *entry;
+	uint64 key;
+
+	nullpo_retv(sd);
+	nullpo_retv(bl);
+
+	clif->view_stats.queued++;
+	key = clif_view_key(sd->bl.id, bl->id);
+	if (ui64db_iget(clif->view_pending, key)) {
+		clif->view_stats.merged++;
+		return;
 	}
+	ui64db_iput(clif->view_pending, key, 1);
+	sd->view_pending++;
+
+	VECTOR_ENSURE(clif->view_queue, 1, 64);
+	VECTOR_PUSHZEROED(clif->view_queue);
+	entry = &VECTOR_LAST(clif->view_queue);
+	entry->observer_id = sd->bl.id;
+	entry->unit_id = bl->id;
+	entry->seq = clif->view_seq++;
+}
+
+/**
+ * Takes a (observer, unit) pair off clif->view_pending.
+ *
+ * @param sd The observing player, NULL if it's gone.
+ * @return Whether the unit was still waiting to be sent.
+ */
+static bool clif_view_unqueue(struct map_session_data *sd, int observer_id, int unit_id)
+{
+	if (!ui64db_remove(clif->view_pending, clif_view_key(observer_id, unit_id)))
+		return false;
+	if (sd != NULL && sd->view_pending > 0)
+		sd->view_pending--;
+	return true;
+}
+
+/**
+ * Sends bl to sd right away if it's still queued as having come into sd's view.
+ * Called before a packet about bl goes to sd, which the client would
+ * otherwise receive before it knows the unit.
+ *
+ * @param sd The observing player.
+ * @param bl The unit.
+ */
+void clif_view_send_pending(struct map_session_data *sd, struct block_list *bl)
+{
+	nullpo_retv(sd);
+	nullpo_retv(bl);
+
+	if (sd->view_pending == 0 || !clif_view_unqueue(sd, sd->bl.id, bl->id))
+		return;
+
+	clif->view_stats.early++;
+	clif->getareachar_unit(sd, bl);
+}
+
+/**
+ * Drops bl from sd's queue when it leaves sd's view before it was sent.
+ *
+ * @param sd The observing player.
+ * @param bl The unit.
+ * @return Whether the unit was still queued.
+ */
+bool clif_view_cancel(struct map_session_data *sd, struct block_list *bl)
+{
+	nullpo_retr(false, sd);
+	nullpo_retr(false, bl);
+
+	if (sd->view_pending == 0 || !clif_view_unqueue(sd, sd->bl.id, bl->id))
+		return false;
+
+	clif->view_stats.dropped++;
+	return true;
+}
+
+/// qsort comparator, by observer, then queue order
+static int clif_view_enter_cmp(const void *a, const void *b)
+{
+	const struct clif_view_enter *ea = (const struct clif_view_enter *)a;
+	const struct clif_view_enter *eb = (const struct clif_view_enter *)b;
+
+	if (ea->observer_id != eb->observer_id)
+		return ea->observer_id < eb->observer_id ? -1 : 1;
+	if (ea->seq != eb->seq)
+		return ea->seq < eb->seq ? -1 : 1;
 	return 0;
 }
 
+/**
+ * Sends the units queued by clif->view_queue_add.
+ *
+ * Runs at the start of every do_sockets, after the timers and the previous
+ * socket pass queued their units and before any packet is sent, so a
+ * client gets the units that came into its view in the same loop iteration.
+ * Each unit is sent once per client, and only if it's still in view.
+ * A client gets at most CLIF_VIEW_ENTER_MAX units per flush, the oldest
+ * first, the rest stays queued for the next one. A queued unit is sent
+ * ahead of the flush when a packet about it goes to the client (see
+ * clif->view_send_pending).
+ */
+void clif_view_flush(void)
+{
+	struct clif_view_enter *queue;
+	int i, n, kept = 0;
+
+	if ((n = VECTOR_LENGTH(clif->view_queue)) == 0)
+		return;
+	clif->view_stats.flushes++;
+
+	queue = VECTOR_DATA(clif->view_queue);
+	qsort(queue, n, sizeof(*queue), clif_view_enter_cmp);
+
+	// unit state doesn't change until the loop ends, so appearance packets can be shared
+	clif->view_pass++;
+	clif->view_flushing = true;
+	for (i = 0; i < n; ) {
+		struct map_session_data *sd = map->id2sd(queue[i].observer_id);
+		int end, sent = 0;
+
+		for (end = i + 1; end < n && queue[end].observer_id == queue[i].observer_id; end++)
+			;
+
+		if (sd == NULL || !sd->fd || sd->bl.prev == NULL) {
+			for (; i < end; i++) {
+				if (clif_view_unqueue(sd, queue[i].observer_id, queue[i].unit_id))
+					clif->view_stats.dropped++;
+			}
+			continue;
+		}
+
+		for (; i < end; i++) {
+			struct block_list *bl;
+
+			if (!ui64db_iget(clif->view_pending, clif_view_key(queue[i].observer_id, queue[i].unit_id)))
+				continue; // already sent by clif->view_send_pending, or cancelled
+
+			bl = map->id2bl(queue[i].unit_id);
+			if (bl == NULL || bl->prev == NULL || bl->m != sd->bl.m
+			 || abs(bl->x - sd->bl.x) > AREA_SIZE || abs(bl->y - sd->bl.y) > AREA_SIZE) {
+				clif_view_unqueue(sd, queue[i].observer_id, queue[i].unit_id);
+				clif->view_stats.dropped++;
+				continue;
+			}
+			if (sent == CLIF_VIEW_ENTER_MAX) {
+				clif->view_stats.deferred++;
+				queue[kept++] = queue[i]; // kept <= i, and queue[i] is not needed anymore
+				continue;
+			}
+			clif_view_unqueue(sd, queue[i].observer_id, queue[i].unit_id);
+			clif->getareachar_unit(sd, bl);
+			clif->view_stats.sent++;
+			sent++;
+		}
+	}
+	clif->view_flushing = false;
+
+	VECTOR_LENGTH(clif->view_queue) = kept; // keep the allocation for the next flush
+	clif->view_seq = 0;
+	for (i = 0; i < kept; i++)
+		queue[i].seq = clif->view_seq++;
+}
+
+/// Registered with sockt->set_presend, see clif->view_flush
+static void clif_view_presend(void)
+{
+	clif->view_flush();
+}
+
 /// Updates whole skill tree (ZC_SKILLINFO_LIST).
 /// 010f <packet len>.W { <skill id>.W <type>.L <level>.W <sp cost>.W <attack range>.W <skill name>.24B <upgradable>.B }*
 void clif_skillinfoblock(struct map_session_data *sd)
@@ -18534,18 +18813,165 @@ unsigned short clif_parse_cmd_optional( int fd, struct map_session_data *sd ) {
 	return cmd;
 }
 
+/**
+ * Adds the tokens earned since the last refill.
+ *
+ * @param bucket Bucket to refill.
+ * @param rate   Packets per second.
+ * @param burst  Bucket size in packets.
+ * @param tick   Current tick.
+ * @retval true if the bucket holds at least one packet.
+ **/
+bool clif_throttle_refill(struct clif_packet_bucket *bucket, int rate, int burst, int64 tick)
+{
+	int64 cap = (int64)burst * 1000;
+
+	nullpo_retr(false, bucket);
+
+	if( bucket->tick == 0 )
+		bucket->tokens = cap;
+	else
+		bucket->tokens += DIFF_TICK(tick, bucket->tick) * rate;
+	if( bucket->tokens > cap )
+		bucket->tokens = cap;
+	bucket->tick = tick;
+
+	return bucket->tokens >= 1000;
+}
+
+/**
+ * Checks the packet_rate / packet_burst budget of a session before its next packet is decoded.
+ *
+ * @retval false when the session must wait, its data stays buffered.
+ **/
+bool clif_throttle_session(int fd, struct map_session_data *sd)
+{
+	nullpo_retr(true, sd);
+
+	if( battle_config.packet_rate <= 0 )
+		return true;
+
+	if( clif->throttle_refill(&sd->throttle.session, battle_config.packet_rate, battle_config.packet_burst, timer->gettick()) )
+		return true;
+
+	sd->throttle.delayed++;
+	clif->throttle_stats.delayed++;
+	return false;
+}
+
+/**
+ * Checks a packet against its db/packet_throttle.conf limit.
+ *
+ * @retval false when the packet must not be dispatched (the session may have been disconnected).
+ **/
+bool clif_throttle_packet(int fd, struct map_session_data *sd, int cmd)
+{
+	struct clif_throttle_entry *entry;
+
+	nullpo_retr(true, sd);
+
+	if( packet_db[cmd].throttle == 0 )
+		return true;
+
+	entry = &clif->throttle_db[packet_db[cmd].throttle - 1];
+	if( clif->throttle_refill(&sd->throttle.type[packet_db[cmd].throttle - 1], entry->rate, entry->burst, timer->gettick()) ) {
+		sd->throttle.type[packet_db[cmd].throttle - 1].tokens -= 1000;
+		return true;
+	}
+
+	entry->dropped++;
+	sd->throttle.dropped++;
+	clif->throttle_stats.dropped++;
+
+	if( entry->action == CLIF_THROTTLE_KICK ) {
+		ShowWarning("clif_throttle_packet: Packet 0x%04x from session #%d (AID: %d) is over its rate limit, disconnecting.\n", cmd, fd, sd->status.account_id);
+		clif->throttle_stats.kicked++;
+		sockt->eof(fd);
+	}
+
+	return false;
+}
+
+/**
+ * Reads the per packet rate limits (db/packet_throttle.conf).
+ **/
+void clif_throttle_read_db(void)
+{
+	config_t throttle_conf;
+	config_setting_t *list = NULL, *entry = NULL;
+	const char *config_filename = "db/packet_throttle.conf"; // FIXME hardcoded name
+	int i = 0, cmd;
+
+	for( cmd = 0; cmd <= MAX_PACKET_DB; cmd++ )
+		packet_db[cmd].throttle = 0;
+	clif->throttle_count = 0;
+
+	if (libconfig->read_file(&throttle_conf, config_filename)) {
+		ShowError("can't read %s\n", config_filename);
+		return;
+	}
+
+	if( (list = libconfig->lookup(&throttle_conf, "packet_throttle")) != NULL ) {
+		while( (entry = libconfig->setting_get_elem(list, i++)) != NULL ) {
+			struct clif_throttle_entry *te;
+			const char *action = "drop";
+			int rate = 0, burst = 0;
+
+			cmd = 0;
+			if( !libconfig->setting_lookup_int(entry, "Id", &cmd) || cmd < MIN_PACKET_DB || cmd > MAX_PACKET_DB || packet_db[cmd].len == 0 ) {
+				ShowWarning("packet_throttle: unknown packet id 0x%04x in entry %d, skipping...\n", cmd, i);
+				continue;
+			}
+			if( packet_db[cmd].throttle != 0 ) {
+				ShowWarning("packet_throttle: duplicate entry for packet 0x%04x, skipping...\n", cmd);
+				continue;
+			}
+			if( !libconfig->setting_lookup_int(entry, "Rate", &rate) || rate <= 0 ) {
+				ShowWarning("packet_throttle: invalid rate for packet 0x%04x, skipping...\n", cmd);
+				continue;
+			}
+			if( !libconfig->setting_lookup_int(entry, "Burst", &burst) || burst < 1 )
+				burst = rate;
+			libconfig->setting_lookup_string(entry, "Action", &action);
+
+			if( clif->throttle_count == CLIF_THROTTLE_MAX ) {
+				ShowWarning("packet_throttle: only %d entries are supported, ignoring the rest...\n", CLIF_THROTTLE_MAX);
+				break;
+			}
+
+			te = &clif->throttle_db[clif->throttle_count];
+			te->cmd = (uint16)cmd;
+			te->rate = rate;
+			te->burst = burst;
+			te->dropped = 0;
+			if( strcmpi(action, "kick") == 0 ) {
+				te->action = CLIF_THROTTLE_KICK;
+			} else {
+				if( strcmpi(action, "drop") != 0 )
+					ShowWarning("packet_throttle: unknown action '%s' for packet 0x%04x, defaulting to 'drop'.\n", action, cmd);
+				te->action = CLIF_THROTTLE_DROP;
+			}
+			packet_db[cmd].throttle = (uint8)++clif->throttle_count;
+		}
+	}
+
+	libconfig->destroy(&throttle_conf);
+	ShowStatus("Done reading '"CL_WHITE"%d"CL_RESET"' entries in '"CL_WHITE"%s"CL_RESET"'.\n", clif->throttle_count, config_filename);
+}
+
 /*==========================================
  * Main client packet processing function
  *------------------------------------------*/
 int clif_parse(int fd) {
 	int cmd, packet_len;
 	TBL_PC* sd;
-	int pnum;
+	int pnum, pmax;
 
-	//TODO apply delays or disconnect based on packet throughput [FlavioJS]
 	// Note: "click masters" can do 80+ clicks in 10 seconds
+	// With packet_rate set, throughput is governed by clif->throttle_session and a session may use its whole burst in one cycle
+	pmax = battle_config.packet_rate > 0 ? battle_config.packet_burst : 3;
 
-	for( pnum = 0; pnum < 3; ++pnum ) { // Limit max packets per cycle to 3 (delay packet spammers) [FlavioJS]  -- This actually aids packet spammers, but stuff like /str+ gets slow without it [Ai4rei]
+	for( pnum = 0; pnum < pmax; ++pnum ) { // Limit max packets per cycle to 3 (delay packet spammers) [FlavioJS]  -- This actually aids packet spammers, but stuff like /str+ gets slow without it [Ai4rei]
 		unsigned short (*parse_cmd_func)(int fd, struct map_session_data *sd);
 		// begin main client packet processing loop
 
@@ -18578,6 +19004,9 @@ int clif_parse(int fd) {
 		if (RFIFOREST(fd) < 2)
 			return 0;
 
+		if( sd && !clif->throttle_session(fd, sd) )
+			return 0; // out of tokens, the rest stays buffered until the bucket refills
+
 		if( HPM->packetsc[hpClif_Parse] ) {
 			int r;
 			if( (r = HPM->parse_packets(fd,hpClif_Parse)) ) {
@@ -18632,6 +19061,17 @@ int clif_parse(int fd) {
 			}
 		}
 
+		clif->throttle_stats.packets++;
+		if( sd ) {
+			sd->throttle.packets++;
+			if( battle_config.packet_rate > 0 )
+				sd->throttle.session.tokens -= 1000;
+			if( packet_db[cmd].throttle && !clif->throttle_packet(fd, sd, cmd) ) {
+				RFIFOSKIP(fd, packet_len); // over its own rate, never dispatched
+				continue;
+			}
+		}
+
 		if( packet_db[cmd].func == clif->pDebug )
 			packet_db[cmd].func(fd, sd);
 		else if( packet_db[cmd].func != NULL ) {
@@ -18752,10 +19192,13 @@ void clif_bc_ready(void) {
  *------------------------------------------*/
 int do_init_clif(bool minimal)
 {
+	clif->view_pending = ui64db_alloc(DB_OPT_BASE);
+
 	if (minimal)
 		return 0;
 
 	packetdb_loaddb();
+	clif->throttle_read_db();
 
 	sockt->set_defaultparse(clif->parse);
 	if (sockt->make_listen_bind(clif->bind_ip,clif->map_port) == -1) {
@@ -18766,6 +19209,8 @@ int do_init_clif(bool minimal)
 	timer->add_func_list(clif->clearunit_delayed_sub, "clif_clearunit_delayed_sub");
 	timer->add_func_list(clif->delayquit, "clif_delayquit");
 
+	sockt->set_presend(clif_view_presend);
+
 	clif->delay_clearunit_ers = ers_new(sizeof(struct block_list),"clif.c::delay_clearunit_ers",ERS_OPT_CLEAR);
 	clif->delayed_damage_ers = ers_new(sizeof(struct cdelayed_damage),"clif.c::delayed_damage_ers",ERS_OPT_CLEAR);
 
@@ -18776,6 +19221,10 @@ void do_final_clif(void)
 {
 	unsigned char i;
 
+	sockt->set_presend(NULL);
+	VECTOR_CLEAR(clif->view_queue);
+	db_destroy(clif->view_pending);
+
 	ers_destroy(clif->delay_clearunit_ers);
 	ers_destroy(clif->delayed_damage_ers);
 
@@ -18802,6 +19251,16 @@ void clif_defaults(void) {
 	clif->map_port = 5121;
 	clif->ally_only = false;
 	clif->delayed_damage_ers = NULL;
+	memset(clif->throttle_db, 0, sizeof(clif->throttle_db));
+	clif->throttle_count = 0;
+	memset(&clif->throttle_stats, 0, sizeof(clif->throttle_stats));
+	VECTOR_INIT(clif->view_queue);
+	clif->view_seq = 0;
+	clif->view_pending = NULL;
+	memset(&clif->view_stats, 0, sizeof(clif->view_stats));
+	clif->view_pass = 0;
+	clif->view_flushing = false;
+	memset(clif->unit_packet_cache, 0, sizeof(clif->unit_packet_cache));
 	/* core */
 	clif->init = do_init_clif;
 	clif->final = do_final_clif;
@@ -18815,6 +19274,10 @@ void clif_defaults(void) {
 	clif->parse = clif_parse;
 	clif->parse_cmd = clif_parse_cmd_optional;
 	clif->decrypt_cmd = clif_decrypt_cmd;
+	clif->throttle_read_db = clif_throttle_read_db;
+	clif->throttle_refill = clif_throttle_refill;
+	clif->throttle_session = clif_throttle_session;
+	clif->throttle_packet = clif_throttle_packet;
 	/* auth */
 	clif->authok = clif_authok;
 	clif->authrefuse = clif_authrefuse;
@@ -18868,6 +19331,8 @@ void clif_defaults(void) {
 	clif->spawn_unit2 = clif_spawn_unit2;
 	clif->set_unit_idle2 = clif_set_unit_idle2;
 	clif->set_unit_walking = clif_set_unit_walking;
+	clif->set_unit_idle_packet = clif_set_unit_idle_packet;
+	clif->set_unit_walking_packet = clif_set_unit_walking_packet;
 	clif->calc_walkdelay = clif_calc_walkdelay;
 	clif->getareachar_skillunit = clif_getareachar_skillunit;
 	clif->getareachar_unit = clif_getareachar_unit;
@@ -18921,6 +19386,10 @@ void clif_defaults(void) {
 	clif->update_rankingpoint = clif_update_rankingpoint;
 	clif->hotkeys = clif_hotkeys_send;
 	clif->insight = clif_insight;
+	clif->view_queue_add = clif_view_queue_add;
+	clif->view_flush = clif_view_flush;
+	clif->view_send_pending = clif_view_send_pending;
+	clif->view_cancel = clif_view_cancel;
 	clif->outsight = clif_outsight;
 	clif->skillcastcancel = clif_skillcastcancel;
 	clif->skill_fail = clif_skill_fail;
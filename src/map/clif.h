@@ -45,6 +45,9 @@ struct view_data;
 #define P2PTR(fd) RFIFO2PTR(fd)
 #define clif_menuskill_clear(sd) ((sd)->menuskill_id = (sd)->menuskill_val = (sd)->menuskill_val2 = 0)
 #define clif_disp_onlyself(sd,mes,len) clif->disp_message( &(sd)->bl, (mes), (len), SELF )
+#define CLIF_THROTTLE_MAX 16 ///< Packet types that can have their own rate limit (db/packet_throttle.conf)
+#define CLIF_VIEW_ENTER_MAX 48 ///< Units sent to a client as entering its view per flush, the rest waits for the next one
+#define CLIF_UNIT_PACKET_CACHE 256 ///< Appearance packets kept during a viewport flush (power of 2)
 #define MAX_ROULETTE_LEVEL 7 /** client-defined value **/
 #define MAX_ROULETTE_COLUMNS 9 /** client-defined value **/
 #define RGB2BGR(c) ((c & 0x0000FF) << 16 | (c & 0x00FF00) | (c & 0xFF0000) >> 16)
@@ -540,6 +543,7 @@ struct s_packet_db {
 	short len;
 	pFunc func;
 	short pos[MAX_PACKET_POS];
+	uint8 throttle; ///< 1-based index in clif->throttle_db, 0 when not limited
 };
 
 struct hCSData {
@@ -557,6 +561,92 @@ struct merge_item {
     int16 nameid;
 };
 
+/**
+ * What happens to a packet over its db/packet_throttle.conf rate.
+ **/
+enum clif_throttle_action {
+	CLIF_THROTTLE_DROP, ///< Discard it without dispatching
+	CLIF_THROTTLE_KICK, ///< Disconnect the session
+};
+
+/**
+ * Token bucket, in thousandths of a packet.
+ **/
+struct clif_packet_bucket {
+	int64 tokens;
+	int64 tick; ///< Last refill
+};
+
+/**
+ * Rate limit of a packet type (db/packet_throttle.conf).
+ **/
+struct clif_throttle_entry {
+	uint16 cmd;
+	int rate;   ///< Packets per second
+	int burst;  ///< Bucket size in packets
+	enum clif_throttle_action action;
+	uint64 dropped; ///< Packets over the limit so far
+};
+
+/**
+ * Per session packet rate accounting.
+ **/
+struct clif_session_throttle {
+	struct clif_packet_bucket session;                   ///< All packets (packet_rate / packet_burst)
+	struct clif_packet_bucket type[CLIF_THROTTLE_MAX];   ///< By clif->throttle_db entry
+	unsigned int packets;                                ///< Packets dispatched
+	unsigned int delayed;                                ///< Parse passes cut short by the session bucket
+	unsigned int dropped;                                ///< Packets over a per type limit
+};
+
+/**
+ * Packet rate limit counters of the whole server.
+ **/
+struct clif_throttle_stats {
+	uint64 packets;
+	uint64 delayed;
+	uint64 dropped;
+	unsigned int kicked;
+};
+
+/**
+ * A unit that came into a client's view and has yet to be sent to it (see clif->view_queue_add).
+ **/
+struct clif_view_enter {
+	int observer_id;   ///< Id of the observing player
+	int unit_id;       ///< Id of the unit that came into view
+	unsigned int seq;  ///< Queue order, older entries are sent first
+};
+
+/**
+ * Viewport sync counters, see the 'stats:viewport' console command.
+ **/
+struct clif_view_stats {
+	uint64 flushes;  ///< Flush passes that had work
+	uint64 queued;   ///< Units queued as entering a view
+	uint64 sent;     ///< Units sent to a client
+	uint64 merged;   ///< Repeated entries of a unit into the same view before a flush
+	uint64 dropped;  ///< Units no longer in view (or gone) when flushed
+	uint64 deferred; ///< Units held back to a later flush by CLIF_VIEW_ENTER_MAX
+	uint64 early;    ///< Units sent ahead of a flush because a packet about them went to the client
+	uint64 packet_builds; ///< Appearance packets built during a flush
+	uint64 packet_hits;   ///< Appearance packets reused from clif->unit_packet_cache
+};
+
+/**
+ * Appearance packet of a unit built during a viewport flush, reused for the
+ * other clients the unit is sent to in the same flush.
+ **/
+struct clif_unit_packet {
+	int unit_id;       ///< 0 if unused
+	unsigned int pass; ///< clif->view_pass the packet was built in
+	bool walk;         ///< u.walk rather than u.idle
+	union {
+		struct packet_idle_unit idle;
+		struct packet_unit_walking walk;
+	} u;
+};
+
 /**
  * Clif.c Interface
  **/
@@ -586,6 +676,18 @@ struct clif_interface {
 	bool ally_only;
 	/* */
 	struct eri *delayed_damage_ers;
+	/* packet rate limits */
+	struct clif_throttle_entry throttle_db[CLIF_THROTTLE_MAX];
+	int throttle_count;
+	struct clif_throttle_stats throttle_stats;
+	/* viewport sync */
+	VECTOR_DECL(struct clif_view_enter) view_queue; ///< Units that came into a client's view since the last clif->view_flush
+	struct DBMap *view_pending; ///< (observer id << 32 | unit id) -> 1 while the unit is queued and not sent yet
+	unsigned int view_seq;
+	struct clif_view_stats view_stats;
+	unsigned int view_pass; ///< Number of the current/last viewport flush
+	bool view_flushing;     ///< A viewport flush is in progress
+	struct clif_unit_packet unit_packet_cache[CLIF_UNIT_PACKET_CACHE]; ///< By unit id, see clif_unit_packet_entry
 	/* core */
 	int (*init) (bool minimal);
 	void (*final) (void);
@@ -599,6 +701,10 @@ struct clif_interface {
 	int (*parse) (int fd);
 	unsigned short (*parse_cmd) ( int fd, struct map_session_data *sd );
 	unsigned short (*decrypt_cmd) ( int cmd, struct map_session_data *sd );
+	void (*throttle_read_db) (void);
+	bool (*throttle_refill) (struct clif_packet_bucket *bucket, int rate, int burst, int64 tick);
+	bool (*throttle_session) (int fd, struct map_session_data *sd);
+	bool (*throttle_packet) (int fd, struct map_session_data *sd, int cmd);
 	/* auth */
 	void (*authok) (struct map_session_data *sd);
 	void (*authrefuse) (int fd, uint8 error_code);
@@ -652,6 +758,8 @@ struct clif_interface {
 	void (*spawn_unit2) (struct block_list* bl, enum send_target target);
 	void (*set_unit_idle2) (struct block_list* bl, struct map_session_data *tsd, enum send_target target);
 	void (*set_unit_walking) (struct block_list* bl, struct map_session_data *tsd,struct unit_data* ud, enum send_target target);
+	void (*set_unit_idle_packet) (struct block_list *bl, struct packet_idle_unit *p);
+	void (*set_unit_walking_packet) (struct block_list *bl, struct unit_data *ud, struct packet_unit_walking *p);
 	int (*calc_walkdelay) (struct block_list *bl,int delay, int type, int damage, int div_);
 	void (*getareachar_skillunit) (struct block_list *bl, struct skill_unit *su, enum send_target target);
 	void (*getareachar_unit) (struct map_session_data* sd,struct block_list *bl);
@@ -705,6 +813,10 @@ struct clif_interface {
 	void (*pRanklist) (int fd, struct map_session_data *sd);
 	void (*hotkeys) (struct map_session_data *sd);
 	int (*insight) (struct block_list *bl,va_list ap);
+	void (*view_queue_add) (struct map_session_data *sd, struct block_list *bl);
+	void (*view_flush) (void);
+	void (*view_send_pending) (struct map_session_data *sd, struct block_list *bl);
+	bool (*view_cancel) (struct map_session_data *sd, struct block_list *bl);
 	int (*outsight) (struct block_list *bl,va_list ap);
 	void (*skillcastcancel) (struct block_list* bl);
 	void (*skill_fail) (struct map_session_data *sd,uint16 skill_id,enum useskill_fail_cause cause,int btype);
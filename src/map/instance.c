@@ -227,6 +227,7 @@ int instance_add_map(const char *name, int instance_id, bool usebasename, const
 
 	memset(map->list[im].npc, 0x00, sizeof(map->list[i].npc));
 	map->list[im].npc_num = 0;
+	memset(&map->list[im].npc_touch, 0x00, sizeof(map->list[im].npc_touch));
 
 	memset(map->list[im].moblist, 0x00, sizeof(map->list[im].moblist));
 	map->list[im].mob_delete_timer = INVALID_TIMER;
@@ -444,6 +445,10 @@ void instance_del_map(int16 m) {
 	aFree(map->list[m].cell);
 	aFree(map->list[m].block);
 	aFree(map->list[m].block_mob);
+	if (map->list[m].npc_touch.start)
+		aFree(map->list[m].npc_touch.start);
+	if (map->list[m].npc_touch.list)
+		aFree(map->list[m].npc_touch.list);
 
 	if (map->list[m].unit_count && map->list[m].units) {
 		for(i = 0; i < map->list[m].unit_count; i++) {
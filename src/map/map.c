@@ -91,6 +91,16 @@ static inline void map_bl_list_expand(void) {
 	RECREATE(map->bl_list, struct block_list *, map->bl_list_size);
 }
 
+/**
+ * Expands the map->regen_* arrays on demand
+ **/
+static inline void map_regen_expand(void) {
+	map->regen_size += 250;
+	RECREATE(map->regen_bl, struct block_list *, map->regen_size);
+	RECREATE(map->regen_data, struct regen_data *, map->regen_size);
+	RECREATE(map->regen_status, struct status_data *, map->regen_size);
+}
+
 /**
  * Expands map->block_free on demand
  **/
@@ -242,6 +252,15 @@ int map_addblock(struct block_list* bl)
 	map->update_cell_bl(bl, true);
 #endif
 
+	if (bl->type == BL_PC) {
+		// (re)appearing on a map, refresh the mini-map dot
+		TBL_PC *sd = (TBL_PC*)bl;
+		if (sd->bg_id)
+			bg->send_xy_queue(sd);
+		if (sd->status.party_id)
+			party->send_xy_queue(sd);
+	}
+
 	return 0;
 }
 
@@ -334,6 +353,15 @@ int map_moveblock(struct block_list *bl, int x1, int y1, int64 tick) {
 
 		skill->unit_move(bl,tick,3);
 
+		if (bl->type == BL_PC) {
+			// mini-map dots are only refreshed for moving members
+			TBL_PC *sd = (TBL_PC*)bl;
+			if (sd->bg_id)
+				bg->send_xy_queue(sd);
+			if (sd->status.party_id)
+				party->send_xy_queue(sd);
+		}
+
 		if( bl->type == BL_PC && ((TBL_PC*)bl)->shadowform_id ) {//Shadow Form Target Moving
 			struct block_list *d_bl;
 			if( (d_bl = map->id2bl(((TBL_PC*)bl)->shadowform_id)) == NULL || !check_distance_bl(bl,d_bl,10) ) {
@@ -1738,7 +1766,7 @@ void map_addiddb(struct block_list *bl)
 	}
 
 	if( bl->type & BL_REGEN )
-		idb_put(map->regen_db, bl->id, bl);
+		map->addregen(bl);
 
 	idb_put(map->id_db,bl->id,bl);
 }
@@ -1763,11 +1791,126 @@ void map_deliddb(struct block_list *bl)
 	}
 
 	if( bl->type & BL_REGEN )
-		idb_remove(map->regen_db,bl->id);
+		map->delregen(bl);
 
 	idb_remove(map->id_db,bl->id);
 }
 
+/**
+ * Appends bl to the dense natural regen store.
+ * Its regen and status data are embedded in the unit, so they're looked up
+ * once here rather than by status_natural_heal_timer on every tick.
+ *
+ * @param bl The entity to add (must be of a BL_REGEN type).
+ */
+void map_addregen(struct block_list *bl)
+{
+	struct regen_data *regen;
+	int i;
+
+	nullpo_retv(bl);
+	regen = status->get_regen_data(bl);
+	Assert_retv(regen != NULL);
+
+	if( (i = idb_iget(map->regen_db, bl->id)) > 0 ) { // already stored, refresh the entry
+		i--;
+	} else {
+		if( map->regen_count >= map->regen_size )
+			map_regen_expand();
+		i = map->regen_count++;
+		idb_iput(map->regen_db, bl->id, i + 1);
+	}
+
+	map->regen_bl[i] = bl;
+	map->regen_data[i] = regen;
+	map->regen_status[i] = status->get_status_data(bl);
+}
+
+/**
+ * Removes bl from the dense natural regen store.
+ * The last entry is moved into the freed slot, so the order of the store
+ * is not preserved. While a pass over the store is running (see
+ * map->regen_pass_begin) the slot is only cleared instead, and the store
+ * is compacted when the pass ends.
+ *
+ * @param bl The entity to remove.
+ */
+void map_delregen(struct block_list *bl)
+{
+	int i, last;
+
+	nullpo_retv(bl);
+
+	if( (i = idb_iget(map->regen_db, bl->id)) <= 0 )
+		return;
+	i--;
+	idb_remove(map->regen_db, bl->id);
+
+	if( map->regen_passes > 0 ) {
+		map->regen_bl[i] = NULL;
+		map->regen_data[i] = NULL;
+		map->regen_status[i] = NULL;
+		map->regen_holes = true;
+		return;
+	}
+
+	last = --map->regen_count;
+	if( i != last ) {
+		map->regen_bl[i] = map->regen_bl[last];
+		map->regen_data[i] = map->regen_data[last];
+		map->regen_status[i] = map->regen_status[last];
+		idb_iput(map->regen_db, map->regen_bl[i]->id, i + 1);
+	}
+}
+
+/**
+ * Starts a pass over the dense natural regen store.
+ * Until the matching map->regen_pass_end, entries keep their index and
+ * removed entries leave a NULL slot behind. Entries added in the meantime
+ * are appended after regen_count.
+ */
+void map_regen_pass_begin(void)
+{
+	map->regen_passes++;
+}
+
+/**
+ * Ends a pass over the dense natural regen store, compacting it once the
+ * outermost pass is done.
+ */
+void map_regen_pass_end(void)
+{
+	Assert_retv(map->regen_passes > 0);
+	if( --map->regen_passes == 0 )
+		map->regen_compact();
+}
+
+/**
+ * Drops the NULL slots left by map_delregen, keeping the order of the
+ * remaining entries.
+ */
+void map_regen_compact(void)
+{
+	int i, j;
+
+	if( !map->regen_holes )
+		return;
+
+	for( i = j = 0; i < map->regen_count; i++ ) {
+		if( map->regen_bl[i] == NULL )
+			continue;
+		if( i != j ) {
+			map->regen_bl[j] = map->regen_bl[i];
+			map->regen_data[j] = map->regen_data[i];
+			map->regen_status[j] = map->regen_status[i];
+			idb_iput(map->regen_db, map->regen_bl[j]->id, j + 1);
+		}
+		j++;
+	}
+	map->regen_count = j;
+	map->regen_holes = false;
+}
+
 /*==========================================
  * Standard call when a player connection is closed.
  *------------------------------------------*/
@@ -1874,6 +2017,7 @@ int map_quit(struct map_session_data *sd) {
 	}
 
 	if( sd->state.vending ) {
+		searchstore->index_remove(sd, SEARCHTYPE_VENDING);
 		idb_remove(vending->db, sd->status.char_id);
 	}
 
@@ -2140,21 +2284,24 @@ void map_foreachnpc(int (*func)(struct npc_data* nd, va_list args), ...) {
 /// Applies func to everything in the db.
 /// Stops iterating gif func returns -1.
 void map_vforeachregen(int (*func)(struct block_list* bl, va_list args), va_list args) {
-	DBIterator* iter;
-	struct block_list* bl;
+	int i, count = map->regen_count;
 
-	iter = db_iterator(map->regen_db);
-	for( bl = (struct block_list*)dbi_first(iter); dbi_exists(iter); bl = (struct block_list*)dbi_next(iter) ) {
+	// func() may add or remove entries, see map_regen_pass_begin
+	map->regen_pass_begin();
+	for( i = 0; i < count; i++ ) {
 		va_list argscopy;
 		int ret;
 
+		if( map->regen_bl[i] == NULL )
+			continue;
+
 		va_copy(argscopy, args);
-		ret = func(bl, argscopy);
+		ret = func(map->regen_bl[i], argscopy);
 		va_end(argscopy);
 		if( ret == -1 )
 			break;// stop iterating
 	}
-	dbi_destroy(iter);
+	map->regen_pass_end();
 }
 
 /// Applies func to everything in the db.
@@ -2348,6 +2495,7 @@ bool map_addnpc(int16 m,struct npc_data *nd) {
 
 	map->list[m].npc[map->list[m].npc_num]=nd;
 	map->list[m].npc_num++;
+	map->list[m].npc_touch.dirty = true;
 	idb_put(map->id_db,nd->bl.id,nd);
 	return true;
 }
@@ -3132,6 +3280,8 @@ void map_clean(int i) {
 	if(map->list[i].cell && map->list[i].cell != (struct mapcell *)0xdeadbeaf) aFree(map->list[i].cell);
 	if(map->list[i].block) aFree(map->list[i].block);
 	if(map->list[i].block_mob) aFree(map->list[i].block_mob);
+	if(map->list[i].npc_touch.start) aFree(map->list[i].npc_touch.start);
+	if(map->list[i].npc_touch.list) aFree(map->list[i].npc_touch.list);
 
 	if(battle_config.dynamic_mobs) { //Dynamic mobs flag by [random]
 		int j;
@@ -3185,6 +3335,8 @@ void do_final_maps(void) {
 		if(map->list[i].cell && map->list[i].cell != (struct mapcell *)0xdeadbeaf ) aFree(map->list[i].cell);
 		if(map->list[i].block) aFree(map->list[i].block);
 		if(map->list[i].block_mob) aFree(map->list[i].block_mob);
+		if(map->list[i].npc_touch.start) aFree(map->list[i].npc_touch.start);
+		if(map->list[i].npc_touch.list) aFree(map->list[i].npc_touch.list);
 
 		if(battle_config.dynamic_mobs) { //Dynamic mobs flag by [random]
 			int j;
@@ -3547,6 +3699,8 @@ int map_config_read(char *cfgName) {
 			map->char_ip_set = chrif->setip(w2);
 		else if (strcmpi(w1, "char_port") == 0)
 			chrif->setport(atoi(w2));
+		else if (strcmpi(w1, "char_local_transport") == 0)
+			chrif->local_transport = config_switch(w2) ? true : false;
 		else if (strcmpi(w1, "map_ip") == 0)
 			map->ip_set = clif->setip(w2);
 		else if (strcmpi(w1, "bind_ip") == 0)
@@ -3590,6 +3744,10 @@ int map_config_read(char *cfgName) {
 			showmsg->console_log = atoi(w2);//[Ind]
 		else if (strcmpi(w1, "default_language") == 0)
 			safestrncpy(map->default_lang_str, w2, sizeof(map->default_lang_str));
+		else if (strcmpi(w1, "npc_preload_threads") == 0)
+			npc->preload_threads = cap_value(atoi(w2), 0, NPC_PRELOAD_THREADS_MAX);
+		else if (strcmpi(w1, "npc_load_report") == 0)
+			npc->load_report = atoi(w2);
 		else if (strcmpi(w1, "import") == 0)
 			map->config_read(w2);
 		else
@@ -5443,6 +5601,7 @@ int do_final(void) {
 	elemental->final();
 	map->list_final();
 	vending->final();
+	searchstore->final();
 
 	HPM_map_do_final();
 
@@ -5471,6 +5630,11 @@ int do_final(void) {
 		aFree(map->block_free);
 	if( map->bl_list )
 		aFree(map->bl_list);
+	if( map->regen_bl ) {
+		aFree(map->regen_bl);
+		aFree(map->regen_data);
+		aFree(map->regen_status);
+	}
 
 	if( !map->enable_grf )
 		aFree(map->cache_buffer);
@@ -5582,6 +5746,27 @@ CPCMD(gm_use) {
 
 	map->cpsd_active = false;
 }
+CPCMD(stats_xy) {
+	ShowInfo("party xy: %u parties queued, %u updates sent, last pass %"PRId64" us (max %"PRId64" us)\n",
+	         party->xy_stats.queued, party->xy_stats.sent, party->xy_stats.duration, party->xy_stats.max_duration);
+	ShowInfo("bg xy: %u teams queued, %u updates sent, last pass %"PRId64" us (max %"PRId64" us)\n",
+	         bg->xy_stats.queued, bg->xy_stats.sent, bg->xy_stats.duration, bg->xy_stats.max_duration);
+}
+CPCMD(stats_viewport) {
+	const struct clif_view_stats *st = &clif->view_stats;
+
+	ShowInfo("viewport sync: %"PRIu64" flushes, %"PRIu64" units queued, %"PRIu64" sent, %"PRIu64" sent early, %"PRIu64" merged, %"PRIu64" dropped, %"PRIu64" deferred\n",
+	         st->flushes, st->queued, st->sent, st->early, st->merged, st->dropped, st->deferred);
+	ShowInfo("viewport packets: %"PRIu64" built, %"PRIu64" reused (%u%% reused)\n",
+	         st->packet_builds, st->packet_hits,
+	         (st->packet_builds + st->packet_hits) ? (unsigned int)(st->packet_hits * 100 / (st->packet_builds + st->packet_hits)) : 0);
+}
+CPCMD(stats_statuscalc) {
+	unsigned int total = status->pc_calc_full + status->pc_calc_partial;
+
+	ShowInfo("player status calc: %u full, %u partial (%u%% partial)\n",
+	         status->pc_calc_full, status->pc_calc_partial, total ? (unsigned int)((uint64)status->pc_calc_partial * 100 / total) : 0);
+}
 /* Hercules Console Parser */
 void map_cp_defaults(void) {
 #ifdef CONSOLE_INPUT
@@ -5594,6 +5779,9 @@ void map_cp_defaults(void) {
 
 	console->input->addCommand("gm:info",CPCMD_A(gm_position));
 	console->input->addCommand("gm:use",CPCMD_A(gm_use));
+	console->input->addCommand("stats:xy",CPCMD_A(stats_xy));
+	console->input->addCommand("stats:statuscalc",CPCMD_A(stats_statuscalc));
+	console->input->addCommand("stats:viewport",CPCMD_A(stats_viewport));
 #endif
 }
 
@@ -5953,6 +6141,7 @@ int do_init(int argc, char *argv[])
 	bg->init(minimal);
 	duel->init(minimal);
 	vending->init(minimal);
+	searchstore->init(minimal);
 
 	if (map->scriptcheck) {
 		bool failed = map->extra_scripts_count > 0 ? false : true;
@@ -6085,6 +6274,13 @@ void map_defaults(void) {
 	map->bl_list = NULL;
 	map->bl_list_count = 0;
 	map->bl_list_size = 0;
+	map->regen_bl = NULL;
+	map->regen_data = NULL;
+	map->regen_status = NULL;
+	map->regen_count = 0;
+	map->regen_size = 0;
+	map->regen_passes = 0;
+	map->regen_holes = false;
 
 	//all in a big chunk, respects order
 	memset(ZEROED_BLOCK_POS(map), 0, ZEROED_BLOCK_SIZE(map));
@@ -6192,6 +6388,11 @@ void map_defaults(void) {
 	map->eraseallipport = map_eraseallipport;
 	map->addiddb = map_addiddb;
 	map->deliddb = map_deliddb;
+	map->addregen = map_addregen;
+	map->delregen = map_delregen;
+	map->regen_pass_begin = map_regen_pass_begin;
+	map->regen_pass_end = map_regen_pass_end;
+	map->regen_compact = map_regen_compact;
 	/* */
 	map->nick2sd = map_nick2sd;
 	map->getmob_boss = map_getmob_boss;
@@ -19,6 +19,8 @@
 struct mob_data;
 struct npc_data;
 struct channel_data;
+struct regen_data;
+struct status_data;
 
 enum E_MAPSERVER_ST {
 	MAPSERVER_ST_RUNNING = CORE_ST_LAST,
@@ -680,6 +682,12 @@ struct map_data {
 	} flag;
 	struct point save;
 	struct npc_data *npc[MAX_NPC_PER_MAP];
+	/* OnTouch/warp area index, rebuilt on demand (see npc_touch_index_build) */
+	struct {
+		int *start;           ///< Offset in list of the entries of each block (bxs*bys+1 entries)
+		unsigned short *list; ///< Indexes in npc[] of the NPCs whose area overlaps each block, ascending
+		bool dirty;           ///< npc[] or an area changed since the last build
+	} npc_touch;
 	struct map_drop_list *drop_list;
 	unsigned short drop_list_count;
 
@@ -803,6 +811,14 @@ struct charid2nick {
 	struct charid_request* requests;// requests of notification on this nick
 };
 
+/// Statistics of the mini-map position broadcasts (party and battleground dots)
+struct xy_broadcast_stats {
+	unsigned int queued;  ///< Parties/teams flushed on the last pass
+	unsigned int sent;    ///< Position/hp updates sent on the last pass
+	int64 duration;       ///< Duration of the last pass, in microseconds
+	int64 max_duration;   ///< Slowest pass since startup, in microseconds
+};
+
 // This is the main header found at the very beginning of the map cache
 struct map_cache_main_header {
 	uint32 file_size;
@@ -900,13 +916,20 @@ struct map_interface {
 	DBMap* map_db;    // unsigned int mapindex -> struct map_data_other_server*
 	DBMap* nick_db;   // int char_id -> struct charid2nick* (requested names of offline characters)
 	DBMap* charid_db; // int char_id -> struct map_session_data*
-	DBMap* regen_db;  // int id -> struct block_list* (status_natural_heal processing)
+	DBMap* regen_db;  // int id -> index+1 in map->regen_bl (status_natural_heal processing)
 	DBMap* zone_db;   // string => struct map_zone_data
 	DBMap* iwall_db;
 	struct block_list **block_free;
 	int block_free_count, block_free_lock, block_free_list_size;
 	struct block_list **bl_list;
 	int bl_list_count, bl_list_size;
+	/* dense natural regen store, removals during a pass are deferred (see map_delregen) */
+	struct block_list **regen_bl;      ///< Entities with natural regen, NULL for an entry removed during a pass
+	struct regen_data **regen_data;    ///< Regen data of regen_bl[i]
+	struct status_data **regen_status; ///< Battle status of regen_bl[i]
+	int regen_count, regen_size;
+	int regen_passes;                  ///< Passes over the store in progress
+	bool regen_holes;                  ///< Entries were removed during a pass and await compaction
 BEGIN_ZEROED_BLOCK; // This block is zeroed in map_defaults()
 	struct block_list bl_head;
 	struct map_zone_data zone_all;/* used as a base on all maps */
@@ -1018,6 +1041,11 @@ END_ZEROED_BLOCK;
 	int (*eraseallipport) (void);
 	void (*addiddb) (struct block_list *bl);
 	void (*deliddb) (struct block_list *bl);
+	void (*addregen) (struct block_list *bl);
+	void (*delregen) (struct block_list *bl);
+	void (*regen_pass_begin) (void);
+	void (*regen_pass_end) (void);
+	void (*regen_compact) (void);
 	/* */
 	struct map_session_data * (*nick2sd) (const char *nick);
 	struct mob_data * (*getmob_boss) (int16 m);
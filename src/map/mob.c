@@ -185,6 +185,7 @@ void mvptomb_destroy(struct mob_data *md) {
 			map->list[m].npc_num--;
 			map->list[m].npc[i] = map->list[m].npc[map->list[m].npc_num];
 			map->list[m].npc[map->list[m].npc_num] = NULL;
+			map->list[m].npc_touch.dirty = true;
 		}
 
 		map->deliddb(&nd->bl);
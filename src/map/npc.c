@@ -24,14 +24,17 @@
 #include "map/status.h"
 #include "map/unit.h"
 #include "common/HPM.h"
+#include "common/atomic.h"
 #include "common/cbasetypes.h"
 #include "common/db.h"
 #include "common/ers.h"
 #include "common/malloc.h"
+#include "common/mutex.h"
 #include "common/nullpo.h"
 #include "common/showmsg.h"
 #include "common/socket.h"
 #include "common/strlib.h"
+#include "common/thread.h"
 #include "common/timer.h"
 #include "common/utils.h"
 
@@ -40,6 +43,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <time.h>
 
 struct npc_interface npc_s;
@@ -856,6 +860,134 @@ int npc_event(struct map_session_data* sd, const char* eventname, int ontouch)
 	return npc->event_sub(sd,ev,eventname);
 }
 
+/**
+ * Gets the OnTouch/warp area of an NPC.
+ *
+ * @param nd The NPC.
+ * @param[out] xs Horizontal half-size of the area.
+ * @param[out] ys Vertical half-size of the area.
+ * @retval true if the NPC has a touch area.
+ */
+static bool npc_touch_area(const struct npc_data *nd, int *xs, int *ys)
+{
+	switch (nd->subtype) {
+		case WARP:
+			*xs = nd->u.warp.xs;
+			*ys = nd->u.warp.ys;
+			break;
+		case SCRIPT:
+			*xs = nd->u.scr.xs;
+			*ys = nd->u.scr.ys;
+			break;
+		default:
+			return false;
+	}
+	return (*xs >= 0 && *ys >= 0);
+}
+
+/**
+ * Rebuilds the OnTouch/warp area index of a map.
+ *
+ * Each block of BLOCK_SIZE x BLOCK_SIZE cells gets the list of NPCs whose
+ * area overlaps it, so that a step only has to check those instead of
+ * every NPC on the map. The lists keep the order of map->list[m].npc[],
+ * which decides which NPC wins when areas overlap.
+ * Hidden NPCs stay in the index, callers check OPTION_INVISIBLE.
+ *
+ * @param m The map.
+ */
+void npc_touch_index_build(int16 m)
+{
+	struct map_data *md;
+	int i, b, total, nblocks;
+
+	Assert_retv(m >= 0 && m < map->count);
+	md = &map->list[m];
+	nblocks = md->bxs * md->bys;
+
+	if (md->npc_touch.start == NULL)
+		CREATE(md->npc_touch.start, int, nblocks + 1);
+	else
+		memset(md->npc_touch.start, 0, (nblocks + 1) * sizeof(int));
+
+	// Count the entries of each block, then turn the counts into end offsets.
+	for (i = 0; i < md->npc_num; i++) {
+		int xs, ys, bx, by, bx0, bx1, by0, by1;
+		const struct npc_data *nd = md->npc[i];
+
+		if (!npc_touch_area(nd, &xs, &ys))
+			continue;
+		bx0 = max(nd->bl.x - xs, 0);
+		bx1 = min(nd->bl.x + xs, md->xs - 1);
+		by0 = max(nd->bl.y - ys, 0);
+		by1 = min(nd->bl.y + ys, md->ys - 1);
+		if (bx0 > bx1 || by0 > by1)
+			continue;
+		for (by = by0 / BLOCK_SIZE; by <= by1 / BLOCK_SIZE; by++)
+			for (bx = bx0 / BLOCK_SIZE; bx <= bx1 / BLOCK_SIZE; bx++)
+				md->npc_touch.start[bx + by * md->bxs]++;
+	}
+	for (total = 0, b = 0; b < nblocks; b++) {
+		total += md->npc_touch.start[b];
+		md->npc_touch.start[b] = total;
+	}
+	md->npc_touch.start[nblocks] = total;
+
+	RECREATE(md->npc_touch.list, unsigned short, max(total, 1));
+
+	// Fill backwards, which leaves start[b] at the first entry of each block
+	// and the entries of a block in ascending order.
+	for (i = md->npc_num - 1; i >= 0; i--) {
+		int xs, ys, bx, by, bx0, bx1, by0, by1;
+		const struct npc_data *nd = md->npc[i];
+
+		if (!npc_touch_area(nd, &xs, &ys))
+			continue;
+		bx0 = max(nd->bl.x - xs, 0);
+		bx1 = min(nd->bl.x + xs, md->xs - 1);
+		by0 = max(nd->bl.y - ys, 0);
+		by1 = min(nd->bl.y + ys, md->ys - 1);
+		if (bx0 > bx1 || by0 > by1)
+			continue;
+		for (by = by0 / BLOCK_SIZE; by <= by1 / BLOCK_SIZE; by++)
+			for (bx = bx0 / BLOCK_SIZE; bx <= bx1 / BLOCK_SIZE; bx++)
+				md->npc_touch.list[--md->npc_touch.start[bx + by * md->bxs]] = (unsigned short)i;
+	}
+
+	md->npc_touch.dirty = false;
+}
+
+/**
+ * Gets the NPCs whose OnTouch/warp area may cover a block of a map,
+ * rebuilding the map's index first if it's out of date.
+ *
+ * @param m The map.
+ * @param bx Block x coordinate.
+ * @param by Block y coordinate.
+ * @param[out] list Indexes in map->list[m].npc[], ascending.
+ * @return The number of entries in list.
+ */
+int npc_touch_index_get(int16 m, int16 bx, int16 by, const unsigned short **list)
+{
+	struct map_data *md;
+	int b;
+
+	nullpo_ret(list);
+	*list = NULL;
+	if (m < 0 || m >= map->count)
+		return 0;
+	md = &map->list[m];
+	if (bx < 0 || bx >= md->bxs || by < 0 || by >= md->bys)
+		return 0;
+
+	if (md->npc_touch.dirty || md->npc_touch.start == NULL)
+		npc->touch_index_build(m);
+
+	b = bx + by * md->bxs;
+	*list = &md->npc_touch.list[md->npc_touch.start[b]];
+	return md->npc_touch.start[b + 1] - md->npc_touch.start[b];
+}
+
 /*==========================================
  * Sub chk then execute area event type
  *------------------------------------------*/
@@ -917,8 +1049,9 @@ int npc_touch_areanpc(struct map_session_data* sd, int16 m, int16 x, int16 y)
 {
 	int xs,ys;
 	int f = 1;
-	int i;
+	int i, k, count;
 	int j, found_warp = 0;
+	const unsigned short *list;
 
 	nullpo_retr(1, sd);
 
@@ -927,7 +1060,9 @@ int npc_touch_areanpc(struct map_session_data* sd, int16 m, int16 x, int16 y)
 		return 1;
 #endif // 0
 
-	for(i=0;i<map->list[m].npc_num;i++) {
+	count = npc->touch_index_get(m, x/BLOCK_SIZE, y/BLOCK_SIZE, &list);
+	for (k = 0, i = 0; k < count; k++) {
+		i = list[k];
 		if (map->list[m].npc[i]->option&OPTION_INVISIBLE) {
 			f=0; // a npc was found, but it is disabled; don't print warning
 			continue;
@@ -949,7 +1084,7 @@ int npc_touch_areanpc(struct map_session_data* sd, int16 m, int16 x, int16 y)
 		&&  y >= map->list[m].npc[i]->bl.y-ys && y <= map->list[m].npc[i]->bl.y+ys )
 			break;
 	}
-	if( i == map->list[m].npc_num ) {
+	if( k == count ) {
 		if( f == 1 ) // no npc found
 			ShowError("npc_touch_areanpc : stray NPC cell/NPC not found in the block on coordinates '%s',%d,%d\n", map->list[m].name, x, y);
 		return 1;
@@ -961,7 +1096,8 @@ int npc_touch_areanpc(struct map_session_data* sd, int16 m, int16 x, int16 y)
 			pc->setpos(sd,map->list[m].npc[i]->u.warp.mapindex,map->list[m].npc[i]->u.warp.x,map->list[m].npc[i]->u.warp.y,CLR_OUTSIGHT);
 			break;
 		case SCRIPT:
-			for (j = i; j < map->list[m].npc_num; j++) {
+			for (; k < count; k++) {
+				j = list[k];
 				if (map->list[m].npc[j]->subtype != WARP) {
 					continue;
 				}
@@ -1026,12 +1162,15 @@ int npc_untouch_areanpc(struct map_session_data* sd, int16 m, int16 x, int16 y)
 // Return 1 if Warped
 int npc_touch_areanpc2(struct mob_data *md)
 {
-	int i, m = md->bl.m, x = md->bl.x, y = md->bl.y, id;
+	int i, k, count, m = md->bl.m, x = md->bl.x, y = md->bl.y, id;
 	char eventname[EVENT_NAME_LENGTH];
 	struct event_data* ev;
 	int xs, ys;
+	const unsigned short *list;
 
-	for( i = 0; i < map->list[m].npc_num; i++ ) {
+	count = npc->touch_index_get(m, x/BLOCK_SIZE, y/BLOCK_SIZE, &list);
+	for( k = 0; k < count; k++ ) {
+		i = list[k];
 		if( map->list[m].npc[i]->option&OPTION_INVISIBLE )
 			continue;
 
@@ -1085,9 +1224,10 @@ int npc_touch_areanpc2(struct mob_data *md)
 //&1: NPC Warps
 //&2: NPCs with on-touch events.
 int npc_check_areanpc(int flag, int16 m, int16 x, int16 y, int16 range) {
-	int i;
+	int i, k, count, found = -1;
 	int x0,y0,x1,y1;
-	int xs,ys;
+	int xs,ys,bx,by;
+	const unsigned short *list;
 
 	if (range < 0) return 0;
 	x0 = max(x-range, 0);
@@ -1105,36 +1245,46 @@ int npc_check_areanpc(int flag, int16 m, int16 x, int16 y, int16 range) {
 	}
 	if (!i) return 0; //No NPC_CELLs.
 
-	//Now check for the actual NPC on said range.
-	for(i=0;i<map->list[m].npc_num;i++) {
-		if (map->list[m].npc[i]->option&OPTION_INVISIBLE)
-			continue;
-
-		switch(map->list[m].npc[i]->subtype) {
-			case WARP:
-				if (!(flag&1))
-					continue;
-				xs=map->list[m].npc[i]->u.warp.xs;
-				ys=map->list[m].npc[i]->u.warp.ys;
-				break;
-			case SCRIPT:
-				if (!(flag&2))
+	//Now check for the actual NPC on said range, the first one in npc[] wins.
+	for (by = y0/BLOCK_SIZE; by <= y1/BLOCK_SIZE; by++) {
+		for (bx = x0/BLOCK_SIZE; bx <= x1/BLOCK_SIZE; bx++) {
+			count = npc->touch_index_get(m, bx, by, &list);
+			for (k = 0; k < count; k++) {
+				i = list[k];
+				if (found != -1 && i >= found)
+					break; // the rest of this block comes later in npc[]
+				if (map->list[m].npc[i]->option&OPTION_INVISIBLE)
 					continue;
-				xs=map->list[m].npc[i]->u.scr.xs;
-				ys=map->list[m].npc[i]->u.scr.ys;
-				break;
-			default:
-				continue;
-		}
 
-		if( x1 >= map->list[m].npc[i]->bl.x-xs && x0 <= map->list[m].npc[i]->bl.x+xs
-		&&  y1 >= map->list[m].npc[i]->bl.y-ys && y0 <= map->list[m].npc[i]->bl.y+ys )
-			break; // found a npc
+				switch(map->list[m].npc[i]->subtype) {
+					case WARP:
+						if (!(flag&1))
+							continue;
+						xs=map->list[m].npc[i]->u.warp.xs;
+						ys=map->list[m].npc[i]->u.warp.ys;
+						break;
+					case SCRIPT:
+						if (!(flag&2))
+							continue;
+						xs=map->list[m].npc[i]->u.scr.xs;
+						ys=map->list[m].npc[i]->u.scr.ys;
+						break;
+					default:
+						continue;
+				}
+
+				if( x1 >= map->list[m].npc[i]->bl.x-xs && x0 <= map->list[m].npc[i]->bl.x+xs
+				&&  y1 >= map->list[m].npc[i]->bl.y-ys && y0 <= map->list[m].npc[i]->bl.y+ys ) {
+					found = i; // found a npc
+					break;
+				}
+			}
+		}
 	}
-	if (i==map->list[m].npc_num)
+	if (found == -1)
 		return 0;
 
-	return (map->list[m].npc[i]->bl.id);
+	return (map->list[m].npc[found]->bl.id);
 }
 
 /*==========================================
@@ -2174,6 +2324,7 @@ int npc_remove_map(struct npc_data* nd) {
 	map->list[m].npc_num--;
 	map->list[m].npc[i] = map->list[m].npc[map->list[m].npc_num];
 	map->list[m].npc[map->list[m].npc_num] = NULL;
+	map->list[m].npc_touch.dirty = true;
 	return 0;
 }
 
@@ -3277,6 +3428,9 @@ void npc_setcells(struct npc_data* nd) {
 			return; // Other types doesn't have touch area
 	}
 
+	if (m >= 0)
+		map->list[m].npc_touch.dirty = true;
+
 	if (m < 0 || xs < 0 || ys < 0 || map->list[m].cell == (struct mapcell *)0xdeadbeaf) //invalid range or map
 		return;
 
@@ -3314,6 +3468,9 @@ void npc_unsetcells(struct npc_data* nd) {
 			return; // Other types doesn't have touch area
 	}
 
+	if (m >= 0)
+		map->list[m].npc_touch.dirty = true;
+
 	if (m < 0 || xs < 0 || ys < 0 || map->list[m].cell == (struct mapcell *)0xdeadbeaf)
 		return;
 
@@ -4106,13 +4263,9 @@ const char* npc_parse_unknown_object(char *w1, char *w2, char *w3, char *w4, con
  * @retval EXIT_FAILURE if there were errors/warnings when loading filepath.
  */
 int npc_parsesrcfile(const char* filepath, bool runOnInit) {
-	int success = EXIT_SUCCESS;
-	int16 m, x, y;
-	int lines = 0;
 	FILE* fp;
 	size_t len;
 	char* buffer;
-	const char* p;
 
 	// read whole file to buffer
 	fp = fopen(filepath, "rb");
@@ -4134,6 +4287,25 @@ int npc_parsesrcfile(const char* filepath, bool runOnInit) {
 	}
 	fclose(fp);
 
+	return npc->parsesrcbuffer(filepath, buffer, len, runOnInit);
+}
+
+/**
+ * Parses the contents of a script file (see npc_parsesrcfile).
+ *
+ * @param filepath  File name and path, for error reporting.
+ * @param buffer    NUL terminated file contents (aMalloc'd, freed by this function).
+ * @param len       Length of buffer, excluding the terminator.
+ * @param runOnInit Whether the OnInit label should be called.
+ * @retval EXIT_SUCCESS if the buffer was loaded correctly.
+ * @retval EXIT_FAILURE if there were errors/warnings when loading the buffer.
+ */
+int npc_parsesrcbuffer(const char* filepath, char* buffer, size_t len, bool runOnInit) {
+	int success = EXIT_SUCCESS;
+	int16 m, x, y;
+	int lines = 0;
+	const char* p;
+
 	if ((unsigned char)buffer[0] == 0xEF && (unsigned char)buffer[1] == 0xBB && (unsigned char)buffer[2] == 0xBF) {
 		// UTF-8 BOM. This is most likely an error on the user's part, because:
 		// - BOM is discouraged in UTF-8, and the only place where you see it is Notepad and such.
@@ -4387,19 +4559,166 @@ int npc_ev_label_db_clear_sub(DBKey key, DBData *data, va_list args)
 	return 0;
 }
 
+/**
+ * Worker thread of the npc source preloader.
+ * Reads the files queued in npc_preload into the buffers allocated by the
+ * main thread; it neither allocates memory nor prints anything, since
+ * neither the memory manager nor showmsg are thread-safe.
+ */
+static void *npc_preload_worker(void *param) {
+	struct npc_preload_queue *queue = param;
+	int32 i;
+
+	while( (i = InterlockedIncrement(&queue->next) - 1) < queue->count ) {
+		struct npc_src_preload *entry = &queue->files[i];
+		int64 start = timer->microtick();
+		FILE *fp;
+
+		if( entry->buffer != NULL && (fp = fopen(entry->name, "rb")) != NULL ) {
+			// one extra byte, to tell a file that grew since stat from one that didn't
+			size_t len = fread(entry->buffer, sizeof(char), entry->len + 1, fp);
+			if( !ferror(fp) )
+				entry->state = len == entry->len ? NPC_PRELOAD_READ : NPC_PRELOAD_SHORT;
+			entry->buffer[entry->len] = '\0';
+			fclose(fp);
+		}
+		entry->read_time = timer->microtick() - start;
+
+		ramutex_lock(queue->mutex);
+		entry->done = 1;
+		racond_broadcast(queue->cond);
+		ramutex_unlock(queue->mutex);
+	}
+
+	return NULL;
+}
+
+/**
+ * Loads the npc source files, in order, registering their NPCs on the main thread.
+ * When npc->preload_threads is set, worker threads read the files ahead of the parser;
+ * any file they could not read is loaded through npc->parsesrcfile as usual, so
+ * error reporting is unchanged.
+ *
+ * Only the reads are done ahead. Parsing and script compilation, nearly all of
+ * the load time, still run serially on the main thread: the script compiler
+ * keeps its state (str_data, str_buf, the bytecode buffer, label lists) in the
+ * global script interface, so it can't run on the workers.
+ * TODO: per-thread compiler state, to compile files on the workers.
+ **/
+void npc_load_srcfiles(void) {
+	struct npc_src_list *file;
+	struct npc_preload_queue queue;
+	rAthread *workers[NPC_PRELOAD_THREADS_MAX];
+	int i, nworkers = 0;
+	int64 load_start = timer->microtick();
+
+	memset(&queue, 0, sizeof(queue));
+	for( file = npc->src_files; file != NULL; file = file->next )
+		queue.count++;
+	if( queue.count == 0 )
+		return;
+
+	CREATE(queue.files, struct npc_src_preload, queue.count);
+	for( i = 0, file = npc->src_files; file != NULL; file = file->next, i++ ) {
+		struct stat st;
+		queue.files[i].name = file->name;
+		if( npc->preload_threads > 0 && stat(file->name, &st) == 0 ) {
+			queue.files[i].len = (size_t)st.st_size;
+			queue.files[i].buffer = (char *)aMalloc(queue.files[i].len + 2); // +1 to detect growth, +1 for the terminator
+		}
+	}
+	queue.mutex = ramutex_create();
+	queue.cond = racond_create();
+
+	for( i = 0; i < min(npc->preload_threads, NPC_PRELOAD_THREADS_MAX); i++ ) {
+		if( (workers[nworkers] = rathread_create(npc_preload_worker, &queue)) == NULL )
+			break;
+		nworkers++;
+	}
+	if( nworkers == 0 )
+		queue.next = queue.count; // read everything on the main thread
+
+	for( i = 0; i < queue.count; i++ ) {
+		struct npc_src_preload *entry = &queue.files[i];
+		int npc_start = npc_id;
+		int64 start;
+		int result;
+
+		ShowStatus("Loading NPC file: %s"CL_CLL"\r", entry->name);
+		if( nworkers > 0 ) {
+			ramutex_lock(queue.mutex);
+			while( !entry->done )
+				racond_wait(queue.cond, queue.mutex, -1);
+			ramutex_unlock(queue.mutex);
+		}
+
+		start = timer->microtick();
+		if( entry->state == NPC_PRELOAD_READ ) {
+			result = npc->parsesrcbuffer(entry->name, entry->buffer, entry->len, false);
+		} else {
+			if( entry->state == NPC_PRELOAD_SHORT )
+				ShowError("npc_load_srcfiles: '%s' changed size while being read (%"PRIuS" bytes expected), reading it again.\n", entry->name, entry->len);
+			if( entry->buffer != NULL )
+				aFree(entry->buffer);
+			result = npc->parsesrcfile(entry->name, false);
+		}
+		entry->buffer = NULL;
+		entry->parse_time = timer->microtick() - start;
+		entry->npcs = npc_id - npc_start;
+		if( result != EXIT_SUCCESS )
+			map->retval = EXIT_FAILURE;
+	}
+
+	for( i = 0; i < nworkers; i++ )
+		rathread_wait(workers[i], NULL);
+	racond_destroy(queue.cond);
+	ramutex_destroy(queue.mutex);
+
+	if( npc->load_report > 0 )
+		npc->load_report_show(queue.files, queue.count, timer->microtick() - load_start);
+
+	aFree(queue.files);
+}
+
+/**
+ * Compares two npc_src_preload entries by parse time, slowest first (qsort).
+ */
+static int npc_load_report_cmp(const void *a, const void *b) {
+	const struct npc_src_preload *fa = a, *fb = b;
+	if( fa->parse_time != fb->parse_time )
+		return fa->parse_time < fb->parse_time ? 1 : -1;
+	return 0;
+}
+
+/**
+ * Prints the boot-time profile of the npc source files: the npc->load_report
+ * slowest files to parse, and the totals.
+ */
+void npc_load_report_show(struct npc_src_preload *files, int count, int64 elapsed) {
+	int64 read_total = 0, parse_total = 0;
+	int i;
+
+	for( i = 0; i < count; i++ ) {
+		read_total += files[i].read_time;
+		parse_total += files[i].parse_time;
+	}
+	qsort(files, count, sizeof(struct npc_src_preload), npc_load_report_cmp);
+
+	ShowInfo("NPC load report: '"CL_WHITE"%d"CL_RESET"' files in "CL_WHITE"%"PRId64""CL_RESET" ms (preloading %"PRId64" ms, parsing %"PRId64" ms)\n",
+	         count, elapsed/1000, read_total/1000, parse_total/1000);
+	for( i = 0; i < count && i < npc->load_report; i++ ) {
+		ShowInfo("  %8"PRId64" us parse, %6"PRId64" us read, %4d NPCs: %s\n",
+		         files[i].parse_time, files[i].read_time, files[i].npcs, files[i].name);
+	}
+}
+
 /**
  * Main npc file processing
  * @param npc_min Minimum npc id - used to know how many NPCs were loaded
  **/
 void npc_process_files( int npc_min ) {
-	struct npc_src_list *file; // Current file
-
 	ShowStatus("Loading NPCs...\r");
-	for( file = npc->src_files; file != NULL; file = file->next ) {
-		ShowStatus("Loading NPC file: %s"CL_CLL"\r", file->name);
-		if (npc->parsesrcfile(file->name, false) != EXIT_SUCCESS)
-			map->retval = EXIT_FAILURE;
-	}
+	npc->load_srcfiles();
 	ShowInfo ("Done loading '"CL_WHITE"%d"CL_RESET"' NPCs:"CL_CLL"\n"
 		"\t-'"CL_WHITE"%d"CL_RESET"' Warps\n"
 		"\t-'"CL_WHITE"%d"CL_RESET"' Shops\n"
@@ -4679,6 +4998,8 @@ void npc_defaults(void) {
 	npc->timer_event_ers = NULL;
 	npc->fake_nd = NULL;
 	npc->src_files = NULL;
+	npc->preload_threads = 0;
+	npc->load_report = 0;
 	/* */
 	npc->trader_ok = false;
 	npc->trader_funds[0] = npc->trader_funds[1] = 0;
@@ -4716,6 +5037,8 @@ void npc_defaults(void) {
 	npc->event = npc_event;
 	npc->touch_areanpc_sub = npc_touch_areanpc_sub;
 	npc->touchnext_areanpc = npc_touchnext_areanpc;
+	npc->touch_index_build = npc_touch_index_build;
+	npc->touch_index_get = npc_touch_index_get;
 	npc->touch_areanpc = npc_touch_areanpc;
 	npc->untouch_areanpc = npc_untouch_areanpc;
 	npc->touch_areanpc2 = npc_touch_areanpc2;
@@ -4766,6 +5089,9 @@ void npc_defaults(void) {
 	npc->parse_mapflag = npc_parse_mapflag;
 	npc->parse_unknown_mapflag = npc_parse_unknown_mapflag;
 	npc->parsesrcfile = npc_parsesrcfile;
+	npc->parsesrcbuffer = npc_parsesrcbuffer;
+	npc->load_srcfiles = npc_load_srcfiles;
+	npc->load_report_show = npc_load_report_show;
 	npc->parse_unknown_object = npc_parse_unknown_object;
 	npc->script_event = npc_script_event;
 	npc->read_event_script = npc_read_event_script;
@@ -10,6 +10,7 @@
 #include "map/unit.h" // struct unit_data
 #include "common/hercules.h"
 #include "common/db.h"
+#include "common/mutex.h"
 
 struct HPluginData;
 struct view_data;
@@ -143,6 +144,35 @@ struct npc_src_list {
 	char name[4]; // dynamic array, the structure is allocated with extra bytes (string length)
 };
 
+#define NPC_PRELOAD_THREADS_MAX 16
+
+enum npc_preload_state {
+	NPC_PRELOAD_PENDING = 0, ///< Not read (yet), or the read failed
+	NPC_PRELOAD_READ,        ///< buffer holds the file contents
+	NPC_PRELOAD_SHORT,       ///< The file changed size between stat and read
+};
+
+/// A npc source file read ahead of the parser by a preload thread, and its load profile
+struct npc_src_preload {
+	const char *name;            ///< File name (owned by npc->src_files)
+	char *buffer;                ///< File contents (allocated by the main thread)
+	size_t len;                  ///< Size of buffer, excluding the terminator
+	enum npc_preload_state state;
+	int done;                    ///< Set by the worker once it's finished with this entry (under the queue mutex)
+	int64 read_time;             ///< Microseconds spent reading the file (worker thread)
+	int64 parse_time;            ///< Microseconds spent parsing the file (main thread)
+	int npcs;                    ///< Number of NPC ids taken by the file
+};
+
+/// Work queue shared by the preload threads
+struct npc_preload_queue {
+	struct npc_src_preload *files;
+	int32 count;
+	volatile int32 next;         ///< Next entry to be read
+	ramutex *mutex;              ///< Protects the done flags
+	racond *cond;                ///< Signaled whenever an entry is done
+};
+
 struct event_data {
 	struct npc_data *nd;
 	int pos;
@@ -164,6 +194,8 @@ struct npc_interface {
 	struct eri *timer_event_ers; //For the npc timer data. [Skotlex]
 	struct npc_data *fake_nd;
 	struct npc_src_list *src_files;
+	int preload_threads; ///< Number of threads reading npc files ahead of the parser (map-server.conf npc_preload_threads)
+	int load_report;     ///< Number of slowest files listed after loading npc files (map-server.conf npc_load_report)
 	struct unit_data base_ud;
 	/* npc trader global data, for ease of transition between the script, cleared on every usage */
 	bool trader_ok;
@@ -202,6 +234,8 @@ struct npc_interface {
 	int (*event) (struct map_session_data *sd, const char *eventname, int ontouch);
 	int (*touch_areanpc_sub) (struct block_list *bl, va_list ap);
 	int (*touchnext_areanpc) (struct map_session_data *sd, bool leavemap);
+	void (*touch_index_build) (int16 m);
+	int (*touch_index_get) (int16 m, int16 bx, int16 by, const unsigned short **list);
 	int (*touch_areanpc) (struct map_session_data *sd, int16 m, int16 x, int16 y);
 	int (*untouch_areanpc) (struct map_session_data *sd, int16 m, int16 x, int16 y);
 	int (*touch_areanpc2) (struct mob_data *md);
@@ -253,6 +287,9 @@ struct npc_interface {
 	const char* (*parse_mapflag) (char *w1, char *w2, char *w3, char *w4, const char *start, const char *buffer, const char *filepath, int *retval);
 	void (*parse_unknown_mapflag) (const char *name, char *w3, char *w4, const char *start, const char *buffer, const char *filepath, int *retval);
 	int (*parsesrcfile) (const char *filepath, bool runOnInit);
+	int (*parsesrcbuffer) (const char *filepath, char *buffer, size_t len, bool runOnInit);
+	void (*load_srcfiles) (void);
+	void (*load_report_show) (struct npc_src_preload *files, int count, int64 elapsed);
 	int (*script_event) (struct map_session_data *sd, enum npce_event type);
 	void (*read_event_script) (void);
 	int (*path_db_clear_sub) (DBKey key, DBData *data, va_list args);
@@ -861,15 +861,44 @@ int party_skill_check(struct map_session_data *sd, int party_id, uint16 skill_id
 	return 0;
 }
 
+/**
+ * Queues the party of sd for the next position/hp broadcast.
+ * Called whenever sd moves or (with party_hp_mode) its hp changes, so that
+ * party->send_xy_timer only visits parties that actually have something to send.
+ */
+void party_send_xy_queue(struct map_session_data *sd) {
+	struct party_data *p;
+
+	nullpo_retv(sd);
+
+	if( !sd->status.party_id || (p = party->search(sd->status.party_id)) == NULL || p->state.xy_queued )
+		return;
+
+	p->state.xy_queued = 1;
+	VECTOR_ENSURE(party->xy_queue, 1, 32);
+	VECTOR_PUSH(party->xy_queue, p->party.party_id);
+}
+
 int party_send_xy_timer(int tid, int64 tick, int id, intptr_t data) {
-	struct party_data* p;
+	int64 start = timer->microtick();
+	unsigned int sent = 0;
+	int n;
 
-	DBIterator *iter = db_iterator(party->db);
-	// for each existing party,
-	for( p = dbi_first(iter); dbi_exists(iter); p = dbi_next(iter) )
+	party->xy_stats.queued = (unsigned int)VECTOR_LENGTH(party->xy_queue);
+
+	// for each party queued since the last pass,
+	for( n = 0; n < VECTOR_LENGTH(party->xy_queue); n++ )
 	{
+		struct party_data* p = party->search(VECTOR_INDEX(party->xy_queue, n));
 		int i;
 
+		if( p == NULL )
+		{// disbanded in the meantime
+			continue;
+		}
+
+		p->state.xy_queued = 0;
+
 		if( !p->party.count )
 		{// no online party members so do not iterate
 			continue;
@@ -886,15 +915,22 @@ int party_send_xy_timer(int tid, int64 tick, int id, intptr_t data) {
 				clif->party_xy(sd);
 				p->data[i].x = sd->bl.x;
 				p->data[i].y = sd->bl.y;
+				sent++;
 			}
 			if (battle_config.party_hp_mode && p->data[i].hp != sd->battle_status.hp)
 			{// perform hp update
 				clif->party_hp(sd);
 				p->data[i].hp = sd->battle_status.hp;
+				sent++;
 			}
 		}
 	}
-	dbi_destroy(iter);
+	VECTOR_LENGTH(party->xy_queue) = 0; // keep the allocation for the next pass
+
+	party->xy_stats.sent = sent;
+	party->xy_stats.duration = timer->microtick() - start;
+	if( party->xy_stats.duration > party->xy_stats.max_duration )
+		party->xy_stats.max_duration = party->xy_stats.duration;
 
 	return 0;
 }
@@ -910,6 +946,7 @@ int party_send_xy_clear(struct party_data *p)
 		p->data[i].hp = 0;
 		p->data[i].x = 0;
 		p->data[i].y = 0;
+		party->send_xy_queue(p->data[i].sd);
 	}
 	return 0;
 }
@@ -1347,6 +1384,7 @@ bool party_booking_delete(struct map_session_data *sd)
 void do_final_party(void) {
 	party->db->destroy(party->db,party->db_final);
 	db_destroy(party->booking_db); // Party Booking [Spiria]
+	VECTOR_CLEAR(party->xy_queue);
 }
 // Constructor, init vars
 void do_init_party(bool minimal) {
@@ -1355,6 +1393,7 @@ void do_init_party(bool minimal) {
 
 	party->db = idb_alloc(DB_OPT_RELEASE_DATA);
 	party->booking_db = idb_alloc(DB_OPT_RELEASE_DATA); // Party Booking [Spiria]
+	VECTOR_INIT(party->xy_queue);
 	timer->add_func_list(party->send_xy_timer, "party_send_xy_timer");
 	timer->add_interval(timer->gettick()+battle_config.party_update_interval, party->send_xy_timer, 0, 0, battle_config.party_update_interval);
 }
@@ -1370,6 +1409,8 @@ void party_defaults(void) {
 	party->db = NULL;
 	party->booking_db = NULL;
 	party->booking_nextid = 1;
+	VECTOR_INIT(party->xy_queue);
+	memset(&party->xy_stats, 0, sizeof(party->xy_stats));
 	/* funcs */
 	party->init = do_init_party;
 	party->final = do_final_party;
@@ -1418,6 +1459,7 @@ void party_defaults(void) {
 	party->vforeachsamemap = party_vforeachsamemap;
 	party->foreachsamemap = party_foreachsamemap;
 	party->send_xy_timer = party_send_xy_timer;
+	party->send_xy_queue = party_send_xy_queue;
 	party->fill_member = party_fill_member;
 	party->sd_check = party_sd_check;
 	party->check_state = party_check_state;
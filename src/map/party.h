@@ -34,6 +34,7 @@ struct party_data {
 		unsigned sg : 1;     ///< There's at least one Star Gladiator in party?
 		unsigned snovice :1; ///< There's a Super Novice
 		unsigned tk : 1;     ///< There's a taekwon
+		unsigned xy_queued : 1; ///< Queued in party->xy_queue for the next position broadcast
 	} state;
 
 	/* HPM Custom Struct */
@@ -79,6 +80,8 @@ struct party_interface {
 	DBMap* db; // int party_id -> struct party_data* (releases data)
 	DBMap* booking_db; // int char_id -> struct party_booking_ad_info* (releases data) // Party Booking [Spiria]
 	unsigned int booking_nextid;
+	VECTOR_DECL(int) xy_queue; ///< Ids of parties with members that moved since the last party->send_xy_timer
+	struct xy_broadcast_stats xy_stats;
 	/* funcs */
 	void (*init) (bool minimal);
 	void (*final) (void);
@@ -132,6 +135,7 @@ struct party_interface {
 	int (*vforeachsamemap) (int (*func)(struct block_list *,va_list),struct map_session_data *sd,int range, va_list ap);
 	int (*foreachsamemap) (int (*func)(struct block_list *,va_list),struct map_session_data *sd,int range,...);
 	int (*send_xy_timer) (int tid, int64 tick, int id, intptr_t data);
+	void (*send_xy_queue) (struct map_session_data *sd);
 	void (*fill_member) (struct party_member* member, struct map_session_data* sd, unsigned int leader);
 	TBL_PC* (*sd_check) (int party_id, int account_id, int char_id);
 	void (*check_state) (struct party_data *p);
@@ -696,9 +696,152 @@ int pc_setinventorydata(struct map_session_data *sd)
 		int id = sd->status.inventory[i].nameid;
 		sd->inventory_data[i] = id?itemdb->search(id):NULL;
 	}
+	pc->itemindex_build(&sd->inventory_index, sd->status.inventory, MAX_INVENTORY);
+	pc->itemindex_build(&sd->cart_index, sd->status.cart, MAX_CART);
 	return 0;
 }
 
+/// Home position of nameid in item_index::head
+#define pc_itemindex_hash(nameid) ( ((unsigned int)(nameid) ^ ((unsigned int)(nameid) >> 8)) & (ITEM_INDEX_SIZE - 1) )
+
+/**
+ * Finds the head[] entry of nameid.
+ *
+ * @param idx    The index.
+ * @param nameid The item id (must not be 0).
+ * @return The position in head[] of nameid, or of the free entry where it'd be inserted.
+ */
+static int pc_itemindex_find(const struct item_index *idx, int nameid)
+{
+	int i = pc_itemindex_hash(nameid);
+
+	while (idx->head[i].nameid != 0 && idx->head[i].nameid != nameid)
+		i = (i + 1) & (ITEM_INDEX_SIZE - 1);
+	return i;
+}
+
+/**
+ * Rebuilds the nameid -> slot index of an item list.
+ *
+ * @param idx   The index.
+ * @param items The item list.
+ * @param max   Number of slots in items (at most ITEM_INDEX_SLOTS).
+ */
+void pc_itemindex_build(struct item_index *idx, const struct item *items, int max)
+{
+	int i;
+
+	nullpo_retv(idx);
+	nullpo_retv(items);
+	Assert_retv(max <= ITEM_INDEX_SLOTS);
+
+	memset(idx->head, 0, sizeof(idx->head));
+	// Backwards, so that every slot becomes the new head of its chain.
+	for (i = max - 1; i >= 0; i--) {
+		int h;
+
+		if (items[i].nameid == 0)
+			continue;
+		h = pc_itemindex_find(idx, items[i].nameid);
+		idx->next[i] = idx->head[h].nameid ? idx->head[h].slot : INDEX_NOT_FOUND;
+		idx->head[h].nameid = items[i].nameid;
+		idx->head[h].slot = i;
+	}
+}
+
+/**
+ * Records that a slot now holds nameid.
+ *
+ * @param idx    The index.
+ * @param nameid The item id.
+ * @param slot   The slot.
+ */
+void pc_itemindex_add(struct item_index *idx, int nameid, int slot)
+{
+	int h, p;
+
+	nullpo_retv(idx);
+	Assert_retv(nameid != 0 && slot >= 0 && slot < ITEM_INDEX_SLOTS);
+
+	h = pc_itemindex_find(idx, nameid);
+	if (idx->head[h].nameid == 0 || slot < idx->head[h].slot) {
+		idx->next[slot] = idx->head[h].nameid ? idx->head[h].slot : INDEX_NOT_FOUND;
+		idx->head[h].nameid = nameid;
+		idx->head[h].slot = slot;
+		return;
+	}
+	for (p = idx->head[h].slot; idx->next[p] != INDEX_NOT_FOUND && idx->next[p] < slot; p = idx->next[p])
+		;
+	idx->next[slot] = idx->next[p];
+	idx->next[p] = slot;
+}
+
+/**
+ * Records that a slot no longer holds nameid.
+ *
+ * @param idx    The index.
+ * @param nameid The item id the slot held.
+ * @param slot   The slot.
+ */
+void pc_itemindex_remove(struct item_index *idx, int nameid, int slot)
+{
+	int h, p;
+
+	nullpo_retv(idx);
+
+	if (nameid == 0)
+		return;
+	h = pc_itemindex_find(idx, nameid);
+	if (idx->head[h].nameid == 0)
+		return;
+
+	if (idx->head[h].slot != slot) {
+		for (p = idx->head[h].slot; idx->next[p] != INDEX_NOT_FOUND && idx->next[p] != slot; p = idx->next[p])
+			;
+		if (idx->next[p] == slot)
+			idx->next[p] = idx->next[slot];
+		return;
+	}
+	if (idx->next[slot] != INDEX_NOT_FOUND) {
+		idx->head[h].slot = idx->next[slot];
+		return;
+	}
+
+	// Last slot of nameid, delete the entry and shift back the ones probed past it.
+	for (p = h;;) {
+		int home;
+
+		p = (p + 1) & (ITEM_INDEX_SIZE - 1);
+		if (idx->head[p].nameid == 0)
+			break;
+		home = pc_itemindex_hash(idx->head[p].nameid);
+		if (h <= p ? (h < home && home <= p) : (h < home || home <= p))
+			continue; // still reachable from its home position
+		idx->head[h] = idx->head[p];
+		h = p;
+	}
+	idx->head[h].nameid = 0;
+}
+
+/**
+ * Gets the first slot holding nameid, the next ones follow through item_index::next.
+ *
+ * @param idx    The index.
+ * @param nameid The item id (must not be 0).
+ * @return The slot, or INDEX_NOT_FOUND.
+ */
+int pc_itemindex_first(const struct item_index *idx, int nameid)
+{
+	int h;
+
+	nullpo_retr(INDEX_NOT_FOUND, idx);
+
+	if (nameid == 0)
+		return INDEX_NOT_FOUND;
+	h = pc_itemindex_find(idx, nameid);
+	return idx->head[h].nameid ? idx->head[h].slot : INDEX_NOT_FOUND;
+}
+
 int pc_calcweapontype(struct map_session_data *sd)
 {
 	nullpo_ret(sd);
@@ -1100,7 +1243,7 @@ bool pc_authok(struct map_session_data *sd, int login_id2, time_t expiration_tim
 		sd->state.showdelay = 1;
 
 	pc->setinventorydata(sd);
-	pc_setequipindex(sd);
+	pc->setequipindex(sd);
 
 	if( sd->status.option & OPTION_INVISIBLE && !pc->can_use_command(sd, "@hide") )
 		sd->status.option &=~ OPTION_INVISIBLE;
@@ -4411,8 +4554,16 @@ int pc_search_inventory(struct map_session_data *sd, int item_id) {
 	int i;
 	nullpo_retr(INDEX_NOT_FOUND, sd);
 
-	ARR_FIND( 0, MAX_INVENTORY, i, sd->status.inventory[i].nameid == item_id && (sd->status.inventory[i].amount > 0 || item_id == 0) );
-	return ( i < MAX_INVENTORY ) ? i : INDEX_NOT_FOUND;
+	if (item_id == 0) { // free slot
+		ARR_FIND( 0, MAX_INVENTORY, i, sd->status.inventory[i].nameid == 0 );
+		return ( i < MAX_INVENTORY ) ? i : INDEX_NOT_FOUND;
+	}
+
+	for (i = pc->itemindex_first(&sd->inventory_index, item_id); i != INDEX_NOT_FOUND; i = sd->inventory_index.next[i]) {
+		if (sd->status.inventory[i].amount > 0)
+			return i;
+	}
+	return INDEX_NOT_FOUND;
 }
 
 /*==========================================
@@ -4478,9 +4629,8 @@ int pc_additem(struct map_session_data *sd,struct item *item_data,int amount,e_l
 
 	// Stackable | Non Rental
 	if( itemdb->isstackable2(data) && item_data->expire_time == 0 ) {
-		for( i = 0; i < MAX_INVENTORY; i++ ) {
-			if( sd->status.inventory[i].nameid == item_data->nameid &&
-			    sd->status.inventory[i].bound == item_data->bound &&
+		for( i = pc->itemindex_first(&sd->inventory_index, item_data->nameid); i != INDEX_NOT_FOUND; i = sd->inventory_index.next[i] ) {
+			if( sd->status.inventory[i].bound == item_data->bound &&
 			    sd->status.inventory[i].expire_time == 0 &&
 				sd->status.inventory[i].unique_id == item_data->unique_id &&
 			    memcmp(&sd->status.inventory[i].card, &item_data->card, sizeof(item_data->card)) == 0 ) {
@@ -4491,6 +4641,8 @@ int pc_additem(struct map_session_data *sd,struct item *item_data,int amount,e_l
 				break;
 			}
 		}
+		if( i == INDEX_NOT_FOUND )
+			i = MAX_INVENTORY;
 	}
 
 	if ( i >= MAX_INVENTORY ) {
@@ -4507,6 +4659,7 @@ int pc_additem(struct map_session_data *sd,struct item *item_data,int amount,e_l
 
 		sd->status.inventory[i].amount = amount;
 		sd->inventory_data[i] = data;
+		pc->itemindex_add(&sd->inventory_index, sd->status.inventory[i].nameid, i);
 		clif->additem(sd,i,amount,0);
 	}
 
@@ -4560,6 +4713,7 @@ int pc_delitem(struct map_session_data *sd,int n,int amount,int type, short reas
 	if( sd->status.inventory[n].amount <= 0 ){
 		if(sd->status.inventory[n].equip)
 			pc->unequipitem(sd, n, PCUNEQUIPITEM_RECALC|PCUNEQUIPITEM_FORCE);
+		pc->itemindex_remove(&sd->inventory_index, sd->status.inventory[n].nameid, n);
 		memset(&sd->status.inventory[n],0,sizeof(sd->status.inventory[0]));
 		sd->inventory_data[n] = NULL;
 	}
@@ -5055,10 +5209,14 @@ int pc_cart_additem(struct map_session_data *sd,struct item *item_data,int amoun
 	i = MAX_CART;
 	if( itemdb->isstackable2(data) && !item_data->expire_time )
 	{
-		ARR_FIND( 0, MAX_CART, i,
-			sd->status.cart[i].nameid == item_data->nameid && sd->status.cart[i].bound == item_data->bound &&
-			sd->status.cart[i].card[0] == item_data->card[0] && sd->status.cart[i].card[1] == item_data->card[1] &&
-			sd->status.cart[i].card[2] == item_data->card[2] && sd->status.cart[i].card[3] == item_data->card[3] );
+		for( i = pc->itemindex_first(&sd->cart_index, item_data->nameid); i != INDEX_NOT_FOUND; i = sd->cart_index.next[i] ) {
+			if( sd->status.cart[i].bound == item_data->bound &&
+				sd->status.cart[i].card[0] == item_data->card[0] && sd->status.cart[i].card[1] == item_data->card[1] &&
+				sd->status.cart[i].card[2] == item_data->card[2] && sd->status.cart[i].card[3] == item_data->card[3] )
+				break;
+		}
+		if( i == INDEX_NOT_FOUND )
+			i = MAX_CART;
 	};
 
 	if( i < MAX_CART && item_data->unique_id == sd->status.cart[i].unique_id)
@@ -5077,6 +5235,7 @@ int pc_cart_additem(struct map_session_data *sd,struct item *item_data,int amoun
 
 		memcpy(&sd->status.cart[i],item_data,sizeof(sd->status.cart[0]));
 		sd->status.cart[i].amount=amount;
+		pc->itemindex_add(&sd->cart_index, sd->status.cart[i].nameid, i);
 		sd->cart_num++;
 		clif->cart_additem(sd,i,amount,0);
 	}
@@ -5107,6 +5266,7 @@ int pc_cart_delitem(struct map_session_data *sd,int n,int amount,int type,e_log_
 	sd->status.cart[n].amount -= amount;
 	sd->cart_weight -= data->weight*amount ;
 	if(sd->status.cart[n].amount <= 0){
+		pc->itemindex_remove(&sd->cart_index, sd->status.cart[n].nameid, n);
 		memset(&sd->status.cart[n],0,sizeof(sd->status.cart[0]));
 		sd->cart_num--;
 	}
@@ -11192,6 +11352,7 @@ void pc_autotrade_start(struct map_session_data *sd) {
 		sd->vend_num = count;
 		sd->state.vending = true;
 		idb_put(vending->db, sd->status.char_id, sd);
+		searchstore->index_add(sd, SEARCHTYPE_VENDING);
 		if( map->list[sd->bl.m].users )
 			clif->showvendingboard(&sd->bl,sd->message,0);
 	}
@@ -11495,6 +11656,11 @@ void pc_defaults(void) {
 	pc->isequip = pc_isequip;
 	pc->equippoint = pc_equippoint;
 	pc->setinventorydata = pc_setinventorydata;
+	pc->setequipindex = pc_setequipindex;
+	pc->itemindex_build = pc_itemindex_build;
+	pc->itemindex_add = pc_itemindex_add;
+	pc->itemindex_remove = pc_itemindex_remove;
+	pc->itemindex_first = pc_itemindex_first;
 
 	pc->checkskill = pc_checkskill;
 	pc->checkskill2 = pc_checkskill2;
@@ -8,6 +8,7 @@
 #include "map/battle.h" // battle
 #include "map/battleground.h" // enum bg_queue_types
 #include "map/buyingstore.h"  // struct s_buyingstore
+#include "map/clif.h" // struct clif_session_throttle
 #include "map/itemdb.h" // MAX_ITEMDELAYS
 #include "map/log.h" // struct e_log_pick_type
 #include "map/map.h" // RC_MAX, ELE_MAX
@@ -29,6 +30,12 @@
 #define MAX_PC_FEELHATE 3
 #define MAX_PC_DEVOTION 5          ///< Max amount of devotion targets
 #define PVP_CALCRANK_INTERVAL 1000 ///< PVP calculation interval
+#define ITEM_INDEX_SLOTS (MAX_INVENTORY > MAX_CART ? MAX_INVENTORY : MAX_CART) ///< Max slots of an item list covered by struct item_index
+#define ITEM_INDEX_SIZE 256        ///< Hash table size of struct item_index (power of two, at least 2*ITEM_INDEX_SLOTS)
+
+#if ITEM_INDEX_SIZE < 2*ITEM_INDEX_SLOTS
+#error ITEM_INDEX_SIZE is too small for MAX_INVENTORY/MAX_CART
+#endif
 
 //Equip indexes constants. (eg: sd->equip_index[EQI_AMMO] returns the index
 //where the arrows are equipped)
@@ -138,6 +145,22 @@ struct pc_combos {
 	unsigned short id;/* this combo id */
 };
 
+/**
+ * nameid -> slot lookup over an item list (inventory, cart).
+ *
+ * head[] is an open-addressed table holding the first slot of each nameid,
+ * the other slots holding the same nameid are chained through next[] in
+ * ascending order. Kept up to date by pc_additem/pc_delitem and
+ * pc_cart_additem/pc_cart_delitem, rebuilt by pc_setinventorydata.
+ */
+struct item_index {
+	struct {
+		int nameid; ///< 0 if unused
+		short slot; ///< First slot holding nameid
+	} head[ITEM_INDEX_SIZE];
+	short next[ITEM_INDEX_SLOTS]; ///< Next slot holding the same nameid, INDEX_NOT_FOUND at the end
+};
+
 struct map_session_data {
 	struct block_list bl;
 	struct unit_data ud;
@@ -228,6 +251,8 @@ struct map_session_data {
 
 	struct mmo_charstatus status;
 	struct item_data* inventory_data[MAX_INVENTORY]; // direct pointers to itemdb entries (faster than doing item_id lookups)
+	struct item_index inventory_index; ///< nameid -> slot lookup of status.inventory
+	struct item_index cart_index;      ///< nameid -> slot lookup of status.cart
 	short equip_index[EQI_MAX];
 	unsigned int weight,max_weight;
 	int cart_weight,cart_num,cart_weight_max;
@@ -306,6 +331,15 @@ BEGIN_ZEROED_BLOCK; // this block will be globally zeroed at the beginning of st
 #ifdef RENEWAL
 	int race_tolerance[RC_MAX];
 #endif
+	struct {
+		bool valid;                  ///< Set by status_calc_pc_ once the values below are stored
+		int subele[ELE_MAX];         ///< subele before status change bonuses
+		int magic_addele[ELE_MAX];   ///< magic_addele before status change bonuses
+		int subrace_demon;           ///< subrace[RC_DEMON] (race_tolerance[RC_DEMON] in renewal) before status change bonuses
+		int dsprate;                 ///< dsprate before status change reductions and underflow protection
+		unsigned int max_weight;     ///< max_weight before SC_KNOWLEDGE
+		unsigned int max_weight_add; ///< max_weight bonus applied after SC_KNOWLEDGE
+	} sc_layer; ///< Input of status->calc_pc_sc_bonus
 	struct s_autospell autospell[15], autospell2[15], autospell3[15];
 	struct s_addeffect addeff[MAX_PC_BONUS], addeff2[MAX_PC_BONUS];
 	struct s_addeffectonskill addeff3[MAX_PC_BONUS];
@@ -537,6 +571,8 @@ END_ZEROED_BLOCK;
 	/* Made Possible Thanks to Yommy~! */
 	unsigned int cryptKey;                                                 ///< Packet obfuscation key to be used for the next received packet
 	unsigned short (*parse_cmd_func)(int fd, struct map_session_data *sd); ///< parse_cmd_func used by this player
+	struct clif_session_throttle throttle;                                 ///< Packet rate accounting, see clif->throttle_session
+	unsigned int view_pending;                                             ///< Units queued by clif->view_queue_add and not sent yet
 
 	unsigned char delayed_damage;//ref. counter bugreport:7307 [Ind/Hercules]
 
@@ -827,6 +863,11 @@ END_ZEROED_BLOCK; /* End */
 	int (*isequip) (struct map_session_data *sd,int n);
 	int (*equippoint) (struct map_session_data *sd,int n);
 	int (*setinventorydata) (struct map_session_data *sd);
+	int (*setequipindex) (struct map_session_data *sd);
+	void (*itemindex_build) (struct item_index *idx, const struct item *items, int max);
+	void (*itemindex_add) (struct item_index *idx, int nameid, int slot);
+	void (*itemindex_remove) (struct item_index *idx, int nameid, int slot);
+	int (*itemindex_first) (const struct item_index *idx, int nameid);
 
 	int (*checkskill) (struct map_session_data *sd,uint16 skill_id);
 	int (*checkskill2) (struct map_session_data *sd,uint16 index);
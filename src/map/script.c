@@ -90,6 +90,12 @@ static inline void script_string_buf_addb(struct script_string_buf *buf,uint8 b)
 	buf->ptr[buf->pos++] = b;
 }
 
+static inline void script_string_buf_addmem(struct script_string_buf *buf, const void *data, size_t len) {
+	script_string_buf_ensure(buf, len);
+	memcpy(buf->ptr + buf->pos, data, len);
+	buf->pos += len;
+}
+
 static inline void script_string_buf_destroy(struct script_string_buf *buf) {
 	if( buf->ptr )
 		aFree(buf->ptr);
@@ -626,6 +632,15 @@ void add_scripti(int a)
 	script->addb(a|0x80);
 }
 
+/// Remembers a constant inlined by the parse being recorded by the bytecode cache.
+static inline void script_bytecode_track_const(int l)
+{
+	if( !script->bytecode.recording )
+		return;
+	VECTOR_ENSURE(script->bytecode.consts, 1, 32);
+	VECTOR_PUSH(script->bytecode.consts, l);
+}
+
 /// Appends a script->str_data object (label/function/variable/integer) to the script buffer.
 
 ///
@@ -653,6 +668,7 @@ void add_scriptl(int l)
 			script->addb(backpatch>>16);
 			break;
 		case C_INT:
+			script_bytecode_track_const(l);
 			script->addi(abs(script->str_data[l].val));
 			if( script->str_data[l].val < 0 ) //Notice that this is negative, from jA (Rayce)
 				script->addc(C_NEG);
@@ -2212,6 +2228,7 @@ bool script_get_constant(const char* name, int* value)
 		return false;
 	}
 	value[0] = script->str_data[n].val;
+	script_bytecode_track_const(n);
 
 	return true;
 }
@@ -2395,6 +2412,479 @@ void script_warning(const char* src, const char* file, int start_line, const cha
 	StrBuf->Destroy(&buf);
 }
 
+/*==========================================
+ * Bytecode cache
+ *------------------------------------------*/
+
+/// Name classes that change the bytecode the parser emits for a name.
+static enum c_op script_bytecode_nametype(enum c_op type)
+{
+	switch( type ) {
+		case C_FUNC:
+		case C_PARAM:
+		case C_INT:
+			return type;
+		default:
+			return C_NAME;
+	}
+}
+
+/// Feeds len bytes into a 64-bit FNV-1a hash.
+static uint64 script_bytecode_fnv(uint64 hash, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	size_t i;
+
+	for( i = 0; i < len; i++ ) {
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/**
+ * Stamp of the script engine that compiled the cached bytecode.
+ *
+ * Covers the cache layout version, the opcode set, the build of script.c and
+ * every buildin (name and argument list, plugin buildins included), so a
+ * cache written by a different engine is discarded as a whole.
+ **/
+static uint64 script_bytecode_stamp(void)
+{
+	uint64 stamp = 0xcbf29ce484222325ULL;
+	int32 value = SCRIPT_BYTECODE_VERSION;
+	int i;
+
+	stamp = script_bytecode_fnv(stamp, &value, sizeof(value));
+	value = C_SUB_PRE;
+	stamp = script_bytecode_fnv(stamp, &value, sizeof(value));
+#ifdef PCRE_SUPPORT
+	value = C_RE_NE;
+	stamp = script_bytecode_fnv(stamp, &value, sizeof(value));
+#endif // PCRE_SUPPORT
+	stamp = script_bytecode_fnv(stamp, __DATE__ " " __TIME__, sizeof(__DATE__ " " __TIME__));
+
+	for( i = LABEL_START; i < script->str_num; i++ ) {
+		const char *name, *arg;
+
+		if( script->str_data[i].type != C_FUNC )
+			continue;
+		name = script->get_str(i);
+		if( (arg = script->buildin[script->str_data[i].val]) == NULL ) // no arguments
+			arg = "";
+		stamp = script_bytecode_fnv(stamp, name, strlen(name) + 1);
+		stamp = script_bytecode_fnv(stamp, arg, strlen(arg) + 1);
+	}
+
+	return stamp;
+}
+
+/// Returns the index of a name in the table being built by script_bytecode_store.
+static int script_bytecode_name_index(int id)
+{
+	int idx = idb_iget(script->bytecode.name_db, id);// stored +1, 0 means not found
+
+	if( idx == 0 ) {
+		VECTOR_ENSURE(script->bytecode.names, 1, 32);
+		VECTOR_PUSH(script->bytecode.names, id);
+		idb_iput(script->bytecode.name_db, id, VECTOR_LENGTH(script->bytecode.names));
+		return VECTOR_LENGTH(script->bytecode.names) - 1;
+	}
+	return idx - 1;
+}
+
+/**
+ * Hashes the part of a script source that parse_script consumes.
+ *
+ * The extent is found with a brace scan that skips strings and comments,
+ * parse_script only stores its result when it consumed exactly that length.
+ *
+ * @param src     Script source.
+ * @param options Parse options, part of the key.
+ * @param src_len [out] Length of the hashed extent.
+ * @return 64-bit FNV-1a hash of the extent and options.
+ **/
+uint64 script_bytecode_hash(const char *src, int options, int *src_len)
+{
+	const char *p = src;
+	uint64 hash;
+	int depth = 0;
+
+	nullpo_ret(src);
+	nullpo_ret(src_len);
+
+	if( options&SCRIPT_IGNORE_EXTERNAL_BRACKETS ) {
+		p += strlen(p);
+	} else {
+		for( ; *p != '\0'; p++ ) {
+			if( *p == '"' ) {
+				for( p++; *p != '\0' && *p != '"'; p++ ) {
+					if( *p == '\\' && p[1] != '\0' )
+						p++;
+				}
+				if( *p == '\0' )
+					break;
+			} else if( p[0] == '/' && p[1] == '/' ) {
+				while( p[1] != '\0' && p[1] != '\n' )
+					p++;
+			} else if( p[0] == '/' && p[1] == '*' ) {
+				for( p += 2; *p != '\0' && !(p[0] == '*' && p[1] == '/'); p++ )
+					;
+				if( *p == '\0' )
+					break;
+				p++;
+			} else if( *p == '{' ) {
+				depth++;
+			} else if( *p == '}' && --depth == 0 ) {
+				p++;
+				break;
+			}
+		}
+	}
+
+	*src_len = (int)(p - src);
+	hash = script_bytecode_fnv(0xcbf29ce484222325ULL, src, *src_len);
+	hash ^= (uint64)options;
+	hash *= 0x100000001b3ULL;
+
+	return hash;
+}
+
+/**
+ * Builds a script from the bytecode cache.
+ *
+ * The entry is only used when its stored source is identical to src, so a
+ * hash collision can't return another script's bytecode.
+ * Names are resolved against the current string table and the entry is
+ * rejected when a name changed class or an inlined constant changed value.
+ *
+ * @param src     Script source.
+ * @param hash    Key from bytecode_hash.
+ * @param src_len Length of the source extent.
+ * @param options Parse options.
+ * @return the script or NULL if it must be parsed.
+ **/
+struct script_code *script_bytecode_load(const char *src, uint64 hash, int src_len, int options)
+{
+	struct script_bytecode_entry *entry;
+	struct script_code *code;
+	const unsigned char *p, *end, *nul;
+	int i, pos;
+
+	nullpo_retr(NULL, src);
+
+	if( !script->bytecode.loaded )
+		script->bytecode_read();
+
+	if( (entry = ui64db_get(script->bytecode.db, hash)) == NULL
+	 || entry->h.src_len != src_len || entry->h.options != options
+	 || entry->h.data_len - entry->h.size < src_len
+	 || memcmp(entry->data + entry->h.data_len - src_len, src, src_len) != 0 )
+		return NULL;
+
+	p = entry->data + entry->h.size;
+	end = entry->data + entry->h.data_len - src_len;
+
+	VECTOR_LENGTH(script->bytecode.names) = 0;
+	VECTOR_ENSURE(script->bytecode.names, entry->h.name_count, 32);
+	for( i = 0; i < entry->h.name_count; i++ ) {
+		enum c_op type;
+		int id;
+
+		if( p >= end || (nul = memchr(p + 1, '\0', end - p - 1)) == NULL )
+			return NULL;
+		type = (enum c_op)*p;
+		id = script->add_str((const char *)p + 1);
+		p = nul + 1;
+		if( script->str_data[id].type == C_NOP ) {// same default as the unknown references of parse_script
+			script->str_data[id].type = C_NAME;
+			script->str_data[id].label = id;
+		}
+		if( script_bytecode_nametype(script->str_data[id].type) != type )
+			return NULL;// e.g. a variable that is now a constant, or a removed command
+		VECTOR_PUSH(script->bytecode.names, id);
+	}
+
+	for( i = 0; i < entry->h.const_count; i++ ) {
+		int32 value;
+		int current;
+
+		if( end - p < (int)sizeof(value) || (nul = memchr(p + sizeof(value), '\0', end - p - sizeof(value))) == NULL )
+			return NULL;
+		memcpy(&value, p, sizeof(value));
+		if( !script->get_constant((const char *)p + sizeof(value), &current) || current != value )
+			return NULL;
+		p = nul + 1;
+	}
+
+	if( end - p != entry->h.label_count * 2 * (int)sizeof(int32) )
+		return NULL;
+
+	CREATE(code, struct script_code, 1);
+	code->script_buf = (unsigned char *)aMalloc(entry->h.size*sizeof(unsigned char));
+	memcpy(code->script_buf, entry->data, entry->h.size);
+	code->script_size = entry->h.size;
+	code->local.vars = NULL;
+	code->local.arrays = NULL;
+
+	for( pos = 0; pos < code->script_size; ) {
+		switch( script->get_com(code->script_buf, &pos) ) {
+			case C_INT:
+				script->get_num(code->script_buf, &pos);
+				break;
+			case C_POS:
+				pos += 3;
+				break;
+			case C_NAME:
+				i = GETVALUE(code->script_buf, pos);
+				if( i >= VECTOR_LENGTH(script->bytecode.names) ) {
+					script->free_code(code);
+					return NULL;
+				}
+				SETVALUE(code->script_buf, pos, VECTOR_INDEX(script->bytecode.names, i));
+				pos += 3;
+				break;
+			case C_STR:
+				pos += (int)strlen((char *)code->script_buf + pos) + 1;
+				break;
+			default:
+				break;
+		}
+	}
+
+	if( options&SCRIPT_USE_LABEL_DB ) {
+		for( i = 0; i < entry->h.label_count; i++, p += 2 * sizeof(int32) ) {
+			int32 name, lpos;
+
+			memcpy(&name, p, sizeof(name));
+			memcpy(&lpos, p + sizeof(name), sizeof(lpos));
+			if( name >= 0 && name < VECTOR_LENGTH(script->bytecode.names) )
+				script->label_add(VECTOR_INDEX(script->bytecode.names, name), lpos);
+		}
+	}
+
+	entry->used = true;
+	script->bytecode.hits++;
+
+	return code;
+}
+
+/**
+ * Stores the script that parse_script just compiled into script->buf.
+ *
+ * @param src     Script source, its extent is stored along with the bytecode.
+ * @param hash    Key from bytecode_hash.
+ * @param src_len Length of the source extent.
+ * @param options Parse options.
+ **/
+void script_bytecode_store(const char *src, uint64 hash, int src_len, int options)
+{
+	struct script_string_buf blob = { 0 };
+	struct script_bytecode_entry *entry;
+	int i, pos, const_count = 0, label_count = 0;
+
+	nullpo_retv(src);
+
+	VECTOR_LENGTH(script->bytecode.names) = 0;
+	db_clear(script->bytecode.name_db);
+
+	script_string_buf_addmem(&blob, script->buf, script->pos);
+	for( pos = 0; pos < script->pos; ) {
+		switch( script->get_com((unsigned char *)blob.ptr, &pos) ) {
+			case C_INT:
+				script->get_num((unsigned char *)blob.ptr, &pos);
+				break;
+			case C_POS:
+				pos += 3;
+				break;
+			case C_NAME:
+				SETVALUE((unsigned char *)blob.ptr, pos, script_bytecode_name_index(GETVALUE((unsigned char *)blob.ptr, pos)));
+				pos += 3;
+				break;
+			case C_STR:
+				pos += (int)strlen(blob.ptr + pos) + 1;
+				break;
+			default:
+				break;
+		}
+	}
+	if( options&SCRIPT_USE_LABEL_DB ) {
+		for( i = 0; i < script->label_count; i++ )
+			script_bytecode_name_index(script->labels[i].key);
+		label_count = script->label_count;
+	}
+
+	for( i = 0; i < VECTOR_LENGTH(script->bytecode.names); i++ ) {
+		int id = VECTOR_INDEX(script->bytecode.names, i);
+		const char *name = script->get_str(id);
+
+		script_string_buf_addb(&blob, (uint8)script_bytecode_nametype(script->str_data[id].type));
+		script_string_buf_addmem(&blob, name, strlen(name) + 1);
+	}
+
+	for( i = 0; i < VECTOR_LENGTH(script->bytecode.consts); i++ ) {
+		int id = VECTOR_INDEX(script->bytecode.consts, i), j;
+		const char *name = script->get_str(id);
+		int32 value = script->str_data[id].val;
+
+		ARR_FIND(0, i, j, VECTOR_INDEX(script->bytecode.consts, j) == id);
+		if( j < i )
+			continue;
+		script_string_buf_addmem(&blob, &value, sizeof(value));
+		script_string_buf_addmem(&blob, name, strlen(name) + 1);
+		const_count++;
+	}
+
+	for( i = 0; i < label_count; i++ ) {
+		int32 name = script_bytecode_name_index(script->labels[i].key), lpos = script->labels[i].pos;
+
+		script_string_buf_addmem(&blob, &name, sizeof(name));
+		script_string_buf_addmem(&blob, &lpos, sizeof(lpos));
+	}
+	script_string_buf_addmem(&blob, src, src_len);
+
+	if( (entry = ui64db_get(script->bytecode.db, hash)) != NULL ) {
+		aFree(entry->data);
+	} else {
+		CREATE(entry, struct script_bytecode_entry, 1);
+		ui64db_put(script->bytecode.db, hash, entry);
+	}
+	entry->h.hash = hash;
+	entry->h.src_len = src_len;
+	entry->h.options = options;
+	entry->h.size = script->pos;
+	entry->h.name_count = VECTOR_LENGTH(script->bytecode.names);
+	entry->h.const_count = const_count;
+	entry->h.label_count = label_count;
+	entry->h.data_len = (int32)blob.pos;
+	entry->data = (unsigned char *)blob.ptr;
+	entry->used = true;
+
+	script->bytecode.stored++;
+	script->bytecode.dirty = true;
+}
+
+/**
+ * Reads the bytecode cache file, entries are discarded when the server binary
+ * or the script engine (see script_bytecode_stamp) changed.
+ **/
+void script_bytecode_read(void)
+{
+	FILE *fp;
+	char key = 0;
+	time_t rtime = 0;
+	int32 version = 0, count = 0;
+	uint64 stamp = 0;
+	int i;
+
+	script->bytecode.loaded = true;
+	script->bytecode.stamp = script_bytecode_stamp();
+
+	if( !HCache->enabled || !(fp = HCache->open(SCRIPT_BYTECODE_CACHE, "rb")) )
+		return;
+
+	if( fseek(fp, 0, SEEK_SET) != 0
+	 || hread(&key, sizeof(key), 1, fp) != 1
+	 || hread(&rtime, sizeof(rtime), 1, fp) != 1
+	 || key != HCACHE_KEY || rtime != HCache->recompile_time
+	 || fseek(fp, 20, SEEK_SET) != 0
+	 || hread(&version, sizeof(version), 1, fp) != 1
+	 || hread(&stamp, sizeof(stamp), 1, fp) != 1
+	 || hread(&count, sizeof(count), 1, fp) != 1
+	 || version != SCRIPT_BYTECODE_VERSION || stamp != script->bytecode.stamp ) {
+		fclose(fp);
+		return;
+	}
+
+	for( i = 0; i < count; i++ ) {
+		struct script_bytecode_entry *entry;
+
+		CREATE(entry, struct script_bytecode_entry, 1);
+		if( hread(&entry->h, sizeof(entry->h), 1, fp) != 1
+		 || entry->h.size <= 0 || entry->h.src_len < 0 || entry->h.data_len < entry->h.size + entry->h.src_len ) {
+			aFree(entry);
+			break;
+		}
+		entry->data = (unsigned char *)aMalloc(entry->h.data_len);
+		if( hread(entry->data, entry->h.data_len, 1, fp) != 1 ) {
+			aFree(entry->data);
+			aFree(entry);
+			break;
+		}
+		ui64db_put(script->bytecode.db, entry->h.hash, entry);
+	}
+	fclose(fp);
+
+	ShowStatus("Loaded '"CL_WHITE"%u"CL_RESET"' compiled scripts from '"CL_WHITE"cache/%s"CL_RESET"'.\n", db_size(script->bytecode.db), SCRIPT_BYTECODE_CACHE);
+}
+
+/**
+ * Writes the entries used during this run back to the cache file, if any were added.
+ **/
+void script_bytecode_save(void)
+{
+	FILE *fp;
+	DBIterator *iter;
+	struct script_bytecode_entry *entry;
+	int32 version = SCRIPT_BYTECODE_VERSION, count = 0;
+
+	if( !script->bytecode.dirty )
+		return;
+	script->bytecode.dirty = false;
+	if( !script->bytecode.loaded ) // entries are only stored after a lookup, which reads the file first
+		return;
+
+	if( !HCache->enabled || !(fp = HCache->open(SCRIPT_BYTECODE_CACHE, "wb")) )
+		return;
+
+	iter = db_iterator(script->bytecode.db);
+	for( entry = dbi_first(iter); dbi_exists(iter); entry = dbi_next(iter) ) {
+		if( entry->used )
+			count++;
+	}
+	hwrite(&version, sizeof(version), 1, fp);
+	hwrite(&script->bytecode.stamp, sizeof(script->bytecode.stamp), 1, fp);
+	hwrite(&count, sizeof(count), 1, fp);
+	for( entry = dbi_first(iter); dbi_exists(iter); entry = dbi_next(iter) ) {
+		if( !entry->used )
+			continue;
+		hwrite(&entry->h, sizeof(entry->h), 1, fp);
+		hwrite(entry->data, entry->h.data_len, 1, fp);
+	}
+	dbi_destroy(iter);
+	fclose(fp);
+
+	ShowInfo("Script bytecode cache: '"CL_WHITE"%u"CL_RESET"' hits, '"CL_WHITE"%u"CL_RESET"' compiled, '"CL_WHITE"%d"CL_RESET"' saved.\n", script->bytecode.hits, script->bytecode.misses, count);
+}
+
+/**
+ * Releases the bytecode cache.
+ **/
+void script_bytecode_clear(void)
+{
+	if( script->bytecode.db != NULL ) {
+		DBIterator *iter = db_iterator(script->bytecode.db);
+		struct script_bytecode_entry *entry;
+
+		for( entry = dbi_first(iter); dbi_exists(iter); entry = dbi_next(iter) ) {
+			aFree(entry->data);
+			aFree(entry);
+		}
+		dbi_destroy(iter);
+		db_destroy(script->bytecode.db);
+		script->bytecode.db = NULL;
+	}
+	if( script->bytecode.name_db != NULL ) {
+		db_destroy(script->bytecode.name_db);
+		script->bytecode.name_db = NULL;
+	}
+	VECTOR_CLEAR(script->bytecode.consts);
+	VECTOR_CLEAR(script->bytecode.names);
+	script->bytecode.loaded = false;
+	script->bytecode.recording = false;
+	script->bytecode.dirty = false;
+}
+
 /*==========================================
  * Analysis of the script
  *------------------------------------------*/
@@ -2404,6 +2894,8 @@ struct script_code* parse_script(const char *src,const char *file,int line,int o
 	struct script_code* code = NULL;
 	char end;
 	bool unresolved_names = false;
+	uint64 hash = 0;
+	int src_len = 0;
 
 	script->parser_current_src = src;
 	script->parser_current_file = file;
@@ -2447,6 +2939,7 @@ struct script_code* parse_script(const char *src,const char *file,int line,int o
 			script->error(src,file,line,script->error_msg,script->error_pos);
 		aFree( script->error_msg );
 		script->pos  = 0;
+		script->bytecode.recording = false;
 		for(i=LABEL_START;i<script->str_num;i++)
 			if(script->str_data[i].type == C_NOP) script->str_data[i].type = C_NAME;
 		for(i=0; i<size; i++)
@@ -2500,6 +2993,24 @@ struct script_code* parse_script(const char *src,const char *file,int line,int o
 		end = '}';
 	}
 
+	// translated strings are resolved at parse time, those scripts can't be reused
+	if( script->config.bytecode_cache && HCache->enabled
+	 && script->syntax.translation_db == NULL && script->lang_export_fp == NULL ) {
+		hash = script->bytecode_hash(src, options, &src_len);
+		if( (code = script->bytecode_load(src, hash, src_len, options)) != NULL ) {
+#ifdef ENABLE_CASE_CHECK
+			script->local_casecheck.clear();
+			script->parser_current_src = NULL;
+			script->parser_current_file = NULL;
+			script->parser_current_line = 0;
+#endif // ENABLE_CASE_CHECK
+			return code;
+		}
+		script->bytecode.misses++;
+		script->bytecode.recording = true;
+		VECTOR_LENGTH(script->bytecode.consts) = 0;
+	}
+
 	// clear references of labels, variables and internal functions
 	for(i=LABEL_START;i<script->str_num;i++) {
 		if(
@@ -2606,6 +3117,13 @@ struct script_code* parse_script(const char *src,const char *file,int line,int o
 	code->script_size = script->pos;
 	code->local.vars = NULL;
 	code->local.arrays = NULL;
+
+	if( script->bytecode.recording ) {
+		script->bytecode.recording = false;
+		// only when the extent scan agrees with what was actually parsed
+		if( (int)(p - src) + (end == '}' ? 1 : 0) == src_len )
+			script->bytecode_store(src, hash, src_len, options);
+	}
 #ifdef ENABLE_CASE_CHECK
 	script->local_casecheck.clear();
 	script->parser_current_src = NULL;
@@ -4351,6 +4869,9 @@ int script_config_read(char *cfgName) {
 		else if(strcmpi(w1,"warn_func_mismatch_argtypes")==0) {
 			script->config.warn_func_mismatch_argtypes = config_switch(w2);
 		}
+		else if(strcmpi(w1,"bytecode_cache")==0) {
+			script->config.bytecode_cache = config_switch(w2);
+		}
 		else if(strcmpi(w1,"import")==0) {
 			script->config_read(w2);
 		}
@@ -4566,6 +5087,7 @@ void do_final_script(void) {
 
 	script->userfunc_db->destroy(script->userfunc_db, script->db_free_code_sub);
 	script->autobonus_db->destroy(script->autobonus_db, script->db_free_code_sub);
+	script->bytecode_clear();
 
 	if (script->str_data)
 		aFree(script->str_data);
@@ -4578,6 +5100,7 @@ void do_final_script(void) {
 
 	if( atcommand->binding_count != 0 )
 		aFree(atcommand->binding);
+	atcommand->dispatch_dirty = true;
 
 	for( i = 0; i < script->buildin_count; i++) {
 		if( script->buildin[i] ) {
@@ -4958,6 +5481,7 @@ void script_parser_clean_leftovers(void) {
  **/
 int script_parse_cleanup_timer(int tid, int64 tick, int id, intptr_t data) {
 	script->parser_clean_leftovers();
+	script->bytecode_save();
 
 	script->parse_cleanup_timer_id = INVALID_TIMER;
 
@@ -4973,6 +5497,8 @@ void do_init_script(bool minimal) {
 	script->st_db = idb_alloc(DB_OPT_BASE);
 	script->userfunc_db = strdb_alloc(DB_OPT_DUP_KEY,0);
 	script->autobonus_db = strdb_alloc(DB_OPT_DUP_KEY,0);
+	script->bytecode.db = ui64db_alloc(DB_OPT_BASE);
+	script->bytecode.name_db = idb_alloc(DB_OPT_BASE);
 
 	script->st_ers = ers_new(sizeof(struct script_state), "script.c::st_ers", ERS_OPT_CLEAN|ERS_OPT_FLEX_CHUNK);
 	script->stack_ers = ers_new(sizeof(struct script_stack), "script.c::script_stack", ERS_OPT_NONE|ERS_OPT_FLEX_CHUNK);
@@ -5018,6 +5544,7 @@ int script_reload(void) {
 
 	if( atcommand->binding_count != 0 )
 		aFree(atcommand->binding);
+	atcommand->dispatch_dirty = true;
 
 	atcommand->binding_count = 0;
 
@@ -6758,9 +7285,8 @@ BUILDIN(countitem) {
 
 	nameid = id->nameid;
 
-	for(i = 0; i < MAX_INVENTORY; i++)
-		if(sd->status.inventory[i].nameid == nameid)
-			count += sd->status.inventory[i].amount;
+	for (i = pc->itemindex_first(&sd->inventory_index, nameid); i != INDEX_NOT_FOUND; i = sd->inventory_index.next[i])
+		count += sd->status.inventory[i].amount;
 
 	script_pushint(st,count);
 	return true;
@@ -7421,7 +7947,7 @@ void buildin_delitem_delete(struct map_session_data* sd, int idx, int* amount, b
 bool buildin_delitem_search(struct map_session_data* sd, struct item* it, bool exact_match)
 {
 	bool delete_items = false;
-	int i, amount;
+	int i, next, amount;
 	struct item* inv;
 
 	// prefer always non-equipped items
@@ -7440,7 +7966,9 @@ bool buildin_delitem_search(struct map_session_data* sd, struct item* it, bool e
 		amount = it->amount;
 
 		// 1st pass -- less important items / exact match
-		for (i = 0; amount && i < ARRAYLENGTH(sd->status.inventory); i++) {
+		// (next is read up front, deleting the item unlinks slot i)
+		for (i = pc->itemindex_first(&sd->inventory_index, it->nameid); amount && i != INDEX_NOT_FOUND; i = next) {
+			next = sd->inventory_index.next[i];
 			inv = &sd->status.inventory[i];
 
 			if (!inv->nameid || !sd->inventory_data[i] || inv->nameid != it->nameid) {
@@ -7481,7 +8009,8 @@ bool buildin_delitem_search(struct map_session_data* sd, struct item* it, bool e
 			// either everything was already consumed or no items were skipped
 			;
 		} else {
-			for (i = 0; amount && i < ARRAYLENGTH(sd->status.inventory); i++) {
+			for (i = pc->itemindex_first(&sd->inventory_index, it->nameid); amount && i != INDEX_NOT_FOUND; i = next) {
+				next = sd->inventory_index.next[i];
 				inv = &sd->status.inventory[i];
 
 				if (!inv->nameid || !sd->inventory_data[i] || inv->nameid != it->nameid) {
@@ -18386,6 +18915,7 @@ BUILDIN(bindatcmd) {
 		atcommand->binding[i]->group_lv = group_lv;
 		atcommand->binding[i]->group_lv_char = group_lv_char;
 		atcommand->binding[i]->log = log;
+		atcommand->dispatch_dirty = true;
 	}
 
 	return true;
@@ -18424,6 +18954,7 @@ BUILDIN(unbindatcmd) {
 
 		if( (atcommand->binding_count = cursor) == 0 )
 			aFree(atcommand->binding);
+		atcommand->dispatch_dirty = true;
 
 		script_pushint(st, 1);
 	} else
@@ -20576,6 +21107,9 @@ void script_defaults(void) {
 	script->parser_current_line = 0;
 
 	memset(&script->syntax,0,sizeof(script->syntax));
+	memset(&script->bytecode,0,sizeof(script->bytecode));
+	VECTOR_INIT(script->bytecode.consts);
+	VECTOR_INIT(script->bytecode.names);
 
 	script->parse_syntax_for_flag = 0;
 
@@ -20720,6 +21254,7 @@ void script_defaults(void) {
 	/* script_config base */
 	script->config.warn_func_mismatch_argtypes = 1;
 	script->config.warn_func_mismatch_paramnum = 1;
+	script->config.bytecode_cache = 1;
 	script->config.check_cmdcount = 65535;
 	script->config.check_gotocount = 2048;
 	script->config.input_min_value = 0;
@@ -20788,6 +21323,13 @@ void script_defaults(void) {
 	script->add_language = script_add_language;
 	script->get_translation_file_name = script_get_translation_file_name;
 	script->parser_clean_leftovers = script_parser_clean_leftovers;
+	/* bytecode cache */
+	script->bytecode_hash = script_bytecode_hash;
+	script->bytecode_load = script_bytecode_load;
+	script->bytecode_store = script_bytecode_store;
+	script->bytecode_read = script_bytecode_read;
+	script->bytecode_save = script_bytecode_save;
+	script->bytecode_clear = script_bytecode_clear;
 
 	script->run_use_script = script_run_use_script;
 	script->run_item_equip_script = script_run_item_equip_script;
@@ -46,6 +46,11 @@ struct item_data;
 //#define SCRIPT_HASH_SDBM
 #define SCRIPT_HASH_ELF
 
+/// File (under ./cache/) holding compiled bytecode across restarts
+#define SCRIPT_BYTECODE_CACHE "script_bytecode.bin"
+/// Version of the bytecode cache layout, bump when the format or the bytecode changes
+#define SCRIPT_BYTECODE_VERSION 2
+
 #define SCRIPT_EQUIP_TABLE_SIZE 20
 
 //#define SCRIPT_DEBUG_DISP
@@ -329,6 +334,7 @@ enum {
 struct Script_Config {
 	unsigned warn_func_mismatch_argtypes : 1;
 	unsigned warn_func_mismatch_paramnum : 1;
+	unsigned bytecode_cache : 1; ///< Keep compiled scripts in ./cache/ across restarts
 	int check_cmdcount;
 	int check_gotocount;
 	int input_min_value;
@@ -497,6 +503,46 @@ struct script_string_buf {
 	size_t pos,size;
 };
 
+/**
+ * Fixed part of a bytecode cache entry, written as-is to the cache file.
+ **/
+struct script_bytecode_header {
+	uint64 hash;       ///< FNV-1a hash of the source extent and parse options
+	int32 src_len;     ///< Length of the source extent
+	int32 options;     ///< Parse options it was compiled with
+	int32 size;        ///< Bytecode length
+	int32 name_count;  ///< Entries in the name table
+	int32 const_count; ///< Entries in the constant table
+	int32 label_count; ///< Entries in the label table
+	int32 data_len;    ///< Length of the data blob
+};
+
+/**
+ * Compiled script stored by the bytecode cache.
+ *
+ * data holds the bytecode (C_NAME operands are indexes into the name table),
+ * followed by the name table ([uint8 type][name\0] each), the constant table
+ * ([int32 value][name\0] each), the label table ([int32 name][int32 pos] each)
+ * and the source extent it was compiled from (h.src_len bytes).
+ **/
+struct script_bytecode_entry {
+	struct script_bytecode_header h;
+	unsigned char *data;
+	bool used; ///< Loaded or stored during this run, only those are written back
+};
+
+struct script_bytecode_cache {
+	DBMap *db;               ///< hash => struct script_bytecode_entry*
+	uint64 stamp;            ///< Script engine stamp of the cache file (see script_bytecode_stamp)
+	bool loaded;             ///< Cache file has been read
+	bool recording;          ///< The current parse is a cache miss that will be stored
+	bool dirty;              ///< New entries not yet written to disk
+	VECTOR_DECL(int) consts; ///< Constants inlined by the current parse
+	VECTOR_DECL(int) names;  ///< Scratch list of name ids
+	DBMap *name_db;          ///< Scratch name id => name table index
+	unsigned int hits, misses, stored;
+};
+
 struct string_translation {
 	int string_id;
 	uint8 translations;
@@ -557,6 +603,8 @@ struct script_interface {
 	/* */
 	struct script_syntax_data syntax;
 	/* */
+	struct script_bytecode_cache bytecode;
+	/* */
 	int parse_options;
 	// important buildin function references for usage in scripts
 	int buildin_set_ref;
@@ -768,6 +816,13 @@ struct script_interface {
 	uint8 (*add_language) (const char *name);
 	const char *(*get_translation_file_name) (const char *file);
 	void (*parser_clean_leftovers) (void);
+	/* bytecode cache */
+	uint64 (*bytecode_hash) (const char *src, int options, int *src_len);
+	struct script_code *(*bytecode_load) (const char *src, uint64 hash, int src_len, int options);
+	void (*bytecode_store) (const char *src, uint64 hash, int src_len, int options);
+	void (*bytecode_read) (void);
+	void (*bytecode_save) (void);
+	void (*bytecode_clear) (void);
 	void (*run_use_script) (struct map_session_data *sd, struct item_data *data, int oid);
 	void (*run_item_equip_script) (struct map_session_data *sd, struct item_data *data, int oid);
 	void (*run_item_unequip_script) (struct map_session_data *sd, struct item_data *data, int oid);
@@ -8,9 +8,12 @@
 
 #include "map/battle.h" // battle_config.*
 #include "map/clif.h" // clif-"open_search_store_info, clif-"search_store_info_*
+#include "map/itemdb.h" // itemdb_isspecial, itemdb_slot
 #include "map/pc.h" // struct map_session_data
 #include "common/cbasetypes.h"
+#include "common/db.h" // VECTOR_*, ARR_FIND
 #include "common/malloc.h" // aMalloc, aRealloc, aFree
+#include "common/nullpo.h" // nullpo_*
 #include "common/showmsg.h" // ShowError, ShowWarning
 #include "common/strlib.h" // safestrncpy
 
@@ -27,16 +30,6 @@ static inline searchstore_search_t searchstore_getsearchfunc(unsigned char type)
 }
 
 
-/// retrieves search-all function by type
-static inline searchstore_searchall_t searchstore_getsearchallfunc(unsigned char type) {
-	switch( type ) {
-		case SEARCHTYPE_VENDING:      return vending->searchall;
-		case SEARCHTYPE_BUYING_STORE: return buyingstore->searchall;
-	}
-	return NULL;
-}
-
-
 /// checks if the player has a store by type
 static inline bool searchstore_hasstore(struct map_session_data* sd, unsigned char type) {
 	switch( type ) {
@@ -79,10 +72,7 @@ bool searchstore_open(struct map_session_data* sd, unsigned int uses, unsigned s
 void searchstore_query(struct map_session_data* sd, unsigned char type, unsigned int min_price, unsigned int max_price, const unsigned short* itemlist, unsigned int item_count, const unsigned short* cardlist, unsigned int card_count)
 {
 	unsigned int i;
-	struct map_session_data* pl_sd;
-	struct DBIterator *iter;
 	struct s_search_store_search s;
-	searchstore_searchall_t store_searchall;
 	time_t querytime;
 
 	if( !battle_config.feature_search_stores ) {
@@ -93,7 +83,7 @@ void searchstore_query(struct map_session_data* sd, unsigned char type, unsigned
 		return;
 	}
 
-	if( ( store_searchall = searchstore_getsearchallfunc(type) ) == NULL ) {
+	if( type >= SEARCHTYPE_MAX ) {
 		ShowError("searchstore_query: Unknown search type %u (account_id=%d).\n", (unsigned int)type, sd->bl.id);
 		return;
 	}
@@ -148,21 +138,11 @@ void searchstore_query(struct map_session_data* sd, unsigned char type, unsigned
 	s.card_count = card_count;
 	s.min_price  = min_price;
 	s.max_price  = max_price;
-	iter         = db_iterator(vending->db);
-
-	for( pl_sd = dbi_first(iter); dbi_exists(iter);  pl_sd = dbi_next(iter) ) {
-		if( sd == pl_sd ) {// skip own shop, if any
-			continue;
-		}
 
-		if( !store_searchall(pl_sd, &s) ) {// exceeded result size
-			clif->search_store_info_failed(sd, SSI_FAILED_OVER_MAXCOUNT);
-			break;
-		}
+	if( !searchstore->index_search(sd, &s, type) ) {// exceeded result size
+		clif->search_store_info_failed(sd, SSI_FAILED_OVER_MAXCOUNT);
 	}
 
-	dbi_destroy(iter);
-
 	if( sd->searchstore.count ) {
 		// reclaim unused memory
 		sd->searchstore.items = (struct s_search_store_info_item*)aRealloc(sd->searchstore.items, sizeof(struct s_search_store_info_item)*sd->searchstore.count);
@@ -332,9 +312,278 @@ bool searchstore_result(struct map_session_data* sd, unsigned int store_id, int
 	return true;
 }
 
+/// returns the position of the first entry of the list, that is not ordered before price and account_id
+static int searchstore_index_lowerbound(const struct s_search_store_index_list* list, unsigned int price, int account_id)
+{
+	int lo = 0, hi = VECTOR_LENGTH(list->entries);
+
+	while( lo < hi ) {
+		int mid = (lo+hi)/2;
+		const struct s_search_store_index_entry* entry = &VECTOR_INDEX(list->entries, mid);
+
+		if( entry->price < price || ( entry->price == price && entry->sd->status.account_id < account_id ) ) {
+			lo = mid+1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+
+/// checks whether or not an indexed store item passes the non-price criteria of a search
+static bool searchstore_index_match(const struct s_search_store_index_entry* entry, const struct s_search_store_search* s, unsigned char type)
+{
+	unsigned int cidx;
+	int c, slot;
+
+	if( entry->sd == s->search_sd ) {// skip own shop, if any
+		return false;
+	}
+
+	if( !s->card_count || type != SEARCHTYPE_VENDING ) {// buying stores only take items without cards
+		return true;
+	}
+
+	if( itemdb_isspecial(entry->card[0]) ) {// something, that is not a carded
+		return false;
+	}
+	slot = itemdb_slot(entry->nameid);
+
+	for( c = 0; c < slot && entry->card[c]; c++ ) {
+		ARR_FIND( 0, s->card_count, cidx, s->cardlist[cidx] == entry->card[c] );
+		if( cidx != s->card_count ) {// found
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/// adds a store item to the index
+void searchstore_index_insert(unsigned char type, const struct s_search_store_index_entry* entry)
+{
+	struct s_search_store_index_list* list;
+	int i;
+
+	if( ( list = (struct s_search_store_index_list*)idb_get(searchstore->index[type], entry->nameid) ) == NULL ) {
+		CREATE(list, struct s_search_store_index_list, 1);
+		VECTOR_INIT(list->entries);
+		idb_put(searchstore->index[type], entry->nameid, list);
+	}
+
+	i = searchstore_index_lowerbound(list, entry->price, entry->sd->status.account_id);
+	VECTOR_ENSURE(list->entries, 1, 8);
+	VECTOR_INSERTCOPY(list->entries, i, *entry);
+}
+
+
+/// removes the items of sd's store with given nameid and price from the index
+void searchstore_index_erase(unsigned char type, struct map_session_data* sd, unsigned short nameid, unsigned int price)
+{
+	struct s_search_store_index_list* list;
+	int i, n;
+
+	if( ( list = (struct s_search_store_index_list*)idb_get(searchstore->index[type], nameid) ) == NULL ) {
+		return;
+	}
+
+	i = searchstore_index_lowerbound(list, price, sd->status.account_id);
+	for( n = 0; i+n < VECTOR_LENGTH(list->entries) && VECTOR_INDEX(list->entries, i+n).sd == sd && VECTOR_INDEX(list->entries, i+n).price == price; n++ )
+		;
+
+	if( n ) {
+		VECTOR_ERASEN(list->entries, i, n);
+	}
+
+	if( !VECTOR_LENGTH(list->entries) ) {// last one of its kind
+		idb_remove(searchstore->index[type], nameid);
+		VECTOR_CLEAR(list->entries);
+		aFree(list);
+	}
+}
+
+
+/// adds all items of sd's store to the index, must be called whenever the store opens or changes
+void searchstore_index_add(struct map_session_data* sd, unsigned char type)
+{
+	struct s_search_store_index_entry entry;
+	int i;
+
+	nullpo_retv(sd);
+
+	memset(&entry, 0, sizeof(entry));
+	entry.sd = sd;
+
+	switch( type ) {
+		case SEARCHTYPE_VENDING:
+			for( i = 0; i < sd->vend_num; i++ ) {
+				const struct item* it = &sd->status.cart[sd->vending[i].index];
+
+				if( !sd->vending[i].amount ) {// sold out
+					continue;
+				}
+
+				entry.nameid = it->nameid;
+				entry.amount = sd->vending[i].amount;
+				entry.price = sd->vending[i].value;
+				memcpy(entry.card, it->card, sizeof(entry.card));
+				entry.refine = it->refine;
+				searchstore->index_insert(type, &entry);
+			}
+			break;
+		case SEARCHTYPE_BUYING_STORE:
+			for( i = 0; i < sd->buyingstore.slots; i++ ) {
+				const struct s_buyingstore_item* it = &sd->buyingstore.items[i];
+
+				if( !it->amount ) {// bought everything
+					continue;
+				}
+
+				entry.nameid = it->nameid;
+				entry.amount = it->amount;
+				entry.price = (unsigned int)it->price;
+				searchstore->index_insert(type, &entry);
+			}
+			break;
+	}
+}
+
+
+/// removes all items of sd's store from the index, must be called before the store closes or changes
+void searchstore_index_remove(struct map_session_data* sd, unsigned char type)
+{
+	int i;
+
+	nullpo_retv(sd);
+
+	switch( type ) {
+		case SEARCHTYPE_VENDING:
+			for( i = 0; i < sd->vend_num; i++ ) {
+				searchstore->index_erase(type, sd, sd->status.cart[sd->vending[i].index].nameid, sd->vending[i].value);
+			}
+			break;
+		case SEARCHTYPE_BUYING_STORE:
+			for( i = 0; i < sd->buyingstore.slots; i++ ) {
+				searchstore->index_erase(type, sd, sd->buyingstore.items[i].nameid, (unsigned int)sd->buyingstore.items[i].price);
+			}
+			break;
+	}
+}
+
+
+/// Searches the index for all store items, that match given ids, price and possible cards.
+/// Results are sent best price first: cheapest vendings, best paying buying stores.
+/// @return Whether or not all matching items fit into the result set.
+bool searchstore_index_search(struct map_session_data* sd, const struct s_search_store_search* s, unsigned char type)
+{
+	struct s_search_store_index_list** lists;
+	int *cur, *stop, step = ( type == SEARCHTYPE_VENDING ) ? 1 : -1;
+	unsigned int idx;
+	bool complete = true;
+
+	if( !s->item_count ) {
+		return true;
+	}
+
+	CREATE(lists, struct s_search_store_index_list*, s->item_count);
+	CREATE(cur, int, s->item_count*2);
+	stop = cur+s->item_count;
+
+	// narrow every item's list down to the price range
+	for( idx = 0; idx < s->item_count; idx++ ) {
+		int lo = 0, hi = 0;
+
+		if( ( lists[idx] = (struct s_search_store_index_list*)idb_get(searchstore->index[type], s->itemlist[idx]) ) != NULL ) {
+			lo = s->min_price ? searchstore_index_lowerbound(lists[idx], s->min_price, 0) : 0;
+			hi = ( s->max_price && s->max_price < UINT_MAX ) ? searchstore_index_lowerbound(lists[idx], s->max_price+1, 0) : VECTOR_LENGTH(lists[idx]->entries);
+		}
+
+		cur[idx]  = ( step > 0 ) ? lo : hi-1;
+		stop[idx] = ( step > 0 ) ? hi : lo-1;
+	}
+
+	// merge the lists, best price first
+	for(;;) {
+		const struct s_search_store_index_entry* best = NULL;
+		unsigned int best_idx = 0;
+
+		for( idx = 0; idx < s->item_count; idx++ ) {
+			const struct s_search_store_index_entry* entry;
+
+			while( cur[idx] != stop[idx] && !searchstore_index_match(&VECTOR_INDEX(lists[idx]->entries, cur[idx]), s, type) ) {
+				cur[idx] += step;
+			}
+
+			if( cur[idx] == stop[idx] ) {// exhausted
+				continue;
+			}
+
+			entry = &VECTOR_INDEX(lists[idx]->entries, cur[idx]);
+			if( best == NULL || ( step > 0 ? entry->price < best->price : entry->price > best->price ) ) {
+				best = entry;
+				best_idx = idx;
+			}
+		}
+
+		if( best == NULL ) {// nothing left
+			break;
+		}
+		cur[best_idx] += step;
+
+		if( !searchstore->result(s->search_sd, searchstore_getstoreid(best->sd, type), best->sd->status.account_id, best->sd->message, best->nameid, best->amount, best->price, best->card, best->refine) )
+		{// result set full
+			complete = false;
+			break;
+		}
+	}
+
+	aFree(cur);
+	aFree(lists);
+
+	return complete;
+}
+
+
+/// releases an item list of the index
+static int searchstore_index_final_sub(DBKey key, DBData *data, va_list ap)
+{
+	struct s_search_store_index_list* list = DB->data2ptr(data);
+
+	VECTOR_CLEAR(list->entries);
+	aFree(list);
+
+	return 0;
+}
+
+
+void searchstore_init(bool minimal) {
+	int i;
+
+	for( i = 0; i < SEARCHTYPE_MAX; i++ ) {
+		searchstore->index[i] = idb_alloc(DB_OPT_BASE);
+	}
+}
+
+
+void searchstore_final(void) {
+	int i;
+
+	for( i = 0; i < SEARCHTYPE_MAX; i++ ) {
+		searchstore->index[i]->destroy(searchstore->index[i], searchstore_index_final_sub);
+		searchstore->index[i] = NULL;
+	}
+}
+
 void searchstore_defaults (void) {
 	searchstore = &searchstore_s;
 
+	memset(searchstore->index, 0, sizeof(searchstore->index));
+
+	searchstore->init = searchstore_init;
+	searchstore->final = searchstore_final;
 	searchstore->open = searchstore_open;
 	searchstore->query = searchstore_query;
 	searchstore->querynext = searchstore_querynext;
@@ -345,5 +594,10 @@ void searchstore_defaults (void) {
 	searchstore->queryremote = searchstore_queryremote;
 	searchstore->clearremote = searchstore_clearremote;
 	searchstore->result = searchstore_result;
+	searchstore->index_add = searchstore_index_add;
+	searchstore->index_remove = searchstore_index_remove;
+	searchstore->index_insert = searchstore_index_insert;
+	searchstore->index_erase = searchstore_index_erase;
+	searchstore->index_search = searchstore_index_search;
 
 }
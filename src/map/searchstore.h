@@ -7,6 +7,7 @@
 
 #include "map/map.h" // MESSAGE_SIZE
 #include "common/hercules.h"
+#include "common/db.h" // VECTOR_DECL
 #include "common/mmo.h" // MAX_SLOTS
 
 #include <time.h>
@@ -22,6 +23,7 @@
 enum e_searchstore_searchtype {
 	SEARCHTYPE_VENDING      = 0,
 	SEARCHTYPE_BUYING_STORE = 1,
+	SEARCHTYPE_MAX
 };
 
 enum e_searchstore_effecttype {
@@ -75,6 +77,21 @@ struct s_search_store_info {
 	bool open;
 };
 
+/// item of an open store, as kept in searchstore->index
+struct s_search_store_index_entry {
+	struct map_session_data* sd;  // owner of the store
+	unsigned int price;
+	unsigned short nameid;
+	unsigned short amount;
+	short card[MAX_SLOTS];
+	unsigned char refine;
+};
+
+/// all store items of one nameid, ordered by price and account id
+struct s_search_store_index_list {
+	VECTOR_DECL(struct s_search_store_index_entry) entries;
+};
+
 /// type for shop search function
 typedef bool (*searchstore_search_t)(struct map_session_data* sd, unsigned short nameid);
 typedef bool (*searchstore_searchall_t)(struct map_session_data* sd, const struct s_search_store_search* s);
@@ -83,6 +100,11 @@ typedef bool (*searchstore_searchall_t)(struct map_session_data* sd, const struc
  * Interface
  **/
 struct searchstore_interface {
+	DBMap *index[SEARCHTYPE_MAX];  // nameid -> struct s_search_store_index_list*, by search type
+	/* */
+	void (*init) (bool minimal);
+	void (*final) (void);
+	/* */
 	bool (*open) (struct map_session_data* sd, unsigned int uses, unsigned short effect);
 	void (*query) (struct map_session_data* sd, unsigned char type, unsigned int min_price, unsigned int max_price, const unsigned short* itemlist, unsigned int item_count, const unsigned short* cardlist, unsigned int card_count);
 	bool (*querynext) (struct map_session_data* sd);
@@ -93,6 +115,11 @@ struct searchstore_interface {
 	bool (*queryremote) (struct map_session_data* sd, int account_id);
 	void (*clearremote) (struct map_session_data* sd);
 	bool (*result) (struct map_session_data* sd, unsigned int store_id, int account_id, const char* store_name, unsigned short nameid, unsigned short amount, unsigned int price, const short* card, unsigned char refine);
+	void (*index_add) (struct map_session_data* sd, unsigned char type);
+	void (*index_remove) (struct map_session_data* sd, unsigned char type);
+	void (*index_insert) (unsigned char type, const struct s_search_store_index_entry* entry);
+	void (*index_erase) (unsigned char type, struct map_session_data* sd, unsigned short nameid, unsigned int price);
+	bool (*index_search) (struct map_session_data* sd, const struct s_search_store_search* s, unsigned char type);
 };
 
 #ifdef HERCULES_CORE
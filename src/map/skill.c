@@ -3553,6 +3553,8 @@ int skill_castend_damage_id(struct block_list* src, struct block_list *bl, uint1
 	struct map_session_data *sd = NULL;
 	struct status_data *tstatus;
 	struct status_change *sc;
+	struct battle_skill_terms terms;
+	bool own_terms = false;
 
 	if (skill_id > 0 && !skill_lv) return 0;
 
@@ -3586,8 +3588,12 @@ int skill_castend_damage_id(struct block_list* src, struct block_list *bl, uint1
 	tstatus = status->get_status_data(bl);
 
 	map->freeblock_lock();
-	
-	
+
+	if (!(flag&1)) { // the targets of a splash are resolved by calls with flag&1, let them share the skill's terms
+		battle->skill_terms_push(&terms, src, skill_id, skill_lv);
+		own_terms = true;
+	}
+
 #ifdef CUSTOM_MO_COMBO_SPIRIT
 	switch (skill_id) {
 		case MO_TRIPLEATTACK:
@@ -4863,14 +4869,19 @@ int skill_castend_damage_id(struct block_list* src, struct block_list *bl, uint1
 			break;
 
 		default:
-			if (skill->castend_damage_id_unknown(src, bl, &skill_id, &skill_lv, &tick, &flag, tstatus, sc))
+			if (skill->castend_damage_id_unknown(src, bl, &skill_id, &skill_lv, &tick, &flag, tstatus, sc)) {
+				if (own_terms)
+					battle->skill_terms_pop(&terms);
 				return 1;
+			}
 			break;
 	}
 
 	if( sc && sc->data[SC_CURSEDCIRCLE_ATKER] ) //Should only remove after the skill has been casted.
 		status_change_end(src,SC_CURSEDCIRCLE_ATKER,INVALID_TIMER);
 
+	if (own_terms)
+		battle->skill_terms_pop(&terms);
 	map->freeblock_unlock();
 
 	if( sd && !(flag&1) )
@@ -16697,10 +16708,17 @@ int skill_unit_timer_sub(DBKey key, DBData *data, va_list ap) {
 	dissonance = skill->dance_switch(su, 0);
 
 	if( su->range >= 0 && group->interval != -1 && su->bl.id != su->prev) {
+		struct block_list *ss = map->id2bl(group->src_id);
+		struct battle_skill_terms terms;
+
+		if (ss != NULL) // units hitting everything in range (Storm Gust, Meteor Storm, ...) share the skill's terms
+			battle->skill_terms_push(&terms, ss, group->skill_id, group->skill_lv);
 		if( battle_config.skill_wall_check )
 			map->foreachinshootrange(skill->unit_timer_sub_onplace, bl, su->range, group->bl_flag, bl,tick);
 		else
 			map->foreachinrange(skill->unit_timer_sub_onplace, bl, su->range, group->bl_flag, bl,tick);
+		if (ss != NULL)
+			battle->skill_terms_pop(&terms);
 
 		if(su->range == -1) //Unit disabled, but it should not be deleted yet.
 			group->unit_id = UNT_USED_TRAPS;
@@ -1024,6 +1024,20 @@ void initChangeTables(void) {
 	status->dbs->ChangeFlagTable[SC_MTF_MATK] = SCB_MATK;
 	status->dbs->ChangeFlagTable[SC_MTF_MLEATKED] |= SCB_ALL;
 
+	// Status changes whose effect on a player's base status is entirely applied by status->calc_pc_sc_bonus
+	status->dbs->PCLayerTable[SC_PROVIDENCE]          = true;
+	status->dbs->PCLayerTable[SC_SIEGFRIED]           = true;
+	status->dbs->PCLayerTable[SC_SERVICEFORYOU]       = true;
+	status->dbs->PCLayerTable[SC_KNOWLEDGE]           = true;
+	status->dbs->PCLayerTable[SC_ARMORPROPERTY]       = true;
+	status->dbs->PCLayerTable[SC_ARMOR_RESIST]        = true;
+	status->dbs->PCLayerTable[SC_ATKER_BLOOD]         = true;
+	status->dbs->PCLayerTable[SC_MTF_MLEATKED]        = true;
+	status->dbs->PCLayerTable[SC_FIRE_CLOAK_OPTION]   = true;
+	status->dbs->PCLayerTable[SC_WATER_DROP_OPTION]   = true;
+	status->dbs->PCLayerTable[SC_WIND_CURTAIN_OPTION] = true;
+	status->dbs->PCLayerTable[SC_STONE_SHIELD_OPTION] = true;
+
 	status->dbs->ChangeFlagTable[SC_MOONSTAR] |= SCB_NONE;
 	status->dbs->ChangeFlagTable[SC_SUPER_STAR] |= SCB_NONE;
 	status->dbs->ChangeFlagTable[SC_STRANGELIGHTS] |= SCB_NONE;
@@ -1063,6 +1077,290 @@ void initChangeTables(void) {
 #undef set_sc_with_vfx
 }
 
+/// qsort comparator grouping status change modifiers by status change.
+int status_sc_mod_cmp(const void *a, const void *b)
+{
+	const struct sc_modifier *ma = a, *mb = b;
+	return ma->type - mb->type;
+}
+
+/**
+ * Fills the status change modifier table.
+ *
+ * Each entry used to be an unconditional line of the matching status_calc_*
+ * function: `stat += bonus + rate * val` for the flat stats, which the
+ * function now adds through status->sc_mod_get(), or
+ * `stat += stat * (bonus + rate * val) / 100` for the rate stats, which it
+ * now applies through status->sc_mod_rate(). Entries are listed per stat;
+ * the percentages of a rate stat are applied in the listed order.
+ */
+void initModifierTable(void)
+{
+#define add_mod(type_, stat_, source_, rate_, bonus_) do { \
+	Assert_retb(status->dbs->sc_mod_count < MAX_SC_MODIFIERS); \
+	status->dbs->sc_mods[status->dbs->sc_mod_count].type = (type_); \
+	status->dbs->sc_mods[status->dbs->sc_mod_count].stat = (stat_); \
+	status->dbs->sc_mods[status->dbs->sc_mod_count].source = (source_); \
+	status->dbs->sc_mods[status->dbs->sc_mod_count].rate = (rate_); \
+	status->dbs->sc_mods[status->dbs->sc_mod_count].bonus = (bonus_); \
+	status->dbs->sc_mod_count++; \
+} while(0)
+	int i;
+
+	status->dbs->sc_mod_count = 0;
+
+	// STR (before Blessing)
+	add_mod(SC_BEYOND_OF_WARCRY,   SCM_STR, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_INCALLSTATUS,       SCM_STR, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_CHASEWALK2,         SCM_STR, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_STR,           SCM_STR, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_STR_CASH,      SCM_STR, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_GDSKILL_BATTLEORDER,SCM_STR, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_LEADERSHIP,         SCM_STR, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_SHOUT,              SCM_STR, SCM_SRC_NONE, 0, 4);
+	add_mod(SC_TRUESIGHT,          SCM_STR, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_STRUP,              SCM_STR, SCM_SRC_NONE, 0, 10);
+	add_mod(SC_NJ_NEN,             SCM_STR, SCM_SRC_VAL1, 1, 0);
+
+	// AGI (after Concentration)
+	add_mod(SC_INCALLSTATUS,       SCM_AGI, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INCAGI,             SCM_AGI, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_AGI,           SCM_AGI, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_AGI_CASH,      SCM_AGI, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_SOULCOLD,           SCM_AGI, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_TRUESIGHT,          SCM_AGI, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_INC_AGI,            SCM_AGI, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_GS_ACCURACY,        SCM_AGI, SCM_SRC_NONE, 0, 4); // added based on skill updates [Reddozen]
+	add_mod(SC_DEC_AGI,            SCM_AGI, SCM_SRC_VAL2, -1, 0);
+	add_mod(SC_QUAGMIRE,           SCM_AGI, SCM_SRC_VAL2, -1, 0);
+	add_mod(SC_ADORAMUS,           SCM_AGI, SCM_SRC_VAL2, -1, 0);
+	add_mod(SC_DROCERA_HERB_STEAMED, SCM_AGI, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INSPIRATION,        SCM_AGI, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_STOMACHACHE,        SCM_AGI, SCM_SRC_VAL1, -1, 0);
+	add_mod(SC_KYOUGAKU,           SCM_AGI, SCM_SRC_VAL3, -1, 0);
+
+	// VIT
+	add_mod(SC_INCALLSTATUS,       SCM_VIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INCVIT,             SCM_VIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_VIT,           SCM_VIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_VIT_CASH,      SCM_VIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_HLIF_CHANGE,        SCM_VIT, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_GLORYWOUNDS,        SCM_VIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_TRUESIGHT,          SCM_VIT, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_LAUDAAGNUS,         SCM_VIT, SCM_SRC_VAL1, 1, 4);
+	add_mod(SC_MINOR_BBQ,          SCM_VIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INSPIRATION,        SCM_VIT, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_STOMACHACHE,        SCM_VIT, SCM_SRC_VAL1, -1, 0);
+	add_mod(SC_KYOUGAKU,           SCM_VIT, SCM_SRC_VAL3, -1, 0);
+
+	// INT (before Blessing)
+	add_mod(SC_MELODYOFSINK,       SCM_INT, SCM_SRC_VAL3, -1, 0);
+	add_mod(SC_INCALLSTATUS,       SCM_INT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INCINT,             SCM_INT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_INT,           SCM_INT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_INT_CASH,      SCM_INT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_HLIF_CHANGE,        SCM_INT, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_GDSKILL_BATTLEORDER,SCM_INT, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_TRUESIGHT,          SCM_INT, SCM_SRC_NONE, 0, 5);
+
+	// DEX (after Concentration, before Blessing)
+	add_mod(SC_INCALLSTATUS,       SCM_DEX, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INCDEX,             SCM_DEX, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_DEX,           SCM_DEX, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_DEX_CASH,      SCM_DEX, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_GDSKILL_BATTLEORDER,SCM_DEX, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_HAWKEYES,           SCM_DEX, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_TRUESIGHT,          SCM_DEX, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_QUAGMIRE,           SCM_DEX, SCM_SRC_VAL2, -1, 0);
+
+	// LUK
+	add_mod(SC_INCALLSTATUS,       SCM_LUK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INCLUK,             SCM_LUK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_LUK,           SCM_LUK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_LUK_CASH,      SCM_LUK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_TRUESIGHT,          SCM_LUK, SCM_SRC_NONE, 0, 5);
+	add_mod(SC_GLORIA,             SCM_LUK, SCM_SRC_NONE, 0, 30);
+	add_mod(SC_PUTTI_TAILS_NOODLES,SCM_LUK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INSPIRATION,        SCM_LUK, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_STOMACHACHE,        SCM_LUK, SCM_SRC_VAL1, -1, 0);
+	add_mod(SC_KYOUGAKU,           SCM_LUK, SCM_SRC_VAL3, -1, 0);
+	add_mod(SC_LAUDARAMUS,         SCM_LUK, SCM_SRC_VAL1, 1, 4);
+
+	// HIT (before rate modifiers)
+	add_mod(SC_INCHIT,             SCM_HIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_MTF_HITFLEE,        SCM_HIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_FOOD_BASICHIT,      SCM_HIT, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_TRUESIGHT,          SCM_HIT, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_HUMMING,            SCM_HIT, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_LKCONCENTRATION,    SCM_HIT, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_INSPIRATION,        SCM_HIT, SCM_SRC_VAL1, 5, 25);
+	add_mod(SC_GS_ADJUSTMENT,      SCM_HIT, SCM_SRC_NONE, 0, -30);
+	add_mod(SC_GS_ACCURACY,        SCM_HIT, SCM_SRC_NONE, 0, 20); // RockmanEXE; changed based on updated [Reddozen]
+	add_mod(SC_MER_HIT,            SCM_HIT, SCM_SRC_VAL2, 1, 0);
+
+	// FLEE (before rate modifiers)
+	add_mod(SC_INCFLEE,            SCM_FLEE, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_MTF_HITFLEE,        SCM_FLEE, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_FOOD_BASICAVOIDANCE,SCM_FLEE, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_WHISTLE,            SCM_FLEE, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_WINDWALK,           SCM_FLEE, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_VIOLENTGALE,        SCM_FLEE, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_MOON_COMFORT,       SCM_FLEE, SCM_SRC_VAL2, 1, 0); //SG skill [Komurka]
+	add_mod(SC_RG_CCONFINE_M,      SCM_FLEE, SCM_SRC_NONE, 0, 10);
+	add_mod(SC_ANGRIFFS_MODUS,     SCM_FLEE, SCM_SRC_VAL3, -1, 0);
+	add_mod(SC_GS_ADJUSTMENT,      SCM_FLEE, SCM_SRC_NONE, 0, 30);
+	add_mod(SC_HLIF_SPEED,         SCM_FLEE, SCM_SRC_VAL1, 10, 10);
+	add_mod(SC_GS_GATLINGFEVER,    SCM_FLEE, SCM_SRC_VAL4, -1, 0);
+	add_mod(SC_PARTYFLEE,          SCM_FLEE, SCM_SRC_VAL1, 10, 0);
+	add_mod(SC_MER_FLEE,           SCM_FLEE, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_HALLUCINATIONWALK,  SCM_FLEE, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_WATER_BARRIER,      SCM_FLEE, SCM_SRC_VAL3, -1, 0);
+#ifdef RENEWAL
+	add_mod(SC_SPEARQUICKEN,       SCM_FLEE, SCM_SRC_VAL1, 2, 0);
+#endif
+
+	// FLEE2 (before rate modifiers)
+	add_mod(SC_PLUSAVOIDVALUE,     SCM_FLEE2, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_WHISTLE,            SCM_FLEE2, SCM_SRC_VAL3, 10, 0);
+
+	// CRITICAL (before Cloaking)
+	add_mod(SC_CRITICALPERCENT,    SCM_CRITICAL, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_EXPLOSIONSPIRITS,   SCM_CRITICAL, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_FORTUNE,            SCM_CRITICAL, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_TRUESIGHT,          SCM_CRITICAL, SCM_SRC_VAL2, 1, 0);
+
+	// BATK (viewable, before Fire Insignia)
+#ifndef RENEWAL
+	add_mod(SC_PLUSATTACKPOWER,    SCM_BATK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_GS_MADNESSCANCEL,   SCM_BATK, SCM_SRC_NONE, 0, 100);
+	add_mod(SC_GS_GATLINGFEVER,    SCM_BATK, SCM_SRC_VAL3, 1, 0);
+#endif
+	add_mod(SC_BATKFOOD,           SCM_BATK, SCM_SRC_VAL1, 1, 0);
+
+	// WATK (viewable, before rate modifiers)
+#ifndef RENEWAL
+	add_mod(SC_IMPOSITIO,          SCM_WATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_DRUMBATTLE,         SCM_WATK, SCM_SRC_VAL2, 1, 0);
+#endif
+	add_mod(SC_WATKFOOD,           SCM_WATK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_VOLCANO,            SCM_WATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_MER_ATK,            SCM_WATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_FIGHTINGSPIRIT,     SCM_WATK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_INSPIRATION,        SCM_WATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_TROPIC_OPTION,      SCM_WATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_HEATER_OPTION,      SCM_WATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_PYROTECHNIC_OPTION, SCM_WATK, SCM_SRC_VAL2, 1, 0);
+
+	// WATK rates (after Gain ATK Rate)
+	add_mod(SC_PROVOKE,            SCM_WATK_RATE, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_SKE,                SCM_WATK_RATE, SCM_SRC_NONE, 0, 300);
+	add_mod(SC_HLIF_FLEET,         SCM_WATK_RATE, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_CURSE,              SCM_WATK_RATE, SCM_SRC_NONE, 0, -25);
+
+	// MATK (equipment MATK in renewal, viewable MATK otherwise; before Fire Insignia)
+	add_mod(SC_PLUSMAGICPOWER,     SCM_MATK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_MATKFOOD,           SCM_MATK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_MANA_PLUS,          SCM_MATK, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_AQUAPLAY_OPTION,    SCM_MATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_CHILLY_AIR_OPTION,  SCM_MATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_COOLER_OPTION,      SCM_MATK, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_ODINS_POWER,        SCM_MATK, SCM_SRC_VAL1, 30, 40); //70 lvl1, 100lvl2
+	add_mod(SC_IZAYOI,             SCM_MATK, SCM_SRC_VAL1, 25, 0);
+
+	// MATK rates (after Magic Power)
+	add_mod(SC_INCMATKRATE,        SCM_MATK_RATE, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_MOONLIT_SERENADE,   SCM_MATK_RATE, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_MTF_MATK,           SCM_MATK_RATE, SCM_SRC_NONE, 0, 25);
+
+	// HIT rates
+	add_mod(SC_INCHITRATE,         SCM_HIT_RATE, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_BLIND,              SCM_HIT_RATE, SCM_SRC_NONE, 0, -25);
+	add_mod(SC_FIRE_EXPANSION_TEAR_GAS, SCM_HIT_RATE, SCM_SRC_NONE, 0, -50);
+	add_mod(SC__GROOMY,            SCM_HIT_RATE, SCM_SRC_VAL3, -1, 0);
+	add_mod(SC_FEAR,               SCM_HIT_RATE, SCM_SRC_NONE, 0, -20);
+
+	// FLEE rates (after Spider Web)
+	add_mod(SC_BERSERK,            SCM_FLEE_RATE, SCM_SRC_NONE, 0, -50);
+	add_mod(SC_BLIND,              SCM_FLEE_RATE, SCM_SRC_NONE, 0, -25);
+	add_mod(SC_FEAR,               SCM_FLEE_RATE, SCM_SRC_NONE, 0, -20);
+	add_mod(SC_PARALYSE,           SCM_FLEE_RATE, SCM_SRC_NONE, 0, -10);
+	add_mod(SC_INFRAREDSCAN,       SCM_FLEE_RATE, SCM_SRC_NONE, 0, -30);
+	add_mod(SC__LAZINESS,          SCM_FLEE_RATE, SCM_SRC_VAL3, -1, 0);
+	add_mod(SC_GLOOMYDAY,          SCM_FLEE_RATE, SCM_SRC_VAL1, -5, -20);
+	add_mod(SC_SATURDAY_NIGHT_FEVER, SCM_FLEE_RATE, SCM_SRC_VAL1, -10, -40);
+	add_mod(SC_FIRE_EXPANSION_SMOKE_POWDER, SCM_FLEE_RATE, SCM_SRC_NONE, 0, 20);
+	add_mod(SC_FIRE_EXPANSION_TEAR_GAS, SCM_FLEE_RATE, SCM_SRC_NONE, 0, -50);
+	add_mod(SC_WIND_STEP_OPTION,   SCM_FLEE_RATE, SCM_SRC_VAL2, 1, 0);
+
+	// DEF (viewable, before Stone and Freeze)
+	add_mod(SC_STONEHARDSKIN,      SCM_DEF, SCM_SRC_VAL1, 1, 0);
+	add_mod(SC_DRUMBATTLE,         SCM_DEF, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_STONESKIN,          SCM_DEF, SCM_SRC_VAL2, 1, 0);
+	add_mod(SC_HAMI_DEFENCE,       SCM_DEF, SCM_SRC_VAL2, 1, 0); //[orn]
+	add_mod(SC_ODINS_POWER,        SCM_DEF, SCM_SRC_NONE, 0, -20);
+
+	// DEF rates (after Provoke)
+	add_mod(SC_NOEQUIPSHIELD,      SCM_DEF_RATE, SCM_SRC_VAL2, -1, 0);
+	add_mod(SC_FLING,              SCM_DEF_RATE, SCM_SRC_VAL2, -1, 0);
+	add_mod(SC_ANALYZE,            SCM_DEF_RATE, SCM_SRC_VAL1, -14, 0);
+	add_mod(SC_SATURDAY_NIGHT_FEVER, SCM_DEF_RATE, SCM_SRC_VAL1, -10, -10);
+	add_mod(SC_EARTHDRIVE,         SCM_DEF_RATE, SCM_SRC_NONE, 0, -25);
+	add_mod(SC_ROCK_CRUSHER,       SCM_DEF_RATE, SCM_SRC_VAL2, -1, 0);
+	add_mod(SC_FROSTMISTY,         SCM_DEF_RATE, SCM_SRC_NONE, 0, -10);
+
+	// DEF2 (viewable, before Banding)
+	add_mod(SC_SUN_COMFORT,        SCM_DEF2, SCM_SRC_VAL2, 1, 0);
+
+	// DEF2 rates (after Angelus)
+	add_mod(SC_POISON,             SCM_DEF2_RATE, SCM_SRC_NONE, 0, -25);
+	add_mod(SC_DPOISON,            SCM_DEF2_RATE, SCM_SRC_NONE, 0, -25);
+	add_mod(SC_SKE,                SCM_DEF2_RATE, SCM_SRC_NONE, 0, -50);
+	add_mod(SC_PROVOKE,            SCM_DEF2_RATE, SCM_SRC_VAL4, -1, 0);
+
+	// MDEF (viewable, before Earth Insignia)
+	add_mod(SC_STONESKIN,          SCM_MDEF, SCM_SRC_VAL3, 1, 0);
+	add_mod(SC_STONEHARDSKIN,      SCM_MDEF, SCM_SRC_VAL1, 1, 0); // Final MDEF increase divided by 10 since were using classic (pre-renewal) mechanics. [Rytech]
+#undef add_mod
+
+	// group by stat (bucket sort, keeping the listed order within a stat)
+	memset(status->dbs->sc_mod_stat_start, 0, sizeof(status->dbs->sc_mod_stat_start));
+	for (i = 0; i < status->dbs->sc_mod_count; i++)
+		status->dbs->sc_mod_stat_start[status->dbs->sc_mods[i].stat + 1]++;
+	for (i = 0; i < SCM_MAX; i++)
+		status->dbs->sc_mod_stat_start[i + 1] += status->dbs->sc_mod_stat_start[i];
+	{
+		int next[SCM_MAX];
+		memcpy(next, status->dbs->sc_mod_stat_start, sizeof(next));
+		for (i = 0; i < status->dbs->sc_mod_count; i++)
+			status->dbs->sc_mods_by_type[next[status->dbs->sc_mods[i].stat]++] = status->dbs->sc_mods[i];
+		memcpy(status->dbs->sc_mods, status->dbs->sc_mods_by_type, sizeof(status->dbs->sc_mods[0]) * status->dbs->sc_mod_count);
+	}
+	for (i = 0; i < status->dbs->sc_mod_count; i++)
+		status->dbs->sc_mods[i].order = i;
+	for (i = SCM_RATE_START; i < SCM_MAX; i++)
+		Assert_retv(status->dbs->sc_mod_stat_start[i + 1] - status->dbs->sc_mod_stat_start[i] <= MAX_SC_MOD_RATES);
+
+	// group by status change, so that a unit's active status changes find their modifiers directly
+	memcpy(status->dbs->sc_mods_by_type, status->dbs->sc_mods, sizeof(status->dbs->sc_mods[0]) * status->dbs->sc_mod_count);
+	qsort(status->dbs->sc_mods_by_type, status->dbs->sc_mod_count, sizeof(status->dbs->sc_mods_by_type[0]), status_sc_mod_cmp);
+	memset(status->dbs->sc_mod_slot, 0, sizeof(status->dbs->sc_mod_slot));
+	status->dbs->sc_mod_type_count = 0;
+	for (i = 0; i < status->dbs->sc_mod_count; i++) {
+		sc_type type = status->dbs->sc_mods_by_type[i].type;
+		if (status->dbs->sc_mod_slot[type] != 0)
+			continue;
+		Assert_retv(status->dbs->sc_mod_type_count < MAX_SC_MOD_TYPES);
+		status->dbs->sc_mod_type_start[status->dbs->sc_mod_type_count] = i;
+		status->dbs->sc_mod_type_stats[status->dbs->sc_mod_type_count] = 0;
+		status->dbs->sc_mod_slot[type] = ++status->dbs->sc_mod_type_count;
+	}
+	status->dbs->sc_mod_type_start[status->dbs->sc_mod_type_count] = status->dbs->sc_mod_count;
+	for (i = 0; i < status->dbs->sc_mod_count; i++) {
+		const struct sc_modifier *mod = &status->dbs->sc_mods_by_type[i];
+		status->dbs->sc_mod_type_stats[status->dbs->sc_mod_slot[mod->type] - 1] |= 1U << mod->stat;
+	}
+}
+
 void initDummyData(void)
 {
 	memset(&status->dummy, 0, sizeof(status->dummy));
@@ -2160,6 +2458,8 @@ int status_calc_pc_(struct map_session_data* sd, enum e_status_calc_opt opt) {
 	if (++calculating > 10) //Too many recursive calls!
 		return -1;
 
+	status->pc_calc_full++;
+
 	// remember player-specific values that are currently being shown to the client (for refresh purposes)
 	memcpy(b_skill, &sd->status.skill, sizeof(b_skill));
 	b_weight = sd->weight;
@@ -2808,10 +3108,11 @@ int status_calc_pc_(struct map_session_data* sd, enum e_status_calc_opt opt) {
 		sd->max_weight += 10000;
 	else if(pc_isridingdragon(sd))
 		sd->max_weight += 5000+2000*pc->checkskill(sd,RK_DRAGONTRAINING);
-	if(sc->data[SC_KNOWLEDGE])
-		sd->max_weight += sd->max_weight*sc->data[SC_KNOWLEDGE]->val1/10;
+	// SC_KNOWLEDGE and the bonuses after it are applied by status->calc_pc_sc_bonus
+	sd->sc_layer.max_weight = sd->max_weight;
+	sd->sc_layer.max_weight_add = 0;
 	if((skill_lv=pc->checkskill(sd,ALL_INCCARRY))>0)
-		sd->max_weight += 2000*skill_lv;
+		sd->sc_layer.max_weight_add += 2000*skill_lv;
 
 	sd->cart_weight_max = battle_config.max_cart_weight + (pc->checkskill(sd, GN_REMODELING_CART)*5000);
 
@@ -2823,12 +3124,7 @@ int status_calc_pc_(struct map_session_data* sd, enum e_status_calc_opt opt) {
 	// Skill SP cost
 	if((skill_lv=pc->checkskill(sd,HP_MANARECHARGE))>0 )
 		sd->dsprate -= 4*skill_lv;
-
-	if(sc->data[SC_SERVICEFORYOU])
-		sd->dsprate -= sc->data[SC_SERVICEFORYOU]->val3;
-
-	if(sc->data[SC_ATKER_BLOOD])
-		sd->dsprate -= sc->data[SC_ATKER_BLOOD]->val1;
+	sd->sc_layer.dsprate = sd->dsprate; // status change reductions are applied by status->calc_pc_sc_bonus
 
 	//Underflow protections.
 	if(sd->dsprate < 0)
@@ -2884,6 +3180,84 @@ int status_calc_pc_(struct map_session_data* sd, enum e_status_calc_opt opt) {
 		sd->subele[ELE_DARK] += skill_lv;
 	}
 
+	// Everything above only changes on a full recalculation; status changes are applied on top of it
+	memcpy(sd->sc_layer.subele, sd->subele, sizeof(sd->sc_layer.subele));
+	memcpy(sd->sc_layer.magic_addele, sd->magic_addele, sizeof(sd->sc_layer.magic_addele));
+#ifdef RENEWAL
+	sd->sc_layer.subrace_demon = sd->race_tolerance[RC_DEMON];
+#else
+	sd->sc_layer.subrace_demon = sd->subrace[RC_DEMON];
+#endif
+	sd->sc_layer.valid = true;
+	status->calc_pc_sc_bonus(sd);
+
+	status_cpy(&sd->battle_status, bstatus);
+
+	// ----- CLIENT-SIDE REFRESH -----
+	if(!sd->bl.prev) {
+		//Will update on LoadEndAck
+		calculating = 0;
+		return 0;
+	}
+	if(memcmp(b_skill,sd->status.skill,sizeof(sd->status.skill)))
+		clif->skillinfoblock(sd);
+	if(b_weight != sd->weight)
+		clif->updatestatus(sd,SP_WEIGHT);
+	if(b_max_weight != sd->max_weight) {
+		clif->updatestatus(sd,SP_MAXWEIGHT);
+		pc->updateweightstatus(sd);
+	}
+	if( b_cart_weight_max != sd->cart_weight_max ) {
+		clif->updatestatus(sd,SP_CARTINFO);
+	}
+
+	calculating = 0;
+
+	return 0;
+}
+
+/**
+ * Applies the status change dependent part of a player's bonuses.
+ *
+ * status_calc_pc_ stores the values these bonuses are applied to in
+ * sd->sc_layer, so that a status change which only affects them (see
+ * status->dbs->PCLayerTable) can be started or ended without rerunning the
+ * equipment, card and skill calculations.
+ *
+ * @param sd Player to update.
+ */
+void status_calc_pc_sc_bonus(struct map_session_data *sd)
+{
+	const struct status_change *sc;
+	int i;
+
+	nullpo_retv(sd);
+	sc = &sd->sc;
+
+	memcpy(sd->subele, sd->sc_layer.subele, sizeof(sd->subele));
+	memcpy(sd->magic_addele, sd->sc_layer.magic_addele, sizeof(sd->magic_addele));
+#ifdef RENEWAL
+	sd->race_tolerance[RC_DEMON] = sd->sc_layer.subrace_demon;
+#else
+	sd->subrace[RC_DEMON] = sd->sc_layer.subrace_demon;
+#endif
+
+	// Weight
+	sd->max_weight = sd->sc_layer.max_weight;
+	if(sc->data[SC_KNOWLEDGE])
+		sd->max_weight += sd->max_weight*sc->data[SC_KNOWLEDGE]->val1/10;
+	sd->max_weight += sd->sc_layer.max_weight_add;
+
+	// Skill SP cost
+	sd->dsprate = sd->sc_layer.dsprate;
+	if(sc->data[SC_SERVICEFORYOU])
+		sd->dsprate -= sc->data[SC_SERVICEFORYOU]->val3;
+	if(sc->data[SC_ATKER_BLOOD])
+		sd->dsprate -= sc->data[SC_ATKER_BLOOD]->val1;
+	if(sd->dsprate < 0)
+		sd->dsprate = 0;
+
+	// Anti-element and anti-race
 	if(sc->count) {
 		if(sc->data[SC_CONCENTRATION]) { //Update the card-bonus data
 			sc->data[SC_CONCENTRATION]->val3 = sd->param_bonus[1]; //Agi
@@ -2953,29 +3327,33 @@ int status_calc_pc_(struct map_session_data* sd, enum e_status_calc_opt opt) {
 		if( sc->data[SC_EARTH_INSIGNIA] && sc->data[SC_EARTH_INSIGNIA]->val1 == 3 )
 			sd->magic_addele[ELE_EARTH] += 25;
 	}
-	status_cpy(&sd->battle_status, bstatus);
+}
 
-	// ----- CLIENT-SIDE REFRESH -----
-	if(!sd->bl.prev) {
-		//Will update on LoadEndAck
-		calculating = 0;
-		return 0;
-	}
-	if(memcmp(b_skill,sd->status.skill,sizeof(sd->status.skill)))
-		clif->skillinfoblock(sd);
-	if(b_weight != sd->weight)
-		clif->updatestatus(sd,SP_WEIGHT);
-	if(b_max_weight != sd->max_weight) {
+/**
+ * Reapplies a player's status change bonuses on top of the bonuses stored by
+ * the last full status_calc_pc_ (see status->calc_pc_sc_bonus).
+ *
+ * @param sd Player to update.
+ * @retval true  the partial recalculation was done.
+ * @retval false there is no full calculation to build on, status_calc_pc_ must be used.
+ */
+bool status_calc_pc_partial(struct map_session_data *sd)
+{
+	unsigned int b_max_weight;
+
+	nullpo_retr(false, sd);
+	if (!sd->sc_layer.valid)
+		return false;
+
+	status->pc_calc_partial++;
+	b_max_weight = sd->max_weight;
+	status->calc_pc_sc_bonus(sd);
+
+	if (sd->bl.prev != NULL && b_max_weight != sd->max_weight) {
 		clif->updatestatus(sd,SP_MAXWEIGHT);
 		pc->updateweightstatus(sd);
 	}
-	if( b_cart_weight_max != sd->cart_weight_max ) {
-		clif->updatestatus(sd,SP_CARTINFO);
-	}
-
-	calculating = 0;
-
-	return 0;
+	return true;
 }
 
 int status_calc_mercenary_(struct mercenary_data *md, enum e_status_calc_opt opt) {
@@ -3338,6 +3716,158 @@ void status_calc_regen_rate(struct block_list *bl, struct regen_data *regen, str
 	if(sc->data[SC_VITATA_500])
 		regen->rate.sp += regen->rate.sp * sc->data[SC_VITATA_500]->val1/100;
 }
+
+/// Value of a modifier for a status change entry: a flat bonus or a percentage.
+static inline int status_sc_mod_value(const struct sc_modifier *mod, const struct status_change_entry *sce)
+{
+	switch (mod->source) {
+		case SCM_SRC_VAL1: return mod->bonus + mod->rate * sce->val1;
+		case SCM_SRC_VAL2: return mod->bonus + mod->rate * sce->val2;
+		case SCM_SRC_VAL3: return mod->bonus + mod->rate * sce->val3;
+		case SCM_SRC_VAL4: return mod->bonus + mod->rate * sce->val4;
+		case SCM_SRC_NONE: break;
+	}
+	return mod->bonus;
+}
+
+/// Inserts a percentage into a rate stat's list, keeping the listed order of the table.
+static inline void status_sc_mod_rate_insert(struct sc_mod_rates *rates, int order, int value)
+{
+	int i = rates->count;
+
+	Assert_retv(rates->count < MAX_SC_MOD_RATES);
+	for (; i > 0 && rates->order[i-1] > order; i--) {
+		rates->order[i] = rates->order[i-1];
+		rates->value[i] = rates->value[i-1];
+	}
+	rates->order[i] = order;
+	rates->value[i] = value;
+	rates->count++;
+}
+
+/**
+ * Returns the flat bonus of the active status changes for a stat.
+ *
+ * Walks whichever list is shorter: the stat's entries of the table, or the
+ * unit's active status changes that have modifiers (sc->mod_active),
+ * skipping those that don't modify the stat.
+ *
+ * @param sc   Status changes of the unit.
+ * @param stat Flat stat to sum.
+ * @return the sum of the stat's modifiers.
+ */
+int status_sc_mod_get(struct status_change *sc, enum sc_mod_stat stat)
+{
+	int i, j, value = 0;
+
+	Assert_ret(stat >= 0 && stat < SCM_RATE_START);
+	if (sc == NULL || sc->mod_count == 0)
+		return 0;
+
+	if (status->dbs->sc_mod_stat_start[stat+1] - status->dbs->sc_mod_stat_start[stat] <= sc->mod_count) {
+		for (i = status->dbs->sc_mod_stat_start[stat]; i < status->dbs->sc_mod_stat_start[stat+1]; i++) {
+			const struct sc_modifier *mod = &status->dbs->sc_mods[i];
+			if (sc->data[mod->type] != NULL)
+				value += status_sc_mod_value(mod, sc->data[mod->type]);
+		}
+		return value;
+	}
+
+	for (i = 0; i < sc->mod_count; i++) {
+		int slot = sc->mod_active[i];
+		const struct status_change_entry *sce;
+
+		if (!(status->dbs->sc_mod_type_stats[slot]&(1U << stat)))
+			continue;
+		if ((sce = sc->data[status->dbs->sc_mods_by_type[status->dbs->sc_mod_type_start[slot]].type]) == NULL)
+			continue;
+		for (j = status->dbs->sc_mod_type_start[slot]; j < status->dbs->sc_mod_type_start[slot+1]; j++) {
+			if (status->dbs->sc_mods_by_type[j].stat == stat)
+				value += status_sc_mod_value(&status->dbs->sc_mods_by_type[j], sce);
+		}
+	}
+	return value;
+}
+
+/**
+ * Applies the percentages of the active status changes for a rate stat.
+ *
+ * Each percentage is applied as `value += value * percentage / 100`, in the
+ * order the table lists them, which is the order the status_calc_* function
+ * used to apply them in. The lists are walked as in status_sc_mod_get.
+ *
+ * @param sc    Status changes of the unit.
+ * @param stat  Rate stat to apply.
+ * @param value Value to modify.
+ * @return the modified value.
+ */
+int status_sc_mod_rate(struct status_change *sc, enum sc_mod_stat stat, int value)
+{
+	struct sc_mod_rates rates;
+	int i, j;
+
+	Assert_retr(value, stat >= SCM_RATE_START && stat < SCM_MAX);
+	if (sc == NULL || sc->mod_count == 0)
+		return value;
+
+	if (status->dbs->sc_mod_stat_start[stat+1] - status->dbs->sc_mod_stat_start[stat] <= sc->mod_count) {
+		// the table lists a stat's entries by order
+		for (i = status->dbs->sc_mod_stat_start[stat]; i < status->dbs->sc_mod_stat_start[stat+1]; i++) {
+			const struct sc_modifier *mod = &status->dbs->sc_mods[i];
+			if (sc->data[mod->type] != NULL)
+				value += value * status_sc_mod_value(mod, sc->data[mod->type]) / 100;
+		}
+		return value;
+	}
+
+	rates.count = 0;
+	for (i = 0; i < sc->mod_count; i++) {
+		int slot = sc->mod_active[i];
+		const struct status_change_entry *sce;
+
+		if (!(status->dbs->sc_mod_type_stats[slot]&(1U << stat)))
+			continue;
+		if ((sce = sc->data[status->dbs->sc_mods_by_type[status->dbs->sc_mod_type_start[slot]].type]) == NULL)
+			continue;
+		for (j = status->dbs->sc_mod_type_start[slot]; j < status->dbs->sc_mod_type_start[slot+1]; j++) {
+			const struct sc_modifier *mod = &status->dbs->sc_mods_by_type[j];
+			if (mod->stat == stat)
+				status_sc_mod_rate_insert(&rates, mod->order, status_sc_mod_value(mod, sce));
+		}
+	}
+
+	for (i = 0; i < rates.count; i++)
+		value += value * rates.value[i] / 100;
+	return value;
+}
+
+/**
+ * Adds a status change to, or removes it from, the unit's list of active
+ * status changes that have modifiers, according to whether sc->data[type]
+ * is set. Must be called whenever sc->data[type] is set or cleared.
+ *
+ * @param sc   Status changes of the unit.
+ * @param type Status change that started or ended.
+ */
+void status_sc_mod_update(struct status_change *sc, sc_type type)
+{
+	int slot, i;
+
+	nullpo_retv(sc);
+	Assert_retv(type >= 0 && type < SC_MAX);
+	if ((slot = status->dbs->sc_mod_slot[type]) == 0)
+		return;
+	slot--;
+
+	ARR_FIND(0, sc->mod_count, i, sc->mod_active[i] == slot);
+	if (sc->data[type] != NULL) {
+		if (i == sc->mod_count)
+			sc->mod_active[sc->mod_count++] = (unsigned char)slot;
+	} else if (i < sc->mod_count) {
+		sc->mod_active[i] = sc->mod_active[--sc->mod_count];
+	}
+}
+
 /// Recalculates parts of an object's battle status according to the specified flags.
 /// @param flag bitfield of values from enum scb_flag
 void status_calc_bl_main(struct block_list *bl, /*enum scb_flag*/int flag) {
@@ -3731,7 +4261,10 @@ void status_calc_bl_(struct block_list *bl, enum scb_flag flag, enum e_status_ca
 
 	if( flag&SCB_BASE ) {// calculate the object's base status too
 		switch( bl->type ) {
-			case BL_PC:   status->calc_pc_(BL_CAST(BL_PC,bl), opt);          break;
+			case BL_PC:
+				if (!(opt&SCO_SC_LAYER) || !status->calc_pc_partial(BL_CAST(BL_PC,bl)))
+					status->calc_pc_(BL_CAST(BL_PC,bl), opt);
+				break;
 			case BL_MOB:  status->calc_mob_(BL_CAST(BL_MOB,bl), opt);        break;
 			case BL_PET:  status->calc_pet_(BL_CAST(BL_PET,bl), opt);        break;
 			case BL_HOM:  status->calc_homunculus_(BL_CAST(BL_HOM,bl), opt); break;
@@ -4147,28 +4680,7 @@ unsigned short status_calc_str(struct block_list *bl, struct status_change *sc,
 		str -= sc->data[SC_HARMONIZE]->val2;
 		return (unsigned short)cap_value(str,0,USHRT_MAX);
 	}
-	if(sc->data[SC_BEYOND_OF_WARCRY])
-		str += sc->data[SC_BEYOND_OF_WARCRY]->val3;
-	if(sc->data[SC_INCALLSTATUS])
-		str += sc->data[SC_INCALLSTATUS]->val1;
-	if(sc->data[SC_CHASEWALK2])
-		str += sc->data[SC_CHASEWALK2]->val1;
-	if(sc->data[SC_FOOD_STR])
-		str += sc->data[SC_FOOD_STR]->val1;
-	if(sc->data[SC_FOOD_STR_CASH])
-		str += sc->data[SC_FOOD_STR_CASH]->val1;
-	if(sc->data[SC_GDSKILL_BATTLEORDER])
-		str += 5;
-	if(sc->data[SC_LEADERSHIP])
-		str += sc->data[SC_LEADERSHIP]->val1;
-	if(sc->data[SC_SHOUT])
-		str += 4;
-	if(sc->data[SC_TRUESIGHT])
-		str += 5;
-	if(sc->data[SC_STRUP])
-		str += 10;
-	if(sc->data[SC_NJ_NEN])
-		str += sc->data[SC_NJ_NEN]->val1;
+	str += status->sc_mod_get(sc, SCM_STR);
 	if(sc->data[SC_BLESSING]){
 		if(sc->data[SC_BLESSING]->val2)
 			str += sc->data[SC_BLESSING]->val2;
@@ -4208,26 +4720,7 @@ unsigned short status_calc_agi(struct block_list *bl, struct status_change *sc,
 	}
 	if(sc->data[SC_CONCENTRATION] && !sc->data[SC_QUAGMIRE])
 		agi += (agi-sc->data[SC_CONCENTRATION]->val3)*sc->data[SC_CONCENTRATION]->val2/100;
-	if(sc->data[SC_INCALLSTATUS])
-		agi += sc->data[SC_INCALLSTATUS]->val1;
-	if(sc->data[SC_INCAGI])
-		agi += sc->data[SC_INCAGI]->val1;
-	if(sc->data[SC_FOOD_AGI])
-		agi += sc->data[SC_FOOD_AGI]->val1;
-	if(sc->data[SC_FOOD_AGI_CASH])
-		agi += sc->data[SC_FOOD_AGI_CASH]->val1;
-	if(sc->data[SC_SOULCOLD])
-		agi += sc->data[SC_SOULCOLD]->val1;
-	if(sc->data[SC_TRUESIGHT])
-		agi += 5;
-	if(sc->data[SC_INC_AGI])
-		agi += sc->data[SC_INC_AGI]->val2;
-	if(sc->data[SC_GS_ACCURACY])
-		agi += 4; // added based on skill updates [Reddozen]
-	if(sc->data[SC_DEC_AGI])
-		agi -= sc->data[SC_DEC_AGI]->val2;
-	if(sc->data[SC_QUAGMIRE])
-		agi -= sc->data[SC_QUAGMIRE]->val2;
+	agi += status->sc_mod_get(sc, SCM_AGI);
 	if(sc->data[SC_NJ_SUITON] && sc->data[SC_NJ_SUITON]->val3)
 		agi -= sc->data[SC_NJ_SUITON]->val2;
 	if(sc->data[SC_MARIONETTE_MASTER])
@@ -4236,16 +4729,6 @@ unsigned short status_calc_agi(struct block_list *bl, struct status_change *sc,
 		agi += ((sc->data[SC_MARIONETTE]->val3)>>8)&0xFF;
 	if(sc->data[SC_SOULLINK] && sc->data[SC_SOULLINK]->val2 == SL_HIGH)
 		agi += ((sc->data[SC_SOULLINK]->val3)>>8)&0xFF;
-	if(sc->data[SC_ADORAMUS])
-		agi -= sc->data[SC_ADORAMUS]->val2;
-	if(sc->data[SC_DROCERA_HERB_STEAMED])
-		agi += sc->data[SC_DROCERA_HERB_STEAMED]->val1;
-	if(sc->data[SC_INSPIRATION])
-		agi += sc->data[SC_INSPIRATION]->val3;
-	if(sc->data[SC_STOMACHACHE])
-		agi -= sc->data[SC_STOMACHACHE]->val1;
-	if(sc->data[SC_KYOUGAKU])
-		agi -= sc->data[SC_KYOUGAKU]->val3;
 
 	if(sc->data[SC_MARSHOFABYSS])
 		agi -= agi * sc->data[SC_MARSHOFABYSS]->val2 / 100;
@@ -4264,36 +4747,13 @@ unsigned short status_calc_vit(struct block_list *bl, struct status_change *sc,
 		vit -= sc->data[SC_HARMONIZE]->val2;
 		return (unsigned short)cap_value(vit,0,USHRT_MAX);
 	}
-	if(sc->data[SC_INCALLSTATUS])
-		vit += sc->data[SC_INCALLSTATUS]->val1;
-	if(sc->data[SC_INCVIT])
-		vit += sc->data[SC_INCVIT]->val1;
-	if(sc->data[SC_FOOD_VIT])
-		vit += sc->data[SC_FOOD_VIT]->val1;
-	if(sc->data[SC_FOOD_VIT_CASH])
-		vit += sc->data[SC_FOOD_VIT_CASH]->val1;
-	if(sc->data[SC_HLIF_CHANGE])
-		vit += sc->data[SC_HLIF_CHANGE]->val2;
-	if(sc->data[SC_GLORYWOUNDS])
-		vit += sc->data[SC_GLORYWOUNDS]->val1;
-	if(sc->data[SC_TRUESIGHT])
-		vit += 5;
+	vit += status->sc_mod_get(sc, SCM_VIT);
 	if(sc->data[SC_MARIONETTE_MASTER])
 		vit -= sc->data[SC_MARIONETTE_MASTER]->val3&0xFF;
 	if(sc->data[SC_MARIONETTE])
 		vit += sc->data[SC_MARIONETTE]->val3&0xFF;
 	if(sc->data[SC_SOULLINK] && sc->data[SC_SOULLINK]->val2 == SL_HIGH)
 		vit += sc->data[SC_SOULLINK]->val3&0xFF;
-	if(sc->data[SC_LAUDAAGNUS])
-		vit += 4 + sc->data[SC_LAUDAAGNUS]->val1;
-	if(sc->data[SC_MINOR_BBQ])
-		vit += sc->data[SC_MINOR_BBQ]->val1;
-	if(sc->data[SC_INSPIRATION])
-		vit += sc->data[SC_INSPIRATION]->val3;
-	if(sc->data[SC_STOMACHACHE])
-		vit -= sc->data[SC_STOMACHACHE]->val1;
-	if(sc->data[SC_KYOUGAKU])
-		vit -= sc->data[SC_KYOUGAKU]->val3;
 
 	if(sc->data[SC_NOEQUIPARMOR])
 		vit -= vit * sc->data[SC_NOEQUIPARMOR]->val2/100;
@@ -4312,22 +4772,7 @@ unsigned short status_calc_int(struct block_list *bl, struct status_change *sc,
 		int_ -= sc->data[SC_HARMONIZE]->val2;
 		return (unsigned short)cap_value(int_,0,USHRT_MAX);
 	}
-	if(sc->data[SC_MELODYOFSINK])
-		int_ -= sc->data[SC_MELODYOFSINK]->val3;
-	if(sc->data[SC_INCALLSTATUS])
-		int_ += sc->data[SC_INCALLSTATUS]->val1;
-	if(sc->data[SC_INCINT])
-		int_ += sc->data[SC_INCINT]->val1;
-	if(sc->data[SC_FOOD_INT])
-		int_ += sc->data[SC_FOOD_INT]->val1;
-	if(sc->data[SC_FOOD_INT_CASH])
-		int_ += sc->data[SC_FOOD_INT_CASH]->val1;
-	if(sc->data[SC_HLIF_CHANGE])
-		int_ += sc->data[SC_HLIF_CHANGE]->val3;
-	if(sc->data[SC_GDSKILL_BATTLEORDER])
-		int_ += 5;
-	if(sc->data[SC_TRUESIGHT])
-		int_ += 5;
+	int_ += status->sc_mod_get(sc, SCM_INT);
 	if(sc->data[SC_BLESSING]){
 		if (sc->data[SC_BLESSING]->val2)
 			int_ += sc->data[SC_BLESSING]->val2;
@@ -4376,22 +4821,7 @@ unsigned short status_calc_dex(struct block_list *bl, struct status_change *sc,
 	}
 	if(sc->data[SC_CONCENTRATION] && !sc->data[SC_QUAGMIRE])
 		dex += (dex-sc->data[SC_CONCENTRATION]->val4)*sc->data[SC_CONCENTRATION]->val2/100;
-	if(sc->data[SC_INCALLSTATUS])
-		dex += sc->data[SC_INCALLSTATUS]->val1;
-	if(sc->data[SC_INCDEX])
-		dex += sc->data[SC_INCDEX]->val1;
-	if(sc->data[SC_FOOD_DEX])
-		dex += sc->data[SC_FOOD_DEX]->val1;
-	if(sc->data[SC_FOOD_DEX_CASH])
-		dex += sc->data[SC_FOOD_DEX_CASH]->val1;
-	if(sc->data[SC_GDSKILL_BATTLEORDER])
-		dex += 5;
-	if(sc->data[SC_HAWKEYES])
-		dex += sc->data[SC_HAWKEYES]->val1;
-	if(sc->data[SC_TRUESIGHT])
-		dex += 5;
-	if(sc->data[SC_QUAGMIRE])
-		dex -= sc->data[SC_QUAGMIRE]->val2;
+	dex += status->sc_mod_get(sc, SCM_DEX);
 	if(sc->data[SC_BLESSING]){
 		if (sc->data[SC_BLESSING]->val2)
 			dex += sc->data[SC_BLESSING]->val2;
@@ -4436,34 +4866,13 @@ unsigned short status_calc_luk(struct block_list *bl, struct status_change *sc,
 	}
 	if(sc->data[SC_CURSE])
 		return 0;
-	if(sc->data[SC_INCALLSTATUS])
-		luk += sc->data[SC_INCALLSTATUS]->val1;
-	if(sc->data[SC_INCLUK])
-		luk += sc->data[SC_INCLUK]->val1;
-	if(sc->data[SC_FOOD_LUK])
-		luk += sc->data[SC_FOOD_LUK]->val1;
-	if(sc->data[SC_FOOD_LUK_CASH])
-		luk += sc->data[SC_FOOD_LUK_CASH]->val1;
-	if(sc->data[SC_TRUESIGHT])
-		luk += 5;
-	if(sc->data[SC_GLORIA])
-		luk += 30;
+	luk += status->sc_mod_get(sc, SCM_LUK);
 	if(sc->data[SC_MARIONETTE_MASTER])
 		luk -= sc->data[SC_MARIONETTE_MASTER]->val4&0xFF;
 	if(sc->data[SC_MARIONETTE])
 		luk += sc->data[SC_MARIONETTE]->val4&0xFF;
 	if(sc->data[SC_SOULLINK] && sc->data[SC_SOULLINK]->val2 == SL_HIGH)
 		luk += sc->data[SC_SOULLINK]->val4&0xFF;
-	if(sc->data[SC_PUTTI_TAILS_NOODLES])
-		luk += sc->data[SC_PUTTI_TAILS_NOODLES]->val1;
-	if(sc->data[SC_INSPIRATION])
-		luk += sc->data[SC_INSPIRATION]->val3;
-	if(sc->data[SC_STOMACHACHE])
-		luk -= sc->data[SC_STOMACHACHE]->val1;
-	if(sc->data[SC_KYOUGAKU])
-		luk -= sc->data[SC_KYOUGAKU]->val3;
-	if(sc->data[SC_LAUDARAMUS])
-		luk += 4 + sc->data[SC_LAUDARAMUS]->val1;
 
 	if(sc->data[SC__STRIPACCESSARY] && bl->type != BL_PC)
 		luk -= luk * sc->data[SC__STRIPACCESSARY]->val2 / 100;
@@ -4483,16 +4892,7 @@ unsigned short status_calc_batk(struct block_list *bl, struct status_change *sc,
 			batk += sc->data[SC_PLUSATTACKPOWER]->val1;
 		return (unsigned short)cap_value(batk,0,USHRT_MAX);
 	}
-#ifndef RENEWAL
-	if(sc->data[SC_PLUSATTACKPOWER])
-		batk += sc->data[SC_PLUSATTACKPOWER]->val1;
-	if(sc->data[SC_GS_MADNESSCANCEL])
-		batk += 100;
-	if(sc->data[SC_GS_GATLINGFEVER])
-		batk += sc->data[SC_GS_GATLINGFEVER]->val3;
-#endif
-	if(sc->data[SC_BATKFOOD])
-		batk += sc->data[SC_BATKFOOD]->val1;
+	batk += status->sc_mod_get(sc, SCM_BATK);
 	if(sc->data[SC_FIRE_INSIGNIA] && sc->data[SC_FIRE_INSIGNIA]->val1 == 2)
 		batk += 50;
 	if(bl->type == BL_ELEM
@@ -4561,32 +4961,11 @@ unsigned short status_calc_watk(struct block_list *bl, struct status_change *sc,
 			watk += sc->data[SC_GENTLETOUCH_CHANGE]->val2;
 		return (unsigned short)cap_value(watk,0,USHRT_MAX);
 	}
-#ifndef RENEWAL
-	if(sc->data[SC_IMPOSITIO])
-		watk += sc->data[SC_IMPOSITIO]->val2;
-	if(sc->data[SC_DRUMBATTLE])
-		watk += sc->data[SC_DRUMBATTLE]->val2;
-#endif
-	if(sc->data[SC_WATKFOOD])
-		watk += sc->data[SC_WATKFOOD]->val1;
-	if(sc->data[SC_VOLCANO])
-		watk += sc->data[SC_VOLCANO]->val2;
-	if(sc->data[SC_MER_ATK])
-		watk += sc->data[SC_MER_ATK]->val2;
-	if(sc->data[SC_FIGHTINGSPIRIT])
-		watk += sc->data[SC_FIGHTINGSPIRIT]->val1;
+	watk += status->sc_mod_get(sc, SCM_WATK);
 	if(sc->data[SC_SHIELDSPELL_DEF] && sc->data[SC_SHIELDSPELL_DEF]->val1 == 3)
 		watk += sc->data[SC_SHIELDSPELL_DEF]->val2;
-	if(sc->data[SC_INSPIRATION])
-		watk += sc->data[SC_INSPIRATION]->val2;
 	if( sc->data[SC_BANDING] && sc->data[SC_BANDING]->val2 > 1 )
 		watk += (10 + 10 * sc->data[SC_BANDING]->val1) * (sc->data[SC_BANDING]->val2);
-	if( sc->data[SC_TROPIC_OPTION] )
-		watk += sc->data[SC_TROPIC_OPTION]->val2;
-	if( sc->data[SC_HEATER_OPTION] )
-		watk += sc->data[SC_HEATER_OPTION]->val2;
-	if( sc->data[SC_PYROTECHNIC_OPTION] )
-		watk += sc->data[SC_PYROTECHNIC_OPTION]->val2;
 
 #ifndef RENEWAL
 	if(sc->data[SC_NIBELUNGEN]) {
@@ -4604,14 +4983,7 @@ unsigned short status_calc_watk(struct block_list *bl, struct status_change *sc,
 #endif
 	if(sc->data[SC_INCATKRATE] && bl->type != BL_MOB)
 		watk += watk * sc->data[SC_INCATKRATE]->val1/100;
-	if(sc->data[SC_PROVOKE])
-		watk += watk * sc->data[SC_PROVOKE]->val3/100;
-	if(sc->data[SC_SKE])
-		watk += watk * 3;
-	if(sc->data[SC_HLIF_FLEET])
-		watk += watk * sc->data[SC_HLIF_FLEET]->val3/100;
-	if(sc->data[SC_CURSE])
-		watk -= watk * 25/100;
+	watk = status->sc_mod_rate(sc, SCM_WATK_RATE, watk);
 #ifndef RENEWAL
 	if(sc->data[SC_NOEQUIPWEAPON] && bl->type != BL_PC)
 		watk -= watk * sc->data[SC_NOEQUIPWEAPON]->val2/100;
@@ -4644,24 +5016,9 @@ unsigned short status_calc_ematk(struct block_list *bl, struct status_change *sc
 
 	if (!sc || !sc->count)
 		return cap_value(matk,0,USHRT_MAX);
-	if (sc->data[SC_PLUSMAGICPOWER])
-		matk += sc->data[SC_PLUSMAGICPOWER]->val1;
-	if (sc->data[SC_MATKFOOD])
-		matk += sc->data[SC_MATKFOOD]->val1;
-	if(sc->data[SC_MANA_PLUS])
-		matk += sc->data[SC_MANA_PLUS]->val1;
-	if(sc->data[SC_AQUAPLAY_OPTION])
-		matk += sc->data[SC_AQUAPLAY_OPTION]->val2;
-	if(sc->data[SC_CHILLY_AIR_OPTION])
-		matk += sc->data[SC_CHILLY_AIR_OPTION]->val2;
-	if(sc->data[SC_COOLER_OPTION])
-		matk += sc->data[SC_COOLER_OPTION]->val2;
+	matk += status->sc_mod_get(sc, SCM_MATK);
 	if(sc->data[SC_FIRE_INSIGNIA] && sc->data[SC_FIRE_INSIGNIA]->val1 == 3)
 		matk += 50;
-	if(sc->data[SC_ODINS_POWER])
-		matk += 40 + 30 * sc->data[SC_ODINS_POWER]->val1; //70 lvl1, 100lvl2
-	if(sc->data[SC_IZAYOI])
-		matk += 25 * sc->data[SC_IZAYOI]->val1;
 	return (unsigned short)cap_value(matk,0,USHRT_MAX);
 #else
 	return 0;
@@ -4681,35 +5038,15 @@ unsigned short status_calc_matk(struct block_list *bl, struct status_change *sc,
 
 #ifndef RENEWAL
 	// take note fixed value first before % modifiers
-	if (sc->data[SC_PLUSMAGICPOWER])
-		matk += sc->data[SC_PLUSMAGICPOWER]->val1;
-	if (sc->data[SC_MATKFOOD])
-		matk += sc->data[SC_MATKFOOD]->val1;
-	if (sc->data[SC_MANA_PLUS])
-		matk += sc->data[SC_MANA_PLUS]->val1;
-	if (sc->data[SC_AQUAPLAY_OPTION])
-		matk += sc->data[SC_AQUAPLAY_OPTION]->val2;
-	if (sc->data[SC_CHILLY_AIR_OPTION])
-		matk += sc->data[SC_CHILLY_AIR_OPTION]->val2;
-	if(sc->data[SC_COOLER_OPTION])
-		matk += sc->data[SC_COOLER_OPTION]->val2;
+	matk += status->sc_mod_get(sc, SCM_MATK);
 	if (sc->data[SC_FIRE_INSIGNIA] && sc->data[SC_FIRE_INSIGNIA]->val1 == 3)
 		matk += 50;
-	if (sc->data[SC_ODINS_POWER])
-		matk += 40 + 30 * sc->data[SC_ODINS_POWER]->val1; //70 lvl1, 100lvl2
-	if (sc->data[SC_IZAYOI])
-		matk += 25 * sc->data[SC_IZAYOI]->val1;
 #endif
 	if( sc->data[SC_ZANGETSU] )
 		matk += sc->data[SC_ZANGETSU]->val3;
 	if (sc->data[SC_MAGICPOWER] && sc->data[SC_MAGICPOWER]->val4)
 		matk += matk * sc->data[SC_MAGICPOWER]->val3/100;
-	if (sc->data[SC_INCMATKRATE])
-		matk += matk * sc->data[SC_INCMATKRATE]->val1/100;
-	if (sc->data[SC_MOONLIT_SERENADE])
-		matk += matk * sc->data[SC_MOONLIT_SERENADE]->val2/100;
-	if (sc->data[SC_MTF_MATK])
-		matk += matk * 25 / 100;
+	matk = status->sc_mod_rate(sc, SCM_MATK_RATE, matk);
 
 	return (unsigned short)cap_value(matk,0,USHRT_MAX);
 }
@@ -4724,14 +5061,7 @@ signed short status_calc_critical(struct block_list *bl, struct status_change *s
 		return (short)cap_value(critical,10,SHRT_MAX);
 	}
 
-	if (sc->data[SC_CRITICALPERCENT])
-		critical += sc->data[SC_CRITICALPERCENT]->val2;
-	if (sc->data[SC_EXPLOSIONSPIRITS])
-		critical += sc->data[SC_EXPLOSIONSPIRITS]->val2;
-	if (sc->data[SC_FORTUNE])
-		critical += sc->data[SC_FORTUNE]->val2;
-	if (sc->data[SC_TRUESIGHT])
-		critical += sc->data[SC_TRUESIGHT]->val2;
+	critical += status->sc_mod_get(sc, SCM_CRITICAL);
 	if(sc->data[SC_CLOAKING])
 		critical += critical;
 	if(sc->data[SC_STRIKING])
@@ -4764,37 +5094,9 @@ signed short status_calc_hit(struct block_list *bl, struct status_change *sc, in
 		return (short)cap_value(hit,1,SHRT_MAX);
 	}
 
-	if(sc->data[SC_INCHIT])
-		hit += sc->data[SC_INCHIT]->val1;
-	if(sc->data[SC_MTF_HITFLEE])
-		hit += sc->data[SC_MTF_HITFLEE]->val1;
-	if(sc->data[SC_FOOD_BASICHIT])
-		hit += sc->data[SC_FOOD_BASICHIT]->val1;
-	if(sc->data[SC_TRUESIGHT])
-		hit += sc->data[SC_TRUESIGHT]->val3;
-	if(sc->data[SC_HUMMING])
-		hit += sc->data[SC_HUMMING]->val2;
-	if(sc->data[SC_LKCONCENTRATION])
-		hit += sc->data[SC_LKCONCENTRATION]->val3;
-	if(sc->data[SC_INSPIRATION])
-		hit += 5 * sc->data[SC_INSPIRATION]->val1 + 25;
-	if(sc->data[SC_GS_ADJUSTMENT])
-		hit -= 30;
-	if(sc->data[SC_GS_ACCURACY])
-		hit += 20; // RockmanEXE; changed based on updated [Reddozen]
-	if(sc->data[SC_MER_HIT])
-		hit += sc->data[SC_MER_HIT]->val2;
-
-	if(sc->data[SC_INCHITRATE])
-		hit += hit * sc->data[SC_INCHITRATE]->val1/100;
-	if(sc->data[SC_BLIND])
-		hit -= hit * 25/100;
-	if(sc->data[SC_FIRE_EXPANSION_TEAR_GAS])
-		hit -= hit * 50 / 100;
-	if(sc->data[SC__GROOMY])
-		hit -= hit * sc->data[SC__GROOMY]->val3 / 100;
-	if(sc->data[SC_FEAR])
-		hit -= hit * 20 / 100;
+	hit += status->sc_mod_get(sc, SCM_HIT);
+
+	hit = status->sc_mod_rate(sc, SCM_HIT_RATE, hit);
 	if (sc->data[SC_VOLCANIC_ASH])
 		hit /= 2;
 	if(sc->data[SC_ILLUSIONDOPING])
@@ -4819,69 +5121,13 @@ signed short status_calc_flee(struct block_list *bl, struct status_change *sc, i
 		return (short)cap_value(flee,1,SHRT_MAX);
 	}
 
-	if(sc->data[SC_INCFLEE])
-		flee += sc->data[SC_INCFLEE]->val1;
-	if(sc->data[SC_MTF_HITFLEE])
-		flee += sc->data[SC_MTF_HITFLEE]->val2;
-	if(sc->data[SC_FOOD_BASICAVOIDANCE])
-		flee += sc->data[SC_FOOD_BASICAVOIDANCE]->val1;
-	if(sc->data[SC_WHISTLE])
-		flee += sc->data[SC_WHISTLE]->val2;
-	if(sc->data[SC_WINDWALK])
-		flee += sc->data[SC_WINDWALK]->val2;
-	if(sc->data[SC_VIOLENTGALE])
-		flee += sc->data[SC_VIOLENTGALE]->val2;
-	if(sc->data[SC_MOON_COMFORT]) //SG skill [Komurka]
-		flee += sc->data[SC_MOON_COMFORT]->val2;
-	if(sc->data[SC_RG_CCONFINE_M])
-		flee += 10;
-	if (sc->data[SC_ANGRIFFS_MODUS])
-		flee -= sc->data[SC_ANGRIFFS_MODUS]->val3;
-	if(sc->data[SC_GS_ADJUSTMENT])
-		flee += 30;
-	if(sc->data[SC_HLIF_SPEED])
-		flee += 10 + sc->data[SC_HLIF_SPEED]->val1 * 10;
-	if(sc->data[SC_GS_GATLINGFEVER])
-		flee -= sc->data[SC_GS_GATLINGFEVER]->val4;
-	if(sc->data[SC_PARTYFLEE])
-		flee += sc->data[SC_PARTYFLEE]->val1 * 10;
-	if(sc->data[SC_MER_FLEE])
-		flee += sc->data[SC_MER_FLEE]->val2;
-	if( sc->data[SC_HALLUCINATIONWALK] )
-		flee += sc->data[SC_HALLUCINATIONWALK]->val2;
-	if( sc->data[SC_WATER_BARRIER] )
-		flee -= sc->data[SC_WATER_BARRIER]->val3;
-#ifdef RENEWAL
-	if( sc->data[SC_SPEARQUICKEN] )
-		flee += 2 * sc->data[SC_SPEARQUICKEN]->val1;
-#endif
+	flee += status->sc_mod_get(sc, SCM_FLEE);
 
 	if(sc->data[SC_INCFLEERATE])
 		flee += flee * sc->data[SC_INCFLEERATE]->val1/100;
 	if(sc->data[SC_SPIDERWEB] && sc->data[SC_SPIDERWEB]->val1)
 		flee -= flee * 50/100;
-	if (sc->data[SC_BERSERK])
-		flee -= flee * 50/100;
-	if(sc->data[SC_BLIND])
-		flee -= flee * 25/100;
-	if(sc->data[SC_FEAR])
-		flee -= flee * 20 / 100;
-	if(sc->data[SC_PARALYSE])
-		flee -= flee / 10; // 10% Flee reduction
-	if(sc->data[SC_INFRAREDSCAN])
-		flee -= flee * 30 / 100;
-	if( sc->data[SC__LAZINESS] )
-		flee -= flee * sc->data[SC__LAZINESS]->val3 / 100;
-	if( sc->data[SC_GLOOMYDAY] )
-		flee -= flee * ( 20 + 5 * sc->data[SC_GLOOMYDAY]->val1 ) / 100;
-	if( sc->data[SC_SATURDAY_NIGHT_FEVER] )
-		flee -= flee * (40 + 10 * sc->data[SC_SATURDAY_NIGHT_FEVER]->val1) / 100;
-	if ( sc->data[SC_FIRE_EXPANSION_SMOKE_POWDER] )
-		flee += flee * 20 / 100;
-	if ( sc->data[SC_FIRE_EXPANSION_TEAR_GAS] )
-		flee -= flee * 50 / 100;
-	if( sc->data[SC_WIND_STEP_OPTION] )
-		flee += flee * sc->data[SC_WIND_STEP_OPTION]->val2 / 100;
+	flee = status->sc_mod_rate(sc, SCM_FLEE_RATE, flee);
 	if( sc->data[SC_ZEPHYR] )
 		flee += sc->data[SC_ZEPHYR]->val2;
 	if(sc->data[SC_VOLCANIC_ASH] && (bl->type==BL_MOB)){ //mob
@@ -4905,10 +5151,7 @@ signed short status_calc_flee2(struct block_list *bl, struct status_change *sc,
 		return (short)cap_value(flee2,10,SHRT_MAX);
 	}
 
-	if(sc->data[SC_PLUSAVOIDVALUE])
-		flee2 += sc->data[SC_PLUSAVOIDVALUE]->val2;
-	if(sc->data[SC_WHISTLE])
-		flee2 += sc->data[SC_WHISTLE]->val3*10;
+	flee2 += status->sc_mod_get(sc, SCM_FLEE2);
 	if(sc->data[SC__UNLUCKY])
 		flee2 -= flee2 * sc->data[SC__UNLUCKY]->val2 / 100;
 
@@ -4948,20 +5191,9 @@ defType status_calc_def(struct block_list *bl, struct status_change *sc, int def
 		return 90;
 #endif
 
-	if (sc->data[SC_STONEHARDSKIN])
-		def += sc->data[SC_STONEHARDSKIN]->val1;
-	if (sc->data[SC_DRUMBATTLE])
-		def += sc->data[SC_DRUMBATTLE]->val3;
-
-	if (sc->data[SC_STONESKIN])
-		def += sc->data[SC_STONESKIN]->val2;
-	if (sc->data[SC_HAMI_DEFENCE]) //[orn]
-		def += sc->data[SC_HAMI_DEFENCE]->val2;
-
+	def += status->sc_mod_get(sc, SCM_DEF);
 	if (sc->data[SC_EARTH_INSIGNIA] && sc->data[SC_EARTH_INSIGNIA]->val1 == 2)
 		def += 50;
-	if (sc->data[SC_ODINS_POWER])
-		def -= 20;
 
 #ifndef RENEWAL
 	if (sc->data[SC_STONE] && sc->opt1 == OPT1_STONE)
@@ -4981,20 +5213,7 @@ defType status_calc_def(struct block_list *bl, struct status_change *sc, int def
 		def >>=1;
 	if (sc->data[SC_PROVOKE] && bl->type != BL_PC) // Provoke doesn't alter player defense->
 		def -= def * sc->data[SC_PROVOKE]->val4/100;
-	if (sc->data[SC_NOEQUIPSHIELD])
-		def -= def * sc->data[SC_NOEQUIPSHIELD]->val2/100;
-	if (sc->data[SC_FLING])
-		def -= def * (sc->data[SC_FLING]->val2)/100;
-	if (sc->data[SC_ANALYZE])
-		def -= def * ( 14 * sc->data[SC_ANALYZE]->val1 ) / 100;
-	if (sc->data[SC_SATURDAY_NIGHT_FEVER])
-		def -= def * (10 + 10 * sc->data[SC_SATURDAY_NIGHT_FEVER]->val1) / 100;
-	if (sc->data[SC_EARTHDRIVE])
-		def -= def * 25 / 100;
-	if (sc->data[SC_ROCK_CRUSHER])
-		def -= def * sc->data[SC_ROCK_CRUSHER]->val2 / 100;
-	if (sc->data[SC_FROSTMISTY])
-		def -= def * 10 / 100;
+	def = status->sc_mod_rate(sc, SCM_DEF_RATE, def);
 	if (sc->data[SC_OVERED_BOOST] && bl->type == BL_HOM)
 		def -= def * 50 / 100;
 
@@ -5046,8 +5265,7 @@ signed short status_calc_def2(struct block_list *bl, struct status_change *sc, i
 		return 0;
 	if (sc->data[SC_ETERNALCHAOS])
 		return 0;
-	if (sc->data[SC_SUN_COMFORT])
-		def2 += sc->data[SC_SUN_COMFORT]->val2;
+	def2 += status->sc_mod_get(sc, SCM_DEF2);
 	if (sc->data[SC_BANDING] && sc->data[SC_BANDING]->val2 > 1)
 		def2 += (5 + sc->data[SC_BANDING]->val1) * (sc->data[SC_BANDING]->val2);
 	if (sc->data[SC_ANGELUS])
@@ -5058,14 +5276,7 @@ signed short status_calc_def2(struct block_list *bl, struct status_change *sc, i
 	if (sc->data[SC_LKCONCENTRATION])
 		def2 -= def2 * sc->data[SC_LKCONCENTRATION]->val4/100;
 #endif
-	if (sc->data[SC_POISON])
-		def2 -= def2 * 25/100;
-	if (sc->data[SC_DPOISON])
-		def2 -= def2 * 25/100;
-	if (sc->data[SC_SKE])
-		def2 -= def2 * 50/100;
-	if (sc->data[SC_PROVOKE])
-		def2 -= def2 * sc->data[SC_PROVOKE]->val4/100;
+	def2 = status->sc_mod_rate(sc, SCM_DEF2_RATE, def2);
 	if (sc->data[SC_JOINTBEAT])
 		def2 -= def2 * ((sc->data[SC_JOINTBEAT]->val2&BREAK_SHOULDER) ? 50 : 0) / 100
 		+ def2 * ((sc->data[SC_JOINTBEAT]->val2&BREAK_WAIST) ? 25 : 0) / 100;
@@ -5114,14 +5325,11 @@ defType status_calc_mdef(struct block_list *bl, struct status_change *sc, int md
 		return 90;
 #endif
 
-	if(sc->data[SC_STONESKIN])
-		mdef += sc->data[SC_STONESKIN]->val3;
+	mdef += status->sc_mod_get(sc, SCM_MDEF);
 	if(sc->data[SC_EARTH_INSIGNIA] && sc->data[SC_EARTH_INSIGNIA]->val1 == 3)
 		mdef += 50;
 	if(sc->data[SC_ENDURE])// It has been confirmed that eddga card grants 1 MDEF, not 0, not 10, but 1.
 		mdef += (sc->data[SC_ENDURE]->val4 == 0) ? sc->data[SC_ENDURE]->val1 : 1;
-	if(sc->data[SC_STONEHARDSKIN])// Final MDEF increase divided by 10 since were using classic (pre-renewal) mechanics. [Rytech]
-		mdef += sc->data[SC_STONEHARDSKIN]->val1;
 	if(sc->data[SC_STONE] && sc->opt1 == OPT1_STONE)
 		mdef += 25*mdef/100;
 	if(sc->data[SC_FREEZE])
@@ -9584,6 +9792,7 @@ int status_change_start(struct block_list *src, struct block_list *bl, enum sc_t
 	} else {// new sc
 		++(sc->count);
 		sce = sc->data[type] = ers_alloc(status->data_ers, struct status_change_entry);
+		status->sc_mod_update(sc, type);
 	}
 
 	sce->val1 = val1;
@@ -9601,8 +9810,12 @@ int status_change_start(struct block_list *src, struct block_list *bl, enum sc_t
 			chrif->save_scdata_single(sd->status.account_id,sd->status.char_id,type,sce);
 	}
 
-	if (calc_flag)
-		status_calc_bl(bl,calc_flag);
+	if (calc_flag) {
+		if (sd && status->dbs->PCLayerTable[type])
+			status->calc_bl_(bl, (enum scb_flag)calc_flag, SCO_SC_LAYER);
+		else
+			status_calc_bl(bl,calc_flag);
+	}
 
 	if(sd && sd->pd)
 		pet->sc_check(sd, type); //Skotlex: Pet Status Effect Healing
@@ -9736,6 +9949,7 @@ int status_change_clear(struct block_list* bl, int type) {
 				timer->delete(sc->data[i]->timer, status->change_timer);
 			ers_free(status->data_ers, sc->data[i]);
 			sc->data[i] = NULL;
+			status->sc_mod_update(sc, (sc_type)i);
 		}
 	}
 
@@ -9815,6 +10029,7 @@ int status_change_end_(struct block_list* bl, enum sc_type type, int tid, const
 	(sc->count)--;
 
 	sc->data[type] = NULL;
+	status->sc_mod_update(sc, type);
 
 	if( sd && status->dbs->DisplayType[type] ) {
 		status->display_remove(sd,type);
@@ -10494,8 +10709,12 @@ int status_change_end_(struct block_list* bl, enum sc_type type, int tid, const
 		}
 	}
 
-	if (calc_flag)
-		status_calc_bl(bl,calc_flag);
+	if (calc_flag) {
+		if (sd && status->dbs->PCLayerTable[type])
+			status->calc_bl_(bl, (enum scb_flag)calc_flag, SCO_SC_LAYER);
+		else
+			status_calc_bl(bl,calc_flag);
+	}
 
 	if(opt_flag&4) //Out of hiding, invoke on place.
 		skill->unit_move(bl,timer->gettick(),1);
@@ -11884,10 +12103,45 @@ int status_change_spread( struct block_list *src, struct block_list *bl ) {
 	return flag;
 }
 
+/**
+ * Whether a natural regen tick can't change anything for bl.
+ * Players may still bleed or regen from item bonuses, everyone else
+ * is done when there's nothing left to heal.
+ **/
+static inline bool status_natural_heal_idle(const struct block_list *bl, const struct regen_data *regen, const struct status_data *st)
+{
+	return (bl->type != BL_PC
+	 && (!regen->flag
+	  || (st->hp >= st->max_hp && st->sp >= st->max_sp
+	   && (regen->flag&RGN_HP || !(regen->flag&RGN_SHP))
+	   && (regen->flag&RGN_SP || !(regen->flag&RGN_SSP))))
+	);
+}
+
 //Natural regen related stuff.
 int status_natural_heal(struct block_list* bl, va_list args) {
 	struct regen_data *regen;
 	struct status_data *st;
+
+	regen = status->get_regen_data(bl);
+	if (!regen) return 0;
+	st = status->get_status_data(bl);
+
+	if (status_natural_heal_idle(bl, regen, st))
+		return 0;
+
+	return status->natural_heal_sub(bl, regen, st);
+}
+
+/**
+ * Applies one natural regen tick to an entity.
+ *
+ * @param bl    The entity.
+ * @param regen Its regen data.
+ * @param st    Its battle status.
+ * @return The regen flags that were still active.
+ */
+int status_natural_heal_sub(struct block_list *bl, struct regen_data *regen, struct status_data *st) {
 	struct status_change *sc;
 	struct unit_data *ud;
 	struct view_data *vd = NULL;
@@ -11895,9 +12149,9 @@ int status_natural_heal(struct block_list* bl, va_list args) {
 	struct map_session_data *sd;
 	int val,rate,bonus = 0,flag;
 
-	regen = status->get_regen_data(bl);
-	if (!regen) return 0;
-	st = status->get_status_data(bl);
+	nullpo_ret(bl);
+	nullpo_ret(regen);
+	nullpo_ret(st);
 	sc = status->get_sc(bl);
 	if (sc && !sc->count)
 		sc = NULL;
@@ -12070,9 +12324,25 @@ int status_natural_heal(struct block_list* bl, va_list args) {
 
 //Natural heal main timer.
 int status_natural_heal_timer(int tid, int64 tick, int id, intptr_t data) {
+	int i, count = map->regen_count;
+
 	// This difference is always positive and lower than UINT_MAX (~24 days)
 	status->natural_heal_diff_tick = (unsigned int)cap_value(DIFF_TICK(tick,status->natural_heal_prev_tick), 0, UINT_MAX);
-	map->foreachregen(status->natural_heal);
+
+	// Walks the dense regen store directly. Units removed meanwhile leave a
+	// NULL slot and units added meanwhile are appended, so every entry that
+	// was stored when the pass started is visited at most once.
+	map->regen_pass_begin();
+	for (i = 0; i < count; i++) {
+		struct block_list *bl = map->regen_bl[i];
+
+		if (bl == NULL || status_natural_heal_idle(bl, map->regen_data[i], map->regen_status[i]))
+			continue;
+
+		status->natural_heal_sub(bl, map->regen_data[i], map->regen_status[i]);
+	}
+	map->regen_pass_end();
+
 	status->natural_heal_prev_tick = tick;
 	return 0;
 }
@@ -12476,6 +12746,7 @@ int do_init_status(bool minimal) {
 	timer->add_func_list(status->kaahi_heal_timer,"status_kaahi_heal_timer");
 	timer->add_func_list(status->natural_heal_timer,"status_natural_heal_timer");
 	status->initChangeTables();
+	status->initModifierTable();
 	status->initDummyData();
 	status->readdb();
 	status->natural_heal_prev_tick = timer->gettick();
@@ -12509,6 +12780,8 @@ void status_defaults(void) {
 	memset(&status->dummy, 0, sizeof(status->dummy));
 	status->natural_heal_prev_tick = 0;
 	status->natural_heal_diff_tick = 0;
+	status->pc_calc_full = 0;
+	status->pc_calc_partial = 0;
 	/* funcs */
 	status->get_refine_chance = status_get_refine_chance;
 	// for looking up associated data
@@ -12566,6 +12839,8 @@ void status_defaults(void) {
 	status->calc_pet_ = status_calc_pet_;
 	status->calc_pc_ = status_calc_pc_;
 	status->calc_pc_additional = status_calc_pc_additional;
+	status->calc_pc_sc_bonus = status_calc_pc_sc_bonus;
+	status->calc_pc_partial = status_calc_pc_partial;
 	status->calc_homunculus_ = status_calc_homunculus_;
 	status->calc_mercenary_ = status_calc_mercenary_;
 	status->calc_elemental_ = status_calc_elemental_;
@@ -12597,6 +12872,7 @@ void status_defaults(void) {
 	status->final = do_final_status;
 
 	status->initChangeTables = initChangeTables;
+	status->initModifierTable = initModifierTable;
 	status->initDummyData = initDummyData;
 	status->base_amotion_pc = status_base_amotion_pc;
 	status->base_atk = status_base_atk;
@@ -12627,9 +12903,13 @@ void status_defaults(void) {
 	status->calc_mode = status_calc_mode;
 	status->calc_ematk = status_calc_ematk;
 	status->calc_bl_main = status_calc_bl_main;
+	status->sc_mod_get = status_sc_mod_get;
+	status->sc_mod_rate = status_sc_mod_rate;
+	status->sc_mod_update = status_sc_mod_update;
 	status->display_add = status_display_add;
 	status->display_remove = status_display_remove;
 	status->natural_heal = status_natural_heal;
+	status->natural_heal_sub = status_natural_heal_sub;
 	status->natural_heal_timer = status_natural_heal_timer;
 	status->readdb_job2 = status_readdb_job2;
 	status->readdb_sizefix = status_readdb_sizefix;
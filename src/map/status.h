@@ -1725,6 +1725,7 @@ enum e_status_calc_opt {
 	SCO_NONE  = 0x0,
 	SCO_FIRST = 0x1, /* trigger the calculations that should take place only onspawn/once */
 	SCO_FORCE = 0x2, /* only relevant to BL_PC types, ensures call bypasses the queue caused by delayed damage */
+	SCO_SC_LAYER = 0x4, /* only relevant to BL_PC types, SCB_BASE only needs the status change bonuses reapplied (see status->calc_pc_partial) */
 };
 
 //Define to determine who gets HP/SP consumed on doing skills/etc. [Skotlex]
@@ -1836,6 +1837,9 @@ struct status_change_entry {
 	bool infinite_duration;
 };
 
+/// Most status changes the modifier table may refer to (slots are stored as unsigned char)
+#define MAX_SC_MOD_TYPES 160
+
 struct status_change {
 	unsigned int option;// effect state (bitfield)
 	unsigned int opt3;// skill state (bitfield)
@@ -1854,6 +1858,8 @@ struct status_change {
 #endif
 	unsigned char bs_counter; // Blood Sucker counter
 	unsigned char fv_counter; // Force of vanguard counter
+	unsigned char mod_count; // Number of entries in mod_active
+	unsigned char mod_active[MAX_SC_MOD_TYPES]; // Modifier table slots of the active status changes that have modifiers (see status->sc_mod_update)
 	struct status_change_entry *data[SC_MAX];
 };
 
@@ -1935,6 +1941,77 @@ struct s_refine_info {
 	int randombonus_max[MAX_REFINE]; // cumulative maximum random bonus damage
 };
 
+/**
+ * Stats that take modifiers from the status change modifier table.
+ *
+ * Each entry stands for one run of a status_calc_* chain. Flat stats sum
+ * their modifiers, so only the additive lines before the first percentage or
+ * conditional line of a chain live in the table. Rate stats are runs of
+ * unconditional `x += x * n / 100` lines; their percentages are applied one
+ * after another, in the order they are listed in initModifierTable, since the
+ * result depends on that order.
+ */
+enum sc_mod_stat {
+	// flat bonuses
+	SCM_STR,
+	SCM_AGI,
+	SCM_VIT,
+	SCM_INT,
+	SCM_DEX,
+	SCM_LUK,
+	SCM_HIT,
+	SCM_FLEE,
+	SCM_FLEE2,
+	SCM_CRITICAL,
+	SCM_BATK,
+	SCM_WATK,
+	SCM_MATK,
+	SCM_DEF,
+	SCM_DEF2,
+	SCM_MDEF,
+	// percentages, applied in order
+	SCM_WATK_RATE,
+	SCM_MATK_RATE,
+	SCM_HIT_RATE,
+	SCM_FLEE_RATE,
+	SCM_DEF_RATE,
+	SCM_DEF2_RATE,
+	SCM_MAX
+};
+
+/// First stat whose modifiers are percentages.
+#define SCM_RATE_START SCM_WATK_RATE
+
+/// Status change value a modifier is scaled by.
+enum sc_mod_source {
+	SCM_SRC_NONE, ///< Constant bonus
+	SCM_SRC_VAL1,
+	SCM_SRC_VAL2,
+	SCM_SRC_VAL3,
+	SCM_SRC_VAL4,
+};
+
+/// Stat modifier granted while a status change is active: bonus + rate * val<source>
+/// (a flat bonus, or a percentage for the rate stats).
+struct sc_modifier {
+	sc_type type;
+	enum sc_mod_stat stat;
+	enum sc_mod_source source;
+	int rate;
+	int bonus;
+	int order; ///< Index in status->dbs->sc_mods; percentages of a stat are applied by ascending order
+};
+
+#define MAX_SC_MODIFIERS 224
+#define MAX_SC_MOD_RATES 16 ///< Most percentage modifiers a rate stat may have
+
+/// Percentages of a rate stat, sorted by sc_modifier::order.
+struct sc_mod_rates {
+	int count;
+	int order[MAX_SC_MOD_RATES];
+	int value[MAX_SC_MOD_RATES];
+};
+
 struct s_status_dbs {
 BEGIN_ZEROED_BLOCK; /* Everything within this block will be memset to 0 when status_defaults() is executed */
 	int max_weight_base[CLASS_COUNT];
@@ -1947,12 +2024,22 @@ BEGIN_ZEROED_BLOCK; /* Everything within this block will be memset to 0 when sta
 	int SkillChangeTable[SC_MAX];         // status -> skill
 	int RelevantBLTypes[SI_MAX];          // "icon" -> enum bl_type (for clif->status_change to identify for which bl types to send packets)
 	bool DisplayType[SC_MAX];
+	bool PCLayerTable[SC_MAX]; // status -> base status effect is fully handled by status->calc_pc_sc_bonus
 	/* */
 	struct s_refine_info refine_info[REFINE_TYPE_MAX];
 	/* */
 	int atkmods[3][MAX_WEAPON_TYPE];//ATK weapon modification for size (size_fix.txt)
 	char job_bonus[CLASS_COUNT][MAX_LEVEL];
 	sc_conf_type sc_conf[SC_MAX];
+	/* */
+	struct sc_modifier sc_mods[MAX_SC_MODIFIERS];         // modifiers grouped by stat
+	struct sc_modifier sc_mods_by_type[MAX_SC_MODIFIERS]; // same modifiers grouped by status change
+	int sc_mod_count;
+	int sc_mod_stat_start[SCM_MAX+1]; // stat -> first index in sc_mods
+	int sc_mod_slot[SC_MAX];          // status change -> modifier slot + 1 (0 when it has no modifiers)
+	int sc_mod_type_start[MAX_SC_MOD_TYPES+1]; // modifier slot -> first index in sc_mods_by_type
+	unsigned int sc_mod_type_stats[MAX_SC_MOD_TYPES]; // modifier slot -> stats it modifies (1 << enum sc_mod_stat)
+	int sc_mod_type_count;            // number of modifier slots in use
 END_ZEROED_BLOCK; /* End */
 };
 
@@ -1973,6 +2060,8 @@ struct status_interface {
 	struct status_data dummy;
 	int64 natural_heal_prev_tick;
 	unsigned int natural_heal_diff_tick;
+	unsigned int pc_calc_full;    ///< Full player status calculations (status_calc_pc_)
+	unsigned int pc_calc_partial; ///< Player status calculations that only reapplied status change bonuses
 	/* */
 	int (*init) (bool minimal);
 	void (*final) (void);
@@ -2027,6 +2116,8 @@ struct status_interface {
 	int (*calc_pet_) (struct pet_data* pd, enum e_status_calc_opt opt);
 	int (*calc_pc_) (struct map_session_data* sd, enum e_status_calc_opt opt);
 	void (*calc_pc_additional) (struct map_session_data* sd, enum e_status_calc_opt opt);
+	void (*calc_pc_sc_bonus) (struct map_session_data *sd);
+	bool (*calc_pc_partial) (struct map_session_data *sd);
 	int (*calc_homunculus_) (struct homun_data *hd, enum e_status_calc_opt opt);
 	int (*calc_mercenary_) (struct mercenary_data *md, enum e_status_calc_opt opt);
 	int (*calc_elemental_) (struct elemental_data *ed, enum e_status_calc_opt opt);
@@ -2050,6 +2141,7 @@ struct status_interface {
 	int (*readdb) (void);
 
 	void (*initChangeTables) (void);
+	void (*initModifierTable) (void);
 	void (*initDummyData) (void);
 	int (*base_amotion_pc) (struct map_session_data *sd, struct status_data *st);
 	unsigned short (*base_atk) (const struct block_list *bl, const struct status_data *st);
@@ -2080,9 +2172,13 @@ struct status_interface {
 	unsigned short (*calc_mode) (struct block_list *bl, struct status_change *sc, int mode);
 	unsigned short (*calc_ematk) (struct block_list *bl, struct status_change *sc, int matk);
 	void (*calc_bl_main) (struct block_list *bl, int flag);
+	int (*sc_mod_get) (struct status_change *sc, enum sc_mod_stat stat);
+	int (*sc_mod_rate) (struct status_change *sc, enum sc_mod_stat stat, int value);
+	void (*sc_mod_update) (struct status_change *sc, sc_type type);
 	void (*display_add) (struct map_session_data *sd, enum sc_type type, int dval1, int dval2, int dval3);
 	void (*display_remove) (struct map_session_data *sd, enum sc_type type);
 	int (*natural_heal) (struct block_list *bl, va_list args);
+	int (*natural_heal_sub) (struct block_list *bl, struct regen_data *regen, struct status_data *st);
 	int (*natural_heal_timer) (int tid, int64 tick, int id, intptr_t data);
 	bool (*readdb_job2) (char *fields[], int columns, int current);
 	bool (*readdb_sizefix) (char *fields[], int columns, int current);
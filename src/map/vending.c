@@ -41,6 +41,7 @@ void vending_closevending(struct map_session_data* sd) {
 	if( sd->state.vending ) {
 		sd->state.vending = 0;
 		clif->closevendingboard(&sd->bl, 0);
+		searchstore->index_remove(sd, SEARCHTYPE_VENDING);
 		idb_remove(vending->db, sd->status.char_id);
 	}
 }
@@ -168,6 +169,9 @@ void vending_purchasereq(struct map_session_data* sd, int aid, unsigned int uid,
 		z -= z * (battle_config.vending_tax/10000.);
 	pc->getzeny(vsd, (int)z, LOG_TYPE_VENDING, sd);
 
+	// amounts are about to change, re-indexed below
+	searchstore->index_remove(vsd, SEARCHTYPE_VENDING);
+
 	for( i = 0; i < count; i++ ) {
 		short amount = *(uint16*)(data + 4*i + 0);
 		short idx    = *(uint16*)(data + 4*i + 2);
@@ -201,6 +205,7 @@ void vending_purchasereq(struct map_session_data* sd, int aid, unsigned int uid,
 		cursor++;
 	}
 	vsd->vend_num = cursor;
+	searchstore->index_add(vsd, SEARCHTYPE_VENDING);
 
 	//Always save BOTH: buyer and customer
 	if( map->save_settings&2 ) {
@@ -290,6 +295,7 @@ void vending_openvending(struct map_session_data* sd, const char* message, const
 	clif->showvendingboard(&sd->bl,message,0);
 
 	idb_put(vending->db, sd->status.char_id, sd);
+	searchstore->index_add(sd, SEARCHTYPE_VENDING);
 }
 
 
@@ -86,6 +86,7 @@
 #define HPM_SOURCES_INCLUDE "HPMHooking/HPMHooking.sources.inc"
 #error HPMHooking plugin needs to be compiled for a specific server type. Please make sure your Makefiles are up to date.
 #endif
+#include "common/atomic.h"
 #include "common/conf.h"
 #include "common/console.h"
 #include "common/db.h"
@@ -125,8 +126,57 @@ struct HookingPointData {
 struct HPMHookPoint {
 	void *func;
 	unsigned int pID;
+	uint64 calls; ///< Times this hook ran (see hooks:stats), updated atomically
 };
 
+#ifdef HPMHOOKING_PROFILE
+/**
+ * Function-level profiler (build with HPMHOOKING_PROFILE).
+ *
+ * Every interface function is redirected to its trampoline at load time and
+ * the call to the original is timed in CPU cycles. Times are inclusive:
+ * interface calls made from within a function count towards it as well.
+ * Counters are updated atomically, as some functions (e.g. timer->microtick)
+ * also run on the NPC preload threads.
+ **/
+struct HPMHookProfile {
+	uint64 calls;
+	uint64 total; ///< cycles
+	uint64 max;   ///< cycles
+};
+
+static inline uint64 HPM_rdtsc(void) {
+#if defined(_MSC_VER)
+	return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	uint32 lo, hi;
+	__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((uint64)hi << 32) | lo;
+#else
+	#error HPMHOOKING_PROFILE requires an x86 cycle counter (rdtsc).
+#endif
+}
+
+static inline void HPM_profile_add(struct HPMHookProfile *prof, uint64 cycles) {
+	int64 max;
+
+	InterlockedIncrement64((volatile int64 *)&prof->calls);
+	InterlockedExchangeAdd64((volatile int64 *)&prof->total, (int64)cycles);
+	while (cycles > (uint64)(max = (int64)prof->max)) {
+		if (InterlockedCompareExchange64((volatile int64 *)&prof->max, (int64)cycles, max) == max)
+			break;
+	}
+}
+
+#define HPM_PROFILE_DECL uint64 hpm_prof___ = 0;
+#define HPM_PROFILE_ENTER() (hpm_prof___ = HPM_rdtsc())
+#define HPM_PROFILE_LEAVE(hname) HPM_profile_add(&HPMHooks.profile.hname, HPM_rdtsc() - hpm_prof___)
+#else // ! HPMHOOKING_PROFILE
+#define HPM_PROFILE_DECL
+#define HPM_PROFILE_ENTER() (void)0
+#define HPM_PROFILE_LEAVE(hname) (void)0
+#endif // HPMHOOKING_PROFILE
+
 struct HPMHooksCore {
 	#include HPM_CORE_INCLUDE
 	struct {
@@ -174,7 +224,10 @@ HPExport bool HPM_Plugin_AddHook(enum HPluginHookType type, const char *target,
 
 			(*hp)[*count - 1].func = hook;
 			(*hp)[*count - 1].pID = pID;
+			(*hp)[*count - 1].calls = 0;
 
+			// Only the hooked slot goes through its trampoline, every other
+			// interface function keeps pointing at the original.
 			*(hpd->sref) = hpd->tref;
 
 			return true;
@@ -186,6 +239,121 @@ HPExport bool HPM_Plugin_AddHook(enum HPluginHookType type, const char *target,
 
 #include HPM_HOOKS_INCLUDE
 
+/**
+ * Lists the hooks of a hooking point list along with their call counts.
+ * @param name  hooking point name
+ * @param hp    hooks
+ * @param count number of hooks
+ * @param type  "pre" or "post"
+ * @param reset whether to reset the counters instead of listing them
+ */
+static void HPM_HP_stats_sub(const char *name, struct HPMHookPoint *hp, int count, const char *type, bool reset) {
+	int i;
+	for (i = 0; i < count; i++) {
+		if (reset)
+			hp[i].calls = 0;
+		else
+			ShowInfo("HPMHooking: %s (%s, plugin #%u): %"PRIu64" calls\n", name, type, hp[i].pID, hp[i].calls);
+	}
+}
+
+/// Walks every hooked point for hooks:stats and hooks:reset.
+static void HPM_HP_stats(bool reset) {
+	struct DBIterator *iter;
+	struct HookingPointData *hpd;
+	int hooked = 0;
+
+	if (hp_db == NULL)
+		return;
+
+	iter = db_iterator(hp_db);
+	for (hpd = dbi_first(iter); dbi_exists(iter); hpd = dbi_next(iter)) {
+		struct HPMHookPoint **pre = (struct HPMHookPoint **)((char *)&HPMHooks.list + (sizeof(struct HPMHookPoint *)*hpd->idx));
+		struct HPMHookPoint **post = (struct HPMHookPoint **)((char *)&HPMHooks.list + (sizeof(struct HPMHookPoint *)*(hpd->idx+1)));
+		int pre_count = *(int *)((char *)&HPMHooks.count + (sizeof(int)*hpd->idx));
+		int post_count = *(int *)((char *)&HPMHooks.count + (sizeof(int)*(hpd->idx+1)));
+
+		if (pre_count == 0 && post_count == 0)
+			continue;
+		hooked++;
+		HPM_HP_stats_sub(hpd->name, *pre, pre_count, "pre", reset);
+		HPM_HP_stats_sub(hpd->name, *post, post_count, "post", reset);
+	}
+	dbi_destroy(iter);
+
+	if (!reset)
+		ShowInfo("HPMHooking: %d of %d interface functions hooked, the others are called directly.\n", hooked, HPMHooks.data.total);
+}
+
+CPCMD(hooks_stats) {
+	HPM_HP_stats(false);
+}
+
+CPCMD(hooks_reset) {
+	HPM_HP_stats(true);
+#ifdef HPMHOOKING_PROFILE
+	memset(&HPMHooks.profile, 0, sizeof(HPMHooks.profile));
+#endif
+	ShowInfo("HPMHooking: call counters reset.\n");
+}
+
+#ifdef HPMHOOKING_PROFILE
+#define HPM_PROFILE_REPORT_MAX 30
+
+/**
+ * Lists the interface functions that took the most time since load (or hooks:reset).
+ * Usage: hooks:profile [count]
+ */
+CPCMD(hooks_profile) {
+	struct {
+		const char *name;
+		const struct HPMHookProfile *prof;
+	} top[HPM_PROFILE_REPORT_MAX];
+	const struct HPMHookProfile *profiles = (const struct HPMHookProfile *)&HPMHooks.profile;
+	struct DBIterator *iter;
+	struct HookingPointData *hpd;
+	int i, n = 0, max = HPM_PROFILE_REPORT_MAX;
+
+	if (line != NULL && *line != '\0')
+		max = cap_value(atoi(line), 1, HPM_PROFILE_REPORT_MAX);
+
+	if (hp_db == NULL)
+		return;
+
+	// profile members are laid out in hooking point order, two list/count slots per point
+	iter = db_iterator(hp_db);
+	for (hpd = dbi_first(iter); dbi_exists(iter); hpd = dbi_next(iter)) {
+		const struct HPMHookProfile *prof = &profiles[hpd->idx/2];
+		if (prof->calls == 0)
+			continue;
+		if (n == max && prof->total <= top[n-1].prof->total)
+			continue;
+		// insertion into the (descending) top list
+		for (i = (n < max) ? n++ : n-1; i > 0 && top[i-1].prof->total < prof->total; i--)
+			top[i] = top[i-1];
+		top[i].name = hpd->name;
+		top[i].prof = prof;
+	}
+	dbi_destroy(iter);
+
+	ShowInfo("HPMHooking: top %d interface functions by total cycles:\n", n);
+	for (i = 0; i < n; i++) {
+		const struct HPMHookProfile *prof = top[i].prof;
+		ShowInfo("  %-40s calls: %10"PRIu64"  total: %14"PRIu64"  avg: %10"PRIu64"  max: %12"PRIu64"\n",
+			top[i].name, prof->calls, prof->total, prof->total / prof->calls, prof->max);
+	}
+}
+#undef HPM_PROFILE_REPORT_MAX
+#endif // HPMHOOKING_PROFILE
+
+HPExport void plugin_init(void) {
+	addCPCommand("hooks:stats", hooks_stats);
+	addCPCommand("hooks:reset", hooks_reset);
+#ifdef HPMHOOKING_PROFILE
+	addCPCommand("hooks:profile", hooks_profile);
+#endif
+}
+
 void HPM_HP_final(void) {
 	int i, len = HPMHooks.data.total * 2;
 
@@ -228,4 +396,11 @@ void HPM_HP_load(void) {
 	}
 
 	#include HPM_SOURCES_INCLUDE
+
+#ifdef HPMHOOKING_PROFILE
+	// Profiling build: every slot goes through its (timed) trampoline.
+	for (i = 0; i < len; i++)
+		*(HookingPoints[i].sref) = HookingPoints[i].tref;
+	ShowStatus("HPMHooking: profiling %d interface functions.\n", len);
+#endif
 }
@@ -0,0 +1,295 @@
+// Copyright (c) Hercules Dev Team, licensed under GNU GPL.
+// See the LICENSE file
+
+/**
+ * Auction house load test.
+ *
+ * Fills the auction subsystem of the char-server with generated auctions,
+ * then answers auction list requests (0x3050) for every search type through
+ * mapif->parse_auction_requestlist and through the full scan of
+ * inter_auction->db it replaced, and prints the latency of both.
+ * Every request is checked first: both must report the same number of
+ * results and pages, and every auction of the indexed page must match the
+ * search.
+ * The test runs while the command line is parsed, before the SQL
+ * connection is opened, and quits the server when done.
+ *
+ * Usage:
+ *   ./char-server --load-plugin auctionbench --auction-bench <auctions>[,<requests>[,<seed>]]
+ *
+ * Defaults are 100000 auctions, 1000 requests per search type and seed 1.
+ **/
+
+#include "common/hercules.h" /* Should always be the first Hercules file included! */
+#include "char/int_auction.h"
+#include "char/mapif.h"
+#include "common/cbasetypes.h"
+#include "common/core.h"
+#include "common/db.h"
+#include "common/malloc.h"
+#include "common/mmo.h"
+#include "common/nullpo.h"
+#include "common/showmsg.h"
+#include "common/socket.h"
+#include "common/strlib.h"
+#include "common/timer.h"
+#include "common/utils.h"
+
+#include "common/HPMDataCheck.h" /* should always be the last Hercules file included! */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+HPExport struct hplugin_info pinfo = {
+	"auctionbench",   // Plugin name
+	SERVER_TYPE_CHAR, // Which server types this plugin works with?
+	"0.1",            // Plugin version
+	HPM_VERSION,      // HPM Version (don't change, macro is automatically updated)
+};
+
+#define AUCTIONBENCH_SELLERS 20000 ///< Distinct sellers (and bidders)
+#define AUCTIONBENCH_ITEMS 2000 ///< Distinct items
+
+/// Words item names are made of, two per item.
+const char *auctionbench_words[] = {
+	"Red", "Blue", "Green", "Old", "Holy", "Evil", "Fire", "Ice",
+	"Sword", "Shield", "Bow", "Staff", "Potion", "Card", "Helm", "Ring",
+};
+
+/// A load test request, as received from a map-server.
+struct auctionbench_request {
+	int char_id;
+	short type;
+	int price;
+	short page;
+	char searchtext[NAME_LENGTH];
+};
+
+/// The last list sent through mapif->auction_sendlist.
+struct auctionbench_list {
+	short count, pages;
+	unsigned char buf[AUCTION_PAGE_SIZE * sizeof(struct auction_data)];
+} auctionbench_list;
+
+int auctionbench_count = 100000;
+uint32 auctionbench_seed = 1;
+
+/// Generator of the auctions and requests, independent of rnd() so runs are repeatable.
+int auctionbench_rand(void)
+{
+	auctionbench_seed = auctionbench_seed * 1103515245 + 12345;
+	return (int)((auctionbench_seed >> 1) & 0x7fffffff);
+}
+
+/// mapif->auction_sendlist replacement keeping the list instead of sending it.
+void auctionbench_sendlist(int fd, int char_id, short count, short pages, unsigned char *buf)
+{
+	auctionbench_list.count = count;
+	auctionbench_list.pages = pages;
+	memcpy(auctionbench_list.buf, buf, count * sizeof(struct auction_data));
+}
+
+/// inter_auction->fromsql replacement generating the auctions.
+void auctionbench_fromsql(void)
+{
+	int i;
+
+	for (i = 0; i < auctionbench_count; i++) {
+		struct auction_data *auction;
+		int item = auctionbench_rand() % AUCTIONBENCH_ITEMS;
+		static const short types[] = { IT_ARMOR, IT_WEAPON, IT_CARD, IT_ETC, IT_PETARMOR, IT_USABLE };
+
+		CREATE(auction, struct auction_data, 1);
+		auction->auction_id = i + 1;
+		auction->seller_id = 150000 + auctionbench_rand() % AUCTIONBENCH_SELLERS;
+		snprintf(auction->seller_name, NAME_LENGTH, "seller %d", auction->seller_id);
+		if (auctionbench_rand() % 2) {
+			auction->buyer_id = 150000 + auctionbench_rand() % AUCTIONBENCH_SELLERS;
+			snprintf(auction->buyer_name, NAME_LENGTH, "buyer %d", auction->buyer_id);
+		}
+		auction->item.nameid = 501 + item;
+		auction->item.identify = 1;
+		auction->item.amount = 1;
+		snprintf(auction->item_name, ITEM_NAME_LENGTH, "%s %s %d", auctionbench_words[item % ARRAYLENGTH(auctionbench_words)],
+		         auctionbench_words[item / ARRAYLENGTH(auctionbench_words) % ARRAYLENGTH(auctionbench_words)], item);
+		auction->type = types[item % ARRAYLENGTH(types)];
+		auction->hours = 24;
+		auction->price = 1 + auctionbench_rand() % 10000000;
+		auction->buynow = auction->price + auctionbench_rand() % 10000000;
+		idb_put(inter_auction->db, auction->auction_id, auction);
+		inter_auction->index_insert(auction);
+	}
+}
+
+/// Writes a 0x3050 request into the receive buffer of fd.
+void auctionbench_packet(int fd, const struct auctionbench_request *req)
+{
+	nullpo_retv(req);
+
+	sockt->session[fd]->rdata_pos = 0;
+	sockt->session[fd]->rdata_size = 16 + NAME_LENGTH;
+	WBUFW(RFIFOP(fd,0),0) = 0x3050;
+	WBUFL(RFIFOP(fd,0),4) = req->char_id;
+	WBUFW(RFIFOP(fd,0),8) = req->type;
+	WBUFL(RFIFOP(fd,0),10) = req->price;
+	WBUFW(RFIFOP(fd,0),14) = req->page;
+	memcpy(RFIFOP(fd,16), req->searchtext, NAME_LENGTH);
+}
+
+/// Whether an auction matches a request, as tested by the full scan.
+bool auctionbench_match(const struct auction_data *auction, const struct auctionbench_request *req)
+{
+	return !((req->type == 0 && auction->type != IT_ARMOR && auction->type != IT_PETARMOR) ||
+		(req->type == 1 && auction->type != IT_WEAPON) ||
+		(req->type == 2 && auction->type != IT_CARD) ||
+		(req->type == 3 && auction->type != IT_ETC) ||
+		(req->type == 4 && !strstr(auction->item_name, req->searchtext)) ||
+		(req->type == 5 && auction->price > req->price) ||
+		(req->type == 6 && auction->seller_id != req->char_id) ||
+		(req->type == 7 && auction->buyer_id != req->char_id));
+}
+
+/**
+ * Answers a request the way mapif_parse_auction_requestlist did before the
+ * indexes: every auction is tested and pages are counted from the first one.
+ */
+void auctionbench_scan(const struct auctionbench_request *req)
+{
+	DBIterator *iter = db_iterator(inter_auction->db);
+	struct auction_data *auction;
+	short i = 0, j = 0, pages = 1;
+
+	for (auction = dbi_first(iter); dbi_exists(iter); auction = dbi_next(iter)) {
+		if (!auctionbench_match(auction, req))
+			continue;
+		if (++i > AUCTION_PAGE_SIZE) {
+			pages++;
+			i = 1;
+		}
+		if (req->page != pages)
+			continue;
+		memcpy(WBUFP(auctionbench_list.buf, j * sizeof(struct auction_data)), auction, sizeof(struct auction_data));
+		j++;
+	}
+	dbi_destroy(iter);
+	auctionbench_list.count = j;
+	auctionbench_list.pages = pages;
+}
+
+/// Prints the latency of a batch of requests.
+void auctionbench_rate(const char *what, int count, int64 duration)
+{
+	ShowInfo("auctionbench: %s: %d requests in %"PRId64" us, %.1f us per request.\n",
+	         what, count, duration, count > 0 ? (double)duration / count : 0.);
+}
+
+/**
+ * Runs the load test.
+ *
+ * @param request_count Requests to answer per search type.
+ * @return Whether every request got the same answer from both paths.
+ */
+bool auctionbench_run(int request_count)
+{
+	struct auctionbench_request *reqs;
+	void (*sendlist) (int fd, int char_id, short count, short pages, unsigned char *buf) = mapif->auction_sendlist;
+	void (*fromsql) (void) = inter_auction->fromsql;
+	int i, type, mismatches = 0, fd = 0; // the requests are read from the dummy session
+	int64 start, total[2] = { 0, 0 };
+
+	start = timer->microtick();
+	inter_auction->fromsql = auctionbench_fromsql;
+	inter_auction->sql_init();
+	inter_auction->fromsql = fromsql;
+	ShowInfo("auctionbench: %d auctions loaded and indexed in %"PRId64" us.\n", auctionbench_count, timer->microtick() - start);
+
+	mapif->auction_sendlist = auctionbench_sendlist;
+	CREATE(reqs, struct auctionbench_request, request_count);
+	for (type = AUCTION_SEARCH_ARMOR; type <= AUCTION_SEARCH_BUY; type++) {
+		int64 duration[2] = { 0, 0 };
+		char what[64];
+
+		for (i = 0; i < request_count; i++) {
+			struct auctionbench_request *req = &reqs[i];
+			short count, pages;
+			int k;
+
+			memset(req, 0, sizeof(*req));
+			req->char_id = 150000 + auctionbench_rand() % AUCTIONBENCH_SELLERS;
+			req->type = type;
+			req->price = auctionbench_rand() % 10000000;
+			safestrncpy(req->searchtext, auctionbench_words[auctionbench_rand() % ARRAYLENGTH(auctionbench_words)], NAME_LENGTH);
+			// any page of the results, found through the index
+			req->page = 1;
+			auctionbench_packet(fd, req);
+			mapif->parse_auction_requestlist(fd);
+			req->page = 1 + auctionbench_rand() % auctionbench_list.pages;
+
+			auctionbench_packet(fd, req);
+			mapif->parse_auction_requestlist(fd);
+			for (k = 0; k < auctionbench_list.count; k++) {
+				if (!auctionbench_match((const struct auction_data *)WBUFP(auctionbench_list.buf, k * sizeof(struct auction_data)), req))
+					break;
+			}
+			if (k < auctionbench_list.count) {
+				mismatches++;
+				continue;
+			}
+			count = auctionbench_list.count;
+			pages = auctionbench_list.pages;
+			auctionbench_scan(req);
+			if (count != auctionbench_list.count || pages != auctionbench_list.pages)
+				mismatches++;
+		}
+
+		start = timer->microtick();
+		for (i = 0; i < request_count; i++)
+			auctionbench_scan(&reqs[i]);
+		duration[0] = timer->microtick() - start;
+
+		start = timer->microtick();
+		for (i = 0; i < request_count; i++) {
+			auctionbench_packet(fd, &reqs[i]);
+			mapif->parse_auction_requestlist(fd);
+		}
+		duration[1] = timer->microtick() - start;
+
+		snprintf(what, sizeof(what), "search type %d, full scan", type);
+		auctionbench_rate(what, request_count, duration[0]);
+		snprintf(what, sizeof(what), "search type %d, indexes", type);
+		auctionbench_rate(what, request_count, duration[1]);
+		total[0] += duration[0];
+		total[1] += duration[1];
+	}
+	auctionbench_rate("all searches, full scan", request_count * (AUCTION_SEARCH_BUY + 1), total[0]);
+	auctionbench_rate("all searches, indexes", request_count * (AUCTION_SEARCH_BUY + 1), total[1]);
+	ShowStatus("auctionbench: %d of %d requests differed.\n", mismatches, request_count * (AUCTION_SEARCH_BUY + 1));
+
+	aFree(reqs);
+	mapif->auction_sendlist = sendlist;
+	inter_auction->sql_final();
+	return mismatches == 0;
+}
+
+/**
+ * --auction-bench handler
+ *
+ * Runs the load test instead of the server.
+ * @see cmdline->exec
+ */
+CMDLINEARG(auctionbench)
+{
+	int requests = 1000, seed = 1;
+
+	if (sscanf(params, "%d,%d,%d", &auctionbench_count, &requests, &seed) < 1 || auctionbench_count < 1 || requests < 1) {
+		ShowError("auctionbench: expected <auctions>[,<requests>[,<seed>]], got '%s'\n", params);
+		exit(EXIT_FAILURE);
+	}
+	auctionbench_seed = (uint32)seed;
+	exit(auctionbench_run(requests) ? EXIT_SUCCESS : EXIT_FAILURE);
+	return true;
+}
+HPExport void server_preinit(void) {
+	addArg("--auction-bench", true, auctionbench, "Runs the auction house load test with the given number of auctions, then quits.");
+}
@@ -0,0 +1,988 @@
+// Copyright (c) Hercules Dev Team, licensed under GNU GPL.
+// See the LICENSE file
+
+/**
+ * Combat simulation harness.
+ *
+ * Runs battle->calc_attack and status_calc_pc outside of a live server:
+ * the map-server starts in minimal mode (no SQL, no network, no NPCs),
+ * creates the characters and monsters described in a configuration file,
+ * evaluates every exchange of that file a fixed number of times and prints
+ * the damage distribution and the number of calls per second.
+ * Damage is only calculated, never applied, so every iteration of an
+ * exchange starts from the same state.
+ * After the exchanges, the scenarios of the file run in order: named checks
+ * and benchmarks of other map-server code paths that need the same headless
+ * setup (see combatsim_scenarios).
+ *
+ * Usage:
+ *   ./map-server --load-plugin combatsim [--battle-config <file>] --combat-sim <file> [--rnd-seed <n>]
+ *
+ * --battle-config must come before --combat-sim, as the battle configuration
+ * is read as soon as the simulation is requested (monster stats depend on it).
+ * Runs with the same --rnd-seed and the same databases print the same numbers,
+ * so the output can be compared between two builds.
+ *
+ * Configuration example:
+ *
+ *   combat_sim: {
+ *     map: "prontera"
+ *     x: 150
+ *     y: 150
+ *     iterations: 10000  // calc_attack calls per exchange
+ *     status_calc: 1000  // status_calc_pc calls per character, 0 to skip
+ *     characters: (
+ *     {
+ *       name: "knight"
+ *       job: 7                          // Job_Knight
+ *       sex: "M"
+ *       base_level: 99
+ *       job_level: 50
+ *       stats: [ 90, 50, 80, 1, 60, 10 ] // str, agi, vit, int, dex, luk
+ *       equip: [ 1163, 2320, 2115 ]      // item ids, equipped in order
+ *       skills: ( ("SM_SWORD", 10), ("KN_TWOHANDQUICKEN", 10) )
+ *     },
+ *     )
+ *     monsters: (
+ *     { name: "orc"; id: 1023 },
+ *     )
+ *     exchanges: (
+ *     { attacker: "knight"; target: "orc"; skill: "KN_BOWLINGBASH"; level: 10 },
+ *     { attacker: "orc"; target: "knight" },  // normal attack
+ *     )
+ *     scenarios: (
+ *     { type: "sc_regression"; values: [ 5, 10, 15, 20 ] },
+ *     )
+ *   }
+ *
+ * Scenarios:
+ *   sc_regression: prints every unit's status under each status change that
+ *     affects it, alone. values are val1-val4 of those status changes.
+ *   sc_recalc: { statuses: [ 10, 12, ... ]; calcs: 100000; values: [ 5, 10, 15, 20 ] }
+ *     times the status recalculations that starting or ending each of the
+ *     given status changes triggers (status_calc_bl with its
+ *     ChangeFlagTable flags) on every unit, first with none of them, then
+ *     with all of them active, and prints the status with all of them.
+ *     By default the status changes are a WoE party's buffs.
+ *   searchstore: { shops: 5000; slots: 12; items: 300; queries: 1000; seed: 1 }
+ *     opens `shops` vending shops of `slots` items, drawn from the first
+ *     `items` item ids of the item db, and times Universal Catalog queries of
+ *     1-3 of those items through the store index and through the per-shop
+ *     scan (vending->searchall) the index replaced. Results are compared
+ *     without the result limit first.
+ **/
+
+#include "common/hercules.h" /* Should always be the first Hercules file included! */
+#include "common/cbasetypes.h"
+#include "common/conf.h"
+#include "common/core.h"
+#include "common/malloc.h"
+#include "common/mmo.h"
+#include "common/nullpo.h"
+#include "common/showmsg.h"
+#include "common/strlib.h"
+#include "common/timer.h"
+#include "common/utils.h"
+#include "map/atcommand.h"
+#include "map/battle.h"
+#include "map/itemdb.h"
+#include "map/map.h"
+#include "map/mob.h"
+#include "map/pc.h"
+#include "map/searchstore.h"
+#include "map/skill.h"
+#include "map/status.h"
+#include "map/unit.h"
+#include "map/vending.h"
+
+#include "common/HPMDataCheck.h" /* should always be the last Hercules file included! */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+HPExport struct hplugin_info pinfo = {
+	"combatsim",     // Plugin name
+	SERVER_TYPE_MAP, // Which server types this plugin works with?
+	"0.1",           // Plugin version
+	HPM_VERSION,     // HPM Version (don't change, macro is automatically updated)
+};
+
+/// A character or monster taking part in the simulation
+struct sim_unit {
+	char name[NAME_LENGTH];
+	struct block_list *bl;
+	struct map_session_data *sd; ///< Owned by the simulation, NULL for monsters
+};
+
+/// Damage figures of an exchange
+struct sim_result {
+	int calls;
+	int hits;    ///< Calls that did some damage
+	int crits;
+	int64 total; ///< Sum of all damage, identical between runs with the same seed
+	int64 *damage; ///< Damage of every call, sorted once the exchange is done
+	int64 duration; ///< Microseconds spent in calc_attack
+};
+
+/// A check or benchmark run after the exchanges
+struct sim_scenario {
+	const char *name;
+	bool (*run) (config_setting_t *conf); ///< Returns false on configuration errors
+};
+
+struct {
+	char *file;
+	uint32 seed; ///< State of combatsim_rand
+	int16 m;
+	int16 x, y;
+	int iterations;
+	int status_calc;
+	struct sim_unit *units;
+	int unit_count;
+	int next_id;
+} sim;
+
+/**
+ * Finds a unit by name.
+ *
+ * @param name Name given in the configuration.
+ * @return The unit, NULL if not found.
+ */
+struct sim_unit *combatsim_unit(const char *name)
+{
+	int i;
+
+	nullpo_retr(NULL, name);
+
+	for (i = 0; i < sim.unit_count; i++) {
+		if (strcmp(sim.units[i].name, name) == 0)
+			return &sim.units[i];
+	}
+	return NULL;
+}
+
+/**
+ * Deterministic pseudo-random numbers for the scenarios (the core's rnd()
+ * isn't available to plugins).
+ *
+ * @return a number in [0, 0x7fffffff].
+ */
+int combatsim_rand(void)
+{
+	sim.seed = sim.seed * 1103515245 + 12345;
+	return (int)((sim.seed >> 1) & 0x7fffffff);
+}
+
+/**
+ * Prints the rate of a timed benchmark loop.
+ *
+ * @param scenario Scenario name.
+ * @param what     What was timed.
+ * @param count    Number of operations.
+ * @param duration Microseconds they took.
+ */
+void combatsim_rate(const char *scenario, const char *what, int64 count, int64 duration)
+{
+	ShowInfo("combatsim: %s: %s: %"PRId64" in %"PRId64" us, %"PRId64"/s\n",
+	         scenario, what, count, duration, count * 1000000 / max(duration, 1));
+}
+
+/**
+ * Creates a character from its configuration, without any client attached.
+ *
+ * @param conf The character's configuration.
+ * @param su   The unit to fill.
+ * @return Whether the character could be created.
+ */
+bool combatsim_add_character(config_setting_t *conf, struct sim_unit *su)
+{
+	struct map_session_data *sd;
+	config_setting_t *list;
+	const char *str;
+	int i, job = JOB_NOVICE, base_level = 1, job_level = 1, class_, equipped = 0;
+
+	nullpo_retr(false, conf);
+	nullpo_retr(false, su);
+
+	libconfig->setting_lookup_int(conf, "job", &job);
+	libconfig->setting_lookup_int(conf, "base_level", &base_level);
+	libconfig->setting_lookup_int(conf, "job_level", &job_level);
+	if ((class_ = pc->jobid2mapid(job)) == -1) {
+		ShowError("combatsim: character '%s' has an invalid job %d\n", su->name, job);
+		return false;
+	}
+
+	CREATE(sd, struct map_session_data, 1);
+	sim.next_id++;
+	pc->setnewpc(sd, sim.next_id, sim.next_id, 0, 0, SEX_MALE, 0); // fd 0 is the session of clients that aren't connected
+	// timers pc->authok would have reset, 0 being a valid timer id
+	sd->followtimer = sd->invincible_timer = sd->npc_timer_id = sd->pvp_timer = INVALID_TIMER;
+	sd->fontcolor_tid = sd->expiration_tid = sd->rental_timer = INVALID_TIMER;
+	for (i = 0; i < MAX_SPIRITBALL; i++)
+		sd->spirit_timer[i] = INVALID_TIMER;
+	for (i = 0; i < ARRAYLENGTH(sd->autobonus); i++)
+		sd->autobonus[i].active = sd->autobonus2[i].active = sd->autobonus3[i].active = INVALID_TIMER;
+	if (libconfig->setting_lookup_string(conf, "sex", &str) && (str[0] == 'F' || str[0] == 'f'))
+		sd->status.sex = SEX_FEMALE;
+	safestrncpy(sd->status.name, su->name, NAME_LENGTH);
+	sd->status.class_ = job;
+	sd->class_ = class_;
+	sd->status.base_level = cap_value(base_level, 1, MAX_LEVEL);
+	sd->status.job_level = cap_value(job_level, 1, MAX_LEVEL);
+	if ((list = libconfig->setting_get_member(conf, "stats")) != NULL) {
+		short *stats[] = { &sd->status.str, &sd->status.agi, &sd->status.vit, &sd->status.int_, &sd->status.dex, &sd->status.luk };
+
+		for (i = 0; i < ARRAYLENGTH(stats) && i < libconfig->setting_length(list); i++)
+			*stats[i] = cap_value(libconfig->setting_get_int_elem(list, i), 1, pc_maxparameter(sd));
+	} else {
+		sd->status.str = sd->status.agi = sd->status.vit = sd->status.int_ = sd->status.dex = sd->status.luk = 1;
+	}
+
+	if ((list = libconfig->setting_get_member(conf, "equip")) != NULL) {
+		for (i = 0; i < libconfig->setting_length(list) && i < MAX_INVENTORY; i++) {
+			int nameid = libconfig->setting_get_int_elem(list, i);
+			struct item_data *data = itemdb->exists(nameid);
+			int pos;
+
+			if (data == NULL || data->equip == 0) {
+				ShowWarning("combatsim: character '%s': item %d doesn't exist or can't be equipped, skipping...\n", su->name, nameid);
+				continue;
+			}
+			pos = data->equip;
+			if ((pos&EQP_ACC) == EQP_ACC) // accessories go on whichever side is free
+				pos = (equipped&EQP_ACC_L) ? EQP_ACC_R : EQP_ACC_L;
+			if (pos&equipped) {
+				ShowWarning("combatsim: character '%s': item %d uses an already equipped slot, skipping...\n", su->name, nameid);
+				continue;
+			}
+			equipped |= pos;
+			sd->status.inventory[i].nameid = nameid;
+			sd->status.inventory[i].amount = 1;
+			sd->status.inventory[i].identify = 1;
+			sd->status.inventory[i].equip = pos;
+		}
+	}
+
+	if ((list = libconfig->setting_get_member(conf, "skills")) != NULL) {
+		for (i = 0; i < libconfig->setting_length(list); i++) {
+			config_setting_t *entry = libconfig->setting_get_elem(list, i);
+			const char *name = libconfig->setting_get_string_elem(entry, 0);
+			int skill_id = name ? skill->name2id(name) : 0, idx;
+
+			if (skill_id == 0 || (idx = skill->get_index(skill_id)) == 0) {
+				ShowWarning("combatsim: character '%s': unknown skill '%s', skipping...\n", su->name, name ? name : "");
+				continue;
+			}
+			sd->status.skill[idx].id = skill_id;
+			sd->status.skill[idx].lv = libconfig->setting_get_int_elem(entry, 1);
+			sd->status.skill[idx].flag = SKILL_FLAG_PERM_GRANTED; // kept whatever the skill tree says
+		}
+	}
+
+	if (pc->set_group(sd, 0) != 0) {
+		ShowError("combatsim: character '%s': group 0 doesn't exist\n", su->name);
+		aFree(sd);
+		return false;
+	}
+	sd->regs.vars = i64db_alloc(DB_OPT_BASE); // item scripts may use variables
+	sd->status.hp = sd->status.sp = 1; // alive, filled up once the status is known
+	sd->bl.m = sim.m;
+	sd->bl.x = sim.x;
+	sd->bl.y = sim.y;
+	pc->setinventorydata(sd);
+	pc->setequipindex(sd);
+	status->set_viewdata(&sd->bl, sd->status.class_);
+	unit->dataset(&sd->bl);
+	status_calc_pc(sd, SCO_FIRST|SCO_FORCE);
+	sd->battle_status.hp = sd->status.hp = sd->battle_status.max_hp;
+	sd->battle_status.sp = sd->status.sp = sd->battle_status.max_sp;
+
+	su->bl = &sd->bl;
+	su->sd = sd;
+	return true;
+}
+
+/**
+ * Spawns a monster from its configuration.
+ *
+ * @param conf The monster's configuration.
+ * @param su   The unit to fill.
+ * @return Whether the monster could be spawned.
+ */
+bool combatsim_add_monster(config_setting_t *conf, struct sim_unit *su)
+{
+	struct mob_data *md;
+	int class_ = 0;
+
+	nullpo_retr(false, conf);
+	nullpo_retr(false, su);
+
+	libconfig->setting_lookup_int(conf, "id", &class_);
+	if (mob->db_checkid(class_) == 0) {
+		ShowError("combatsim: monster '%s' has an invalid id %d\n", su->name, class_);
+		return false;
+	}
+	if ((md = mob->once_spawn_sub(NULL, sim.m, sim.x, sim.y, su->name, class_, "", 0, AI_NONE)) == NULL) { // size 0: stats as in the mob db
+		ShowError("combatsim: monster '%s' couldn't be created\n", su->name);
+		return false;
+	}
+	mob->spawn(md);
+
+	su->bl = &md->bl;
+	su->sd = NULL;
+	return true;
+}
+
+/**
+ * Frees the characters created by the simulation
+ * (monsters are removed with the map-server's units on shutdown).
+ */
+void combatsim_clear_units(void)
+{
+	int i;
+
+	for (i = 0; i < sim.unit_count; i++) {
+		if (sim.units[i].sd != NULL) {
+			db_destroy(sim.units[i].sd->regs.vars);
+			aFree(sim.units[i].sd);
+		}
+	}
+	if (sim.units != NULL)
+		aFree(sim.units);
+	sim.units = NULL;
+	sim.unit_count = 0;
+}
+
+/**
+ * qsort comparator for damage values.
+ */
+int combatsim_damage_cmp(const void *a, const void *b)
+{
+	int64 x = *(const int64 *)a, y = *(const int64 *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * Evaluates an exchange sim.iterations times and prints its results.
+ *
+ * @param conf The exchange's configuration.
+ * @return Whether the exchange was valid.
+ */
+bool combatsim_exchange(config_setting_t *conf)
+{
+	struct sim_unit *src, *target;
+	struct sim_result res;
+	const char *str = NULL;
+	int skill_id = 0, skill_lv = 1, count = 0, attack_type = BF_WEAPON;
+	int64 start;
+
+	nullpo_retr(false, conf);
+
+	if (!libconfig->setting_lookup_string(conf, "attacker", &str) || (src = combatsim_unit(str)) == NULL) {
+		ShowError("combatsim: exchange #%d: unknown attacker '%s'\n", libconfig->setting_index(conf), str ? str : "");
+		return false;
+	}
+	str = NULL;
+	if (!libconfig->setting_lookup_string(conf, "target", &str) || (target = combatsim_unit(str)) == NULL) {
+		ShowError("combatsim: exchange #%d: unknown target '%s'\n", libconfig->setting_index(conf), str ? str : "");
+		return false;
+	}
+	if (libconfig->setting_lookup_string(conf, "skill", &str)) {
+		if ((skill_id = skill->name2id(str)) == 0) {
+			ShowError("combatsim: exchange #%d: unknown skill '%s'\n", libconfig->setting_index(conf), str);
+			return false;
+		}
+		libconfig->setting_lookup_int(conf, "level", &skill_lv);
+		if ((attack_type = skill->get_type(skill_id)) == 0) {
+			ShowError("combatsim: exchange #%d: skill '%s' does no damage\n", libconfig->setting_index(conf), str);
+			return false;
+		}
+	}
+	libconfig->setting_lookup_int(conf, "count", &count); // targets sharing a split damage skill
+
+	memset(&res, 0, sizeof(res));
+	CREATE(res.damage, int64, sim.iterations);
+
+	start = timer->microtick();
+	for (res.calls = 0; res.calls < sim.iterations; res.calls++) {
+		struct Damage d = battle->calc_attack(attack_type, src->bl, target->bl, skill_id, skill_lv, count);
+		int64 damage = d.damage + d.damage2;
+
+		res.damage[res.calls] = damage;
+		res.total += damage;
+		if (damage > 0 && d.dmg_lv == ATK_DEF)
+			res.hits++;
+		if (d.type == BDT_CRIT)
+			res.crits++;
+	}
+	res.duration = timer->microtick() - start;
+
+	qsort(res.damage, res.calls, sizeof(*res.damage), combatsim_damage_cmp);
+	ShowInfo("combatsim: %s -> %s, %s Lv %d: %d calls, %"PRId64" calls/s, %d%% hit, %d%% crit\n",
+	         src->name, target->name, skill_id ? skill->get_name(skill_id) : "attack", skill_id ? skill_lv : 0,
+	         res.calls, (int64)res.calls * 1000000 / max(res.duration, 1),
+	         res.hits * 100 / max(res.calls, 1), res.crits * 100 / max(res.calls, 1));
+	ShowInfo("combatsim:   damage min %"PRId64", p10 %"PRId64", median %"PRId64", p90 %"PRId64", max %"PRId64", avg %"PRId64", total %"PRId64"\n",
+	         res.damage[0], res.damage[res.calls / 10], res.damage[res.calls / 2], res.damage[res.calls * 9 / 10], res.damage[res.calls - 1],
+	         res.total / res.calls, res.total);
+
+	aFree(res.damage);
+	return true;
+}
+
+/**
+ * Times status_calc_pc on every character.
+ */
+void combatsim_status_calc(void)
+{
+	int i, n;
+
+	for (i = 0; i < sim.unit_count; i++) {
+		struct map_session_data *sd = sim.units[i].sd;
+		int64 start, duration;
+
+		if (sd == NULL)
+			continue;
+
+		start = timer->microtick();
+		for (n = 0; n < sim.status_calc; n++)
+			status_calc_pc(sd, SCO_FORCE);
+		duration = timer->microtick() - start;
+
+		ShowInfo("combatsim: %s status_calc_pc: %d calls, %"PRId64" calls/s (atk %d, matk %d-%d, def %d, flee %d, hit %d, aspd %d)\n",
+		         sim.units[i].name, n, (int64)n * 1000000 / max(duration, 1),
+		         sd->battle_status.batk + sd->battle_status.rhw.atk, sd->battle_status.matk_min, sd->battle_status.matk_max,
+		         sd->battle_status.def, sd->battle_status.flee, sd->battle_status.hit, sd->battle_status.amotion);
+	}
+}
+
+/**
+ * Prints the battle status figures the status change calculations touch,
+ * in a fixed format so that two builds' outputs can be diffed.
+ */
+void combatsim_sc_print(const char *name, sc_type type, const struct status_data *st)
+{
+	ShowInfo("combatsim: sc %4d %s: str %d agi %d vit %d int %d dex %d luk %d, batk %d watk %d matk %d-%d,"
+	         " hit %d flee %d flee2 %d cri %d, def %d def2 %d mdef %d mdef2 %d, aspd %d speed %d, hp %u sp %u\n",
+	         (int)type, name, st->str, st->agi, st->vit, st->int_, st->dex, st->luk, st->batk, st->rhw.atk, st->matk_min, st->matk_max,
+	         st->hit, st->flee, st->flee2, st->cri, st->def, st->def2, st->mdef, st->mdef2, st->amotion, st->speed, st->max_hp, st->max_sp);
+}
+
+/**
+ * Status change regression scenario.
+ *
+ * For every status change that affects the battle status, puts it alone on
+ * every unit with the configured values, recalculates the affected parts of
+ * the status and prints the result. Comparing the output of two builds shows
+ * any status change whose calculation changed between them.
+ *
+ * @param conf The scenario's configuration.
+ * @return true.
+ */
+bool combatsim_sc_regression(config_setting_t *conf)
+{
+	config_setting_t *list;
+	int i, changed = 0;
+	int values[4] = { 5, 10, 15, 20 }; // a level
+	sc_type type;
+
+	nullpo_retr(false, conf);
+
+	if ((list = libconfig->setting_get_member(conf, "values")) != NULL) {
+		for (i = 0; i < ARRAYLENGTH(values) && i < libconfig->setting_length(list); i++)
+			values[i] = libconfig->setting_get_int_elem(list, i);
+	}
+
+	for (i = 0; i < sim.unit_count; i++) {
+		struct block_list *bl = sim.units[i].bl;
+		struct status_change *sc = status->get_sc(bl);
+		struct status_data *st = status->get_status_data(bl);
+		struct map_session_data *sd = BL_CAST(BL_PC, bl);
+		struct status_data base;
+
+		if (sc == NULL || sc->count != 0)
+			continue;
+		status_calc_bl(bl, SCB_ALL); // settles what the spawn calculation leaves out (monster matk)
+		memcpy(&base, st, sizeof(base));
+		combatsim_sc_print(sim.units[i].name, SC_NONE, st);
+
+		for (type = 0; type < SC_MAX; type++) {
+			struct status_change_entry sce;
+			int flag = status->dbs->ChangeFlagTable[type];
+
+			if (flag == SCB_NONE)
+				continue;
+			memset(&sce, 0, sizeof(sce));
+			sce.timer = INVALID_TIMER;
+			sce.val1 = values[0];
+			sce.val2 = values[1];
+			sce.val3 = values[2];
+			sce.val4 = values[3];
+			sc->data[type] = &sce;
+			sc->count = 1;
+			status->sc_mod_update(sc, type);
+			status_calc_bl(bl, flag);
+			if (memcmp(&base, st, sizeof(base)) != 0) {
+				combatsim_sc_print(sim.units[i].name, type, st);
+				changed++;
+			}
+			sc->data[type] = NULL;
+			sc->count = 0;
+			status->sc_mod_update(sc, type);
+			status_calc_bl(bl, flag);
+			// refill what a lower maximum cut off
+			st->hp = base.hp;
+			st->sp = base.sp;
+			if (sd != NULL) {
+				sd->status.hp = base.hp;
+				sd->status.sp = base.sp;
+			}
+		}
+	}
+	ShowStatus("combatsim: status change regression done, %d unit and status change pairs altered a status.\n", changed);
+	return true;
+}
+
+/**
+ * Buff-heavy recalculation scenario, see the file's header.
+ *
+ * @param conf The scenario's configuration.
+ * @return Whether the configuration was valid.
+ */
+bool combatsim_sc_recalc(config_setting_t *conf)
+{
+	// a WoE party's buffs, none of them recalculating the whole player
+	sc_type defaults[] = {
+		SC_BLESSING, SC_INC_AGI, SC_ANGELUS, SC_GLORIA, SC_IMPOSITIO, SC_SUFFRAGIUM, SC_ASSUMPTIO, SC_MAGNIFICAT,
+		SC_ADRENALINE, SC_WEAPONPERFECT, SC_OVERTHRUST, SC_MAXIMIZEPOWER, SC_CONCENTRATION, SC_TWOHANDQUICKEN,
+		SC_SHOUT, SC_WINDWALK, SC_TRUESIGHT, SC_PLUSATTACKPOWER, SC_PLUSMAGICPOWER, SC_ATTHASTE_POTION3,
+		SC_FOOD_STR, SC_FOOD_AGI, SC_FOOD_VIT, SC_FOOD_INT, SC_FOOD_DEX, SC_FOOD_LUK, SC_INCHIT, SC_INCFLEE,
+		SC_INCALLSTATUS, SC_INCATKRATE,
+	};
+	sc_type *types = defaults;
+	struct status_change_entry *entries;
+	config_setting_t *list;
+	int i, j, k, count = ARRAYLENGTH(defaults), calcs = 100000, values[4] = { 5, 10, 15, 20 };
+
+	nullpo_retr(false, conf);
+
+	libconfig->setting_lookup_int(conf, "calcs", &calcs);
+	if ((list = libconfig->setting_get_member(conf, "values")) != NULL) {
+		for (i = 0; i < ARRAYLENGTH(values) && i < libconfig->setting_length(list); i++)
+			values[i] = libconfig->setting_get_int_elem(list, i);
+	}
+	if ((list = libconfig->setting_get_member(conf, "statuses")) != NULL) {
+		count = libconfig->setting_length(list);
+		CREATE(types, sc_type, max(count, 1));
+		for (i = 0; i < count; i++) {
+			types[i] = libconfig->setting_get_int_elem(list, i);
+			if (types[i] <= SC_NONE || types[i] >= SC_MAX || status->dbs->ChangeFlagTable[types[i]] == SCB_NONE) {
+				ShowError("combatsim: sc_recalc: status change %d doesn't exist or affects no status\n", types[i]);
+				aFree(types);
+				return false;
+			}
+		}
+	}
+	if (count < 1 || calcs < 1) {
+		ShowError("combatsim: sc_recalc: statuses must not be empty and calcs must be positive\n");
+		if (types != defaults)
+			aFree(types);
+		return false;
+	}
+
+	CREATE(entries, struct status_change_entry, count);
+	for (i = 0; i < count; i++) {
+		entries[i].timer = INVALID_TIMER;
+		entries[i].val1 = values[0];
+		entries[i].val2 = values[1];
+		entries[i].val3 = values[2];
+		entries[i].val4 = values[3];
+	}
+
+	for (i = 0; i < sim.unit_count; i++) {
+		struct block_list *bl = sim.units[i].bl;
+		struct status_change *sc = status->get_sc(bl);
+		char what[NAME_LENGTH + 64];
+
+		if (sc == NULL || sc->count != 0)
+			continue;
+		// every recalculation a status change of the set starts or ends triggers, first without any, then with all of them active
+		for (j = 0; j < 2; j++) {
+			int64 start, duration;
+			int n = 0;
+
+			if (j == 1) {
+				for (k = 0; k < count; k++) {
+					sc->data[types[k]] = &entries[k];
+					sc->count++;
+					status->sc_mod_update(sc, types[k]);
+				}
+				status_calc_bl(bl, SCB_ALL);
+			}
+			start = timer->microtick();
+			while (n < calcs) {
+				for (k = 0; k < count && n < calcs; k++, n++)
+					status_calc_bl(bl, status->dbs->ChangeFlagTable[types[k]]);
+			}
+			duration = timer->microtick() - start;
+			snprintf(what, sizeof(what), "%s, %d of %d status changes active", sim.units[i].name, j ? count : 0, count);
+			combatsim_rate("sc_recalc", what, n, duration);
+		}
+		combatsim_sc_print(sim.units[i].name, SC_NONE, status->get_status_data(bl));
+		for (k = 0; k < count; k++) {
+			sc->data[types[k]] = NULL;
+			sc->count--;
+			status->sc_mod_update(sc, types[k]);
+		}
+		status_calc_bl(bl, SCB_ALL);
+	}
+
+	aFree(entries);
+	if (types != defaults)
+		aFree(types);
+	return true;
+}
+
+/// qsort comparator putting search results in a canonical order.
+int combatsim_searchstore_cmp(const void *a, const void *b)
+{
+	const struct s_search_store_info_item *x = a, *y = b;
+
+	if (x->price != y->price)
+		return (x->price > y->price) - (x->price < y->price);
+	if (x->account_id != y->account_id)
+		return x->account_id - y->account_id;
+	return x->nameid - y->nameid;
+}
+
+/**
+ * Runs a Universal Catalog query over the shops, through the index or
+ * through the per-shop scan.
+ *
+ * @param searcher Searching character, receives the results.
+ * @param shops    The shops.
+ * @param count    Number of shops.
+ * @param s        The query.
+ * @param indexed  Whether to use the index.
+ */
+void combatsim_searchstore_query(struct map_session_data *searcher, struct map_session_data **shops, int count, const struct s_search_store_search *s, bool indexed)
+{
+	int i;
+
+	searcher->searchstore.count = 0;
+	if (indexed) {
+		searchstore->index_search(searcher, s, SEARCHTYPE_VENDING);
+		return;
+	}
+	for (i = 0; i < count; i++) {
+		if (!vending->searchall(shops[i], s))
+			break;
+	}
+}
+
+/**
+ * Universal Catalog scenario, see the file's header.
+ *
+ * @param conf The scenario's configuration.
+ * @return Whether the configuration was valid and both paths agreed.
+ */
+bool combatsim_searchstore(config_setting_t *conf)
+{
+	struct map_session_data **shops, *searcher;
+	struct s_search_store_search *queries;
+	unsigned short *pool, *itemlists;
+	struct s_search_store_info_item *results;
+	int shop_count = 5000, slots = 12, items = 300, query_count = 1000, seed = 1;
+	int i, j, nameid, pool_size = 0, mismatches = 0, max_results = battle->bc->searchstore_maxresults;
+	int64 start, found[2] = { 0, 0 }, duration[2] = { 0, 0 };
+
+	nullpo_retr(false, conf);
+
+	libconfig->setting_lookup_int(conf, "shops", &shop_count);
+	libconfig->setting_lookup_int(conf, "slots", &slots);
+	libconfig->setting_lookup_int(conf, "items", &items);
+	libconfig->setting_lookup_int(conf, "queries", &query_count);
+	libconfig->setting_lookup_int(conf, "seed", &seed);
+	if (shop_count < 1 || slots < 1 || slots > MAX_VENDING || items < 1 || query_count < 1) {
+		ShowError("combatsim: searchstore: shops, items and queries must be positive and slots within 1-%d\n", MAX_VENDING);
+		return false;
+	}
+	sim.seed = (uint32)seed;
+
+	CREATE(pool, unsigned short, items);
+	for (nameid = 501; nameid < MAX_ITEMDB && pool_size < items; nameid++) {
+		if (itemdb->exists(nameid) != NULL)
+			pool[pool_size++] = (unsigned short)nameid;
+	}
+
+	start = timer->microtick();
+	CREATE(shops, struct map_session_data *, shop_count);
+	for (i = 0; i < shop_count; i++) {
+		struct map_session_data *sd;
+
+		CREATE(sd, struct map_session_data, 1);
+		sd->bl.id = sd->status.account_id = 2000000 + i;
+		sd->vender_id = i + 1;
+		sd->state.vending = 1;
+		sd->vend_num = slots;
+		snprintf(sd->message, sizeof(sd->message), "shop %d", i);
+		for (j = 0; j < slots; j++) {
+			int k;
+
+			do { // the scan only reports the first slot of an item in a shop
+				nameid = pool[combatsim_rand() % pool_size];
+				ARR_FIND(0, j, k, sd->status.cart[k].nameid == nameid);
+			} while (k < j && pool_size >= slots);
+			sd->status.cart[j].nameid = nameid;
+			sd->status.cart[j].amount = 1 + combatsim_rand() % 10;
+			sd->status.cart[j].identify = 1;
+			sd->vending[j].index = j;
+			sd->vending[j].amount = sd->status.cart[j].amount;
+			sd->vending[j].value = 1 + combatsim_rand() % 1000000;
+		}
+		searchstore->index_add(sd, SEARCHTYPE_VENDING);
+		shops[i] = sd;
+	}
+	combatsim_rate("searchstore", "shops opened and indexed", shop_count, timer->microtick() - start);
+
+	CREATE(searcher, struct map_session_data, 1);
+	CREATE(queries, struct s_search_store_search, query_count);
+	CREATE(itemlists, unsigned short, query_count * 3);
+	for (i = 0; i < query_count; i++) {
+		struct s_search_store_search *s = &queries[i];
+		unsigned short *itemlist = &itemlists[i * 3];
+
+		s->search_sd = searcher;
+		s->item_count = 1 + combatsim_rand() % 3;
+		for (j = 0; j < (int)s->item_count; j++) {
+			int k;
+
+			do {
+				itemlist[j] = pool[combatsim_rand() % pool_size];
+				ARR_FIND(0, j, k, itemlist[k] == itemlist[j]);
+			} while (k < j && pool_size >= 3);
+		}
+		s->itemlist = itemlist;
+		s->min_price = (combatsim_rand() % 2) ? (unsigned int)(combatsim_rand() % 500000) : 0;
+		s->max_price = (combatsim_rand() % 2) ? s->min_price + (unsigned int)(combatsim_rand() % 500000) : 0;
+	}
+
+	CREATE(searcher->searchstore.items, struct s_search_store_info_item, shop_count * slots);
+	CREATE(results, struct s_search_store_info_item, shop_count * slots);
+
+	// both paths must find the same items when nothing limits the results
+	battle->bc->searchstore_maxresults = shop_count * slots;
+	for (i = 0; i < min(query_count, 100); i++) {
+		unsigned int count;
+
+		combatsim_searchstore_query(searcher, shops, shop_count, &queries[i], false);
+		count = searcher->searchstore.count;
+		memcpy(results, searcher->searchstore.items, sizeof(*results) * count);
+		combatsim_searchstore_query(searcher, shops, shop_count, &queries[i], true);
+		qsort(results, count, sizeof(*results), combatsim_searchstore_cmp);
+		qsort(searcher->searchstore.items, searcher->searchstore.count, sizeof(*results), combatsim_searchstore_cmp);
+		if (count != searcher->searchstore.count || memcmp(results, searcher->searchstore.items, sizeof(*results) * count) != 0)
+			mismatches++;
+	}
+
+	// then time them with the configured result limit
+	battle->bc->searchstore_maxresults = max_results;
+	for (j = 0; j < 2; j++) {
+		start = timer->microtick();
+		for (i = 0; i < query_count; i++) {
+			combatsim_searchstore_query(searcher, shops, shop_count, &queries[i], j == 1);
+			found[j] += searcher->searchstore.count;
+		}
+		duration[j] = timer->microtick() - start;
+	}
+	combatsim_rate("searchstore", "queries, per-shop scan", query_count, duration[0]);
+	combatsim_rate("searchstore", "queries, index", query_count, duration[1]);
+	ShowInfo("combatsim: searchstore: %d shops x %d slots over %d items, %"PRId64"/%"PRId64" results (scan/index, limit %d), %d of %d unlimited queries differed.\n",
+	         shop_count, slots, pool_size, found[0], found[1], max_results, mismatches, min(query_count, 100));
+
+	for (i = 0; i < shop_count; i++) {
+		searchstore->index_remove(shops[i], SEARCHTYPE_VENDING);
+		aFree(shops[i]);
+	}
+	aFree(results);
+	aFree(searcher->searchstore.items);
+	aFree(searcher);
+	aFree(itemlists);
+	aFree(queries);
+	aFree(shops);
+	aFree(pool);
+	return mismatches == 0;
+}
+
+/// Scenarios a `scenarios` entry may name in its `type`
+struct sim_scenario combatsim_scenarios[] = {
+	{ "sc_regression", combatsim_sc_regression },
+	{ "sc_recalc", combatsim_sc_recalc },
+	{ "searchstore", combatsim_searchstore },
+};
+
+/**
+ * Runs a scenario.
+ *
+ * @param conf The scenario's configuration.
+ * @return Whether the scenario exists and ran.
+ */
+bool combatsim_scenario(config_setting_t *conf)
+{
+	const char *str = NULL;
+	int i;
+
+	nullpo_retr(false, conf);
+
+	libconfig->setting_lookup_string(conf, "type", &str);
+	ARR_FIND(0, ARRAYLENGTH(combatsim_scenarios), i, str != NULL && strcmp(combatsim_scenarios[i].name, str) == 0);
+	if (i == ARRAYLENGTH(combatsim_scenarios)) {
+		ShowError("combatsim: scenario #%d: unknown type '%s'\n", libconfig->setting_index(conf), str ? str : "");
+		return false;
+	}
+	ShowStatus("combatsim: scenario #%d: %s\n", libconfig->setting_index(conf), str);
+	return combatsim_scenarios[i].run(conf);
+}
+
+/**
+ * Loads the parts of the map-server that minimal mode leaves out but
+ * damage and status calculations need.
+ */
+void combatsim_load(void)
+{
+	skill->read_db(false); // minimal mode only reads skill_db.txt
+	battle->init(false);
+	map->read_zone_db();
+	atcommand->init(false); // pc groups check their commands against it
+	pc->init(false);
+	status->init(false);
+}
+
+/**
+ * Runs the simulation described in sim.file.
+ *
+ * @return Whether the simulation ran (false on configuration errors).
+ */
+bool combatsim_run(void)
+{
+	config_t conf;
+	config_setting_t *root, *list;
+	const char *str = "prontera";
+	int i, x = -1, y = -1, count, exchanges = 0, scenarios = 0;
+	bool ok = true;
+
+	if (libconfig->read_file(&conf, sim.file))
+		return false;
+	if ((root = libconfig->lookup(&conf, "combat_sim")) == NULL) {
+		ShowError("combatsim: '%s' has no 'combat_sim' block\n", sim.file);
+		libconfig->destroy(&conf);
+		return false;
+	}
+
+	combatsim_load();
+
+	libconfig->setting_lookup_string(root, "map", &str);
+	if ((sim.m = map->mapname2mapid(str)) < 0) {
+		ShowError("combatsim: unknown map '%s'\n", str);
+		libconfig->destroy(&conf);
+		return false;
+	}
+	libconfig->setting_lookup_int(root, "x", &x);
+	libconfig->setting_lookup_int(root, "y", &y);
+	sim.x = (x > 0 && x < map->list[sim.m].xs) ? x : map->list[sim.m].xs / 2;
+	sim.y = (y > 0 && y < map->list[sim.m].ys) ? y : map->list[sim.m].ys / 2;
+	sim.iterations = 10000;
+	libconfig->setting_lookup_int(root, "iterations", &sim.iterations);
+	sim.iterations = max(sim.iterations, 1);
+	sim.status_calc = 0;
+	libconfig->setting_lookup_int(root, "status_calc", &sim.status_calc);
+
+	count = 0;
+	if ((list = libconfig->setting_get_member(root, "characters")) != NULL)
+		count += libconfig->setting_length(list);
+	if ((list = libconfig->setting_get_member(root, "monsters")) != NULL)
+		count += libconfig->setting_length(list);
+	CREATE(sim.units, struct sim_unit, max(count, 1));
+
+	for (i = 0; ok && (list = libconfig->setting_get_member(root, "characters")) != NULL && i < libconfig->setting_length(list); i++) {
+		config_setting_t *entry = libconfig->setting_get_elem(list, i);
+		struct sim_unit *su = &sim.units[sim.unit_count];
+
+		if (!libconfig->setting_lookup_string(entry, "name", &str) || combatsim_unit(str) != NULL) {
+			ShowError("combatsim: character #%d has no name or a duplicate one\n", i);
+			ok = false;
+			break;
+		}
+		safestrncpy(su->name, str, NAME_LENGTH);
+		if (!(ok = combatsim_add_character(entry, su)))
+			break;
+		sim.unit_count++;
+	}
+	for (i = 0; ok && (list = libconfig->setting_get_member(root, "monsters")) != NULL && i < libconfig->setting_length(list); i++) {
+		config_setting_t *entry = libconfig->setting_get_elem(list, i);
+		struct sim_unit *su = &sim.units[sim.unit_count];
+
+		if (!libconfig->setting_lookup_string(entry, "name", &str) || combatsim_unit(str) != NULL) {
+			ShowError("combatsim: monster #%d has no name or a duplicate one\n", i);
+			ok = false;
+			break;
+		}
+		safestrncpy(su->name, str, NAME_LENGTH);
+		if (!(ok = combatsim_add_monster(entry, su)))
+			break;
+		sim.unit_count++;
+	}
+
+	if (ok) {
+		ShowStatus("combatsim: %d units on %s (%d,%d), %d iterations per exchange.\n", sim.unit_count, map->list[sim.m].name, sim.x, sim.y, sim.iterations);
+		if (sim.status_calc > 0)
+			combatsim_status_calc();
+		for (i = 0; ok && (list = libconfig->setting_get_member(root, "exchanges")) != NULL && i < libconfig->setting_length(list); i++) {
+			if ((ok = combatsim_exchange(libconfig->setting_get_elem(list, i))))
+				exchanges++;
+		}
+		for (i = 0; ok && (list = libconfig->setting_get_member(root, "scenarios")) != NULL && i < libconfig->setting_length(list); i++) {
+			if ((ok = combatsim_scenario(libconfig->setting_get_elem(list, i))))
+				scenarios++;
+		}
+		if (ok)
+			ShowStatus("combatsim: done, %d exchanges, %d scenarios.\n", exchanges, scenarios);
+	}
+
+	combatsim_clear_units();
+	libconfig->destroy(&conf);
+	return ok;
+}
+
+/**
+ * --combat-sim handler
+ *
+ * Runs the simulation described in the given file instead of the server.
+ * @see cmdline->exec
+ */
+CMDLINEARG(combatsim)
+{
+	if (sim.file != NULL)
+		aFree(sim.file);
+	sim.file = aStrdup(params);
+	map->minimal = true;
+	// monster stats are adjusted to the battle configuration while the mob db is read
+	battle->config_read(map->BATTLE_CONF_FILENAME);
+	return true;
+}
+HPExport void server_preinit(void) {
+	addArg("--combat-sim", true, combatsim, "Runs the combat simulation described in the given file, then quits.");
+}
+HPExport void server_online(void) {
+	if (sim.file == NULL)
+		return;
+	if (!combatsim_run())
+		exit(EXIT_FAILURE);
+}
+HPExport void plugin_final(void) {
+	if (sim.file != NULL)
+		aFree(sim.file);
+	sim.file = NULL;
+}
@@ -0,0 +1,300 @@
+// Copyright (c) Hercules Dev Team, licensed under GNU GPL.
+// See the LICENSE file
+
+/**
+ * Local transport benchmark.
+ *
+ * Connects a session to itself through a loopback listener and pushes
+ * map-server to char-server traffic through it, first over TCP, then over
+ * the shared memory rings of the local transport (sockt->shm_create):
+ *  - save: character saves (0x2b01, one mmo_charstatus each), streamed
+ *    with up to 64 packets in flight;
+ *  - auth: auth requests (0x2b26) answered one at a time by an auth reply
+ *    (0x2afd, one mmo_charstatus), so each costs a full round trip.
+ * Both ends live in this process and are driven by sockt->perform, so the
+ * numbers compare the copies and system calls of the two transports, not
+ * the scheduling of two processes.
+ * Every packet is checked on arrival (order, length and contents).
+ * The benchmark runs while the command line is parsed and quits the server
+ * when done.
+ *
+ * Usage:
+ *   ./char-server --load-plugin shmbench --shm-bench <packets>[,<port>]
+ *
+ * Defaults are 100000 packets per test and port 6190 (on 127.0.0.1).
+ **/
+
+#include "common/hercules.h" /* Should always be the first Hercules file included! */
+#include "common/cbasetypes.h"
+#include "common/core.h"
+#include "common/malloc.h"
+#include "common/mmo.h"
+#include "common/showmsg.h"
+#include "common/socket.h"
+#include "common/strlib.h"
+#include "common/timer.h"
+
+#include "common/HPMDataCheck.h" /* should always be the last Hercules file included! */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+HPExport struct hplugin_info pinfo = {
+	"shmbench",                         // Plugin name
+	SERVER_TYPE_CHAR|SERVER_TYPE_MAP,   // Which server types this plugin works with?
+	"0.1",                              // Plugin version
+	HPM_VERSION,                        // HPM Version (don't change, macro is automatically updated)
+};
+
+#define SHMBENCH_WINDOW 64 ///< Save packets in flight
+#define SHMBENCH_SAVE_LEN (13 + sizeof(struct mmo_charstatus))
+#define SHMBENCH_AUTH_LEN 20
+#define SHMBENCH_REPLY_LEN (25 + sizeof(struct mmo_charstatus))
+
+struct shmbench_state {
+	int map_fd;      ///< The map-server end
+	int char_fd;     ///< The char-server end, accepted from the listener
+	int saves;       ///< Save packets received by the char-server end
+	int replies;     ///< Auth replies received by the map-server end
+	int errors;      ///< Packets that arrived out of order or damaged
+	struct mmo_charstatus status; ///< Body of the saves and auth replies
+} shmbench;
+
+/// Whether a character body is the one sent with sequence number seq.
+bool shmbench_check_status(const uint8 *body, int seq)
+{
+	const struct mmo_charstatus *status = (const struct mmo_charstatus *)body;
+
+	return status->char_id == seq && status->account_id == shmbench.status.account_id
+	    && memcmp(status->name, shmbench.status.name, NAME_LENGTH) == 0
+	    && body[sizeof(struct mmo_charstatus) - 1] == (uint8)seq;
+}
+
+/// Writes a character body with sequence number seq.
+void shmbench_write_status(uint8 *body, int seq)
+{
+	shmbench.status.char_id = seq;
+	memcpy(body, &shmbench.status, sizeof(struct mmo_charstatus));
+	body[sizeof(struct mmo_charstatus) - 1] = (uint8)seq;
+}
+
+/// Parse function of the char-server end.
+int shmbench_parse_char(int fd)
+{
+	if (shmbench.char_fd == 0) { // set up like the link of a map-server
+		shmbench.char_fd = fd;
+		sockt->session[fd]->flag.server = 1;
+		sockt->realloc_fifo(fd, FIFOSIZE_SERVERLINK, FIFOSIZE_SERVERLINK);
+	}
+
+	while (RFIFOREST(fd) >= 4) {
+		switch (RFIFOW(fd,0)) {
+			case 0x2b01:
+				if (RFIFOREST(fd) < RFIFOW(fd,2))
+					return 0;
+				if (RFIFOW(fd,2) != SHMBENCH_SAVE_LEN || RFIFOL(fd,8) != shmbench.saves || !shmbench_check_status(RFIFOP(fd,13), shmbench.saves))
+					shmbench.errors++;
+				shmbench.saves++;
+				RFIFOSKIP(fd, RFIFOW(fd,2));
+				break;
+			case 0x2b26:
+				if (RFIFOREST(fd) < SHMBENCH_AUTH_LEN)
+					return 0;
+				WFIFOHEAD(fd, SHMBENCH_REPLY_LEN);
+				WFIFOW(fd,0) = 0x2afd;
+				WFIFOW(fd,2) = SHMBENCH_REPLY_LEN;
+				WFIFOL(fd,4) = RFIFOL(fd,2);
+				WFIFOL(fd,8) = RFIFOL(fd,10);
+				memset(WFIFOP(fd,12), 0, 13);
+				shmbench_write_status(WFIFOP(fd,25), RFIFOL(fd,6));
+				WFIFOSET(fd, SHMBENCH_REPLY_LEN);
+				RFIFOSKIP(fd, SHMBENCH_AUTH_LEN);
+				break;
+			default:
+				ShowError("shmbench: unexpected packet 0x%04x on the char-server end.\n", RFIFOW(fd,0));
+				sockt->eof(fd);
+				return 0;
+		}
+	}
+	return 0;
+}
+
+/// Parse function of the map-server end.
+int shmbench_parse_map(int fd)
+{
+	while (RFIFOREST(fd) >= 4) {
+		if (RFIFOW(fd,0) != 0x2afd) {
+			ShowError("shmbench: unexpected packet 0x%04x on the map-server end.\n", RFIFOW(fd,0));
+			sockt->eof(fd);
+			return 0;
+		}
+		if (RFIFOREST(fd) < RFIFOW(fd,2))
+			return 0;
+		if (RFIFOW(fd,2) != SHMBENCH_REPLY_LEN || !shmbench_check_status(RFIFOP(fd,25), shmbench.replies))
+			shmbench.errors++;
+		shmbench.replies++;
+		RFIFOSKIP(fd, RFIFOW(fd,2));
+	}
+	return 0;
+}
+
+/// Runs the sockets until cond holds, false if a session was lost on the way.
+#define shmbench_perform_until(cond) \
+	while (!(cond)) { \
+		sockt->perform(0); \
+		if (!sockt->session_is_active(shmbench.map_fd) || !sockt->session_is_active(shmbench.char_fd)) \
+			return false; \
+	}
+
+/**
+ * Sends count character saves from the map-server end.
+ */
+bool shmbench_save(int count)
+{
+	int fd = shmbench.map_fd, sent;
+
+	shmbench.saves = 0;
+	for (sent = 0; sent < count; sent++) {
+		shmbench_perform_until(sent - shmbench.saves < SHMBENCH_WINDOW);
+		WFIFOHEAD(fd, SHMBENCH_SAVE_LEN);
+		WFIFOW(fd,0) = 0x2b01;
+		WFIFOW(fd,2) = SHMBENCH_SAVE_LEN;
+		WFIFOL(fd,4) = shmbench.status.account_id;
+		WFIFOL(fd,8) = sent;
+		WFIFOB(fd,12) = 0;
+		shmbench_write_status(WFIFOP(fd,13), sent);
+		WFIFOSET(fd, SHMBENCH_SAVE_LEN);
+	}
+	shmbench_perform_until(shmbench.saves == count);
+	return true;
+}
+
+/**
+ * Sends count auth requests from the map-server end, each after the reply to the previous one.
+ */
+bool shmbench_auth(int count)
+{
+	int fd = shmbench.map_fd, sent;
+
+	shmbench.replies = 0;
+	for (sent = 0; sent < count; sent++) {
+		WFIFOHEAD(fd, SHMBENCH_AUTH_LEN);
+		WFIFOW(fd,0) = 0x2b26;
+		WFIFOL(fd,2) = shmbench.status.account_id;
+		WFIFOL(fd,6) = sent;
+		WFIFOL(fd,10) = sent;
+		WFIFOB(fd,14) = 0;
+		WFIFOL(fd,15) = 0x7f000001;
+		WFIFOB(fd,19) = 0;
+		WFIFOSET(fd, SHMBENCH_AUTH_LEN);
+		shmbench_perform_until(shmbench.replies == sent + 1);
+	}
+	return true;
+}
+
+/**
+ * Times both tests on the current transport.
+ */
+bool shmbench_run_transport(const char *transport, int count)
+{
+	int64 start, duration;
+
+	start = timer->microtick();
+	if (!shmbench_save(count))
+		return false;
+	duration = timer->microtick() - start;
+	ShowInfo("shmbench: %s: save: %d packets of %d bytes in %"PRId64" us, %.0f packets/s, %.1f MB/s.\n", transport, count, (int)SHMBENCH_SAVE_LEN,
+	         duration, duration > 0 ? count * 1000000. / duration : 0., duration > 0 ? (double)count * SHMBENCH_SAVE_LEN / duration : 0.);
+
+	start = timer->microtick();
+	if (!shmbench_auth(count))
+		return false;
+	duration = timer->microtick() - start;
+	ShowInfo("shmbench: %s: auth: %d round trips in %"PRId64" us, %.0f round trips/s, %.2f us each.\n", transport, count,
+	         duration, duration > 0 ? count * 1000000. / duration : 0., count > 0 ? (double)duration / count : 0.);
+	return true;
+}
+
+/**
+ * Runs the benchmark.
+ *
+ * @param count Packets per test.
+ * @param port  Port of the loopback listener.
+ * @return Whether every packet arrived intact on both transports.
+ */
+bool shmbench_run(int count, uint16 port)
+{
+	struct hSockOpt opt = { 0 };
+	int listen_fd;
+	bool ok;
+
+	memset(&shmbench, 0, sizeof(shmbench));
+	shmbench.status.account_id = 2000000;
+	safestrncpy(shmbench.status.name, "shmbench", NAME_LENGTH);
+
+	opt.silent = 1;
+	sockt->set_defaultparse(shmbench_parse_char);
+	if ((listen_fd = sockt->make_listen_bind(0x7f000001, port)) == -1
+	 || (shmbench.map_fd = sockt->make_connection(0x7f000001, port, &opt)) == -1) {
+		ShowError("shmbench: Unable to connect through 127.0.0.1:%d.\n", port);
+		return false;
+	}
+	sockt->session[shmbench.map_fd]->func_parse = shmbench_parse_map;
+	sockt->session[shmbench.map_fd]->flag.server = 1;
+	sockt->realloc_fifo(shmbench.map_fd, FIFOSIZE_SERVERLINK, FIFOSIZE_SERVERLINK);
+	// the char-server end is known once the first packet arrives
+	WFIFOHEAD(shmbench.map_fd, SHMBENCH_AUTH_LEN);
+	memset(WFIFOP(shmbench.map_fd,0), 0, SHMBENCH_AUTH_LEN);
+	WFIFOW(shmbench.map_fd,0) = 0x2b26;
+	WFIFOSET(shmbench.map_fd, SHMBENCH_AUTH_LEN);
+	while (shmbench.char_fd == 0 || shmbench.replies == 0) {
+		sockt->perform(10);
+		if (!sockt->session_is_active(shmbench.map_fd)) {
+			ShowError("shmbench: Connection through 127.0.0.1:%d lost.\n", port);
+			return false;
+		}
+	}
+	sockt->close(listen_fd);
+
+	ok = shmbench_run_transport("loopback TCP", count);
+	if (ok && sockt->shm_create(shmbench.map_fd) && sockt->shm_attach(shmbench.char_fd, sockt->session[shmbench.map_fd]->shm->name)) {
+		sockt->shm_unlink(shmbench.map_fd);
+		sockt->shm_start_send(shmbench.map_fd);
+		sockt->shm_start_recv(shmbench.map_fd);
+		sockt->shm_start_send(shmbench.char_fd);
+		sockt->shm_start_recv(shmbench.char_fd);
+		ok = shmbench_run_transport("shared memory", count);
+	} else if (ok) {
+		ShowError("shmbench: Unable to set up the local transport.\n");
+		ok = false;
+	}
+	if (!ok)
+		ShowError("shmbench: A session was lost during the benchmark.\n");
+	ShowStatus("shmbench: %d packets arrived out of order or damaged.\n", shmbench.errors);
+
+	sockt->close(shmbench.map_fd);
+	sockt->close(shmbench.char_fd);
+	return ok && shmbench.errors == 0;
+}
+
+/**
+ * --shm-bench handler
+ *
+ * Runs the benchmark instead of the server.
+ * @see cmdline->exec
+ */
+CMDLINEARG(shmbench)
+{
+	int count = 100000, port = 6190;
+
+	if (sscanf(params, "%d,%d", &count, &port) < 1 || count < 1 || port < 1 || port > 65535) {
+		ShowError("shmbench: expected <packets>[,<port>], got '%s'\n", params);
+		exit(EXIT_FAILURE);
+	}
+	exit(shmbench_run(count, (uint16)port) ? EXIT_SUCCESS : EXIT_FAILURE);
+	return true;
+}
+HPExport void server_preinit(void) {
+	addArg("--shm-bench", true, shmbench, "Runs the local transport benchmark with the given number of packets, then quits.");
+}
@@ -0,0 +1,1413 @@
+// Copyright (c) Hercules Dev Team, licensed under GNU GPL.
+// See the LICENSE file
+
+/**
+ * Headless client load generator.
+ *
+ * Connects a number of simulated players to a running login/char/map-server
+ * set, the same way the game client does, and keeps them busy with a list of
+ * scenarios (walking, chatting, attacking, using skills). For every scenario
+ * the latency of each request, measured until the map-server's reply is
+ * received, is printed as percentiles, together with the CPU usage of the
+ * given server processes.
+ *
+ * Usage:
+ *   ./loadgen [--login-ip <ip>] [--login-port <port>] [--bots <n>] [--ramp <n>]
+ *             [--user-prefix <prefix>] [--password <pass>] [--autoregister]
+ *             [--scenarios <list>] [--duration <s>] [--think <ms>]
+ *             [--skill <id>,<lv>] [--server-pid <pid>]... [--packet-obfuscation]
+ *
+ * Scenarios: idle, walk, chat, attack, skill, mix (default: idle,walk,chat,attack,mix).
+ * A login scenario, timing the handshake from the login-server to the map-server's
+ * authentication reply, always runs first.
+ *
+ * The packet layout is taken from map/packets.h and map/packets_struct.h, so the
+ * tool must be built with the same PACKETVER as the map-server it connects to.
+ * Accounts are named <prefix><n>; with --autoregister they are created through the
+ * _M suffix and a character is created for accounts that don't have one.
+ *
+ * Server side notes:
+ * - add the load generator's address to the allow list in conf/packet.conf,
+ *   otherwise the connection burst is taken for a DDoS;
+ * - with --autoregister, raise allowed_regs in conf/login-server.conf;
+ * - disable the PIN code system in conf/char-server.conf.
+ */
+
+#define HERCULES_CORE
+
+#include "common/cbasetypes.h"
+#include "common/core.h"
+#include "common/db.h"
+#include "common/malloc.h"
+#include "common/mmo.h"
+#include "common/nullpo.h"
+#include "common/random.h"
+#include "common/showmsg.h"
+#include "common/socket.h"
+#include "common/strlib.h"
+#include "common/timer.h"
+#include "common/utils.h"
+#include "map/packets_struct.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#define LOADGEN_PACKET_DB 0x0F00         ///< Same range as the map-server's packet_db (MAX_PACKET_DB)
+#define LOADGEN_PACKET_POS 20            ///< Same as the map-server's MAX_PACKET_POS
+#define LOADGEN_MAX_SCENARIOS 16
+#define LOADGEN_MAX_PIDS 8
+#define LOADGEN_TIMER_INTERVAL 100       ///< Bot update interval (ms)
+#define LOADGEN_REQUEST_TIMEOUT 5000     ///< A request without a reply after this long is counted as a timeout (ms)
+#define LOADGEN_LOGIN_TIMEOUT 30000      ///< Maximum duration of the login/char/map handshake (ms)
+#define LOADGEN_KEEPALIVE 10000          ///< Idle bots send a TickSend after this long, to stay below the stall time (ms)
+#define LOADGEN_RFIFO_SIZE (64*1024)     ///< Receive buffer of map-server sessions, large enough for any packet
+#define LOADGEN_CLIENT_VERSION 20        ///< Client version sent to the login-server (login-server.conf default)
+
+/// Packet entry, loaded from map/packets.h
+struct loadgen_packet {
+	short len;
+	char func[48];                   ///< Name of the map-server's handler, e.g. "clif->pWantToConnection"
+	short pos[LOADGEN_PACKET_POS];
+};
+
+/// Client packets sent by the bots
+enum loadgen_cmd {
+	LGC_WANTTOCONNECTION,
+	LGC_LOADENDACK,
+	LGC_TICKSEND,
+	LGC_WALKTOXY,
+	LGC_ACTIONREQUEST,
+	LGC_GLOBALMESSAGE,
+	LGC_USESKILLTOID,
+	LGC_MAX
+};
+
+/// Timed requests
+enum loadgen_request {
+	LGR_NONE = -1,
+	LGR_LOGIN,
+	LGR_TICK,
+	LGR_WALK,
+	LGR_CHAT,
+	LGR_ATTACK,
+	LGR_SKILL,
+	LGR_MAX
+};
+
+enum loadgen_state {
+	LGS_OFFLINE,  ///< Not started yet
+	LGS_LOGIN,    ///< Waiting for the login-server
+	LGS_CHAR,     ///< Waiting for the char-server
+	LGS_MAP,      ///< Waiting for the map-server
+	LGS_READY,    ///< In game
+	LGS_FAILED,
+};
+
+/// Simulated player
+struct loadgen_bot {
+	int index;
+	enum loadgen_state state;
+	int fd;                          ///< Current connection, -1 if none
+	char userid[NAME_LENGTH];
+	char name[NAME_LENGTH];
+	int account_id;
+	int char_id;
+	int login_id1;
+	int login_id2;
+	uint8 sex;
+	bool has_char;                   ///< The char-server listed a character
+	int slot;
+	bool skip_aid;                   ///< Next 4 bytes from the server are the bare account id
+	uint32 crypt_key;                ///< Packet obfuscation key
+	short x, y;                      ///< Last known position
+	short home_x, home_y;            ///< Spawn position, walks stay around it
+	int target_id;                   ///< Monster in sight, 0 if none
+	enum loadgen_request request;    ///< Request waiting for a reply
+	int64 request_sent;              ///< timer->microtick() of the request
+	int64 request_tick;              ///< timer->gettick() of the request
+	int64 next_action;
+	int64 last_send;
+};
+
+/// Session data of the bots' connections
+struct loadgen_session {
+	int bot;
+};
+
+struct loadgen_latency {
+	VECTOR_DECL(int) samples;        ///< Reply latencies (us)
+	int sent;
+	int timeouts;
+};
+
+struct loadgen_scenario {
+	char name[16];
+	unsigned int requests;           ///< Bitmask of timed requests (1<<LGR_*)
+	struct loadgen_latency latency[LGR_MAX];
+	int64 started;
+	int64 cpu_start[LOADGEN_MAX_PIDS];
+};
+
+static const struct {
+	const char *name;
+	unsigned int requests;
+} loadgen_scenario_db[] = {
+	{ "idle",   1<<LGR_TICK },
+	{ "walk",   1<<LGR_WALK },
+	{ "chat",   1<<LGR_CHAT },
+	{ "attack", 1<<LGR_ATTACK },
+	{ "skill",  1<<LGR_SKILL },
+	{ "mix",    (1<<LGR_WALK)|(1<<LGR_CHAT)|(1<<LGR_ATTACK)|(1<<LGR_SKILL) },
+};
+
+static const char *loadgen_request_name[LGR_MAX] = { "login", "tick", "walk", "chat", "attack", "skill" };
+
+static const char *loadgen_cmd_func[LGC_MAX] = {
+	"clif->pWantToConnection",
+	"clif->pLoadEndAck",
+	"clif->pTickSend",
+	"clif->pWalkToXY",
+	"clif->pActionRequest",
+	"clif->pGlobalMessage",
+	"clif->pUseSkillToId",
+};
+
+static struct loadgen_packet packet_db[LOADGEN_PACKET_DB + 1];
+static int loadgen_cmd[LGC_MAX];
+static uint32 crypt_keys[3];
+
+// Configuration
+static char *login_ip_str;
+static uint16 login_port = 6900;
+static int bot_count = 100;
+static int ramp = 20;
+static char *user_prefix;
+static char *password;
+static bool autoregister = false;
+static char *scenario_list;
+static int duration = 30;
+static int think = 1000;
+static int skill_id = 0;
+static int skill_lv = 0;
+static bool obfuscation = false;
+static int server_pids[LOADGEN_MAX_PIDS];
+static int server_pid_count = 0;
+
+// State
+static uint32 login_ip;
+static struct loadgen_bot *bots;
+static int bots_started = 0;
+static int64 ramp_start;
+static struct loadgen_scenario scenarios[LOADGEN_MAX_SCENARIOS];
+static int scenario_count = 0;
+static int scenario_cur = 0;
+static int unframed = 0;
+
+/*==========================================
+ * Packet database
+ *------------------------------------------*/
+
+/**
+ * Adds an entry of map/packets.h.
+ *
+ * Later entries override earlier ones, like in packetdb_addpacket(); the
+ * handler and offsets are only replaced when the entry has them.
+ * @param args Stringified handler and offsets, empty for length only entries.
+ */
+static void loadgen_packet_add(int cmd, int len, const char *args)
+{
+	const char *p;
+	int i;
+
+	if (cmd > LOADGEN_PACKET_DB)
+		return;
+
+	packet_db[cmd].len = len;
+
+	if (*args == '\0')
+		return;
+
+	p = strchr(args, ',');
+	safestrncpy(packet_db[cmd].func, args, min(sizeof(packet_db[cmd].func), p ? (size_t)(p - args + 1) : strlen(args) + 1));
+	trim(packet_db[cmd].func);
+	memset(packet_db[cmd].pos, 0, sizeof(packet_db[cmd].pos));
+
+	for (i = 0; p != NULL && i < LOADGEN_PACKET_POS; i++) {
+		packet_db[cmd].pos[i] = (short)strtol(p + 1, NULL, 0);
+		p = strchr(p + 1, ',');
+	}
+}
+
+/**
+ * Loads the packet lengths, offsets and obfuscation keys of this PACKETVER
+ * and looks up the commands the bots send.
+ */
+static bool loadgen_packet_loaddb(void)
+{
+	int i, cmd;
+
+	memset(packet_db, 0, sizeof(packet_db));
+
+#define packet(id, size, ...) loadgen_packet_add((id), (size), #__VA_ARGS__)
+#define packetKeys(a,b,c) do { crypt_keys[0] = (a); crypt_keys[1] = (b); crypt_keys[2] = (c); } while(0)
+#include "map/packets.h"
+#undef packet
+#undef packetKeys
+
+	// Server packets that are only sent with the size of their packets_struct.h layout
+	if (packet_db[authokType].len == 0)
+		packet_db[authokType].len = (short)sizeof(struct packet_authok);
+	if (packet_db[damageType].len == 0)
+		packet_db[damageType].len = (short)sizeof(struct packet_damage);
+
+	for (i = 0; i < LGC_MAX; i++) {
+		loadgen_cmd[i] = 0;
+		for (cmd = 0; cmd <= LOADGEN_PACKET_DB; cmd++) {
+			if (strcmp(packet_db[cmd].func, loadgen_cmd_func[i]) == 0)
+				loadgen_cmd[i] = cmd;
+		}
+		if (loadgen_cmd[i] == 0) {
+			ShowError("loadgen_packet_loaddb: %s has no packet in PACKETVER %d.\n", loadgen_cmd_func[i], PACKETVER);
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Writes a packed position, see WBUFPOS in clif.c
+static void loadgen_wbufpos(uint8 *p, short x, short y, unsigned char dir)
+{
+	p[0] = (uint8)(x>>2);
+	p[1] = (uint8)((x<<6) | ((y>>4)&0x3f));
+	p[2] = (uint8)((y<<4) | (dir&0xf));
+}
+
+/// Reads a packed position, see RBUFPOS in clif.c
+static void loadgen_rbufpos(const uint8 *p, short *x, short *y)
+{
+	*x = ((p[0]&0xff)<<2) | (p[1]>>6);
+	*y = ((p[1]&0x3f)<<4) | (p[2]>>4);
+}
+
+/// Length of a character entry of the char-server, see char_mmo_char_tobuf()
+static int loadgen_charinfo_len(void)
+{
+	int len = 106;
+#if PACKETVER > 20081217
+	len += 4;
+#endif
+#if PACKETVER >= 20141022
+	len += 2;
+#endif
+#if PACKETVER >= 20061023
+	len += 2;
+#endif
+#if (PACKETVER >= 20100720 && PACKETVER <= 20100727) || PACKETVER >= 20100803
+	len += MAP_NAME_LENGTH_EXT;
+#endif
+#if PACKETVER >= 20100803
+	len += 4;
+#endif
+#if PACKETVER >= 20110111
+	len += 4;
+#endif
+#if PACKETVER != 20111116
+	#if PACKETVER >= 20110928
+	len += 4;
+	#endif
+	#if PACKETVER >= 20111025
+	len += 4;
+	#endif
+	#if PACKETVER >= 20141016
+	len += 1;
+	#endif
+#endif
+	return len;
+}
+
+/// Reads the name and slot of a character entry, see char_mmo_char_tobuf()
+static void loadgen_charinfo_read(struct loadgen_bot *bot, const uint8 *buf)
+{
+	int offset = 0;
+#if PACKETVER > 20081217
+	offset += 4;
+#endif
+#if PACKETVER >= 20141022
+	offset += 2;
+#endif
+	safestrncpy(bot->name, (const char*)buf + 74 + offset, NAME_LENGTH);
+	bot->slot = RBUFW(buf, 104 + offset);
+	bot->has_char = true;
+}
+
+/*==========================================
+ * Statistics
+ *------------------------------------------*/
+
+/// Returns the user + system CPU time of a process in clock ticks, or -1 if not available.
+static int64 loadgen_cpu_ticks(int pid)
+{
+#ifdef __linux__
+	char path[64], buf[1024], *p;
+	unsigned long utime, stime;
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+	if ((fp = fopen(path, "r")) == NULL)
+		return -1;
+	p = fgets(buf, sizeof(buf), fp);
+	fclose(fp);
+	// The process name may contain spaces, continue after it
+	if (p == NULL || (p = strrchr(buf, ')')) == NULL)
+		return -1;
+	if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2)
+		return -1;
+	return (int64)(utime + stime);
+#else
+	return -1;
+#endif
+}
+
+static int loadgen_latency_cmp(const void *a, const void *b)
+{
+	return *(const int*)a - *(const int*)b;
+}
+
+/// Returns the p-th percentile of sorted samples, in milliseconds.
+static double loadgen_percentile(const int *samples, int count, int p)
+{
+	return samples[cap_value(count * p / 100, 0, count - 1)] / 1000.;
+}
+
+static void loadgen_scenario_start(struct loadgen_scenario *sc)
+{
+	int i;
+
+	sc->started = timer->gettick();
+	for (i = 0; i < server_pid_count; i++)
+		sc->cpu_start[i] = loadgen_cpu_ticks(server_pids[i]);
+}
+
+static void loadgen_scenario_report(struct loadgen_scenario *sc)
+{
+	int64 elapsed = DIFF_TICK(timer->gettick(), sc->started);
+	int i, ready = 0, failed = 0;
+
+	for (i = 0; i < bot_count; i++) {
+		if (bots[i].state == LGS_READY)
+			ready++;
+		else if (bots[i].state == LGS_FAILED)
+			failed++;
+	}
+
+	ShowInfo("Scenario '"CL_WHITE"%s"CL_RESET"': %.1fs, %d bots in game, %d failed\n", sc->name, elapsed / 1000., ready, failed);
+
+	for (i = 0; i < LGR_MAX; i++) {
+		struct loadgen_latency *lat = &sc->latency[i];
+		int count = VECTOR_LENGTH(lat->samples);
+
+		if (!(sc->requests & (1<<i)))
+			continue;
+		if (count == 0) {
+			ShowInfo("  %-6s: %d sent, no replies, %d timeouts\n", loadgen_request_name[i], lat->sent, lat->timeouts);
+			continue;
+		}
+		qsort(VECTOR_DATA(lat->samples), count, sizeof(int), loadgen_latency_cmp);
+		ShowInfo("  %-6s: %d sent, %d replies, %d timeouts, %.1f/s, p50 %.2fms, p90 %.2fms, p99 %.2fms, max %.2fms\n",
+		         loadgen_request_name[i], lat->sent, count, lat->timeouts, elapsed > 0 ? count * 1000. / elapsed : 0.,
+		         loadgen_percentile(VECTOR_DATA(lat->samples), count, 50),
+		         loadgen_percentile(VECTOR_DATA(lat->samples), count, 90),
+		         loadgen_percentile(VECTOR_DATA(lat->samples), count, 99),
+		         VECTOR_LAST(lat->samples) / 1000.);
+	}
+
+	for (i = 0; i < server_pid_count; i++) {
+		int64 cpu = loadgen_cpu_ticks(server_pids[i]);
+
+		if (cpu < 0 || sc->cpu_start[i] < 0 || elapsed <= 0) {
+			ShowInfo("  cpu   : pid %d not available\n", server_pids[i]);
+			continue;
+		}
+#ifndef _WIN32
+		ShowInfo("  cpu   : pid %d %.1f%%\n", server_pids[i], (cpu - sc->cpu_start[i]) * 100000. / sysconf(_SC_CLK_TCK) / elapsed);
+#endif
+	}
+}
+
+/**
+ * Records the reply to a bot's pending request.
+ * Replies that don't match the pending request (e.g. broadcasts of other
+ * bots' actions) are ignored.
+ */
+static void loadgen_reply(struct loadgen_bot *bot, enum loadgen_request request)
+{
+	struct loadgen_latency *lat = &scenarios[scenario_cur].latency[request];
+
+	if (bot->request != request)
+		return;
+
+	if (scenarios[scenario_cur].requests & (1<<request)) {
+		VECTOR_ENSURE(lat->samples, 1, 256);
+		VECTOR_PUSH(lat->samples, (int)(timer->microtick() - bot->request_sent));
+	}
+	bot->request = LGR_NONE;
+	bot->next_action = timer->gettick() + think / 2 + rnd() % (think + 1);
+}
+
+static void loadgen_request(struct loadgen_bot *bot, enum loadgen_request request)
+{
+	if (scenarios[scenario_cur].requests & (1<<request))
+		scenarios[scenario_cur].latency[request].sent++;
+	bot->request = request;
+	bot->request_sent = timer->microtick();
+	bot->request_tick = timer->gettick();
+}
+
+/*==========================================
+ * Connections
+ *------------------------------------------*/
+
+static void loadgen_bot_failed(struct loadgen_bot *bot, const char *reason)
+{
+	ShowWarning("loadgen: bot '%s' failed: %s\n", bot->userid, reason);
+	bot->state = LGS_FAILED;
+	bot->request = LGR_NONE;
+	if (bot->fd != -1 && sockt->session_is_valid(bot->fd))
+		sockt->eof(bot->fd);
+	bot->fd = -1;
+}
+
+/**
+ * Opens a new connection for a bot, the previous one is closed.
+ * @return false if the connection failed (the bot is marked as failed).
+ */
+static bool loadgen_connect(struct loadgen_bot *bot, uint32 ip, uint16 port, ParseFunc func)
+{
+	struct hSockOpt opt;
+	struct loadgen_session *ls;
+	int fd;
+
+	opt.silent = 1;
+	opt.setTimeo = 0;
+
+	if (bot->fd != -1 && sockt->session_is_valid(bot->fd))
+		sockt->eof(bot->fd);
+	bot->fd = -1;
+
+	if ((fd = sockt->make_connection(ip, port, &opt)) == -1) {
+		loadgen_bot_failed(bot, "connection refused");
+		return false;
+	}
+
+	CREATE(ls, struct loadgen_session, 1);
+	ls->bot = bot->index;
+	sockt->session[fd]->session_data = ls;
+	sockt->session[fd]->func_parse = func;
+	bot->fd = fd;
+	bot->skip_aid = false;
+	return true;
+}
+
+/**
+ * Returns the bot of a connection, or NULL if the connection is closed or
+ * no longer the bot's current one.
+ */
+static struct loadgen_bot *loadgen_session_bot(int fd)
+{
+	struct loadgen_session *ls = sockt->session[fd]->session_data;
+	struct loadgen_bot *bot;
+
+	nullpo_retr(NULL, ls);
+	bot = &bots[ls->bot];
+
+	if (sockt->session[fd]->flag.eof) {
+		if (bot->fd == fd)
+			loadgen_bot_failed(bot, "disconnected");
+		sockt->close(fd);
+		return NULL;
+	}
+	if (bot->fd != fd) {
+		RFIFOSKIP(fd, RFIFOREST(fd));
+		return NULL;
+	}
+	return bot;
+}
+
+/// Sends a map-server packet, obfuscating its command if requested.
+static void loadgen_map_send(struct loadgen_bot *bot, int len)
+{
+	int fd = bot->fd;
+
+	if (obfuscation) {
+		bot->crypt_key = bot->crypt_key * crypt_keys[1] + crypt_keys[2];
+		WFIFOW(fd,0) ^= (uint16)((bot->crypt_key >> 16) & 0x7FFF);
+	}
+	WFIFOSET(fd,len);
+	bot->last_send = timer->gettick();
+}
+
+/*==========================================
+ * Map-server
+ *------------------------------------------*/
+
+static void loadgen_send_tick(struct loadgen_bot *bot)
+{
+	int fd = bot->fd;
+	int cmd = loadgen_cmd[LGC_TICKSEND];
+
+	WFIFOHEAD(fd,packet_db[cmd].len);
+	memset(WFIFOP(fd,0), 0, packet_db[cmd].len);
+	WFIFOW(fd,0) = cmd;
+	WFIFOL(fd,packet_db[cmd].pos[0]) = (uint32)timer->gettick();
+	loadgen_request(bot, LGR_TICK);
+	loadgen_map_send(bot, packet_db[cmd].len);
+}
+
+static void loadgen_send_walk(struct loadgen_bot *bot)
+{
+	int fd = bot->fd;
+	int cmd = loadgen_cmd[LGC_WALKTOXY];
+
+	bot->x = (short)max(1, bot->home_x + rnd_value(-5, 5));
+	bot->y = (short)max(1, bot->home_y + rnd_value(-5, 5));
+
+	WFIFOHEAD(fd,packet_db[cmd].len);
+	memset(WFIFOP(fd,0), 0, packet_db[cmd].len);
+	WFIFOW(fd,0) = cmd;
+	loadgen_wbufpos(WFIFOP(fd,packet_db[cmd].pos[0]), bot->x, bot->y, 0);
+	loadgen_request(bot, LGR_WALK);
+	loadgen_map_send(bot, packet_db[cmd].len);
+}
+
+static void loadgen_send_chat(struct loadgen_bot *bot)
+{
+	char message[NAME_LENGTH + 32];
+	int fd = bot->fd;
+	int cmd = loadgen_cmd[LGC_GLOBALMESSAGE];
+	int len;
+
+	len = snprintf(message, sizeof(message), "%s : load test %d", bot->name, rnd() % 1000) + 1;
+
+	WFIFOHEAD(fd,4 + len);
+	WFIFOW(fd,0) = cmd;
+	WFIFOW(fd,2) = 4 + len;
+	memcpy(WFIFOP(fd,4), message, len);
+	loadgen_request(bot, LGR_CHAT);
+	loadgen_map_send(bot, 4 + len);
+}
+
+static void loadgen_send_attack(struct loadgen_bot *bot)
+{
+	int fd = bot->fd;
+	int cmd = loadgen_cmd[LGC_ACTIONREQUEST];
+
+	WFIFOHEAD(fd,packet_db[cmd].len);
+	memset(WFIFOP(fd,0), 0, packet_db[cmd].len);
+	WFIFOW(fd,0) = cmd;
+	WFIFOL(fd,packet_db[cmd].pos[0]) = bot->target_id;
+	WFIFOB(fd,packet_db[cmd].pos[1]) = 0; // once attack
+	loadgen_request(bot, LGR_ATTACK);
+	loadgen_map_send(bot, packet_db[cmd].len);
+}
+
+static void loadgen_send_skill(struct loadgen_bot *bot)
+{
+	int fd = bot->fd;
+	int cmd = loadgen_cmd[LGC_USESKILLTOID];
+
+	WFIFOHEAD(fd,packet_db[cmd].len);
+	memset(WFIFOP(fd,0), 0, packet_db[cmd].len);
+	WFIFOW(fd,0) = cmd;
+	WFIFOW(fd,packet_db[cmd].pos[0]) = skill_lv;
+	WFIFOW(fd,packet_db[cmd].pos[1]) = skill_id;
+	WFIFOL(fd,packet_db[cmd].pos[2]) = bot->target_id ? bot->target_id : bot->account_id;
+	loadgen_request(bot, LGR_SKILL);
+	loadgen_map_send(bot, packet_db[cmd].len);
+}
+
+/// Sends the next request of the current scenario.
+static void loadgen_bot_act(struct loadgen_bot *bot)
+{
+	enum loadgen_request choices[LGR_MAX];
+	unsigned int requests = scenarios[scenario_cur].requests;
+	int count = 0;
+
+	if (requests & (1<<LGR_TICK))
+		choices[count++] = LGR_TICK;
+	if (requests & (1<<LGR_WALK))
+		choices[count++] = LGR_WALK;
+	if (requests & (1<<LGR_CHAT))
+		choices[count++] = LGR_CHAT;
+	if ((requests & (1<<LGR_ATTACK)) && bot->target_id != 0)
+		choices[count++] = LGR_ATTACK;
+	if ((requests & (1<<LGR_SKILL)) && skill_id != 0)
+		choices[count++] = LGR_SKILL;
+
+	if (count == 0) { // nothing to attack, move around to find something
+		loadgen_send_walk(bot);
+		return;
+	}
+
+	switch (choices[rnd() % count]) {
+		case LGR_TICK:   loadgen_send_tick(bot);   break;
+		case LGR_WALK:   loadgen_send_walk(bot);   break;
+		case LGR_CHAT:   loadgen_send_chat(bot);   break;
+		case LGR_ATTACK: loadgen_send_attack(bot); break;
+		case LGR_SKILL:  loadgen_send_skill(bot);  break;
+		default: break;
+	}
+}
+
+/// Tracks monsters in sight as attack and skill targets.
+static void loadgen_parse_unit(struct loadgen_bot *bot, int fd, int cmd)
+{
+	int id, type;
+
+	if (cmd == unit_walkingType) {
+		id = RFIFOL(fd,offsetof(struct packet_unit_walking, GID));
+#if PACKETVER > 20071106
+		type = RFIFOB(fd,offsetof(struct packet_unit_walking, objecttype));
+#else
+		type = RFIFOW(fd,offsetof(struct packet_unit_walking, job)) >= 1000 ? 0x5 : 0x0;
+#endif
+	} else {
+		id = RFIFOL(fd,offsetof(struct packet_idle_unit, GID));
+#if PACKETVER >= 20091103
+		type = RFIFOB(fd,offsetof(struct packet_idle_unit, objecttype));
+#else
+		type = RFIFOW(fd,offsetof(struct packet_idle_unit, job)) >= 1000 ? 0x5 : 0x0;
+#endif
+	}
+
+	if (type == 0x5 && bot->target_id == 0) // NPC_MOB_TYPE, see clif_bl_type()
+		bot->target_id = id;
+}
+
+static int loadgen_parse_map(int fd)
+{
+	struct loadgen_bot *bot = loadgen_session_bot(fd);
+
+	if (bot == NULL)
+		return 0;
+
+	while (RFIFOREST(fd) >= 2) {
+		int cmd, len;
+
+		if (bot->skip_aid) {
+			if (RFIFOREST(fd) < 4)
+				return 0;
+			RFIFOSKIP(fd,4);
+			bot->skip_aid = false;
+			continue;
+		}
+
+		cmd = RFIFOW(fd,0);
+		if (cmd > LOADGEN_PACKET_DB || packet_db[cmd].len == 0) {
+			// Unknown length, the rest of the buffer can't be framed
+			unframed++;
+			RFIFOSKIP(fd, RFIFOREST(fd));
+			return 0;
+		}
+		if ((len = packet_db[cmd].len) == -1) {
+			if (RFIFOREST(fd) < 4)
+				return 0;
+			if ((len = RFIFOW(fd,2)) < 4) {
+				unframed++;
+				RFIFOSKIP(fd, RFIFOREST(fd));
+				return 0;
+			}
+		}
+		if ((int)RFIFOREST(fd) < len)
+			return 0;
+
+		if (cmd == authokType) {
+			loadgen_rbufpos(RFIFOP(fd,offsetof(struct packet_authok, PosDir)), &bot->x, &bot->y);
+			bot->home_x = bot->x;
+			bot->home_y = bot->y;
+			bot->state = LGS_READY;
+			loadgen_reply(bot, LGR_LOGIN);
+			WFIFOHEAD(fd,packet_db[loadgen_cmd[LGC_LOADENDACK]].len);
+			memset(WFIFOP(fd,0), 0, packet_db[loadgen_cmd[LGC_LOADENDACK]].len);
+			WFIFOW(fd,0) = loadgen_cmd[LGC_LOADENDACK];
+			loadgen_map_send(bot, packet_db[loadgen_cmd[LGC_LOADENDACK]].len);
+		} else if (cmd == idle_unitType || cmd == spawn_unitType || cmd == unit_walkingType) {
+			loadgen_parse_unit(bot, fd, cmd);
+		} else if (cmd == damageType) {
+			if ((int)RFIFOL(fd,offsetof(struct packet_damage, GID)) == bot->account_id)
+				loadgen_reply(bot, LGR_ATTACK);
+		} else {
+			switch (cmd) {
+				case 0x7f: // ZC_NOTIFY_TIME
+					loadgen_reply(bot, LGR_TICK);
+					break;
+				case 0x80: // ZC_NOTIFY_VANISH
+					if ((int)RFIFOL(fd,2) == bot->target_id)
+						bot->target_id = 0;
+					break;
+				case 0x81: // SC_NOTIFY_BAN
+					RFIFOSKIP(fd,len);
+					loadgen_bot_failed(bot, "kicked by the map-server");
+					return 0;
+				case 0x87: // ZC_NOTIFY_PLAYERMOVE
+					loadgen_reply(bot, LGR_WALK);
+					break;
+				case 0x8e: // ZC_NOTIFY_PLAYERCHAT
+					loadgen_reply(bot, LGR_CHAT);
+					break;
+				case 0x110: // ZC_ACK_TOUSESKILL (failure)
+					loadgen_reply(bot, LGR_SKILL);
+					break;
+#if PACKETVER < 20091124
+				case 0x13e: // ZC_USESKILL_ACK
+#else
+				case 0x7fb: // ZC_USESKILL_ACK2
+#endif
+					if ((int)RFIFOL(fd,2) == bot->account_id)
+						loadgen_reply(bot, LGR_SKILL);
+					break;
+				case 0x114: // ZC_NOTIFY_SKILL
+				case 0x1de: // ZC_NOTIFY_SKILL2
+					if ((int)RFIFOL(fd,4) == bot->account_id)
+						loadgen_reply(bot, LGR_SKILL);
+					break;
+				case 0x11a: // ZC_USE_SKILL
+					if ((int)RFIFOL(fd,10) == bot->account_id)
+						loadgen_reply(bot, LGR_SKILL);
+					break;
+			}
+		}
+		RFIFOSKIP(fd,len);
+	}
+	return 0;
+}
+
+/*==========================================
+ * Char-server
+ *------------------------------------------*/
+
+static void loadgen_char_select(struct loadgen_bot *bot)
+{
+	int fd = bot->fd;
+
+	if (!bot->has_char) {
+		if (!autoregister) {
+			loadgen_bot_failed(bot, "the account has no character");
+			return;
+		}
+		// Create one, with the account's name
+		safestrncpy(bot->name, bot->userid, NAME_LENGTH);
+#if PACKETVER >= 20120307
+		WFIFOHEAD(fd,31);
+		WFIFOW(fd,0) = 0x970;
+		safestrncpy((char*)WFIFOP(fd,2), bot->name, NAME_LENGTH);
+		WFIFOB(fd,26) = 0; // slot
+		WFIFOW(fd,27) = 0; // hair color
+		WFIFOW(fd,29) = 1; // hair style
+		WFIFOSET(fd,31);
+#else
+		WFIFOHEAD(fd,37);
+		WFIFOW(fd,0) = 0x67;
+		safestrncpy((char*)WFIFOP(fd,2), bot->name, NAME_LENGTH);
+		memset(WFIFOP(fd,26), 5, 6); // str, agi, vit, int, dex, luk
+		WFIFOB(fd,32) = 0; // slot
+		WFIFOW(fd,33) = 0; // hair color
+		WFIFOW(fd,35) = 1; // hair style
+		WFIFOSET(fd,37);
+#endif
+		return;
+	}
+
+	WFIFOHEAD(fd,3);
+	WFIFOW(fd,0) = 0x66;
+	WFIFOB(fd,2) = bot->slot;
+	WFIFOSET(fd,3);
+}
+
+static int loadgen_parse_char(int fd)
+{
+	struct loadgen_bot *bot = loadgen_session_bot(fd);
+
+	if (bot == NULL)
+		return 0;
+
+	while (RFIFOREST(fd) >= 2) {
+		int cmd, len;
+
+		if (bot->skip_aid) {
+			if (RFIFOREST(fd) < 4)
+				return 0;
+			RFIFOSKIP(fd,4);
+			bot->skip_aid = false;
+			continue;
+		}
+
+		cmd = RFIFOW(fd,0);
+		switch (cmd) {
+			case 0x6c: case 0x6e: case 0x81: len = 3; break;
+			case 0x6d: len = 2 + loadgen_charinfo_len(); break;
+			case 0x71: len = 28; break;
+			case 0x8b9: len = 12; break;
+			default: // Everything else has its length in the header
+				if (RFIFOREST(fd) < 4)
+					return 0;
+				len = RFIFOW(fd,2);
+				if (len < 4) {
+					unframed++;
+					RFIFOSKIP(fd, RFIFOREST(fd));
+					return 0;
+				}
+				break;
+		}
+		if ((int)RFIFOREST(fd) < len)
+			return 0;
+
+		switch (cmd) {
+			case 0x6b: // HC_ACCEPT_ENTER
+			{
+				int header = 24;
+#if PACKETVER >= 20100413
+				header += 3;
+#endif
+				if (len >= header + loadgen_charinfo_len())
+					loadgen_charinfo_read(bot, RFIFOP(fd,header));
+#if PACKETVER < 20110309
+				loadgen_char_select(bot);
+#endif
+				break;
+			}
+			case 0x8b9: // HC_SECOND_PASSWD_LOGIN
+				if (RFIFOW(fd,10) != 0) { // PINCODE_OK
+					RFIFOSKIP(fd,len);
+					loadgen_bot_failed(bot, "the char-server asks for a PIN code");
+					return 0;
+				}
+				loadgen_char_select(bot);
+				break;
+			case 0x6d: // HC_ACCEPT_MAKECHAR
+				loadgen_charinfo_read(bot, RFIFOP(fd,2));
+				loadgen_char_select(bot);
+				break;
+			case 0x71: // HC_NOTIFY_ZONESVR
+			{
+				uint32 ip = ntohl(RFIFOL(fd,22));
+				uint16 port = RFIFOW(fd,26);
+				int cmd_connect = loadgen_cmd[LGC_WANTTOCONNECTION];
+				int mfd;
+
+				bot->char_id = RFIFOL(fd,2);
+				RFIFOSKIP(fd,len);
+				if (!loadgen_connect(bot, ip, port, loadgen_parse_map))
+					return 0;
+				bot->state = LGS_MAP;
+				bot->crypt_key = crypt_keys[0];
+				mfd = bot->fd;
+				sockt->realloc_fifo(mfd, LOADGEN_RFIFO_SIZE, sockt->session[mfd]->max_wdata);
+#if PACKETVER < 20070521
+				bot->skip_aid = true;
+#endif
+				WFIFOHEAD(mfd,packet_db[cmd_connect].len);
+				memset(WFIFOP(mfd,0), 0, packet_db[cmd_connect].len);
+				WFIFOW(mfd,0) = cmd_connect;
+				WFIFOL(mfd,packet_db[cmd_connect].pos[0]) = bot->account_id;
+				WFIFOL(mfd,packet_db[cmd_connect].pos[1]) = bot->char_id;
+				WFIFOL(mfd,packet_db[cmd_connect].pos[2]) = bot->login_id1;
+				WFIFOL(mfd,packet_db[cmd_connect].pos[3]) = (uint32)timer->gettick();
+				WFIFOB(mfd,packet_db[cmd_connect].pos[4]) = bot->sex;
+				loadgen_map_send(bot, packet_db[cmd_connect].len);
+				return 0;
+			}
+			case 0x6c: // HC_REFUSE_ENTER
+			case 0x6e: // HC_REFUSE_MAKECHAR
+			case 0x81: // SC_NOTIFY_BAN
+				RFIFOSKIP(fd,len);
+				loadgen_bot_failed(bot, cmd == 0x6e ? "character creation refused" : "refused by the char-server");
+				return 0;
+		}
+		RFIFOSKIP(fd,len);
+	}
+	return 0;
+}
+
+/*==========================================
+ * Login-server
+ *------------------------------------------*/
+
+static int loadgen_parse_login(int fd)
+{
+	struct loadgen_bot *bot = loadgen_session_bot(fd);
+
+	if (bot == NULL)
+		return 0;
+
+	while (RFIFOREST(fd) >= 2) {
+		int cmd = RFIFOW(fd,0);
+
+		switch (cmd) {
+			case 0x69: // AC_ACCEPT_LOGIN
+			{
+				uint32 ip;
+				uint16 port;
+				int cfd;
+
+				if (RFIFOREST(fd) < 4 || RFIFOREST(fd) < RFIFOW(fd,2))
+					return 0;
+				if (RFIFOW(fd,2) < 47 + 32) {
+					RFIFOSKIP(fd, RFIFOW(fd,2));
+					loadgen_bot_failed(bot, "no char-server online");
+					return 0;
+				}
+				bot->login_id1 = RFIFOL(fd,4);
+				bot->account_id = RFIFOL(fd,8);
+				bot->login_id2 = RFIFOL(fd,12);
+				bot->sex = RFIFOB(fd,46);
+				ip = ntohl(RFIFOL(fd,47));
+				port = RFIFOW(fd,47+4);
+				RFIFOSKIP(fd, RFIFOW(fd,2));
+
+				if (!loadgen_connect(bot, ip, port, loadgen_parse_char))
+					return 0;
+				bot->state = LGS_CHAR;
+				bot->skip_aid = true;
+				cfd = bot->fd;
+				WFIFOHEAD(cfd,17);
+				WFIFOW(cfd,0) = 0x65;
+				WFIFOL(cfd,2) = bot->account_id;
+				WFIFOL(cfd,6) = bot->login_id1;
+				WFIFOL(cfd,10) = bot->login_id2;
+				WFIFOW(cfd,14) = 0;
+				WFIFOB(cfd,16) = bot->sex;
+				WFIFOSET(cfd,17);
+				return 0;
+			}
+			case 0x6a: // AC_REFUSE_LOGIN
+			case 0x83e: // AC_REFUSE_LOGIN_R2
+			{
+				char reason[64];
+				int len = cmd == 0x6a ? 23 : 26;
+
+				if (RFIFOREST(fd) < len)
+					return 0;
+				snprintf(reason, sizeof(reason), "refused by the login-server (%d)", cmd == 0x6a ? RFIFOB(fd,2) : (int)RFIFOL(fd,2));
+				RFIFOSKIP(fd,len);
+				loadgen_bot_failed(bot, reason);
+				return 0;
+			}
+			default:
+				unframed++;
+				RFIFOSKIP(fd, RFIFOREST(fd));
+				return 0;
+		}
+	}
+	return 0;
+}
+
+/// Connects a bot to the login-server.
+static void loadgen_bot_start(struct loadgen_bot *bot)
+{
+	char userid[NAME_LENGTH];
+	int fd;
+
+	bot->state = LGS_LOGIN;
+	if (!loadgen_connect(bot, login_ip, login_port, loadgen_parse_login))
+		return;
+
+	loadgen_request(bot, LGR_LOGIN);
+
+	fd = bot->fd;
+	snprintf(userid, sizeof(userid), autoregister ? "%s_M" : "%s", bot->userid);
+	WFIFOHEAD(fd,55);
+	WFIFOW(fd,0) = 0x64;
+	WFIFOL(fd,2) = LOADGEN_CLIENT_VERSION;
+	safestrncpy((char*)WFIFOP(fd,6), userid, NAME_LENGTH);
+	safestrncpy((char*)WFIFOP(fd,30), password, NAME_LENGTH);
+	WFIFOB(fd,54) = 0; // client type
+	WFIFOSET(fd,55);
+}
+
+/*==========================================
+ * Main loop
+ *------------------------------------------*/
+
+/// Returns true when the current scenario is over.
+static bool loadgen_scenario_done(int64 tick)
+{
+	int i;
+
+	if (scenario_cur > 0)
+		return DIFF_TICK(tick, scenarios[scenario_cur].started) >= duration * 1000;
+
+	// Login scenario: until every bot is in game or failed
+	if (bots_started < bot_count)
+		return false;
+	for (i = 0; i < bot_count; i++) {
+		if (bots[i].state != LGS_READY && bots[i].state != LGS_FAILED)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Starts new bots, schedules the bots' requests and moves through the scenarios.
+ * @see timer->do_timer
+ */
+static int loadgen_timer(int tid, int64 tick, int id, intptr_t data)
+{
+	int i, target;
+
+	target = (int)min((int64)bot_count, ramp * DIFF_TICK(tick, ramp_start) / 1000 + 1);
+	while (bots_started < target)
+		loadgen_bot_start(&bots[bots_started++]);
+
+	for (i = 0; i < bots_started; i++) {
+		struct loadgen_bot *bot = &bots[i];
+
+		switch (bot->state) {
+			case LGS_LOGIN:
+			case LGS_CHAR:
+			case LGS_MAP:
+				if (DIFF_TICK(tick, bot->request_tick) > LOADGEN_LOGIN_TIMEOUT) {
+					scenarios[scenario_cur].latency[LGR_LOGIN].timeouts++;
+					loadgen_bot_failed(bot, "login timed out");
+				}
+				break;
+			case LGS_READY:
+				if (bot->request != LGR_NONE) {
+					if (DIFF_TICK(tick, bot->request_tick) <= LOADGEN_REQUEST_TIMEOUT)
+						break;
+					if (scenarios[scenario_cur].requests & (1<<bot->request))
+						scenarios[scenario_cur].latency[bot->request].timeouts++;
+					bot->request = LGR_NONE;
+				}
+				if (scenario_cur > 0 && DIFF_TICK(tick, bot->next_action) >= 0)
+					loadgen_bot_act(bot);
+				else if (DIFF_TICK(tick, bot->last_send) >= LOADGEN_KEEPALIVE)
+					loadgen_send_tick(bot);
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (!loadgen_scenario_done(tick))
+		return 0;
+
+	loadgen_scenario_report(&scenarios[scenario_cur]);
+	if (++scenario_cur == scenario_count) {
+		ShowStatus("Load test finished (%d packets could not be framed).\n", unframed);
+		core->runflag = CORE_ST_STOP;
+		return 0;
+	}
+	ShowStatus("Starting scenario '"CL_WHITE"%s"CL_RESET"' for %ds.\n", scenarios[scenario_cur].name, duration);
+	loadgen_scenario_start(&scenarios[scenario_cur]);
+	for (i = 0; i < bot_count; i++) {
+		// Replies to the previous scenario's requests are not counted in this one
+		if (bots[i].state == LGS_READY)
+			bots[i].request = LGR_NONE;
+		bots[i].next_action = tick + rnd() % (think + 1);
+	}
+	return 0;
+}
+
+/// Parses the comma-separated scenario list.
+static bool loadgen_scenarios_read(const char *list)
+{
+	char *names = aStrdup(list), *name, *saveptr = NULL;
+	bool ok = true;
+
+	memset(scenarios, 0, sizeof(scenarios));
+	safestrncpy(scenarios[0].name, "login", sizeof(scenarios[0].name));
+	scenarios[0].requests = 1<<LGR_LOGIN;
+	scenario_count = 1;
+
+	for (name = strtok_r(names, ",", &saveptr); name != NULL; name = strtok_r(NULL, ",", &saveptr)) {
+		int i;
+
+		trim(name);
+		ARR_FIND(0, ARRAYLENGTH(loadgen_scenario_db), i, strcmpi(loadgen_scenario_db[i].name, name) == 0);
+		if (i == ARRAYLENGTH(loadgen_scenario_db)) {
+			ShowError("loadgen_scenarios_read: unknown scenario '%s'.\n", name);
+			ok = false;
+			break;
+		}
+		if (scenario_count == LOADGEN_MAX_SCENARIOS) {
+			ShowError("loadgen_scenarios_read: too many scenarios (max %d).\n", LOADGEN_MAX_SCENARIOS - 1);
+			ok = false;
+			break;
+		}
+		if ((loadgen_scenario_db[i].requests & (1<<LGR_SKILL)) && skill_id == 0)
+			ShowWarning("loadgen_scenarios_read: scenario '%s' uses skills, but no --skill was given.\n", name);
+		safestrncpy(scenarios[scenario_count].name, loadgen_scenario_db[i].name, sizeof(scenarios[scenario_count].name));
+		scenarios[scenario_count].requests = loadgen_scenario_db[i].requests;
+		scenario_count++;
+	}
+	aFree(names);
+	return ok;
+}
+
+/*==========================================
+ * Command line
+ *------------------------------------------*/
+
+/**
+ * --login-ip handler
+ *
+ * Overrides the login-server address.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(loginip)
+{
+	aFree(login_ip_str);
+	login_ip_str = aStrdup(params);
+	return true;
+}
+
+/**
+ * --login-port handler
+ *
+ * Overrides the login-server port.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(loginport)
+{
+	login_port = (uint16)atoi(params);
+	return true;
+}
+
+/**
+ * --bots handler
+ *
+ * Sets the number of simulated players.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(bots)
+{
+	bot_count = atoi(params);
+	if (bot_count <= 0) {
+		ShowError("--bots: the number of bots must be positive.\n");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * --ramp handler
+ *
+ * Sets the number of bots started per second.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(ramp)
+{
+	ramp = max(1, atoi(params));
+	return true;
+}
+
+/**
+ * --user-prefix handler
+ *
+ * Overrides the account name prefix.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(userprefix)
+{
+	aFree(user_prefix);
+	user_prefix = aStrdup(params);
+	return true;
+}
+
+/**
+ * --password handler
+ *
+ * Overrides the accounts' password.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(password)
+{
+	aFree(password);
+	password = aStrdup(params);
+	return true;
+}
+
+/**
+ * --autoregister handler
+ *
+ * Creates missing accounts and characters.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(autoregister)
+{
+	autoregister = true;
+	return true;
+}
+
+/**
+ * --scenarios handler
+ *
+ * Overrides the list of scenarios.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(scenarios)
+{
+	aFree(scenario_list);
+	scenario_list = aStrdup(params);
+	return true;
+}
+
+/**
+ * --duration handler
+ *
+ * Sets the duration of each scenario, in seconds.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(duration)
+{
+	duration = max(1, atoi(params));
+	return true;
+}
+
+/**
+ * --think handler
+ *
+ * Sets the average delay between a reply and the next request of a bot, in milliseconds.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(think)
+{
+	think = max(0, atoi(params));
+	return true;
+}
+
+/**
+ * --skill handler
+ *
+ * Sets the skill used by the skill scenarios.
+ * @see cmdline->exec
+ */
+static CMDLINEARG(skill)
+{
+	if (sscanf(params, "%d,%d", &skill_id, &skill_lv) != 2 || skill_id <= 0 || skill_lv <= 0) {
+		ShowError("--skill: expected <skill id>,<skill level>.\n");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * --server-pid handler
+ *
+ * Adds a server process to the CPU usage report (can be repeated).
+ * @see cmdline->exec
+ */
+static CMDLINEARG(serverpid)
+{
+	if (server_pid_count == LOADGEN_MAX_PIDS) {
+		ShowError("--server-pid: too many processes (max %d).\n", LOADGEN_MAX_PIDS);
+		return false;
+	}
+	server_pids[server_pid_count++] = atoi(params);
+	return true;
+}
+
+/**
+ * --packet-obfuscation handler
+ *
+ * Obfuscates the commands sent to the map-server (packet_obfuscation: 2).
+ * @see cmdline->exec
+ */
+static CMDLINEARG(packetobfuscation)
+{
+	obfuscation = true;
+	return true;
+}
+
+/**
+ * Defines the local command line arguments
+ */
+void cmdline_args_init_local(void)
+{
+	CMDLINEARG_DEF2(login-ip, loginip, "Login-server address (default 127.0.0.1)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(login-port, loginport, "Login-server port (default 6900)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(bots, bots, "Number of simulated players (default 100)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(ramp, ramp, "Bots started per second (default 20)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(user-prefix, userprefix, "Account name prefix (default loadbot)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(password, password, "Account password (default loadbot)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(autoregister, autoregister, "Creates missing accounts (_M) and characters", CMDLINE_OPT_NORMAL);
+	CMDLINEARG_DEF2(scenarios, scenarios, "Comma-separated scenarios: idle, walk, chat, attack, skill, mix", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(duration, duration, "Duration of each scenario in seconds (default 30)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(think, think, "Average delay between requests of a bot in ms (default 1000)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(skill, skill, "Skill used by the skill scenarios: <id>,<level>", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(server-pid, serverpid, "Server process to report the CPU usage of (can be repeated)", CMDLINE_OPT_NORMAL|CMDLINE_OPT_PARAM);
+	CMDLINEARG_DEF2(packet-obfuscation, packetobfuscation, "Obfuscates the map-server packets", CMDLINE_OPT_NORMAL);
+}
+
+void set_server_type(void)
+{
+	SERVER_TYPE = SERVER_TYPE_UNKNOWN;
+}
+
+void do_abort(void)
+{
+}
+
+int do_init(int argc, char** argv)
+{
+	int i;
+
+	login_ip_str = aStrdup("127.0.0.1");
+	user_prefix = aStrdup("loadbot");
+	password = aStrdup("loadbot");
+	scenario_list = aStrdup("idle,walk,chat,attack,mix");
+
+	cmdline->exec(argc, argv, CMDLINE_OPT_PREINIT);
+	cmdline->exec(argc, argv, CMDLINE_OPT_NORMAL);
+
+	if (!loadgen_packet_loaddb() || !loadgen_scenarios_read(scenario_list)) {
+		core->runflag = CORE_ST_STOP;
+		return EXIT_FAILURE;
+	}
+
+	if ((login_ip = sockt->host2ip(login_ip_str)) == 0) {
+		ShowError("do_init: unable to resolve '%s'.\n", login_ip_str);
+		core->runflag = CORE_ST_STOP;
+		return EXIT_FAILURE;
+	}
+
+	CREATE(bots, struct loadgen_bot, bot_count);
+	for (i = 0; i < bot_count; i++) {
+		bots[i].index = i;
+		bots[i].fd = -1;
+		bots[i].request = LGR_NONE;
+		snprintf(bots[i].userid, sizeof(bots[i].userid), "%s%d", user_prefix, i + 1);
+	}
+
+	ShowStatus("Load test of %s:%d with %d bots (PACKETVER %d), %d scenarios of %ds.\n",
+	           login_ip_str, login_port, bot_count, PACKETVER, scenario_count - 1, duration);
+
+	timer->add_func_list(loadgen_timer, "loadgen_timer");
+	ramp_start = timer->gettick();
+	loadgen_scenario_start(&scenarios[0]);
+	timer->add_interval(ramp_start + LOADGEN_TIMER_INTERVAL, loadgen_timer, 0, 0, LOADGEN_TIMER_INTERVAL);
+
+	return EXIT_SUCCESS;
+}
+
+int do_final(void)
+{
+	int i, j;
+
+	for (i = 0; i < LOADGEN_MAX_SCENARIOS; i++) {
+		for (j = 0; j < LGR_MAX; j++)
+			VECTOR_CLEAR(scenarios[i].latency[j].samples);
+	}
+	if (bots != NULL)
+		aFree(bots);
+	aFree(login_ip_str);
+	aFree(user_prefix);
+	aFree(password);
+	aFree(scenario_list);
+	return EXIT_SUCCESS;
+}
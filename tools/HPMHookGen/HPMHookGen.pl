@@ -584,6 +584,22 @@ EOF
 	print FH <<"EOF";
 } count;
 
+#ifdef HPMHOOKING_PROFILE
+struct {
+EOF
+
+	foreach my $key (@$keysref) {
+		foreach my $if (@{ $ifs{$key} }) {
+
+			print FH <<"EOF";
+	struct HPMHookProfile $if->{hname};
+EOF
+		}
+	}
+	print FH <<"EOF";
+} profile;
+#endif // HPMHOOKING_PROFILE
+
 struct {
 EOF
 
@@ -633,12 +649,14 @@ EOF
 
 			print FH <<"EOF";
 $if->{handlerdef} {$if->{notes}
-	int hIndex = 0;${initialization}
+	int hIndex = 0;
+	HPM_PROFILE_DECL${initialization}
 	if( HPMHooks.count.$if->{hname}_pre ) {
 		$if->{predef}
 		*HPMforce_return = false;
 		for(hIndex = 0; hIndex < HPMHooks.count.$if->{hname}_pre; hIndex++ ) {$beforeblock3
 			preHookFunc = HPMHooks.list.$if->{hname}_pre[hIndex].func;
+			InterlockedIncrement64((volatile int64 *)&HPMHooks.list.$if->{hname}_pre[hIndex].calls);
 			$if->{precall}$afterblock3
 		}
 		if( *HPMforce_return ) {
@@ -647,12 +665,15 @@ $if->{handlerdef} {$if->{notes}
 		}
 	}
 	{$beforeblock2
-		$if->{origcall}$afterblock2
+		HPM_PROFILE_ENTER();
+		$if->{origcall}
+		HPM_PROFILE_LEAVE($if->{hname});$afterblock2
 	}
 	if( HPMHooks.count.$if->{hname}_post ) {
 		$if->{postdef}
 		for(hIndex = 0; hIndex < HPMHooks.count.$if->{hname}_post; hIndex++ ) {$beforeblock3
 			postHookFunc = HPMHooks.list.$if->{hname}_post[hIndex].func;
+			InterlockedIncrement64((volatile int64 *)&HPMHooks.list.$if->{hname}_post[hIndex].calls);
 			$if->{postcall}$afterblock3
 		}
 	}